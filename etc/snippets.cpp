@@ -167,3 +167,56 @@ fragment auto gather_fwd_fs(const gather_fwd_vs_output in [[stage_input]] /* , .
 		encode_2d_motion((in.motion_next.xy / in.motion_next.w) - (in.motion_now.xy / in.motion_now.w)),
 	}
 }
+
+//////////////////////////////////////////
+// unified motion (can be used by all warp modes via the *_unified functions)
+
+struct unified_uniforms_t {
+	matrix4f mvm; // @t
+	matrix4f prev_mvm; // @t-1
+	matrix4f mvpm; // @t
+	matrix4f prev_mvpm; // @t-1
+	/* ... */
+};
+
+struct unified_vs_output {
+	float4 motion_prev;
+	float4 motion_now;
+	float depth_prev;
+	float depth_now;
+	/* ... */
+};
+
+struct unified_fs_output {
+	/* e.g.: half4 color [[color(0)]] */
+	half4 motion [[color(1)]];
+	/* ... */
+};
+
+vertex auto unified_vs(buffer<const float3> in_position,
+					   param<unified_uniforms_t> uniforms
+					   /* ... */) {
+	unified_vs_output out;
+	
+	// get the vertex position for this id,
+	// transform it with the model-view-projection matrix from the previous and current frame to create the screen-space motion,
+	// and with the model-view matrix from the previous and current frame to create the linear depth delta
+	float4 pos { in_position[vertex_id], 1.0f };
+	out.motion_prev = pos * uniforms.prev_mvpm;
+	out.motion_now = pos * uniforms.mvpm;
+	out.depth_prev = -(pos * uniforms.prev_mvm).z;
+	out.depth_now = -(pos * uniforms.mvm).z;
+	
+	return out;
+}
+
+fragment auto unified_fs(const unified_vs_output in [[stage_input]] /* , ... */) {
+	return unified_fs_output {
+		/* color, ... */
+		half4 {
+			half2((in.motion_now.xy / in.motion_now.w) - (in.motion_prev.xy / in.motion_prev.w)),
+			(half)(in.depth_now - in.depth_prev),
+			0.0h
+		}
+	}
+}
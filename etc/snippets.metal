@@ -173,3 +173,55 @@ fragment gather_fwd_fs_output gather_fwd_fs(const gather_fwd_vs_output in [[stag
 		encode_2d_motion((in.motion_next.xy / in.motion_next.w) - (in.motion_now.xy / in.motion_now.w)),
 	}
 }
+
+//////////////////////////////////////////
+// unified motion (can be used by all warp modes via the *_unified functions)
+
+struct unified_uniforms_t {
+	matrix_float4x4 mvm; // @t
+	matrix_float4x4 prev_mvm; // @t-1
+	matrix_float4x4 mvpm; // @t
+	matrix_float4x4 prev_mvpm; // @t-1
+	/* ... */
+};
+
+struct unified_vs_output {
+	float4 motion_prev;
+	float4 motion_now;
+	float depth_prev;
+	float depth_now;
+	/* ... */
+};
+
+struct unified_fs_output {
+	/* e.g.: half4 color [[color(0)]] */
+	half4 motion [[color(1)]];
+	/* ... */
+};
+
+vertex unified_vs_output unified_vs(device const packed_float3* in_position [[buffer(0)]],
+									constant unified_uniforms_t& uniforms [[buffer(1)]],
+									/* ... */
+									const unsigned int vid [[vertex_id]]) {
+	unified_vs_output out;
+	
+	// get the vertex position for this id,
+	// transform it with the model-view-projection matrix from the previous and current frame to create the screen-space motion,
+	// and with the model-view matrix from the previous and current frame to create the linear depth delta
+	float4 pos(in_position[vid], 1.0f);
+	out.motion_prev = uniforms.prev_mvpm * pos;
+	out.motion_now = uniforms.mvpm * pos;
+	out.depth_prev = -(uniforms.prev_mvm * pos).z;
+	out.depth_now = -(uniforms.mvm * pos).z;
+	
+	return out;
+}
+
+fragment unified_fs_output unified_fs(const unified_vs_output in [[stage_in]] /* , ... */) {
+	return {
+		/* color, ... */
+		half4(half2((in.motion_now.xy / in.motion_now.w) - (in.motion_prev.xy / in.motion_prev.w)),
+			  half(in.depth_now - in.depth_prev),
+			  0.0h)
+	}
+}
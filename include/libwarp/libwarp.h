@@ -20,13 +20,20 @@
 #define __LIBWARP_H__
 
 #include <stdint.h>
+#include <stddef.h>
+// LIBWARP_CPU_ONLY: standalone CPU-only build without the libfloor runtime
+// (only the *_cpu warp functions, libwarp_prebuild, libwarp_cleanup and libwarp_destroy are available)
+#if !defined(LIBWARP_CPU_ONLY)
 #include <floor/core/essentials.hpp>
+#endif
 
-#if defined(__APPLE__) && defined(__OBJC__) && !defined(FLOOR_NO_METAL)
+#if defined(__APPLE__) && defined(__OBJC__) && !defined(FLOOR_NO_METAL) && !defined(LIBWARP_CPU_ONLY)
 #include <Metal/MTLTexture.h>
 #endif
 
-#if defined(__cplusplus)
+// NOTE: the Vulkan interop API is declared in libwarp/libwarp_vulkan.h
+
+#if defined(__cplusplus) && !defined(LIBWARP_CPU_ONLY)
 class compute_image;
 #include <memory>
 #endif
@@ -63,6 +70,51 @@ extern "C" {
 		LIBWARP_DEPTH_BUFFER_FAILURE	= 11,
 		//! failed to initialize libfloor
 		LIBWARP_FLOOR_INIT_FAILURE		= 12,
+		//! specified recording is invalid or has already been destroyed
+		LIBWARP_INVALID_RECORDING		= 13,
+		//! specified binding is not used by the recording
+		LIBWARP_INVALID_BINDING			= 14,
+		//! specified in-flight count is invalid (must be in [1, LIBWARP_MAX_IN_FLIGHT])
+		LIBWARP_INVALID_IN_FLIGHT_COUNT	= 15,
+		//! the warp job was cancelled or superseded by a newer job before it completed
+		LIBWARP_JOB_CANCELLED			= 16,
+		//! specified job handle is invalid or has already been waited on/released
+		LIBWARP_INVALID_JOB				= 17,
+		//! failed to allocate the low-confidence tile mask or the auto mode tile buffer, or no tile mask has been produced yet,
+		//! or the user-provided tile mask storage is too small
+		LIBWARP_TILE_MASK_FAILURE		= 18,
+		//! camera setup input downscale factor is invalid (must be 1, 2 or 4)
+		LIBWARP_INVALID_INPUT_DOWNSCALE	= 19,
+		//! failed to create the scatter history buffers
+		LIBWARP_HISTORY_BUFFER_FAILURE	= 20,
+		//! specified motion blur sample count is invalid (must be in [1, LIBWARP_MAX_MOTION_BLUR_SAMPLES])
+		LIBWARP_INVALID_MOTION_BLUR_SAMPLES	= 21,
+		//! less than two motion fields were specified for a composition, the composed motion field couldn't be created,
+		//! or the specified composition id isn't cached (anymore)
+		LIBWARP_MOTION_COMPOSITION_FAILURE	= 22,
+		//! invalid streaming parameters, failed to create the band images, or a stream callback failed
+		LIBWARP_STREAM_FAILURE			= 23,
+		//! camera setup projection or cubemap face is invalid
+		LIBWARP_INVALID_PROJECTION		= 24,
+		//! a required motion estimation image is missing or the luma pyramids couldn't be created
+		LIBWARP_MOTION_ESTIMATION_FAILURE	= 25,
+		//! invalid block motion block size or the block motion buffers couldn't be created/read
+		LIBWARP_BLOCK_MOTION_FAILURE		= 26,
+		//! invalid host output ring size/format or frame, or the ring images couldn't be created/mapped
+		LIBWARP_HOST_OUTPUT_FAILURE		= 27,
+		//! the requested host output frame is still being warped, or all host output ring entries are in use
+		LIBWARP_HOST_OUTPUT_NOT_READY	= 28,
+		//! a CPU warp image is missing or too small for the camera setup
+		LIBWARP_CPU_IMAGE_FAILURE		= 29,
+		//! failed to import, wait on or signal a Vulkan timeline semaphore
+		LIBWARP_VULKAN_SYNC_FAILURE		= 30,
+		//! failed to create the gather depth pyramid buffers
+		LIBWARP_DEPTH_PYRAMID_FAILURE	= 31,
+		//! the enabled optional outputs/features can't be combined with each other or with the called warp variant
+		//! (e.g. confidence output with unified motion, or block motion output together with confidence output)
+		LIBWARP_UNSUPPORTED_COMBINATION	= 32,
+		//! the specified camera setup is nullptr
+		LIBWARP_INVALID_CAMERA_SETUP	= 33,
 	} LIBWARP_ERROR_CODE;
 	
 	//! determines how depth values in the depth buffer should be interpreted
@@ -77,6 +129,35 @@ extern "C" {
 		//LIBWARP_DEPTH_LOG,
 	} LIBWARP_DEPTH_TYPE;
 	
+	//! footprint of a scattered pixel (scatter-based warping only)
+	typedef enum {
+		//! each source pixel is written to exactly one destination pixel, remaining single pixel holes are fixed up
+		LIBWARP_SPLAT_NONE,
+		//! each source pixel covers the 2x2 destination pixels around its scattered position
+		LIBWARP_SPLAT_2X2,
+		//! each source pixel covers its projected footprint (up to 4x4 pixels), which is estimated from its scattered neighbor
+		//! pixels -> hole-free output when geometry is magnified (e.g. camera moving towards it)
+		//! NOTE: this requires two additional depth/motion reads and scatter computations per pixel and pass
+		LIBWARP_SPLAT_ADAPTIVE,
+	} LIBWARP_SPLAT_MODE;
+	
+	//! projection model of the rendered images and the warped output
+	//! NOTE: gather-based warping only uses 2D motion and is thus independent of the projection,
+	//!       except for the depth linearization of the depth-aware modes
+	typedef enum {
+		//! perspective projection with a vertical field of view of 'field_of_view', optionally asymmetric (see frustum_shift_*)
+		LIBWARP_PROJECTION_PERSPECTIVE,
+		//! orthographic projection with a view volume height of 'ortho_height' (normalized depth is linear in [near, far])
+		LIBWARP_PROJECTION_ORTHOGRAPHIC,
+		//! equirectangular 360° panorama: x covers the longitude [-180°, 180°] (center looks along -z),
+		//! y the latitude [90°, -90°] (top to bottom), depth must be the distance to the camera origin
+		//! (i.e. use LIBWARP_DEPTH_LINEAR)
+		LIBWARP_PROJECTION_EQUIRECTANGULAR,
+		//! single face of a cubemap (90° perspective, see 'cube_face'), 3D motion must be in the cubemap space that is shared
+		//! by all faces (not in the space of the face camera)
+		LIBWARP_PROJECTION_CUBEMAP_FACE,
+	} LIBWARP_PROJECTION;
+	
 	//! all necessary camera state
 	//! NOTE: program/kernels will be recompiled when this changes
 	typedef struct libwarp_camera_setup {
@@ -88,9 +169,176 @@ extern "C" {
 		LIBWARP_DEPTH_TYPE depth_type;
 		//! when rendering with Metal/Vulkan: set this to true
 		bool is_screen_origin_top_left { true };
+		//! motion and depth inputs may be rendered at a reduced resolution of
+		//! ceil(screen_width / input_downscale) x ceil(screen_height / input_downscale), must be 1, 2 or 4
+		//! NOTE: scatter-based warping upsamples these with depth-edge-aware weights,
+		//!       gather-based warping samples them at normalized coordinates
+		uint32_t input_downscale { 1u };
+		//! footprint of scattered pixels in the depth and color passes of scatter-based warping
+		LIBWARP_SPLAT_MODE splat_mode { LIBWARP_SPLAT_NONE };
+		//! projection model of the rendered images and the warped output
+		LIBWARP_PROJECTION projection { LIBWARP_PROJECTION_PERSPECTIVE };
+		//! perspective projection only: off-axis shift of the projection center for asymmetric frusta (0 if symmetric),
+		//! i.e. the [2][0] and [2][1] entries of the projection matrix: (right + left) / (right - left), (top + bottom) / (top - bottom)
+		//! NOTE: 'field_of_view' is then the angle spanned by the frustum (top - bottom)
+		float frustum_shift_x { 0.0f };
+		float frustum_shift_y { 0.0f };
+		//! orthographic projection only: height of the view volume in world units (width is derived from the aspect ratio)
+		float ortho_height { 2.0f };
+		//! cubemap face projection only: rendered face (0 - 5: +X, -X, +Y, -Y, +Z, -Z)
+		uint32_t cube_face { 0u };
 	} libwarp_camera_setup;
 	
-#if defined(__APPLE__) && defined(__OBJC__) && !defined(FLOOR_NO_METAL)
+	//! handle of a recorded warp command sequence (see libwarp_record_*), 0 is never a valid recording
+	//! NOTE: handles are never reused, so a destroyed recording (or one destroyed by libwarp_cleanup/libwarp_destroy)
+	//!       reliably fails with LIBWARP_INVALID_RECORDING
+	typedef uint64_t libwarp_recording;
+	
+	//! image bindings of a recording, these can be replaced after recording via libwarp_rebind_*
+	typedef enum {
+		//! scatter/forward-only gather: color, bidirectional gather: current color
+		LIBWARP_BINDING_COLOR,
+		//! scatter: depth, bidirectional gather: current depth
+		LIBWARP_BINDING_DEPTH,
+		//! scatter/forward-only gather: motion, bidirectional gather: forward motion
+		LIBWARP_BINDING_MOTION,
+		//! output image of all warp modes
+		LIBWARP_BINDING_OUTPUT,
+		//! bidirectional gather: previous color
+		LIBWARP_BINDING_COLOR_PREV,
+		//! bidirectional gather: previous depth
+		LIBWARP_BINDING_DEPTH_PREV,
+		//! bidirectional gather: backward motion
+		LIBWARP_BINDING_MOTION_BACKWARD,
+		//! bidirectional gather: forward motion depth
+		LIBWARP_BINDING_MOTION_DEPTH_FORWARD,
+		//! bidirectional gather: backward motion depth
+		LIBWARP_BINDING_MOTION_DEPTH_BACKWARD,
+		//! amount of bindings (not a valid binding)
+		LIBWARP_BINDING_COUNT,
+	} LIBWARP_BINDING;
+	
+	//! handle of an asynchronously submitted warp job (0 is never a valid job)
+	typedef uint64_t libwarp_job;
+	
+	//! determines how a submitted warp job interacts with previously submitted jobs
+	typedef enum {
+		//! the job is executed after all previously submitted jobs
+		LIBWARP_SUBMIT_QUEUED,
+		//! all previously submitted jobs that haven't completed yet are cancelled (superseded by this job):
+		//! pending jobs are dropped before dispatch, a running multi-pass job stops before its next kernel
+		LIBWARP_SUBMIT_LATEST_WINS,
+	} LIBWARP_SUBMIT_MODE;
+	
+	//! warp mode that was selected by libwarp_auto_*
+	typedef enum {
+		//! all tiles were simple (consistent motion, no (dis)occlusions) -> forward-only gather from the previous frame
+		LIBWARP_WARP_MODE_GATHER_FORWARD_ONLY,
+		//! bidirectional gather for the whole frame
+		LIBWARP_WARP_MODE_GATHER_BIDIRECTIONAL,
+		//! forward-only gather for simple tiles and bidirectional gather for complex tiles
+		LIBWARP_WARP_MODE_GATHER_MIXED,
+	} LIBWARP_WARP_MODE;
+	
+	//! per-pixel confidence values that are written to the confidence output (see libwarp_set_confidence_output_*)
+	//! 1.0: valid unique source, 0.75: projected source, but occluded/not depth-consistent in both directions,
+	//! 0.5: partial/unconverged source, 0.0: no source (disocclusion/hole)
+	//! NOTE: any tile that contains a pixel with a confidence < 0.5 is marked in the low-confidence tile mask
+	typedef struct libwarp_tile_info {
+		//! width of a tile in pixels
+		uint32_t tile_width;
+		//! height of a tile in pixels
+		uint32_t tile_height;
+		//! amount of tiles in x direction
+		uint32_t tile_count_x;
+		//! amount of tiles in y direction
+		uint32_t tile_count_y;
+	} libwarp_tile_info;
+	
+	//! motion of a single block of the warp output (see libwarp_set_block_motion_output)
+	typedef struct libwarp_block_motion {
+		//! dominant motion (in quarter pixels) from the block in the warp output to its source in the current color input,
+		//! i.e. can be used as a motion vector candidate by a video encoder that encodes the warped frame
+		//! NOTE: this is the motion that most converged pixels of the block agree on (within half a pixel), averaged over these
+		int32_t mv_x;
+		int32_t mv_y;
+		//! sum of absolute luma differences (8-bit scale) between the output block and the motion compensated source block
+		uint32_t sad;
+		//! in [0, 1]: fraction of pixels in the block that agree on the dominant motion, reduced by the average luma difference
+		float confidence;
+	} libwarp_block_motion;
+	
+	//! block layout of the block motion output
+	typedef struct libwarp_block_motion_info {
+		//! width/height of a block in pixels
+		uint32_t block_size;
+		//! amount of blocks in x direction
+		uint32_t block_count_x;
+		//! amount of blocks in y direction
+		uint32_t block_count_y;
+	} libwarp_block_motion_info;
+	
+	//! pixel format of the host output ring images (see libwarp_set_host_output)
+	typedef enum {
+		//! RGBA 8-bit unsigned normalized
+		LIBWARP_HOST_OUTPUT_RGBA8,
+		//! RGBA 16-bit float
+		LIBWARP_HOST_OUTPUT_RGBA16F,
+		//! RGBA 32-bit float
+		LIBWARP_HOST_OUTPUT_RGBA32F,
+	} LIBWARP_HOST_OUTPUT_FORMAT;
+	
+	//! a mapped host output frame (see libwarp_map_host_output)
+	typedef struct libwarp_host_frame {
+		//! mapped pixel data, only valid until the frame is released
+		const void* data;
+		uint32_t width;
+		uint32_t height;
+		//! size of a pixel row in bytes
+		size_t row_pitch;
+		LIBWARP_HOST_OUTPUT_FORMAT format;
+	} libwarp_host_frame;
+	
+	//! max size of the host output ring
+#define LIBWARP_MAX_HOST_OUTPUT_RING 8u
+	
+	//! max amount of sub-frame samples of a motion blurred gather (see libwarp_gather_motion_blur_*)
+#define LIBWARP_MAX_MOTION_BLUR_SAMPLES 32u
+	
+	//! inputs of a streaming scatter (see libwarp_scatter_streaming)
+	typedef enum {
+		//! RGBA 32-bit float per pixel
+		LIBWARP_STREAM_INPUT_COLOR,
+		//! 32-bit float per pixel (according to the depth type of the camera setup)
+		LIBWARP_STREAM_INPUT_DEPTH,
+		//! encoded 3D motion, uint32_t per pixel (same format as for libwarp_scatter_metal)
+		LIBWARP_STREAM_INPUT_MOTION,
+	} LIBWARP_STREAM_INPUT;
+	
+	//! host-side input/output of a streaming scatter, all rows are tightly packed and have a width of screen_width pixels
+	typedef struct libwarp_stream_callbacks {
+		//! user pointer that is passed to all callbacks
+		void* user_data;
+		//! must write the 'row_count' frame rows starting at frame row 'first_row' of the specified input to 'rows',
+		//! return false to abort
+		bool (*read_rows)(void* user_data, const LIBWARP_STREAM_INPUT input,
+						  const uint32_t first_row, const uint32_t row_count, void* rows);
+		//! receives the 'row_count' finished output rows (RGBA 32-bit float) starting at frame row 'first_row',
+		//! 'rows' is only valid during the call, return false to abort
+		bool (*write_rows)(void* user_data, const uint32_t first_row, const uint32_t row_count, const void* rows);
+	} libwarp_stream_callbacks;
+	
+	//! host memory image of the CPU warp functions (see libwarp_scatter_cpu), rows are 'row_pitch' bytes apart
+	//! pixel formats: color/output RGBA 32-bit float, depth 32-bit float (according to the depth type of the camera setup),
+	//! motion uint32_t (encoded 3D motion for scatter, packed 2D motion for gather), motion depth RG 32-bit float
+	typedef struct libwarp_cpu_image {
+		void* data;
+		uint32_t width;
+		uint32_t height;
+		size_t row_pitch;
+	} libwarp_cpu_image;
+	
+#if defined(__APPLE__) && defined(__OBJC__) && !defined(FLOOR_NO_METAL) && !defined(LIBWARP_CPU_ONLY)
 	//! scatter-based warping for use with Metal
 	//! 'clear_frame' signals if the current color data (from previous frame(s)) shoud be cleared or not
 	//! -> if the frame is not cleared, then empty pixels will retain the color from previous frames
@@ -104,6 +352,47 @@ extern "C" {
 											 id <MTLTexture> motion_texture,
 											 id <MTLTexture> output_texture);
 	
+	//! scatter-based warping for use with Metal, using second-order (acceleration-aware) extrapolation
+	//! 'motion_prev_texture' is the 3D motion of the previous frame (same format as 'motion_texture'),
+	//! pixels are moved along the quadratic trajectory through their current and two previous positions:
+	//! displacement = delta * motion + 0.5 * delta * (delta + 1) * (motion - motion_prev)
+	LIBWARP_ERROR_CODE libwarp_scatter_accel_metal(const libwarp_camera_setup* const camera_setup,
+												   const float delta,
+												   const bool clear_frame,
+												   id <MTLTexture> color_texture,
+												   id <MTLTexture> depth_texture,
+												   id <MTLTexture> motion_texture,
+												   id <MTLTexture> motion_prev_texture,
+												   id <MTLTexture> output_texture);
+	
+	//! scatter-based warping for use with Metal, using unified motion
+	//! unified motion: single float4 image per frame (e.g. RGBA16F) that can be consumed by all warp modes
+	//! <xy: screen-space motion from the previous to the current frame (same NDC scale as the 2D motion),
+	//!  z: linear depth delta from the previous to the current frame (in world units), w: unused>
+	//! NOTE: renderers only need to write this single motion target (see etc/snippets.cpp)
+	LIBWARP_ERROR_CODE libwarp_scatter_unified_metal(const libwarp_camera_setup* const camera_setup,
+													 const float delta,
+													 const bool clear_frame,
+													 id <MTLTexture> color_texture,
+													 id <MTLTexture> depth_texture,
+													 id <MTLTexture> motion_texture,
+													 id <MTLTexture> output_texture);
+	
+	//! two-layer scatter-based warping for use with Metal
+	//! in addition to the first layer (nearest surface), this takes a second layer (second-nearest surface, e.g. depth-peeled)
+	//! which is only scattered into pixels that aren't covered by the first layer -> fills most disocclusion holes
+	//! NOTE: both layers use the same formats as libwarp_scatter_metal
+	LIBWARP_ERROR_CODE libwarp_scatter_two_layer_metal(const libwarp_camera_setup* const camera_setup,
+													   const float delta,
+													   const bool clear_frame,
+													   id <MTLTexture> color_texture,
+													   id <MTLTexture> depth_texture,
+													   id <MTLTexture> motion_texture,
+													   id <MTLTexture> color_layer2_texture,
+													   id <MTLTexture> depth_layer2_texture,
+													   id <MTLTexture> motion_layer2_texture,
+													   id <MTLTexture> output_texture);
+	
 	//! gather-based warping for use with Metal
 	//! NOTE: bidirectional warping
 	LIBWARP_ERROR_CODE libwarp_gather_metal(const libwarp_camera_setup* const camera_setup,
@@ -118,6 +407,19 @@ extern "C" {
 											id <MTLTexture> motion_depth_backward_texture,
 											id <MTLTexture> output_texture);
 	
+	//! gather-based warping for use with Metal, using the unified motion of the current and previous frame
+	//! (see libwarp_scatter_unified_metal)
+	//! NOTE: bidirectional warping, the forward motion (prev -> current) is approximated by the motion of the previous frame
+	LIBWARP_ERROR_CODE libwarp_gather_unified_metal(const libwarp_camera_setup* const camera_setup,
+													const float delta,
+													id <MTLTexture> color_current_texture,
+													id <MTLTexture> depth_current_texture,
+													id <MTLTexture> color_prev_texture,
+													id <MTLTexture> depth_prev_texture,
+													id <MTLTexture> motion_current_texture,
+													id <MTLTexture> motion_prev_texture,
+													id <MTLTexture> output_texture);
+	
 	//! gather-based warping for use with Metal
 	//! NOTE: forward-only warping
 	LIBWARP_ERROR_CODE libwarp_gather_forward_only_metal(const libwarp_camera_setup* const camera_setup,
@@ -125,9 +427,224 @@ extern "C" {
 														 id <MTLTexture> color_texture,
 														 id <MTLTexture> motion_texture,
 														 id <MTLTexture> output_texture);
+	
+	//! gather-based warping for use with Metal, using unified motion (see libwarp_scatter_unified_metal)
+	//! NOTE: forward-only warping
+	LIBWARP_ERROR_CODE libwarp_gather_forward_only_unified_metal(const libwarp_camera_setup* const camera_setup,
+																 const float delta,
+																 id <MTLTexture> color_texture,
+																 id <MTLTexture> motion_texture,
+																 id <MTLTexture> output_texture);
+	
+	//! gather-based warping for use with Metal
+	//! NOTE: forward-only warping using second-order extrapolation (see libwarp_scatter_accel_metal),
+	//!       'motion_prev_texture' is the 2D motion of the previous frame (same format as 'motion_texture')
+	LIBWARP_ERROR_CODE libwarp_gather_forward_only_accel_metal(const libwarp_camera_setup* const camera_setup,
+															   const float delta,
+															   id <MTLTexture> color_texture,
+															   id <MTLTexture> motion_texture,
+															   id <MTLTexture> motion_prev_texture,
+															   id <MTLTexture> output_texture);
+	
+	//! gather-based warping for use with Metal
+	//! NOTE: depth-aware forward-only warping: same as libwarp_gather_forward_only_metal, but also uses the depth of the
+	//!       color frame to resolve occlusions (nearest surface wins) and disocclusions (filled with the background)
+	//! NOTE: fails with LIBWARP_UNSUPPORTED_COMBINATION if confidence output, block motion output, the scatter history
+	//!       or the depth pyramid is enabled
+	LIBWARP_ERROR_CODE libwarp_gather_forward_only_depth_metal(const libwarp_camera_setup* const camera_setup,
+															   const float delta,
+															   id <MTLTexture> color_texture,
+															   id <MTLTexture> depth_texture,
+															   id <MTLTexture> motion_texture,
+															   id <MTLTexture> output_texture);
+	
+	//! motion blurred gather-based warping for use with Metal
+	//! NOTE: bidirectional warping (same inputs as libwarp_gather_metal), the output is the average of 'sample_count' warps
+	//!       at sub-frame deltas that are evenly distributed over the shutter interval [delta - shutter / 2, delta + shutter / 2]
+	//!       (clamped to [0, 1]), all sub-frame warps are computed in a single kernel invocation, sharing the motion search:
+	//!       each additional sample only costs a few color fetches
+	//! NOTE: fails with LIBWARP_UNSUPPORTED_COMBINATION if confidence output, block motion output, the scatter history
+	//!       or the depth pyramid is enabled
+	LIBWARP_ERROR_CODE libwarp_gather_motion_blur_metal(const libwarp_camera_setup* const camera_setup,
+														const float delta,
+														const float shutter,
+														const uint32_t sample_count,
+														id <MTLTexture> color_current_texture,
+														id <MTLTexture> depth_current_texture,
+														id <MTLTexture> color_prev_texture,
+														id <MTLTexture> depth_prev_texture,
+														id <MTLTexture> motion_forward_texture,
+														id <MTLTexture> motion_backward_texture,
+														id <MTLTexture> motion_depth_forward_texture,
+														id <MTLTexture> motion_depth_backward_texture,
+														id <MTLTexture> output_texture);
+	
+	//! motion blurred gather-based warping for use with Metal
+	//! NOTE: forward-only warping (same inputs as libwarp_gather_forward_only_metal), see libwarp_gather_motion_blur_metal
+	//!       (sub-frame deltas are not clamped, since this extrapolates)
+	LIBWARP_ERROR_CODE libwarp_gather_forward_only_motion_blur_metal(const libwarp_camera_setup* const camera_setup,
+																	 const float delta,
+																	 const float shutter,
+																	 const uint32_t sample_count,
+																	 id <MTLTexture> color_texture,
+																	 id <MTLTexture> motion_texture,
+																	 id <MTLTexture> output_texture);
+	
+	//! estimates the 2D motion from the source to the target frame for inputs that don't provide any motion (e.g. video),
+	//! using hierarchical block matching (3 luma pyramid levels, 8x8 blocks, sub-pixel refinement)
+	//! the motion is stored at the source positions and written in the format of the 2D motion inputs of the gather-based
+	//! warp modes (R32UI), if 'invert_motion' is set, the negated motion is written instead:
+	//!  * bidirectional gather: forward motion = (source: previous, target: current),
+	//!                          backward motion = (source: current, target: previous)
+	//!  * forward-only gather: motion = (source: current, target: previous, inverted) -> constant velocity extrapolation
+	//! if both depth textures and 'motion_depth_texture' (RG32F) are non-nil, the motion depth is written as well
+	//! NOTE: the motion range is limited to +/-24px by the search (+/-6px at the coarsest level)
+	LIBWARP_ERROR_CODE libwarp_estimate_motion_metal(const libwarp_camera_setup* const camera_setup,
+													 const bool invert_motion,
+													 id <MTLTexture> color_src_texture,
+													 id <MTLTexture> color_dst_texture,
+													 id <MTLTexture> depth_src_texture,
+													 id <MTLTexture> depth_dst_texture,
+													 id <MTLTexture> motion_texture,
+													 id <MTLTexture> motion_depth_texture);
+	
+	//! composes 'motion_texture_count' (>= 2) consecutive 2D motion textures (same format as for libwarp_gather_forward_only_metal)
+	//! into a single long-range motion field: motion_textures[i] is the motion from frame i to i + 1 (at frame i),
+	//! the composed motion is the motion from frame 0 to frame 'motion_texture_count' (at frame 0)
+	//! -> e.g. to only render every n-th frame and warp from the last rendered frame over multiple frames
+	//! the composed motion field is owned by libwarp and cached under 'composition_id' (the last few compositions are kept),
+	//! composing an already cached id is a no-op, so this may simply be called before each warp
+	//! NOTE: all compositions of the same id must use the same motion textures
+	LIBWARP_ERROR_CODE libwarp_compose_motion_metal(const libwarp_camera_setup* const camera_setup,
+													const uint64_t composition_id,
+													const id <MTLTexture>* motion_textures,
+													const uint32_t motion_texture_count);
+	
+	//! gather-based warping for use with Metal
+	//! NOTE: forward-only warping using the composed motion field of 'composition_id' (see libwarp_compose_motion_metal),
+	//!       'delta' is relative to the full composed interval (1.0 == frame 'motion_texture_count')
+	LIBWARP_ERROR_CODE libwarp_gather_forward_only_composed_metal(const libwarp_camera_setup* const camera_setup,
+																  const uint64_t composition_id,
+																  const float delta,
+																  id <MTLTexture> color_texture,
+																  id <MTLTexture> output_texture);
+	
+	//! records the scatter-based warp command sequence for the specified Metal textures,
+	//! which can then be executed any number of times via libwarp_replay
+	//! NOTE: recordings only contain the plain warp modes: all libwarp_record_* calls fail with
+	//!       LIBWARP_UNSUPPORTED_COMBINATION if confidence output, block motion output, the scatter history or the depth
+	//!       pyramid is enabled, or if the last warp of the same mode used unified motion, second-order extrapolation or
+	//!       a second layer
+	LIBWARP_ERROR_CODE libwarp_record_scatter_metal(const libwarp_camera_setup* const camera_setup,
+													const bool clear_frame,
+													id <MTLTexture> color_texture,
+													id <MTLTexture> depth_texture,
+													id <MTLTexture> motion_texture,
+													id <MTLTexture> output_texture,
+													libwarp_recording* recording);
+	
+	//! records the bidirectional gather-based warp command sequence for the specified Metal textures
+	//! NOTE: since current and previous textures swap every other frame, either record two sequences or rebind them
+	LIBWARP_ERROR_CODE libwarp_record_gather_metal(const libwarp_camera_setup* const camera_setup,
+												   id <MTLTexture> color_current_texture,
+												   id <MTLTexture> depth_current_texture,
+												   id <MTLTexture> color_prev_texture,
+												   id <MTLTexture> depth_prev_texture,
+												   id <MTLTexture> motion_forward_texture,
+												   id <MTLTexture> motion_backward_texture,
+												   id <MTLTexture> motion_depth_forward_texture,
+												   id <MTLTexture> motion_depth_backward_texture,
+												   id <MTLTexture> output_texture,
+												   libwarp_recording* recording);
+	
+	//! records the forward-only gather-based warp command sequence for the specified Metal textures
+	LIBWARP_ERROR_CODE libwarp_record_gather_forward_only_metal(const libwarp_camera_setup* const camera_setup,
+																id <MTLTexture> color_texture,
+																id <MTLTexture> motion_texture,
+																id <MTLTexture> output_texture,
+																libwarp_recording* recording);
+	
+	//! replaces the texture of the specified binding in a recording
+	LIBWARP_ERROR_CODE libwarp_rebind_metal(libwarp_recording recording,
+											const LIBWARP_BINDING binding,
+											id <MTLTexture> texture);
+	
+	//! asynchronously submits a scatter-based warp job for use with Metal (see libwarp_scatter_metal)
+	LIBWARP_ERROR_CODE libwarp_submit_scatter_metal(const libwarp_camera_setup* const camera_setup,
+													const float delta,
+													const bool clear_frame,
+													id <MTLTexture> color_texture,
+													id <MTLTexture> depth_texture,
+													id <MTLTexture> motion_texture,
+													id <MTLTexture> output_texture,
+													const LIBWARP_SUBMIT_MODE submit_mode,
+													libwarp_job* job);
+	
+	//! asynchronously submits a bidirectional gather-based warp job for use with Metal (see libwarp_gather_metal)
+	LIBWARP_ERROR_CODE libwarp_submit_gather_metal(const libwarp_camera_setup* const camera_setup,
+												   const float delta,
+												   id <MTLTexture> color_current_texture,
+												   id <MTLTexture> depth_current_texture,
+												   id <MTLTexture> color_prev_texture,
+												   id <MTLTexture> depth_prev_texture,
+												   id <MTLTexture> motion_forward_texture,
+												   id <MTLTexture> motion_backward_texture,
+												   id <MTLTexture> motion_depth_forward_texture,
+												   id <MTLTexture> motion_depth_backward_texture,
+												   id <MTLTexture> output_texture,
+												   const LIBWARP_SUBMIT_MODE submit_mode,
+												   libwarp_job* job);
+	
+	//! asynchronously submits a forward-only gather-based warp job for use with Metal (see libwarp_gather_forward_only_metal)
+	LIBWARP_ERROR_CODE libwarp_submit_gather_forward_only_metal(const libwarp_camera_setup* const camera_setup,
+																const float delta,
+																id <MTLTexture> color_texture,
+																id <MTLTexture> motion_texture,
+																id <MTLTexture> output_texture,
+																const LIBWARP_SUBMIT_MODE submit_mode,
+																libwarp_job* job);
+	
+	//! automatic gather-based warping for use with Metal, takes the same inputs as libwarp_gather_metal
+	//! per tile, the forward/backward motion consistency is checked: tiles without (dis)occlusions are warped forward-only,
+	//! others bidirectionally; per frame, the cheapest of forward-only, bidirectional or mixed warping is selected based on
+	//! these statistics and the measured kernel costs
+	//! NOTE: 'selected_mode' may be nil, otherwise it is set to the mode that has been executed
+	//! NOTE: mixed warping is never selected while confidence output, block motion output, the scatter history or the
+	//!       depth pyramid is enabled
+	LIBWARP_ERROR_CODE libwarp_auto_metal(const libwarp_camera_setup* const camera_setup,
+										  const float delta,
+										  id <MTLTexture> color_current_texture,
+										  id <MTLTexture> depth_current_texture,
+										  id <MTLTexture> color_prev_texture,
+										  id <MTLTexture> depth_prev_texture,
+										  id <MTLTexture> motion_forward_texture,
+										  id <MTLTexture> motion_backward_texture,
+										  id <MTLTexture> motion_depth_forward_texture,
+										  id <MTLTexture> motion_depth_backward_texture,
+										  id <MTLTexture> output_texture,
+										  LIBWARP_WARP_MODE* selected_mode);
+	
+	//! sets the single-channel float texture that subsequent warp calls will write per-pixel confidence values to
+	//! and enables generation of the low-confidence tile mask, a nil texture disables confidence output again
+	//! NOTE: gather calls with unified motion or second-order extrapolation fail with LIBWARP_UNSUPPORTED_COMBINATION
+	//!       while confidence output is enabled
+	LIBWARP_ERROR_CODE libwarp_set_confidence_output_metal(id <MTLTexture> confidence_texture);
+	
+	//! acquires the next host output ring entry for the specified camera setup (see libwarp_set_host_output):
+	//! 'output_texture' must be used as the output texture of the next warp call, which must then be followed by
+	//! libwarp_commit_host_output with the returned 'frame'
+	LIBWARP_ERROR_CODE libwarp_acquire_host_output_metal(const libwarp_camera_setup* const camera_setup,
+														 id <MTLTexture>* output_texture,
+														 uint32_t* frame);
+	
+	//! replaces all low-confidence tiles of the last warp output with the corresponding tiles of the re-rendered texture
+	//! (i.e. only these tiles need to be re-rendered, see libwarp_get_low_confidence_tiles)
+	LIBWARP_ERROR_CODE libwarp_merge_metal(const libwarp_camera_setup* const camera_setup,
+										   id <MTLTexture> rerendered_texture,
+										   id <MTLTexture> output_texture);
 #endif
 	
-#if defined(__cplusplus)
+#if defined(__cplusplus) && !defined(LIBWARP_CPU_ONLY)
 	//! scatter-based warping for use with any libfloor-based backend
 	//! 'clear_frame' signals if the current color data (from previous frame(s)) should be cleared or not
 	//! -> if the frame is not cleared, then empty pixels will retain the color from previous frames
@@ -141,6 +658,39 @@ extern "C" {
 											 std::shared_ptr<compute_image> motion_texture,
 											 std::shared_ptr<compute_image> output_texture);
 	
+	//! scatter-based warping for use with any libfloor-based backend, using second-order extrapolation
+	//! (see libwarp_scatter_accel_metal)
+	LIBWARP_ERROR_CODE libwarp_scatter_accel_floor(const libwarp_camera_setup* const camera_setup,
+												   const float delta,
+												   const bool clear_frame,
+												   std::shared_ptr<compute_image> color_texture,
+												   std::shared_ptr<compute_image> depth_texture,
+												   std::shared_ptr<compute_image> motion_texture,
+												   std::shared_ptr<compute_image> motion_prev_texture,
+												   std::shared_ptr<compute_image> output_texture);
+	
+	//! scatter-based warping for use with any libfloor-based backend, using unified motion
+	//! (see libwarp_scatter_unified_metal)
+	LIBWARP_ERROR_CODE libwarp_scatter_unified_floor(const libwarp_camera_setup* const camera_setup,
+													 const float delta,
+													 const bool clear_frame,
+													 std::shared_ptr<compute_image> color_texture,
+													 std::shared_ptr<compute_image> depth_texture,
+													 std::shared_ptr<compute_image> motion_texture,
+													 std::shared_ptr<compute_image> output_texture);
+	
+	//! two-layer scatter-based warping for use with any libfloor-based backend (see libwarp_scatter_two_layer_metal)
+	LIBWARP_ERROR_CODE libwarp_scatter_two_layer_floor(const libwarp_camera_setup* const camera_setup,
+													   const float delta,
+													   const bool clear_frame,
+													   std::shared_ptr<compute_image> color_texture,
+													   std::shared_ptr<compute_image> depth_texture,
+													   std::shared_ptr<compute_image> motion_texture,
+													   std::shared_ptr<compute_image> color_layer2_texture,
+													   std::shared_ptr<compute_image> depth_layer2_texture,
+													   std::shared_ptr<compute_image> motion_layer2_texture,
+													   std::shared_ptr<compute_image> output_texture);
+	
 	//! scatter-based warping for use with any libfloor-based backend
 	//! NOTE: bidirectional warping
 	LIBWARP_ERROR_CODE libwarp_gather_floor(const libwarp_camera_setup* const camera_setup,
@@ -155,6 +705,18 @@ extern "C" {
 											std::shared_ptr<compute_image> motion_depth_backward_texture,
 											std::shared_ptr<compute_image> output_texture);
 	
+	//! gather-based warping for use with any libfloor-based backend, using the unified motion of the current and previous frame
+	//! (see libwarp_gather_unified_metal)
+	LIBWARP_ERROR_CODE libwarp_gather_unified_floor(const libwarp_camera_setup* const camera_setup,
+													const float delta,
+													std::shared_ptr<compute_image> color_current_texture,
+													std::shared_ptr<compute_image> depth_current_texture,
+													std::shared_ptr<compute_image> color_prev_texture,
+													std::shared_ptr<compute_image> depth_prev_texture,
+													std::shared_ptr<compute_image> motion_current_texture,
+													std::shared_ptr<compute_image> motion_prev_texture,
+													std::shared_ptr<compute_image> output_texture);
+	
 	//! scatter-based warping for use with any libfloor-based backend
 	//! NOTE: forward-only warping
 	LIBWARP_ERROR_CODE libwarp_gather_forward_only_floor(const libwarp_camera_setup* const camera_setup,
@@ -162,12 +724,377 @@ extern "C" {
 														 std::shared_ptr<compute_image> color_texture,
 														 std::shared_ptr<compute_image> motion_texture,
 														 std::shared_ptr<compute_image> output_texture);
+	
+	//! gather-based warping for use with any libfloor-based backend, using unified motion
+	//! (see libwarp_scatter_unified_metal)
+	//! NOTE: forward-only warping
+	LIBWARP_ERROR_CODE libwarp_gather_forward_only_unified_floor(const libwarp_camera_setup* const camera_setup,
+																 const float delta,
+																 std::shared_ptr<compute_image> color_texture,
+																 std::shared_ptr<compute_image> motion_texture,
+																 std::shared_ptr<compute_image> output_texture);
+	
+	//! gather-based warping for use with any libfloor-based backend
+	//! NOTE: forward-only warping using second-order extrapolation (see libwarp_gather_forward_only_accel_metal)
+	LIBWARP_ERROR_CODE libwarp_gather_forward_only_accel_floor(const libwarp_camera_setup* const camera_setup,
+															   const float delta,
+															   std::shared_ptr<compute_image> color_texture,
+															   std::shared_ptr<compute_image> motion_texture,
+															   std::shared_ptr<compute_image> motion_prev_texture,
+															   std::shared_ptr<compute_image> output_texture);
+	
+	//! gather-based warping for use with any libfloor-based backend
+	//! NOTE: depth-aware forward-only warping (see libwarp_gather_forward_only_depth_metal)
+	LIBWARP_ERROR_CODE libwarp_gather_forward_only_depth_floor(const libwarp_camera_setup* const camera_setup,
+															   const float delta,
+															   std::shared_ptr<compute_image> color_texture,
+															   std::shared_ptr<compute_image> depth_texture,
+															   std::shared_ptr<compute_image> motion_texture,
+															   std::shared_ptr<compute_image> output_texture);
+	
+	//! motion blurred gather-based warping for use with any libfloor-based backend (see libwarp_gather_motion_blur_metal)
+	LIBWARP_ERROR_CODE libwarp_gather_motion_blur_floor(const libwarp_camera_setup* const camera_setup,
+														const float delta,
+														const float shutter,
+														const uint32_t sample_count,
+														std::shared_ptr<compute_image> color_current_texture,
+														std::shared_ptr<compute_image> depth_current_texture,
+														std::shared_ptr<compute_image> color_prev_texture,
+														std::shared_ptr<compute_image> depth_prev_texture,
+														std::shared_ptr<compute_image> motion_forward_texture,
+														std::shared_ptr<compute_image> motion_backward_texture,
+														std::shared_ptr<compute_image> motion_depth_forward_texture,
+														std::shared_ptr<compute_image> motion_depth_backward_texture,
+														std::shared_ptr<compute_image> output_texture);
+	
+	//! motion blurred forward-only gather-based warping for use with any libfloor-based backend
+	//! (see libwarp_gather_forward_only_motion_blur_metal)
+	LIBWARP_ERROR_CODE libwarp_gather_forward_only_motion_blur_floor(const libwarp_camera_setup* const camera_setup,
+																	 const float delta,
+																	 const float shutter,
+																	 const uint32_t sample_count,
+																	 std::shared_ptr<compute_image> color_texture,
+																	 std::shared_ptr<compute_image> motion_texture,
+																	 std::shared_ptr<compute_image> output_texture);
+	
+	//! block-matching motion estimation for use with any libfloor-based backend (see libwarp_estimate_motion_metal)
+	//! NOTE: depth images and 'motion_depth_texture' may be nullptr
+	LIBWARP_ERROR_CODE libwarp_estimate_motion_floor(const libwarp_camera_setup* const camera_setup,
+													 const bool invert_motion,
+													 std::shared_ptr<compute_image> color_src_texture,
+													 std::shared_ptr<compute_image> color_dst_texture,
+													 std::shared_ptr<compute_image> depth_src_texture,
+													 std::shared_ptr<compute_image> depth_dst_texture,
+													 std::shared_ptr<compute_image> motion_texture,
+													 std::shared_ptr<compute_image> motion_depth_texture);
+	
+	//! composes consecutive 2D motion images into a single long-range motion field (see libwarp_compose_motion_metal)
+	LIBWARP_ERROR_CODE libwarp_compose_motion_floor(const libwarp_camera_setup* const camera_setup,
+													const uint64_t composition_id,
+													const std::shared_ptr<compute_image>* motion_textures,
+													const uint32_t motion_texture_count);
+	
+	//! forward-only gather-based warping for use with any libfloor-based backend, using a composed motion field
+	//! (see libwarp_gather_forward_only_composed_metal)
+	LIBWARP_ERROR_CODE libwarp_gather_forward_only_composed_floor(const libwarp_camera_setup* const camera_setup,
+																  const uint64_t composition_id,
+																  const float delta,
+																  std::shared_ptr<compute_image> color_texture,
+																  std::shared_ptr<compute_image> output_texture);
+	
+	//! records the scatter-based warp command sequence for the specified images,
+	//! which can then be executed any number of times via libwarp_replay
+	LIBWARP_ERROR_CODE libwarp_record_scatter_floor(const libwarp_camera_setup* const camera_setup,
+													const bool clear_frame,
+													std::shared_ptr<compute_image> color_texture,
+													std::shared_ptr<compute_image> depth_texture,
+													std::shared_ptr<compute_image> motion_texture,
+													std::shared_ptr<compute_image> output_texture,
+													libwarp_recording* recording);
+	
+	//! records the bidirectional gather-based warp command sequence for the specified images
+	//! NOTE: since current and previous images swap every other frame, either record two sequences or rebind them
+	LIBWARP_ERROR_CODE libwarp_record_gather_floor(const libwarp_camera_setup* const camera_setup,
+												   std::shared_ptr<compute_image> color_current_texture,
+												   std::shared_ptr<compute_image> depth_current_texture,
+												   std::shared_ptr<compute_image> color_prev_texture,
+												   std::shared_ptr<compute_image> depth_prev_texture,
+												   std::shared_ptr<compute_image> motion_forward_texture,
+												   std::shared_ptr<compute_image> motion_backward_texture,
+												   std::shared_ptr<compute_image> motion_depth_forward_texture,
+												   std::shared_ptr<compute_image> motion_depth_backward_texture,
+												   std::shared_ptr<compute_image> output_texture,
+												   libwarp_recording* recording);
+	
+	//! records the forward-only gather-based warp command sequence for the specified images
+	LIBWARP_ERROR_CODE libwarp_record_gather_forward_only_floor(const libwarp_camera_setup* const camera_setup,
+																std::shared_ptr<compute_image> color_texture,
+																std::shared_ptr<compute_image> motion_texture,
+																std::shared_ptr<compute_image> output_texture,
+																libwarp_recording* recording);
+	
+	//! replaces the image of the specified binding in a recording
+	LIBWARP_ERROR_CODE libwarp_rebind_floor(libwarp_recording recording,
+											const LIBWARP_BINDING binding,
+											std::shared_ptr<compute_image> texture);
+	
+	//! asynchronously submits a scatter-based warp job for use with any libfloor-based backend (see libwarp_scatter_floor)
+	LIBWARP_ERROR_CODE libwarp_submit_scatter_floor(const libwarp_camera_setup* const camera_setup,
+													const float delta,
+													const bool clear_frame,
+													std::shared_ptr<compute_image> color_texture,
+													std::shared_ptr<compute_image> depth_texture,
+													std::shared_ptr<compute_image> motion_texture,
+													std::shared_ptr<compute_image> output_texture,
+													const LIBWARP_SUBMIT_MODE submit_mode,
+													libwarp_job* job);
+	
+	//! asynchronously submits a bidirectional gather-based warp job for use with any libfloor-based backend (see libwarp_gather_floor)
+	LIBWARP_ERROR_CODE libwarp_submit_gather_floor(const libwarp_camera_setup* const camera_setup,
+												   const float delta,
+												   std::shared_ptr<compute_image> color_current_texture,
+												   std::shared_ptr<compute_image> depth_current_texture,
+												   std::shared_ptr<compute_image> color_prev_texture,
+												   std::shared_ptr<compute_image> depth_prev_texture,
+												   std::shared_ptr<compute_image> motion_forward_texture,
+												   std::shared_ptr<compute_image> motion_backward_texture,
+												   std::shared_ptr<compute_image> motion_depth_forward_texture,
+												   std::shared_ptr<compute_image> motion_depth_backward_texture,
+												   std::shared_ptr<compute_image> output_texture,
+												   const LIBWARP_SUBMIT_MODE submit_mode,
+												   libwarp_job* job);
+	
+	//! asynchronously submits a forward-only gather-based warp job for use with any libfloor-based backend
+	//! (see libwarp_gather_forward_only_floor)
+	LIBWARP_ERROR_CODE libwarp_submit_gather_forward_only_floor(const libwarp_camera_setup* const camera_setup,
+																const float delta,
+																std::shared_ptr<compute_image> color_texture,
+																std::shared_ptr<compute_image> motion_texture,
+																std::shared_ptr<compute_image> output_texture,
+																const LIBWARP_SUBMIT_MODE submit_mode,
+																libwarp_job* job);
+	
+	//! automatic gather-based warping for use with any libfloor-based backend (see libwarp_auto_metal)
+	LIBWARP_ERROR_CODE libwarp_auto_floor(const libwarp_camera_setup* const camera_setup,
+										  const float delta,
+										  std::shared_ptr<compute_image> color_current_texture,
+										  std::shared_ptr<compute_image> depth_current_texture,
+										  std::shared_ptr<compute_image> color_prev_texture,
+										  std::shared_ptr<compute_image> depth_prev_texture,
+										  std::shared_ptr<compute_image> motion_forward_texture,
+										  std::shared_ptr<compute_image> motion_backward_texture,
+										  std::shared_ptr<compute_image> motion_depth_forward_texture,
+										  std::shared_ptr<compute_image> motion_depth_backward_texture,
+										  std::shared_ptr<compute_image> output_texture,
+										  LIBWARP_WARP_MODE* selected_mode);
+	
+	//! sets the single-channel float image that subsequent warp calls will write per-pixel confidence values to
+	//! and enables generation of the low-confidence tile mask, a nullptr image disables confidence output again
+	//! NOTE: see libwarp_set_confidence_output_metal for unsupported combinations
+	LIBWARP_ERROR_CODE libwarp_set_confidence_output_floor(std::shared_ptr<compute_image> confidence_texture);
+	
+	//! acquires the next host output ring entry for the specified camera setup (see libwarp_acquire_host_output_metal)
+	LIBWARP_ERROR_CODE libwarp_acquire_host_output_floor(const libwarp_camera_setup* const camera_setup,
+														 std::shared_ptr<compute_image>* output_texture,
+														 uint32_t* frame);
+	
+	//! replaces all low-confidence tiles of the last warp output with the corresponding tiles of the re-rendered image
+	//! (i.e. only these tiles need to be re-rendered, see libwarp_get_low_confidence_tiles)
+	LIBWARP_ERROR_CODE libwarp_merge_floor(const libwarp_camera_setup* const camera_setup,
+										   std::shared_ptr<compute_image> rerendered_texture,
+										   std::shared_ptr<compute_image> output_texture);
 #endif
 	
+	//! retrieves the low-confidence tile mask of the last warp call that had confidence output enabled
+	//! 'tile_mask' must be able to hold tile_count_x * tile_count_y values (row-major, non-zero: tile needs re-rendering)
+	//! NOTE: 'tile_mask' may be NULL to only query the tile info, 'tile_info' may be NULL if it isn't needed
+	//! NOTE: this waits until the corresponding warp job has completed
+	LIBWARP_ERROR_CODE libwarp_get_low_confidence_tiles(const libwarp_camera_setup* const camera_setup,
+														uint32_t* tile_mask,
+														const uint32_t tile_mask_count,
+														libwarp_tile_info* tile_info);
+	
+	//! enables per-block motion output with the specified block size (8 or 16, 0 disables it again):
+	//! subsequent (non-unified, non-accelerated) forward-only and bidirectional gather calls store the motion of all
+	//! converged pixels that were sampled from the current color input while warping (pixels that were only sampled from the
+	//! previous color input don't contribute) and resolve it into the dominant motion per block (one libwarp_block_motion)
+	//! NOTE: while enabled, unified/accelerated gather calls, gather calls with confidence output and bidirectional gather calls
+	//!       with the depth pyramid fail with LIBWARP_UNSUPPORTED_COMBINATION
+	LIBWARP_ERROR_CODE libwarp_set_block_motion_output(const uint32_t block_size);
+	
+	//! retrieves the block motion of the last gather call that had block motion output enabled
+	//! 'blocks' must be able to hold block_count_x * block_count_y entries (row-major)
+	//! NOTE: 'blocks' may be NULL to only query the block info, 'block_info' may be NULL if it isn't needed
+	//! NOTE: this waits until the corresponding warp job has completed
+	LIBWARP_ERROR_CODE libwarp_get_block_motion(const libwarp_camera_setup* const camera_setup,
+												libwarp_block_motion* blocks,
+												const uint32_t block_capacity,
+												libwarp_block_motion_info* block_info);
+	
+	//! executes a previously recorded warp command sequence with the specified time delta
+	//! NOTE: nothing but the time delta is updated, all images/kernels/parameters were resolved when recording
+	//! NOTE: like any other warp, a replay occupies an in-flight slot (see libwarp_set_in_flight_count)
+	LIBWARP_ERROR_CODE libwarp_replay(libwarp_recording recording, const float delta);
+	
+	//! destroys a recording, the handle is invalid afterwards
+	//! NOTE: all recordings are also destroyed by libwarp_cleanup and libwarp_destroy
+	void libwarp_destroy_recording(libwarp_recording recording);
+	
+	//! cancels a submitted warp job: if it hasn't been dispatched yet, it is dropped,
+	//! if it is currently running, no further kernels of it are dispatched
+	//! NOTE: the job handle stays valid until it is waited on or released
+	LIBWARP_ERROR_CODE libwarp_cancel_job(const libwarp_job job);
+	
+	//! waits until the specified job has completed or was cancelled and returns its result
+	//! (LIBWARP_JOB_CANCELLED if it was cancelled/superseded), the job handle is invalid afterwards
+	LIBWARP_ERROR_CODE libwarp_wait_job(const libwarp_job job);
+	
+	//! releases the job handle without waiting for it (the job itself is still executed, unless cancelled)
+	LIBWARP_ERROR_CODE libwarp_release_job(const libwarp_job job);
+	
+	//! max amount of warp jobs that can be in flight at the same time
+#define LIBWARP_MAX_IN_FLIGHT 4u
+	
+	//! sets the amount of warp jobs that may be in flight at the same time (default: 1)
+	//! with a count > 1, each consecutive warp job uses its own compute queue and internal resources (e.g. scatter depth buffer),
+	//! and warp calls return as soon as all kernels have been enqueued, so that consecutive jobs can overlap on the device
+	//! NOTE: the output of a job may only be accessed after a call to libwarp_finish,
+	//!       all input/output images must stay unmodified until then
+	LIBWARP_ERROR_CODE libwarp_set_in_flight_count(const uint32_t count);
+	
+	//! waits until all in-flight warp jobs have completed
+	LIBWARP_ERROR_CODE libwarp_finish();
+	
+	//! enables or disables temporal hole filling for scatter-based warping (default: disabled)
+	//! if enabled, libwarp keeps a history of the last covered color and depth of each pixel, as well as its age
+	//! (amount of warped frames since it was last covered): holes are filled from the history, which is reprojected with the
+	//! scatter motion, weighted by its age and blended with the covered neighborhood, history samples that would occlude the
+	//! surrounding background are rejected
+	//! NOTE: this replaces the clear and fixup passes ('clear_frame' is ignored),
+	//!       (re-)enabling resets the history (e.g. on camera cuts), recording fails while it is enabled
+	//! NOTE: a different color input than in the previous warp is assumed to be the next frame (delta is relative to it)
+	//! NOTE: with an in-flight count > 1, the history resolve of a warp job waits until the previous warp job has completed
+	LIBWARP_ERROR_CODE libwarp_set_scatter_history(const bool enable);
+	
+	//! enables or disables the min/max depth pyramid of bidirectional gather-based warping (default: disabled)
+	//! if enabled, a min/max depth pyramid is built once per input frame, which the gather uses to rule out occluders
+	//! around each pixel, skipping the depth reads of its occlusion check wherever the depth range around the pixel and its
+	//! motion depth rule out any occlusion (the output is the same as without the pyramid, up to float rounding)
+	//! NOTE: a frame is new when the gather switches to the other image set (i.e. the current color image changes), if the input
+	//!       images are updated in place instead, this must be called again for every new frame (resets the pyramids)
+	//! NOTE: can't be combined with confidence output, block motion output or unified motion,
+	//!       bidirectional gather calls fail with LIBWARP_UNSUPPORTED_COMBINATION in that case
+	//! NOTE: each in-flight slot (see libwarp_set_in_flight_count) keeps its own pyramids, which it builds on first use per frame
+	LIBWARP_ERROR_CODE libwarp_set_gather_depth_pyramid(const bool enable);
+	
+	//! streaming (out-of-core) scatter-based warping for frames that don't fit into device memory (e.g. 16K or gigapixel frames):
+	//! the frame is processed in horizontal bands of 'band_height' output rows, the inputs of each band are read through the
+	//! callbacks, including a halo of rows above and below it, and its output rows are written once they are finished
+	//! -> device memory usage is proportional to the band size, not the frame size
+	//! 'max_displacement' must be an upper bound of the screen-space displacement (in pixels) of any pixel at 'delta',
+	//! it determines the halo size: pixels that move further than this across band boundaries are lost
+	//! NOTE: the frame is always cleared, input downscaling, second-order/unified motion, two-layer scatter, temporal hole
+	//!       filling and confidence output are not supported, single pixel holes at band boundaries are fixed up within the band
+	//! NOTE: fails with LIBWARP_UNSUPPORTED_COMBINATION if temporal hole filling or confidence output is enabled, or if the last
+	//!       scatter used second-order/unified motion or a second layer
+	//! NOTE: this is blocking, each band is completed before the next one is read
+	LIBWARP_ERROR_CODE libwarp_scatter_streaming(const libwarp_camera_setup* const camera_setup,
+												 const float delta,
+												 const uint32_t band_height,
+												 const float max_displacement,
+												 const libwarp_stream_callbacks* const callbacks);
+	
+	//! enables the host output ring with the specified size (in [2, LIBWARP_MAX_HOST_OUTPUT_RING], 0 disables it again):
+	//! libwarp allocates 'ring_size' host-visible output images of the specified format, each warp writes into the next
+	//! ring entry (see libwarp_acquire_host_output_*), which the host can then map without an additional copy, while the
+	//! next frames are already being warped into the other entries
+	//! flow: acquire -> warp into the acquired output -> commit -> ... -> map -> consume -> release
+	//! NOTE: all ring entries must have been released before the ring can be changed or disabled
+	LIBWARP_ERROR_CODE libwarp_set_host_output(const uint32_t ring_size, const LIBWARP_HOST_OUTPUT_FORMAT format);
+	
+	//! signals that the warp into the specified acquired host output frame has been executed/enqueued,
+	//! the frame's completion fence is the in-flight slot of that warp
+	//! NOTE: for warp jobs, this must be called after libwarp_wait_job
+	LIBWARP_ERROR_CODE libwarp_commit_host_output(const uint32_t frame);
+	
+	//! maps the specified committed host output frame: if 'wait' is true, this waits until the warp has completed,
+	//! otherwise LIBWARP_HOST_OUTPUT_NOT_READY is returned if it hasn't been waited on yet (e.g. by later warps reusing
+	//! its in-flight slot or libwarp_finish)
+	LIBWARP_ERROR_CODE libwarp_map_host_output(const uint32_t frame, const bool wait, libwarp_host_frame* host_frame);
+	
+	//! unmaps the specified host output frame and returns its ring entry to libwarp, 'host_frame.data' is invalid afterwards
+	LIBWARP_ERROR_CODE libwarp_release_host_output(const uint32_t frame);
+	
+	//! scatter-based warping on the CPU, using host memory images (see libwarp_scatter_floor)
+	//! NOTE: this doesn't require the libfloor runtime and is the only scatter mode of CPU-only builds,
+	//!       confidence output, two-layer scatter, temporal hole filling and recordings are not supported
+	//! NOTE: this is blocking and executed by the CPU warp thread pool (see libwarp_set_cpu_thread_count),
+	//!       pixels are processed by scalar code (multithreaded, but not vectorized)
+	LIBWARP_ERROR_CODE libwarp_scatter_cpu(const libwarp_camera_setup* const camera_setup,
+										   const float delta,
+										   const bool clear_frame,
+										   const libwarp_cpu_image* const color_image,
+										   const libwarp_cpu_image* const depth_image,
+										   const libwarp_cpu_image* const motion_image,
+										   const libwarp_cpu_image* output_image);
+	
+	//! bidirectional gather-based warping on the CPU, using host memory images (see libwarp_gather_floor)
+	//! NOTE: in contrast to the GPU variant, image sets aren't swapped internally, all images must always be specified
+	LIBWARP_ERROR_CODE libwarp_gather_cpu(const libwarp_camera_setup* const camera_setup,
+										  const float delta,
+										  const libwarp_cpu_image* const color_current_image,
+										  const libwarp_cpu_image* const depth_current_image,
+										  const libwarp_cpu_image* const color_prev_image,
+										  const libwarp_cpu_image* const depth_prev_image,
+										  const libwarp_cpu_image* const motion_forward_image,
+										  const libwarp_cpu_image* const motion_backward_image,
+										  const libwarp_cpu_image* const motion_depth_forward_image,
+										  const libwarp_cpu_image* const motion_depth_backward_image,
+										  const libwarp_cpu_image* output_image);
+	
+	//! forward-only gather-based warping on the CPU, using host memory images (see libwarp_gather_forward_only_floor)
+	LIBWARP_ERROR_CODE libwarp_gather_forward_only_cpu(const libwarp_camera_setup* const camera_setup,
+													   const float delta,
+													   const libwarp_cpu_image* const color_image,
+													   const libwarp_cpu_image* const motion_image,
+													   const libwarp_cpu_image* output_image);
+	
+	//! sets the amount of worker threads of the CPU warp functions (0: amount of hardware threads, default)
+	LIBWARP_ERROR_CODE libwarp_set_cpu_thread_count(const uint32_t count);
+	
 	//! optional helper function that can be used to pre-build a program for the specified camera setup
 	LIBWARP_ERROR_CODE libwarp_prebuild(const libwarp_camera_setup* const camera_setup);
 	
+	//! progress callback of libwarp_prebuild_async, called from a prebuild worker thread once the program of
+	//! 'camera_setup' has been built ('result'), 'built_count' of 'total_count' setups of all outstanding prebuilds are done
+	//! NOTE: must not call any libwarp function other than libwarp_get_prebuild_progress
+	typedef void (*libwarp_prebuild_callback)(void* user_data,
+											  const libwarp_camera_setup* camera_setup,
+											  const LIBWARP_ERROR_CODE result,
+											  const uint32_t built_count,
+											  const uint32_t total_count);
+	
+	//! asynchronously pre-builds the programs of all 'count' camera setups on 'thread_count' worker threads
+	//! (0: amount of hardware threads), setups that are already built or being built are skipped
+	//! programs are built outside of the warp lock: warps of already built setups are not blocked while this is running,
+	//! warps of setups that are still being built wait for them to finish (instead of building them a second time)
+	//! NOTE: 'callback' is optional, 'camera_setups' may be freed once this returns
+	//! NOTE: not available in CPU-only builds
+	LIBWARP_ERROR_CODE libwarp_prebuild_async(const libwarp_camera_setup* const camera_setups,
+											  const uint32_t count,
+											  const uint32_t thread_count,
+											  libwarp_prebuild_callback callback,
+											  void* user_data);
+	
+	//! returns how many setups of all outstanding async prebuilds have been built (non-blocking)
+	//! NOTE: the counts are reset once all outstanding prebuilds are done and a new async prebuild is started
+	LIBWARP_ERROR_CODE libwarp_get_prebuild_progress(uint32_t* built_count, uint32_t* total_count);
+	
+	//! waits until all outstanding async prebuilds are done and returns the first error that occurred (if any)
+	LIBWARP_ERROR_CODE libwarp_wait_prebuild();
+	
 	//! optional helper function that can be used to clear any run-time state
+	//! NOTE: all pending warp jobs are cancelled and the currently executing one is waited on
 	void libwarp_cleanup();
 	
 	//! deinitializes and destroys all libwarp state
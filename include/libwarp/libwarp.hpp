@@ -0,0 +1,316 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __LIBWARP_HPP__
+#define __LIBWARP_HPP__
+
+#include <libwarp/libwarp.h>
+
+#if !defined(LIBWARP_CPU_ONLY)
+#include <atomic>
+#include <memory>
+#include <span>
+#include <utility>
+
+//! C++20 API for use with any libfloor-based backend
+//! * images are passed as non-owning views (no ref-count traffic or heap allocations per warp call)
+//! * context and job objects are move-only RAII handles of the libwarp state and of submitted warp jobs
+//! * batched warp calls execute multiple frames under a single lock acquisition
+//! NOTE: the corresponding libwarp_*_floor functions of the C API are thin wrappers around this
+namespace libwarp {
+	
+	//! non-owning view of a libfloor image, referring to the std::shared_ptr that is owned by the caller
+	//! NOTE: the referenced std::shared_ptr must outlive the warp call the view is passed to,
+	//!       libwarp only takes (shared) ownership of an image when it is bound for the first time (or the bound image changes),
+	//!       so that re-using the same images every frame doesn't cause any ref-count traffic
+	class image_view {
+	public:
+		constexpr image_view() = default;
+		constexpr image_view(std::nullptr_t) {}
+		constexpr image_view(const std::shared_ptr<compute_image>& img) : img_ptr(&img) {}
+		
+		//! returns the referenced image (or a nullptr image if this is an empty view)
+		const std::shared_ptr<compute_image>& get() const {
+			return (img_ptr != nullptr ? *img_ptr : null_image);
+		}
+		
+		explicit operator bool() const {
+			return (img_ptr != nullptr && *img_ptr != nullptr);
+		}
+		
+	protected:
+		const std::shared_ptr<compute_image>* img_ptr { nullptr };
+		static inline const std::shared_ptr<compute_image> null_image {};
+	};
+	
+	//! images of a scatter-based warp (see libwarp_scatter_floor)
+	struct scatter_images {
+		image_view color;
+		image_view depth;
+		image_view motion;
+		image_view output;
+	};
+	
+	//! images of a bidirectional gather-based warp (see libwarp_gather_floor)
+	struct gather_images {
+		image_view color_current;
+		image_view depth_current;
+		image_view color_prev;
+		image_view depth_prev;
+		image_view motion_forward;
+		image_view motion_backward;
+		image_view motion_depth_forward;
+		image_view motion_depth_backward;
+		image_view output;
+	};
+	
+	//! images of a forward-only gather-based warp (see libwarp_gather_forward_only_floor)
+	struct gather_forward_only_images {
+		image_view color;
+		image_view motion;
+		image_view output;
+	};
+	
+	//! a single frame of a batched scatter-based warp
+	struct scatter_frame {
+		float delta;
+		bool clear_frame;
+		scatter_images images;
+	};
+	
+	//! a single frame of a batched bidirectional gather-based warp
+	struct gather_frame {
+		float delta;
+		gather_images images;
+	};
+	
+	//! a single frame of a batched forward-only gather-based warp
+	struct gather_forward_only_frame {
+		float delta;
+		gather_forward_only_images images;
+	};
+	
+	//! move-only handle of an asynchronously submitted warp job:
+	//! the job handle is released on destruction (the job itself is still executed, unless cancelled)
+	class job {
+	public:
+		job() = default;
+		explicit job(const libwarp_job handle_) : handle(handle_) {}
+		~job() {
+			release();
+		}
+		
+		job(job&& other) noexcept : handle(std::exchange(other.handle, 0)) {}
+		job& operator=(job&& other) noexcept {
+			if (this != &other) {
+				release();
+				handle = std::exchange(other.handle, 0);
+			}
+			return *this;
+		}
+		job(const job&) = delete;
+		job& operator=(const job&) = delete;
+		
+		//! returns the underlying job handle (0 if this doesn't refer to a job)
+		libwarp_job get() const {
+			return handle;
+		}
+		
+		explicit operator bool() const {
+			return (handle != 0);
+		}
+		
+		//! cancels the job (see libwarp_cancel_job)
+		LIBWARP_ERROR_CODE cancel() const {
+			return (handle != 0 ? libwarp_cancel_job(handle) : LIBWARP_INVALID_JOB);
+		}
+		
+		//! waits until the job has completed or was cancelled and returns its result (see libwarp_wait_job)
+		//! NOTE: this doesn't refer to a job anymore afterwards
+		LIBWARP_ERROR_CODE wait() {
+			return (handle != 0 ? libwarp_wait_job(std::exchange(handle, 0)) : LIBWARP_INVALID_JOB);
+		}
+		
+		//! returns the job handle and gives up ownership of it (it must then be waited on or released manually)
+		libwarp_job detach() {
+			return std::exchange(handle, 0);
+		}
+		
+		//! releases the job handle without waiting for the job (see libwarp_release_job)
+		void release() {
+			if (handle != 0) {
+				libwarp_release_job(std::exchange(handle, 0));
+			}
+		}
+		
+	protected:
+		libwarp_job handle { 0 };
+	};
+	
+	//! scatter-based warping (see libwarp_scatter_floor)
+	LIBWARP_ERROR_CODE scatter(const libwarp_camera_setup& camera_setup,
+							   const float delta,
+							   const bool clear_frame,
+							   const scatter_images& images);
+	
+	//! bidirectional gather-based warping (see libwarp_gather_floor)
+	LIBWARP_ERROR_CODE gather(const libwarp_camera_setup& camera_setup,
+							  const float delta,
+							  const gather_images& images);
+	
+	//! forward-only gather-based warping (see libwarp_gather_forward_only_floor)
+	LIBWARP_ERROR_CODE gather_forward_only(const libwarp_camera_setup& camera_setup,
+										   const float delta,
+										   const gather_forward_only_images& images);
+	
+	//! batched scatter-based warping: warps all frames in order, stops at the first frame that fails and returns its error
+	LIBWARP_ERROR_CODE scatter(const libwarp_camera_setup& camera_setup,
+							   std::span<const scatter_frame> frames);
+	
+	//! batched bidirectional gather-based warping (see batched scatter)
+	LIBWARP_ERROR_CODE gather(const libwarp_camera_setup& camera_setup,
+							  std::span<const gather_frame> frames);
+	
+	//! batched forward-only gather-based warping (see batched scatter)
+	LIBWARP_ERROR_CODE gather_forward_only(const libwarp_camera_setup& camera_setup,
+										   std::span<const gather_forward_only_frame> frames);
+	
+	//! asynchronously submits a scatter-based warp job (see libwarp_submit_scatter_floor)
+	//! NOTE: the job takes (shared) ownership of all images until it has been executed
+	LIBWARP_ERROR_CODE submit_scatter(const libwarp_camera_setup& camera_setup,
+									  const float delta,
+									  const bool clear_frame,
+									  const scatter_images& images,
+									  job& submitted_job,
+									  const LIBWARP_SUBMIT_MODE submit_mode = LIBWARP_SUBMIT_QUEUED);
+	
+	//! asynchronously submits a bidirectional gather-based warp job (see libwarp_submit_gather_floor)
+	LIBWARP_ERROR_CODE submit_gather(const libwarp_camera_setup& camera_setup,
+									 const float delta,
+									 const gather_images& images,
+									 job& submitted_job,
+									 const LIBWARP_SUBMIT_MODE submit_mode = LIBWARP_SUBMIT_QUEUED);
+	
+	//! asynchronously submits a forward-only gather-based warp job (see libwarp_submit_gather_forward_only_floor)
+	LIBWARP_ERROR_CODE submit_gather_forward_only(const libwarp_camera_setup& camera_setup,
+												  const float delta,
+												  const gather_forward_only_images& images,
+												  job& submitted_job,
+												  const LIBWARP_SUBMIT_MODE submit_mode = LIBWARP_SUBMIT_QUEUED);
+	
+	//! move-only shared owner of the libwarp state for a specific camera setup
+	//! NOTE: libwarp state is global and shared by all contexts, libwarp_destroy is only called once the last context
+	//!       has been destroyed (libwarp_cleanup via any context still affects all of them)
+	class context {
+	public:
+		explicit context(const libwarp_camera_setup& camera_setup_) : camera_setup(camera_setup_) {
+			++owner_count;
+		}
+		~context() {
+			if (is_owner) {
+				release();
+			}
+		}
+		
+		context(context&& other) noexcept : camera_setup(other.camera_setup), is_owner(std::exchange(other.is_owner, false)) {}
+		context& operator=(context&& other) noexcept {
+			// the current ownership is released first (same as destruction), then the one of the other context is taken over
+			if (this != &other) {
+				if (is_owner) {
+					release();
+				}
+				camera_setup = other.camera_setup;
+				is_owner = std::exchange(other.is_owner, false);
+			}
+			return *this;
+		}
+		context(const context&) = delete;
+		context& operator=(const context&) = delete;
+		
+		const libwarp_camera_setup& get_camera_setup() const {
+			return camera_setup;
+		}
+		
+		//! sets the camera setup that is used by all subsequent warp calls of this context
+		void set_camera_setup(const libwarp_camera_setup& camera_setup_) {
+			camera_setup = camera_setup_;
+		}
+		
+		//! pre-builds the warp program for the current camera setup (see libwarp_prebuild)
+		LIBWARP_ERROR_CODE prebuild() const {
+			return libwarp_prebuild(&camera_setup);
+		}
+		
+		//! clears any run-time state (see libwarp_cleanup)
+		void cleanup() const {
+			libwarp_cleanup();
+		}
+		
+		LIBWARP_ERROR_CODE scatter(const float delta, const bool clear_frame, const scatter_images& images) const {
+			return libwarp::scatter(camera_setup, delta, clear_frame, images);
+		}
+		LIBWARP_ERROR_CODE gather(const float delta, const gather_images& images) const {
+			return libwarp::gather(camera_setup, delta, images);
+		}
+		LIBWARP_ERROR_CODE gather_forward_only(const float delta, const gather_forward_only_images& images) const {
+			return libwarp::gather_forward_only(camera_setup, delta, images);
+		}
+		
+		LIBWARP_ERROR_CODE scatter(std::span<const scatter_frame> frames) const {
+			return libwarp::scatter(camera_setup, frames);
+		}
+		LIBWARP_ERROR_CODE gather(std::span<const gather_frame> frames) const {
+			return libwarp::gather(camera_setup, frames);
+		}
+		LIBWARP_ERROR_CODE gather_forward_only(std::span<const gather_forward_only_frame> frames) const {
+			return libwarp::gather_forward_only(camera_setup, frames);
+		}
+		
+		LIBWARP_ERROR_CODE submit_scatter(const float delta, const bool clear_frame, const scatter_images& images,
+										  job& submitted_job, const LIBWARP_SUBMIT_MODE submit_mode = LIBWARP_SUBMIT_QUEUED) const {
+			return libwarp::submit_scatter(camera_setup, delta, clear_frame, images, submitted_job, submit_mode);
+		}
+		LIBWARP_ERROR_CODE submit_gather(const float delta, const gather_images& images,
+										 job& submitted_job, const LIBWARP_SUBMIT_MODE submit_mode = LIBWARP_SUBMIT_QUEUED) const {
+			return libwarp::submit_gather(camera_setup, delta, images, submitted_job, submit_mode);
+		}
+		LIBWARP_ERROR_CODE submit_gather_forward_only(const float delta, const gather_forward_only_images& images,
+													  job& submitted_job, const LIBWARP_SUBMIT_MODE submit_mode = LIBWARP_SUBMIT_QUEUED) const {
+			return libwarp::submit_gather_forward_only(camera_setup, delta, images, submitted_job, submit_mode);
+		}
+		
+	protected:
+		libwarp_camera_setup camera_setup;
+		bool is_owner { true };
+		
+		// amount of contexts that currently own the libwarp state
+		static inline std::atomic<uint32_t> owner_count { 0u };
+		
+		static void release() {
+			if (--owner_count == 0u) {
+				libwarp_destroy();
+			}
+		}
+	};
+	
+} // namespace libwarp
+
+#endif
+
+#endif
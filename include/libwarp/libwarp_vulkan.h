@@ -0,0 +1,122 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef __LIBWARP_VULKAN_H__
+#define __LIBWARP_VULKAN_H__
+
+// Vulkan interop API: separate from libwarp.h, so that only users of the Vulkan interop depend on the Vulkan headers
+#include <libwarp/libwarp.h>
+
+#if !defined(FLOOR_NO_VULKAN) && !defined(LIBWARP_CPU_ONLY)
+#include <vulkan/vulkan.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+	
+	//! Vulkan image that is shared with libwarp through external memory (zero-copy, see libwarp_scatter_vulkan)
+	//! the image memory must have been allocated with VkExportMemoryAllocateInfo on the same physical device
+	//! (see libwarp_get_vulkan_device_uuid), using an opaque fd (Linux/Android) or opaque win32 handle (Windows)
+	typedef struct {
+		//! the caller's image, only used to identify the image (imports are cached per image, see libwarp_release_vulkan_image)
+		VkImage image;
+		//! exported handle of the image memory (opaque fd or win32 handle), ownership stays with the caller
+		int64_t memory_handle;
+		//! size of the exported memory allocation
+		uint64_t memory_size;
+		//! offset of the image in the exported memory allocation
+		uint64_t memory_offset;
+		//! memory type index the exported memory was allocated with (libwarp uses the same physical device, so this is
+		//! also a valid index on the libwarp device), the import must use the same memory type
+		uint32_t memory_type_index;
+		//! the create info the image was created with, the image is re-created with it on the libwarp device
+		//! NOTE: 'pNext' is ignored, only 2D images with 1 mip level and 1 layer are supported,
+		//!       input images require VK_IMAGE_USAGE_SAMPLED_BIT, the output image VK_IMAGE_USAGE_STORAGE_BIT
+		VkImageCreateInfo create_info;
+		//! the layout the image is in while libwarp accesses it (the output image must be in VK_IMAGE_LAYOUT_GENERAL)
+		VkImageLayout layout;
+	} libwarp_vulkan_image;
+	
+	//! synchronization with the caller via one of its timeline semaphores
+	//! the semaphore must have been created with VkExportSemaphoreCreateInfo (opaque fd or opaque win32 handle)
+	typedef struct {
+		//! the caller's timeline semaphore, only used to identify the semaphore (imports are cached per semaphore)
+		VkSemaphore semaphore;
+		//! exported handle of the semaphore (opaque fd or win32 handle), ownership stays with the caller
+		int64_t semaphore_handle;
+		//! libwarp won't access any image before the semaphore has reached this value
+		uint64_t wait_value;
+		//! the semaphore is signaled with this value once the warp has completed and the output image can be used
+		uint64_t signal_value;
+	} libwarp_vulkan_sync;
+	
+	//! retrieves the device UUID of the Vulkan device libwarp is using ('uuid' must point to VK_UUID_SIZE bytes),
+	//! external memory and semaphores can only be shared with a VkDevice of the same physical device
+	LIBWARP_ERROR_CODE libwarp_get_vulkan_device_uuid(uint8_t* uuid);
+	
+	//! scatter-based warping for use with Vulkan (see libwarp_scatter_metal)
+	//! all images are imported into the libwarp device on first use and cached until released or libwarp_cleanup
+	//! NOTE: if 'sync' is non-null, libwarp waits for 'wait_value' on the host before executing the warp and signals
+	//!       'signal_value' from the host once the warp has completed (i.e. the call blocks until then, even in async mode),
+	//!       if 'sync' is null, the caller is responsible for not accessing the images while the warp is executed
+	LIBWARP_ERROR_CODE libwarp_scatter_vulkan(const libwarp_camera_setup* const camera_setup,
+											  const float delta,
+											  const bool clear_frame,
+											  const libwarp_vulkan_image* const color_image,
+											  const libwarp_vulkan_image* const depth_image,
+											  const libwarp_vulkan_image* const motion_image,
+											  const libwarp_vulkan_image* const output_image,
+											  const libwarp_vulkan_sync* const sync);
+	
+	//! gather-based warping for use with Vulkan (see libwarp_gather_metal and libwarp_scatter_vulkan)
+	//! NOTE: bidirectional warping
+	LIBWARP_ERROR_CODE libwarp_gather_vulkan(const libwarp_camera_setup* const camera_setup,
+											 const float delta,
+											 const libwarp_vulkan_image* const color_current_image,
+											 const libwarp_vulkan_image* const depth_current_image,
+											 const libwarp_vulkan_image* const color_prev_image,
+											 const libwarp_vulkan_image* const depth_prev_image,
+											 const libwarp_vulkan_image* const motion_forward_image,
+											 const libwarp_vulkan_image* const motion_backward_image,
+											 const libwarp_vulkan_image* const motion_depth_forward_image,
+											 const libwarp_vulkan_image* const motion_depth_backward_image,
+											 const libwarp_vulkan_image* const output_image,
+											 const libwarp_vulkan_sync* const sync);
+	
+	//! gather-based warping for use with Vulkan (see libwarp_gather_forward_only_metal and libwarp_scatter_vulkan)
+	//! NOTE: forward-only warping
+	LIBWARP_ERROR_CODE libwarp_gather_forward_only_vulkan(const libwarp_camera_setup* const camera_setup,
+														  const float delta,
+														  const libwarp_vulkan_image* const color_image,
+														  const libwarp_vulkan_image* const motion_image,
+														  const libwarp_vulkan_image* const output_image,
+														  const libwarp_vulkan_sync* const sync);
+	
+	//! releases the cached imports of the specified image (must be called before the caller destroys/re-allocates it)
+	//! NOTE: an image that has been used as input and as output is imported once per access mode, both are released
+	//! NOTE: waits for all in-flight warps to complete
+	LIBWARP_ERROR_CODE libwarp_release_vulkan_image(VkImage image);
+	
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+
+#endif
@@ -49,6 +49,30 @@
 #define LIBWARP_FAR_PLANE 500.0f
 #endif
 
+// LIBWARP_PROJECTION: projection model of the input and output images
+// 0 = perspective (optionally asymmetric), 1 = orthographic, 2 = equirectangular (360° panorama), 3 = cubemap face
+#if !defined(LIBWARP_PROJECTION)
+#define LIBWARP_PROJECTION 0
+#endif
+
+// LIBWARP_FRUSTUM_SHIFT_X/LIBWARP_FRUSTUM_SHIFT_Y: perspective off-axis shift of the projection center in NDC (asymmetric frustum)
+#if !defined(LIBWARP_FRUSTUM_SHIFT_X)
+#define LIBWARP_FRUSTUM_SHIFT_X 0.0f
+#endif
+#if !defined(LIBWARP_FRUSTUM_SHIFT_Y)
+#define LIBWARP_FRUSTUM_SHIFT_Y 0.0f
+#endif
+
+// LIBWARP_ORTHO_HEIGHT: orthographic view volume height in world units
+#if !defined(LIBWARP_ORTHO_HEIGHT)
+#define LIBWARP_ORTHO_HEIGHT 2.0f
+#endif
+
+// LIBWARP_CUBE_FACE: rendered cubemap face (0 - 5: +X, -X, +Y, -Y, +Z, -Z)
+#if !defined(LIBWARP_CUBE_FACE)
+#define LIBWARP_CUBE_FACE 0
+#endif
+
 // TILE_SIZE_X: work-group x-size / tile width
 #if !defined(TILE_SIZE_X)
 #if defined(__WINDOWS__) && defined(FLOOR_COMPUTE_HOST)
@@ -123,42 +147,164 @@ namespace warp_camera {
 	static constexpr const float2 inv_screen_size { 1.0f / screen_size };
 	// screen width / height aspect ratio
 	static constexpr const float aspect_ratio { screen_size.x / screen_size.y };
-	// projection up vector
-	static constexpr const float _up_vec { const_math::tan(const_math::deg_to_rad(LIBWARP_SCREEN_FOV) * 0.5f) };
-	// projection right vector
-	static constexpr const float right_vec { _up_vec * aspect_ratio };
 #if defined(SCREEN_ORIGIN_LEFT_BOTTOM)
-	static constexpr const float up_vec { _up_vec };
-#else // flip up vector for "left top" origin
-	static constexpr const float up_vec { -_up_vec };
+	static constexpr const float y_sign { 1.0f };
+#else // flip y for "left top" origin
+	static constexpr const float y_sign { -1.0f };
 #endif
 	// [near, far] plane, needed for depth correction
 	static constexpr const float2 near_far_plane { LIBWARP_NEAR_PLANE, LIBWARP_FAR_PLANE };
 	
-	// reconstructs a 3D position from a 2D screen coordinate and its associated real world depth
-	static float3 reconstruct_position(const uint2& coord, const float& linear_depth) {
-		// originally this was: ((float2(coord) + 0.5f) * 2.0f * inv_screen_size - 1.0f) * float2(right_vec, up_vec) * linear_depth
-		// -> simplified below (with constexpr terms forced to be computed at compile-time)
-		constexpr const auto ce_term_1 = inv_screen_size * float2(right_vec, up_vec);
-		constexpr const auto ce_term_2 = 2.0f * ce_term_1;
-		constexpr const auto ce_term_3 = ce_term_1 - float2(right_vec, up_vec);
-		return {
-			(float2(coord) * ce_term_2 + ce_term_3) * linear_depth,
-			-linear_depth
+	enum class projection_type : uint32_t {
+		perspective = 0,
+		orthographic = 1,
+		equirectangular = 2,
+		cubemap_face = 3,
+	};
+	
+	// projection policies: each one maps between 2D screen coordinates + linear depth and 3D view space positions
+	// (camera looks along -z), only the policy selected via LIBWARP_PROJECTION is instantiated
+	// NOTE: linear depth is the distance along the view direction, except for equirectangular, where it is the distance to
+	//       the camera origin
+	template <projection_type type> struct projection;
+	
+	// (optionally asymmetric) perspective projection
+	template <> struct projection<projection_type::perspective> {
+		// projection up vector
+		static constexpr const float _up_vec { const_math::tan(const_math::deg_to_rad(LIBWARP_SCREEN_FOV) * 0.5f) };
+		// projection right vector
+		static constexpr const float right_vec { _up_vec * aspect_ratio };
+		static constexpr const float up_vec { _up_vec * y_sign };
+		// off-axis shift of the projection center (in screen-oriented NDC)
+		static constexpr const float2 shift { LIBWARP_FRUSTUM_SHIFT_X, LIBWARP_FRUSTUM_SHIFT_Y * y_sign };
+		// normalized depth is non-linear
+		static constexpr const bool linear_normalized_depth { false };
+		
+		static float3 reconstruct_position(const float2& coord, const float& linear_depth) {
+			// originally this was: (((coord + 0.5f) * 2.0f * inv_screen_size - 1.0f) + shift) * float2(right_vec, up_vec) * linear_depth
+			// -> simplified below (with constexpr terms forced to be computed at compile-time)
+			constexpr const auto ce_term_1 = inv_screen_size * float2(right_vec, up_vec);
+			constexpr const auto ce_term_2 = 2.0f * ce_term_1;
+			constexpr const auto ce_term_3 = ce_term_1 + (shift - 1.0f) * float2(right_vec, up_vec);
+			return {
+				(coord * ce_term_2 + ce_term_3) * linear_depth,
+				-linear_depth
+			};
+		}
+		
+		static float2 reproject_position(const float3& position) {
+			constexpr const auto ce_term = float2 { 1.0f / right_vec, 1.0f / up_vec };
+			const auto proj_dst_coord = (position.xy * ce_term) / -position.z - shift;
+			return ((proj_dst_coord * 0.5f + 0.5f) * screen_size);
+		}
+	};
+	
+	// orthographic projection with a view volume height of LIBWARP_ORTHO_HEIGHT (centered on the view axis)
+	template <> struct projection<projection_type::orthographic> {
+		static constexpr const float2 half_extent {
+			0.5f * LIBWARP_ORTHO_HEIGHT * aspect_ratio,
+			0.5f * LIBWARP_ORTHO_HEIGHT * y_sign
+		};
+		// normalized depth is linear in [near, far]
+		static constexpr const bool linear_normalized_depth { true };
+		
+		static float3 reconstruct_position(const float2& coord, const float& linear_depth) {
+			// originally this was: ((coord + 0.5f) * 2.0f * inv_screen_size - 1.0f) * half_extent
+			constexpr const auto ce_term_1 = inv_screen_size * half_extent;
+			constexpr const auto ce_term_2 = 2.0f * ce_term_1;
+			constexpr const auto ce_term_3 = ce_term_1 - half_extent;
+			return {
+				coord * ce_term_2 + ce_term_3,
+				-linear_depth
+			};
+		}
+		
+		static float2 reproject_position(const float3& position) {
+			constexpr const auto ce_term = 0.5f / half_extent;
+			return ((position.xy * ce_term + 0.5f) * screen_size);
+		}
+	};
+	
+	// equirectangular projection: x covers the longitude [-pi, pi] (center == -z), y the latitude [pi/2, -pi/2] (top to bottom)
+	template <> struct projection<projection_type::equirectangular> {
+		static constexpr const float2 angle_scale {
+			2.0f * const_math::PI<float>,
+			const_math::PI<float> * y_sign
+		};
+		static constexpr const bool linear_normalized_depth { false };
+		
+		static float3 reconstruct_position(const float2& coord, const float& linear_depth) {
+			// -> (longitude, latitude)
+			const auto angles = ((coord + 0.5f) * inv_screen_size - 0.5f) * angle_scale;
+			const auto cos_lat = math::cos(angles.y);
+			return float3 {
+				math::sin(angles.x) * cos_lat,
+				math::sin(angles.y),
+				-math::cos(angles.x) * cos_lat
+			} * linear_depth;
+		}
+		
+		static float2 reproject_position(const float3& position) {
+			const float2 angles {
+				math::atan2(position.x, -position.z),
+				math::asin(clamp(position.y / position.length(), -1.0f, 1.0f)),
+			};
+			// NOTE: longitude wraps around at the left/right border
+			return ((angles / angle_scale + 0.5f) * screen_size);
+		}
+	};
+	
+	// single cubemap face (90° perspective, face orientation of the common cubemap convention),
+	// positions and motion are in the cubemap space that is shared by all faces, not in the space of the face camera
+	template <> struct projection<projection_type::cubemap_face> {
+		// right, up and forward axis of the face camera in cubemap space
+		static constexpr const float3 face_axes[6][3] {
+			{ { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f } }, // +X
+			{ { 0.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f }, { -1.0f, 0.0f, 0.0f } }, // -X
+			{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f } }, // +Y
+			{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f, 0.0f } }, // -Y
+			{ { 1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } }, // +Z
+			{ { -1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } }, // -Z
 		};
+		static constexpr const float3 right_axis { face_axes[LIBWARP_CUBE_FACE][0] };
+		static constexpr const float3 up_axis { face_axes[LIBWARP_CUBE_FACE][1] };
+		static constexpr const float3 forward_axis { face_axes[LIBWARP_CUBE_FACE][2] };
+		// tan(45°) == 1
+		static constexpr const float2 ndc_scale { aspect_ratio, y_sign };
+		static constexpr const bool linear_normalized_depth { false };
+		
+		static float3 reconstruct_position(const float2& coord, const float& linear_depth) {
+			const auto ndc = ((coord + 0.5f) * 2.0f * inv_screen_size - 1.0f) * ndc_scale;
+			return (right_axis * ndc.x + up_axis * ndc.y + forward_axis) * linear_depth;
+		}
+		
+		static float2 reproject_position(const float3& position) {
+			constexpr const auto ce_term = 1.0f / ndc_scale;
+			const float2 face_xy { position.dot(right_axis), position.dot(up_axis) };
+			const auto proj_dst_coord = (face_xy * ce_term) / position.dot(forward_axis);
+			return ((proj_dst_coord * 0.5f + 0.5f) * screen_size);
+		}
+	};
+	
+	using projection_policy = projection<projection_type(LIBWARP_PROJECTION)>;
+	
+	// reconstructs a 3D position from a 2D screen coordinate and its associated real world depth
+	floor_inline_always static float3 reconstruct_position(const uint2& coord, const float& linear_depth) {
+		return projection_policy::reconstruct_position(float2(coord), linear_depth);
 	}
 	
 	// reprojects a 3D position back to 2D
-	static float2 reproject_position(const float3& position) {
-		constexpr const auto ce_term = float2 { 1.0f / right_vec, 1.0f / up_vec };
-		const auto proj_dst_coord = (position.xy * ce_term) / -position.z;
-		return ((proj_dst_coord * 0.5f + 0.5f) * screen_size);
+	floor_inline_always static float2 reproject_position(const float3& position) {
+		return projection_policy::reproject_position(position);
 	}
 	
 	// linearizes the input depth value according to the depth type and returns the real world depth value
 	template <depth_type type = DEFAULT_DEPTH_TYPE>
 	constexpr static float linearize_depth(const float& depth) {
-		if (type == depth_type::normalized) {
+		if (type == depth_type::normalized && projection_policy::linear_normalized_depth) {
+			// normalized in [0, 1], but linear (orthographic projection)
+			return (depth == 1.0f ? 1.0f : near_far_plane.x + depth * (near_far_plane.y - near_far_plane.x));
+		} else if (type == depth_type::normalized) {
 			// reading from the actual depth buffer which is normalized in [0, 1]
 			constexpr const float2 near_far_projection {
 				-(near_far_plane.y + near_far_plane.x) / (near_far_plane.x - near_far_plane.y),
@@ -206,32 +352,282 @@ floor_inline_always static float3 decode_3d_motion(const uint32_t& encoded_motio
 	return signs * ((float3(shifted_motion) * adjust).exp2() - 1.0f);
 }
 
+// LIBWARP_INPUT_DOWNSCALE: motion/depth inputs may have a lower resolution than color/output (1, 2 or 4)
+#if !defined(LIBWARP_INPUT_DOWNSCALE)
+#define LIBWARP_INPUT_DOWNSCALE 1u
+#endif
+// LIBWARP_UPSAMPLE_DEPTH_TOLERANCE: max relative linear depth difference of an input sample to the nearest sample,
+// for it to be considered part of the same surface when upsampling
+#if !defined(LIBWARP_UPSAMPLE_DEPTH_TOLERANCE)
+#define LIBWARP_UPSAMPLE_DEPTH_TOLERANCE 0.05f
+#endif
+
+namespace warp_input {
+	//! resolution of the motion/depth inputs
+	static constexpr const uint2 input_size {
+		(LIBWARP_SCREEN_WIDTH + LIBWARP_INPUT_DOWNSCALE - 1u) / LIBWARP_INPUT_DOWNSCALE,
+		(LIBWARP_SCREEN_HEIGHT + LIBWARP_INPUT_DOWNSCALE - 1u) / LIBWARP_INPUT_DOWNSCALE,
+	};
+	
+	//! returns the nearest motion/depth input coordinate of the full-resolution pixel at 'coord'
+	floor_inline_always static uint2 input_coord(const uint2& coord) {
+		return coord / LIBWARP_INPUT_DOWNSCALE;
+	}
+	
+	//! reads the linear depth and decoded motion of the full-resolution pixel at 'coord'
+	//! with reduced resolution inputs, the 2x2 input neighborhood is upsampled with depth-edge-aware weights:
+	//! only samples on the same surface as the nearest sample contribute (bilinearly weighted), which keeps depth edges sharp
+	//! and biases edge pixels towards the foreground (motion of the occluder is preferred over the motion of the background)
+	template <typename motion_image_type, typename decode_motion_func_type>
+	floor_inline_always static auto read_depth_and_motion(const int2& coord,
+														  depth_image_type img_depth,
+														  motion_image_type img_motion,
+														  decode_motion_func_type&& decode_motion) {
+		using motion_type = decltype(decode_motion(img_motion.read(coord)));
+		struct {
+			float linear_depth;
+			motion_type motion;
+		} ret;
+#if LIBWARP_INPUT_DOWNSCALE == 1
+		ret.linear_depth = warp_camera::linearize_depth(img_depth.read(coord));
+		ret.motion = decode_motion(img_motion.read(coord));
+#else
+		// position of the full-resolution pixel center in the input
+		const float2 p = (float2(coord) + 0.5f) * (1.0f / float(LIBWARP_INPUT_DOWNSCALE)) - 0.5f;
+		const float2 p_floor = p.floored();
+		const float2 frac = p - p_floor;
+		const int2 base { p_floor };
+		static constexpr const int2 tap_offsets[4] { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } };
+		const float bilinear_weights[4] {
+			(1.0f - frac.x) * (1.0f - frac.y),
+			frac.x * (1.0f - frac.y),
+			(1.0f - frac.x) * frac.y,
+			frac.x * frac.y,
+		};
+		
+		uint2 taps[4];
+		float depths[4];
+		float nearest_depth { 1.0e10f };
+		uint32_t nearest_tap { 0u };
+#pragma unroll
+		for (uint32_t i = 0; i < 4u; ++i) {
+			taps[i] = uint2((base + tap_offsets[i]).clamped(int2(0), int2(input_size - 1u)));
+			depths[i] = warp_camera::linearize_depth(img_depth.read(taps[i]));
+			if (depths[i] < nearest_depth) {
+				nearest_depth = depths[i];
+				nearest_tap = i;
+			}
+		}
+		
+		ret.linear_depth = 0.0f;
+		ret.motion = {};
+		float weight_sum { 0.0f };
+#pragma unroll
+		for (uint32_t i = 0; i < 4u; ++i) {
+			// the nearest sample always contributes, so that the weight sum can't be 0
+			const bool same_surface = (abs(depths[i] - nearest_depth) <= LIBWARP_UPSAMPLE_DEPTH_TOLERANCE * nearest_depth);
+			const float weight = (same_surface ? bilinear_weights[i] : 0.0f) + (i == nearest_tap ? 1.0e-4f : 0.0f);
+			ret.linear_depth += weight * depths[i];
+			ret.motion += weight * decode_motion(img_motion.read(taps[i]));
+			weight_sum += weight;
+		}
+		ret.linear_depth /= weight_sum;
+		ret.motion /= weight_sum;
+#endif
+		return ret;
+	}
+};
+
 // computes the "scattered" destination coordinate of the pixel at 'coord',
 // according to it's depth value (which is also returned) and motion vector, as well as the current time delta
 floor_inline_always static auto scatter(const int2& coord,
 										const float& delta,
 										depth_image_type img_depth,
 										const_image_2d<uint1> img_motion) {
-	// read rendered/input depth and linearize it (linear distance from the camera origin)
-	const auto linear_depth = warp_camera::linearize_depth(img_depth.read(coord));
-	// get 3d motion for this pixel
-	const auto motion = decode_3d_motion(img_motion.read(coord));
+	// read rendered/input depth and linearize it (linear distance from the camera origin),
+	// get 3d motion for this pixel (both upsampled if the inputs have a reduced resolution)
+	const auto input = warp_input::read_depth_and_motion(coord, img_depth, img_motion, [](const uint32_t& encoded_motion) {
+		return decode_3d_motion(encoded_motion);
+	});
+	const auto& linear_depth = input.linear_depth;
+	const auto& motion = input.motion;
 	// reconstruct 3D position from depth + camera/screen setup,
 	// then predict/compute new 3D position from current motion and time
 	const auto new_pos = warp_camera::reconstruct_position(coord, linear_depth) + delta * motion;
+	// project 3D position back into 2D
+	const auto dst_pos = warp_camera::reproject_position(new_pos);
 	// -> return
 	const struct {
 		const uint2 coord;
+		const float2 pos;
 		const float linear_depth;
 	} ret {
-		// project 3D position back into 2D
 		// NOTE: convert directly to uint so that we won't have to check for >= 0
-		.coord = warp_camera::reproject_position(new_pos),
+		.coord = dst_pos,
+		.pos = dst_pos,
 		.linear_depth = linear_depth
 	};
 	return ret;
 }
 
+// computes the second-order displacement after 'delta' frames from the current and previous per-frame motion,
+// i.e. follows the quadratic trajectory through the current and the two previous positions (constant acceleration)
+template <typename motion_type>
+floor_inline_always static motion_type second_order_displacement(const float& delta,
+																 const motion_type& motion,
+																 const motion_type& motion_prev) {
+	return delta * motion + (0.5f * delta * (delta + 1.0f)) * (motion - motion_prev);
+}
+
+// same as scatter(), but extrapolates along a second-order trajectory using the motion of the previous frame
+floor_inline_always static auto scatter_accel(const int2& coord,
+											  const float& delta,
+											  depth_image_type img_depth,
+											  const_image_2d<uint1> img_motion,
+											  const_image_2d<uint1> img_motion_prev) {
+	const auto input = warp_input::read_depth_and_motion(coord, img_depth, img_motion, [](const uint32_t& encoded_motion) {
+		return decode_3d_motion(encoded_motion);
+	});
+	const auto& linear_depth = input.linear_depth;
+	const auto& motion = input.motion;
+	const auto position = warp_camera::reconstruct_position(coord, linear_depth);
+	// the previous motion of this pixel is stored at its previous position
+	// NOTE: if the previous position is off-screen, assume no acceleration
+	const uint2 prev_coord { warp_camera::reproject_position(position - motion) };
+	auto motion_prev = motion;
+	if (prev_coord.x < LIBWARP_SCREEN_WIDTH &&
+		prev_coord.y < LIBWARP_SCREEN_HEIGHT) {
+		motion_prev = decode_3d_motion(img_motion_prev.read(warp_input::input_coord(prev_coord)));
+	}
+	const auto new_pos = position + second_order_displacement(delta, motion, motion_prev);
+	const auto dst_pos = warp_camera::reproject_position(new_pos);
+	const struct {
+		const uint2 coord;
+		const float2 pos;
+		const float linear_depth;
+	} ret {
+		.coord = dst_pos,
+		.pos = dst_pos,
+		.linear_depth = linear_depth
+	};
+	return ret;
+}
+
+// LIBWARP_SPLAT_MODE: footprint of a scattered pixel in the depth and color passes
+// 0 = single pixel, 1 = 2x2 pixels, 2 = adaptive (projected footprint, estimated from the scattered neighbor pixels)
+#if !defined(LIBWARP_SPLAT_MODE)
+#define LIBWARP_SPLAT_MODE 0
+#endif
+// LIBWARP_SPLAT_MAX_FOOTPRINT: max width/height (in pixels) of an adaptive footprint
+#if !defined(LIBWARP_SPLAT_MAX_FOOTPRINT)
+#define LIBWARP_SPLAT_MAX_FOOTPRINT 4
+#endif
+// LIBWARP_SPLAT_DEPTH_TOLERANCE: max relative linear depth difference of a neighbor pixel, for it to be considered part of the
+// same surface when estimating the adaptive footprint
+#if !defined(LIBWARP_SPLAT_DEPTH_TOLERANCE)
+#define LIBWARP_SPLAT_DEPTH_TOLERANCE 0.05f
+#endif
+
+namespace warp_splat {
+	//! max width/height of a footprint in pixels
+	static constexpr const int32_t max_footprint { LIBWARP_SPLAT_MODE == 1 ? 2 : LIBWARP_SPLAT_MAX_FOOTPRINT };
+	//! depth scale of footprint pixels that don't contain the scattered position itself:
+	//! direct hits of the same surface take precedence over the footprint of their neighbors, which keeps the output sharp
+	//! when the surface isn't magnified, while a footprint still can't overwrite a nearer surface
+	static constexpr const float footprint_depth_scale { 1.001f };
+	
+	//! calls 'func(dst_coord, test_depth)' for each on-screen pixel that is covered by the scattered pixel at 'coord',
+	//! 'scatter_func(coord)' must return the scattered pixel of the specified source coordinate
+	template <typename scatter_func_type, typename func_type>
+	floor_inline_always static void for_each_pixel(const int2& coord, scatter_func_type&& scatter_func, func_type&& func) {
+		const auto scattered = scatter_func(coord);
+#if LIBWARP_SPLAT_MODE == 0
+		if (scattered.coord.x < LIBWARP_SCREEN_WIDTH &&
+			scattered.coord.y < LIBWARP_SCREEN_HEIGHT) {
+			func(scattered.coord, scattered.linear_depth);
+		}
+#else
+#if LIBWARP_SPLAT_MODE == 1
+		const float2 half_extent { 1.0f };
+#else
+		// the projected pixel is approximated by the parallelogram that is spanned by the scattered positions of the right
+		// and bottom neighbor pixels (local Jacobian of the warp) -> footprint is its bounding box
+		// NOTE: neighbors that are on a different surface (or off-screen) are assumed to be undistorted
+		float2 dx { 1.0f, 0.0f }, dy { 0.0f, 1.0f };
+		const auto is_same_surface = [&scattered](const auto& neighbor) {
+			return (abs(neighbor.linear_depth - scattered.linear_depth) <=
+					LIBWARP_SPLAT_DEPTH_TOLERANCE * min(neighbor.linear_depth, scattered.linear_depth));
+		};
+		if (coord.x + 1 < int32_t(LIBWARP_SCREEN_WIDTH)) {
+			const auto right = scatter_func(coord + int2 { 1, 0 });
+			if (is_same_surface(right)) {
+				dx = right.pos - scattered.pos;
+			}
+		}
+		if (coord.y + 1 < int32_t(LIBWARP_SCREEN_HEIGHT)) {
+			const auto bottom = scatter_func(coord + int2 { 0, 1 });
+			if (is_same_surface(bottom)) {
+				dy = bottom.pos - scattered.pos;
+			}
+		}
+		const auto half_extent = (0.5f * (dx.abs() + dy.abs())).clamped(0.5f, 0.5f * float(max_footprint));
+#endif
+		// all pixels whose centers are inside the footprint (always contains the pixel of the scattered position)
+		const int2 center_px { scattered.pos.floored() };
+		const int2 min_px { (scattered.pos - half_extent - 0.5f).ceiled() };
+		const int2 max_px_unclamped { (scattered.pos + half_extent - 0.5f).floored() };
+		const int2 max_px {
+			min(max_px_unclamped.x, min_px.x + max_footprint - 1),
+			min(max_px_unclamped.y, min_px.y + max_footprint - 1),
+		};
+#pragma unroll
+		for (int32_t y = 0; y < max_footprint; ++y) {
+			const int32_t py = min_px.y + y;
+			if (py > max_px.y || py < 0 || py >= int32_t(LIBWARP_SCREEN_HEIGHT)) {
+				continue;
+			}
+#pragma unroll
+			for (int32_t x = 0; x < max_footprint; ++x) {
+				const int32_t px = min_px.x + x;
+				if (px > max_px.x || px < 0 || px >= int32_t(LIBWARP_SCREEN_WIDTH)) {
+					continue;
+				}
+				const bool is_center = (px == center_px.x && py == center_px.y);
+				func(uint2 { uint32_t(px), uint32_t(py) },
+					 is_center ? scattered.linear_depth : scattered.linear_depth * footprint_depth_scale);
+			}
+		}
+#endif
+	}
+};
+
+// depth pass of a scattered pixel: keep the nearest depth per destination pixel
+template <typename scatter_func_type>
+floor_inline_always static void scatter_depth_test(const int2& coord,
+												   scatter_func_type&& scatter_func,
+												   buffer<uint32_t> depth_buffer) {
+	warp_splat::for_each_pixel(coord, scatter_func, [&depth_buffer](const uint2& dst_coord, const float& linear_depth) {
+		atomic_min(&depth_buffer[dst_coord.y * LIBWARP_SCREEN_WIDTH + dst_coord.x], *(const uint32_t*)&linear_depth);
+	});
+}
+
+// color pass of a scattered pixel: only write the color if it passes the depth test
+template <typename scatter_func_type>
+floor_inline_always static void scatter_color_write(const int2& coord,
+													scatter_func_type&& scatter_func,
+													const_image_2d<float> img_color,
+													image_2d<float4, true> img_out_color,
+													buffer<const float> depth_buffer) {
+	warp_splat::for_each_pixel(coord, scatter_func, [&](const uint2& dst_coord, const float& linear_depth) {
+		if (linear_depth > depth_buffer[dst_coord.y * LIBWARP_SCREEN_WIDTH + dst_coord.x]) {
+			return;
+		}
+		auto color = img_color.read(coord);
+		color.w = 1.0f; // px fixup
+		img_out_color.write(dst_coord, color);
+	});
+}
+
 //
 kernel_2d() void libwarp_warp_scatter_depth(depth_image_type img_depth,
 											const_image_2d<uint1> img_motion,
@@ -242,12 +638,9 @@ kernel_2d() void libwarp_warp_scatter_depth(depth_image_type img_depth,
 											param<float> delta) {
 	screen_check();
 	
-	const auto scattered = scatter(global_id.xy, delta, img_depth, img_motion);
-	if (scattered.coord.x < LIBWARP_SCREEN_WIDTH &&
-		scattered.coord.y < LIBWARP_SCREEN_HEIGHT) {
-		atomic_min(&depth_buffer[scattered.coord.y * LIBWARP_SCREEN_WIDTH + scattered.coord.x],
-				   *(const uint32_t*)&scattered.linear_depth);
-	}
+	scatter_depth_test(global_id.xy, [&](const int2& coord) {
+		return scatter(coord, delta, img_depth, img_motion);
+	}, depth_buffer);
 }
 //
 kernel_2d() void libwarp_warp_scatter_color(const_image_2d<float> img_color,
@@ -258,21 +651,164 @@ kernel_2d() void libwarp_warp_scatter_color(const_image_2d<float> img_color,
 											param<float> delta) {
 	screen_check();
 	
+	scatter_color_write(global_id.xy, [&](const int2& coord) {
+		return scatter(coord, delta, img_depth, img_motion);
+	}, img_color, img_out_color, depth_buffer);
+}
+
+// two-layer scatter: the second layer (second-nearest surface) is only scattered into pixels that weren't covered by the
+// first layer, using its own depth buffer (depth pass of the first layer must have completed)
+kernel_2d() void libwarp_warp_scatter_depth_layer2(depth_image_type img_depth,
+												   const_image_2d<uint1> img_motion,
+												   buffer<const float> depth_buffer,
+												   buffer<uint32_t> depth_buffer_layer2,
+												   param<float> delta) {
+	screen_check();
+	
+	warp_splat::for_each_pixel(global_id.xy, [&](const int2& coord) {
+		return scatter(coord, delta, img_depth, img_motion);
+	}, [&](const uint2& dst_coord, const float& linear_depth) {
+		const auto idx = dst_coord.y * LIBWARP_SCREEN_WIDTH + dst_coord.x;
+		// only fill holes of the first layer
+		if (depth_buffer[idx] == numeric_limits<float>::max()) {
+			atomic_min(&depth_buffer_layer2[idx], *(const uint32_t*)&linear_depth);
+		}
+	});
+}
+//
+kernel_2d() void libwarp_warp_scatter_color_layer2(const_image_2d<float> img_color,
+												   depth_image_type img_depth,
+												   const_image_2d<uint1> img_motion,
+												   image_2d<float4, true> img_out_color,
+												   buffer<const float> depth_buffer,
+												   buffer<const float> depth_buffer_layer2,
+												   param<float> delta) {
+	screen_check();
+	
 	const auto coord = global_id.xy;
-	const auto scattered = scatter(coord, delta, img_depth, img_motion);
-	if (scattered.coord.x >= LIBWARP_SCREEN_WIDTH ||
-		scattered.coord.y >= LIBWARP_SCREEN_HEIGHT) {
+	warp_splat::for_each_pixel(coord, [&](const int2& src_coord) {
+		return scatter(src_coord, delta, img_depth, img_motion);
+	}, [&](const uint2& dst_coord, const float& linear_depth) {
+		const auto idx = dst_coord.y * LIBWARP_SCREEN_WIDTH + dst_coord.x;
+		if (depth_buffer[idx] != numeric_limits<float>::max() || // covered by the first layer
+			linear_depth > depth_buffer_layer2[idx]) {
+			return;
+		}
+		auto color = img_color.read(coord);
+		color.w = 1.0f; // px fixup
+		img_out_color.write(dst_coord, color);
+	});
+}
+
+// second-order variants of the scatter depth/color passes (additionally consume the 3D motion of the previous frame)
+kernel_2d() void libwarp_warp_scatter_depth_accel(depth_image_type img_depth,
+												  const_image_2d<uint1> img_motion,
+												  const_image_2d<uint1> img_motion_prev,
+												  buffer<uint32_t> depth_buffer,
+												  param<float> delta) {
+	screen_check();
+	
+	scatter_depth_test(global_id.xy, [&](const int2& coord) {
+		return scatter_accel(coord, delta, img_depth, img_motion, img_motion_prev);
+	}, depth_buffer);
+}
+//
+kernel_2d() void libwarp_warp_scatter_color_accel(const_image_2d<float> img_color,
+												  depth_image_type img_depth,
+												  const_image_2d<uint1> img_motion,
+												  const_image_2d<uint1> img_motion_prev,
+												  image_2d<float4, true> img_out_color,
+												  buffer<const float> depth_buffer,
+												  param<float> delta) {
+	screen_check();
+	
+	scatter_color_write(global_id.xy, [&](const int2& coord) {
+		return scatter_accel(coord, delta, img_depth, img_motion, img_motion_prev);
+	}, img_color, img_out_color, depth_buffer);
+}
+
+// streaming (out-of-core) scatter: the frame is processed in horizontal bands, 'band' is { src_row, src_rows, dst_row, dst_rows }
+// all input images only contain the frame rows [src_row, src_row + src_rows) (output band + halo),
+// the output image and depth buffer only contain the frame rows [dst_row, dst_row + dst_rows)
+// NOTE: work-items cover the input band, motion/depth input bands must have the screen width (no input downscale)
+namespace warp_band {
+	//! same as scatter(), but reads the frame pixel at 'coord' from the input band images
+	//! NOTE: rows outside of the input band are clamped to it (only happens for the neighbors of adaptive splats)
+	floor_inline_always static auto scatter(const int2& coord,
+											const float& delta,
+											depth_image_type img_depth,
+											const_image_2d<uint1> img_motion,
+											const uint4& band) {
+		const int2 band_coord { coord.x, clamp(coord.y - int32_t(band.x), 0, int32_t(band.y) - 1) };
+		const auto linear_depth = warp_camera::linearize_depth(img_depth.read(band_coord));
+		const auto motion = decode_3d_motion(img_motion.read(band_coord));
+		const auto new_pos = warp_camera::reconstruct_position(coord, linear_depth) + delta * motion;
+		const auto dst_pos = warp_camera::reproject_position(new_pos);
+		const struct {
+			const uint2 coord;
+			const float2 pos;
+			const float linear_depth;
+		} ret {
+			.coord = dst_pos,
+			.pos = dst_pos,
+			.linear_depth = linear_depth
+		};
+		return ret;
+	}
+
+	//! returns the output band row of the scattered frame pixel at 'dst_coord', or ~0u if it isn't inside the output band
+	floor_inline_always static uint32_t dst_row(const uint2& dst_coord, const uint4& band) {
+		// NOTE: wraps around for rows above the band
+		const uint32_t row = dst_coord.y - band.z;
+		return (row < band.w ? row : ~0u);
+	}
+};
+
+kernel_2d() void libwarp_warp_scatter_depth_band(depth_image_type img_depth,
+												 const_image_2d<uint1> img_motion,
+												 buffer<uint32_t> depth_buffer,
+												 param<float> delta,
+												 param<uint4> band) {
+	screen_check();
+	if (global_id.y >= band.y) {
 		return;
 	}
-	
-	const auto dst_depth = depth_buffer[scattered.coord.y * LIBWARP_SCREEN_WIDTH + scattered.coord.x];
-	if (scattered.linear_depth > dst_depth) {
+
+	const int2 coord { int32_t(global_id.x), int32_t(global_id.y + band.x) };
+	warp_splat::for_each_pixel(coord, [&](const int2& src_coord) {
+		return warp_band::scatter(src_coord, delta, img_depth, img_motion, band);
+	}, [&](const uint2& dst_coord, const float& linear_depth) {
+		const auto row = warp_band::dst_row(dst_coord, band);
+		if (row != ~0u) {
+			atomic_min(&depth_buffer[row * LIBWARP_SCREEN_WIDTH + dst_coord.x], *(const uint32_t*)&linear_depth);
+		}
+	});
+}
+//
+kernel_2d() void libwarp_warp_scatter_color_band(const_image_2d<float> img_color,
+												 depth_image_type img_depth,
+												 const_image_2d<uint1> img_motion,
+												 image_2d<float4, true> img_out_color,
+												 buffer<const float> depth_buffer,
+												 param<float> delta,
+												 param<uint4> band) {
+	screen_check();
+	if (global_id.y >= band.y) {
 		return;
 	}
-	
-	auto color = img_color.read(coord);
-	color.w = 1.0f; // px fixup
-	img_out_color.write(scattered.coord, color);
+
+	const int2 coord { int32_t(global_id.x), int32_t(global_id.y + band.x) };
+	warp_splat::for_each_pixel(coord, [&](const int2& src_coord) {
+		return warp_band::scatter(src_coord, delta, img_depth, img_motion, band);
+	}, [&](const uint2& dst_coord, const float& linear_depth) {
+		const auto row = warp_band::dst_row(dst_coord, band);
+		if (row == ~0u || linear_depth > depth_buffer[row * LIBWARP_SCREEN_WIDTH + dst_coord.x]) {
+			return;
+		}
+		auto color = img_color.read(global_id.xy);
+		color.w = 1.0f; // px fixup
+		img_out_color.write(uint2 { dst_coord.x, row }, color);
+	});
 }
 
 // decodes the encoded input 2D motion vector
@@ -282,6 +818,64 @@ static float2 decode_2d_motion(const uint32_t& encoded_motion) {
 	return unpack_snorm_2x16(encoded_motion) * 0.5f;
 }
 
+// decodes the unified motion that is shared by all warp modes (motion from the previous to the current frame)
+// format: float4 <screen-space x, screen-space y, linear depth delta, unused>
+// NOTE: x/y use the same (NDC) scale as the 2D motion, the depth delta is in world units (same as the linearized depth)
+floor_inline_always static float3 decode_unified_motion(const float4& motion) {
+	return { motion.xy * 0.5f, motion.z };
+}
+
+// computes the "scattered" destination coordinate of the pixel at 'coord' using the unified motion
+// (extrapolates the screen-space position and linear depth with constant velocity)
+floor_inline_always static auto scatter_unified(const int2& coord,
+												const float& delta,
+												depth_image_type img_depth,
+												const_image_2d<float> img_motion) {
+	const auto input = warp_input::read_depth_and_motion(coord, img_depth, img_motion, [](const float4& encoded_motion) {
+		return decode_unified_motion(encoded_motion);
+	});
+	const auto& linear_depth = input.linear_depth;
+	const auto& motion = input.motion;
+	const auto new_coord = ((float2(coord) + 0.5f) * warp_camera::inv_screen_size + delta * motion.xy) * warp_camera::screen_size;
+	const struct {
+		const uint2 coord;
+		const float2 pos;
+		const float linear_depth;
+	} ret {
+		// NOTE: convert directly to uint so that we won't have to check for >= 0
+		.coord = new_coord,
+		.pos = new_coord,
+		// must stay >= 0 for the depth test
+		.linear_depth = max(linear_depth + delta * motion.z, 0.0f)
+	};
+	return ret;
+}
+
+// unified motion variants of the scatter depth/color passes
+kernel_2d() void libwarp_warp_scatter_depth_unified(depth_image_type img_depth,
+													const_image_2d<float> img_motion,
+													buffer<uint32_t> depth_buffer,
+													param<float> delta) {
+	screen_check();
+	
+	scatter_depth_test(global_id.xy, [&](const int2& coord) {
+		return scatter_unified(coord, delta, img_depth, img_motion);
+	}, depth_buffer);
+}
+//
+kernel_2d() void libwarp_warp_scatter_color_unified(const_image_2d<float> img_color,
+													depth_image_type img_depth,
+													const_image_2d<float> img_motion,
+													image_2d<float4, true> img_out_color,
+													buffer<const float> depth_buffer,
+													param<float> delta) {
+	screen_check();
+	
+	scatter_color_write(global_id.xy, [&](const int2& coord) {
+		return scatter_unified(coord, delta, img_depth, img_motion);
+	}, img_color, img_out_color, depth_buffer);
+}
+
 // gaussian blur helper functions (used in warp_gather_forward)
 #define TAP_COUNT 21u
 template <uint32_t tap_count>
@@ -330,148 +924,1515 @@ static constexpr auto compute_coefficients() {
 //! TODO: this may be dependent on the screen size, needs more research
 static constexpr const uint32_t gather_search_iterations { 6u };
 
-kernel_2d() void libwarp_warp_gather_forward(const_image_2d<float> img_color,
-											 const_image_2d<uint1> img_motion,
-											 image_2d<float4, true> img_out_color,
-											 param<float> delta) {
-	screen_check();
-	
+//! per-pixel confidence values of the different warp cases (in [0, 1])
+namespace warp_confidence {
+	//! fwd and bwd (or the forward-only search) converged to consistent positions
+	static constexpr const float valid { 1.0f };
+	//! occlusion case: projection from the other frame was consistent
+	static constexpr const float occlusion_projected { 0.75f };
+	//! occlusion case: only the unprojected color could be used, or only one of fwd/bwd converged
+	static constexpr const float partial { 0.5f };
+	//! nothing converged / hole: color is a fallback (blur, interpolation or fixup)
+	static constexpr const float invalid { 0.0f };
+};
+
+// LIBWARP_CONFIDENCE_THRESHOLD: pixels with a confidence below this mark their tile as low-confidence
+#if !defined(LIBWARP_CONFIDENCE_THRESHOLD)
+#define LIBWARP_CONFIDENCE_THRESHOLD 0.5f
+#endif
+
+// amount of tiles in x direction (the tile mask is stored row-major)
+static constexpr const uint32_t tile_count_x { (LIBWARP_SCREEN_WIDTH + TILE_SIZE_X - 1u) / TILE_SIZE_X };
+
+// returns the index of the tile containing the pixel at 'coord' (tiles == work-groups)
+floor_inline_always static uint32_t tile_index(const uint2& coord) {
+	return (coord.y / TILE_SIZE_Y) * tile_count_x + coord.x / TILE_SIZE_X;
+}
+
+// flags the tile of the pixel at 'coord' in the tile mask if the confidence is below the threshold
+// NOTE: all work-items write the same value, so no atomics are needed
+floor_inline_always static void mark_low_confidence_tile(const uint2& coord, const float& confidence, buffer<uint32_t> tile_mask) {
+	if (confidence < LIBWARP_CONFIDENCE_THRESHOLD) {
+		tile_mask[tile_index(coord)] = 1u;
+	}
+}
+
+// result of a gather-based warp for a single pixel
+struct gather_result {
+	float4 color;
+	float confidence;
+	// converged (normalized) source position in the current color input (only set by the forward-only and bidirectional gather)
+	float2 source;
+	// false if the color wasn't sampled at 'source' (e.g. only from the previous color input)
+	bool has_source { true };
+};
+
+// forward-only gather search, 'displacement' returns the screen-space displacement after delta of the pixel at 'p',
+// 'sample_color' returns the color of the converged source position
+template <typename displacement_func_type, typename sample_color_func_type>
+static gather_result gather_forward(const int2& coord,
+									const_image_2d<float> img_color,
+									displacement_func_type&& displacement,
+									sample_color_func_type&& sample_color) {
 	// iterate
-	const int2 coord { global_id.xy };
 	const float2 p_init = (float2(coord) + 0.5f) * warp_camera::inv_screen_size; // start at pixel center (this is p_t+alpha)
 	float2 p_fwd = p_init;
 	float4 fallback_color;
 #pragma unroll
 	for (uint32_t i = 0; i < gather_search_iterations; ++i) {
-		const auto motion = decode_2d_motion(img_motion.read(p_fwd));
-		p_fwd = p_init - delta * motion;
+		p_fwd = p_init - displacement(p_fwd);
 		fallback_color += (1.0f / float(gather_search_iterations)) * img_color.read_linear_repeat_mirrored(p_fwd);
 	}
 	
 #if 0 // just read the sample, ignoring any error
-	img_out_color.write(coord, img_color.read_linear(p_fwd));
+	return { sample_color(p_fwd), warp_confidence::valid, p_fwd };
 #else // if screen-space error is too high, compute directional blur
-	const auto motion_fwd = decode_2d_motion(img_motion.read(p_fwd));
-	const auto err_fwd = ((p_fwd + delta * motion_fwd - p_init).dot() +
+	const auto displacement_fwd = displacement(p_fwd);
+	const auto err_fwd = ((p_fwd + displacement_fwd - p_init).dot() +
 						  // account for out-of-bound access (-> large error so any checks will fail)
 						  ((p_fwd < 0.0f).any() || (p_fwd > 1.0f).any() ? 1.0e10f : 0.0f));
 	
 	const float epsilon_1 { 0.00025f };
 	const float epsilon_1_sq { epsilon_1 * epsilon_1 };
-	float4 color;
 	if (err_fwd >= epsilon_1_sq) {
 		// compute directional blur in the motion direction of the pixel
 		static constexpr const auto coeffs = compute_coefficients<TAP_COUNT>();
 		static constexpr const int overlap = TAP_COUNT / 2;
-		const auto dir = motion_fwd.normalized();
+		// NOTE: the blur is symmetric, so the sign of the displacement doesn't matter
+		const auto dir = displacement_fwd.normalized();
 		
+		float4 color;
 #pragma clang loop unroll_count(TAP_COUNT)
 		for (int i = -overlap; i <= overlap; ++i) {
 			// TODO: use linear sampling / blur
 			color += coeffs[size_t(overlap + i)] * img_color.read(coord + int2(float(i) * dir));
 		}
-		color = (color + fallback_color) * 0.5f;
-	} else {
-		color = img_color.read_linear(p_fwd);
+		return { (color + fallback_color) * 0.5f, warp_confidence::invalid, p_fwd };
 	}
-	img_out_color.write(coord, color);
+	return { sample_color(p_fwd), warp_confidence::valid, p_fwd };
 #endif
 }
 
-kernel_2d() void libwarp_warp_gather(const_image_2d<float> img_color,
-									 depth_image_type img_depth,
-									 const_image_2d<float> img_color_prev,
-									 depth_image_type img_depth_prev,
-									 const_image_2d<uint1> img_motion_forward,
-									 const_image_2d<uint1> img_motion_backward,
-									 // packed <forward depth: fwd t-1 -> t (used here), backward depth: bwd t-1 -> t-2 (unused here)>
-									 const_image_2d<float2> img_motion_depth_forward,
-									 // packed <forward depth: t+1 -> t (unused here), backward depth: t -> t-1 (used here)>
-									 const_image_2d<float2> img_motion_depth_backward,
-									 image_2d<float4, true> img_out_color,
-									 param<float> delta) {
+template <typename displacement_func_type>
+static gather_result gather_forward(const int2& coord,
+									const_image_2d<float> img_color,
+									displacement_func_type&& displacement) {
+	return gather_forward(coord, img_color, displacement, [&img_color](const float2& p_fwd) {
+		return img_color.read_linear(p_fwd);
+	});
+}
+
+// linear forward-only gather
+static gather_result gather_forward(const int2& coord,
+									const float& delta,
+									const_image_2d<float> img_color,
+									const_image_2d<uint1> img_motion) {
+	return gather_forward(coord, img_color, [&delta, &img_motion](const float2& p) {
+		return delta * decode_2d_motion(img_motion.read(p));
+	});
+}
+
+// second-order forward-only gather (additionally consumes the 2D motion of the previous frame)
+static gather_result gather_forward_accel(const int2& coord,
+										  const float& delta,
+										  const_image_2d<float> img_color,
+										  const_image_2d<uint1> img_motion,
+										  const_image_2d<uint1> img_motion_prev) {
+	return gather_forward(coord, img_color, [&delta, &img_motion, &img_motion_prev](const float2& p) {
+		const auto motion = decode_2d_motion(img_motion.read(p));
+		// the previous motion is stored at the previous position
+		const auto motion_prev = decode_2d_motion(img_motion_prev.read(p - motion));
+		return second_order_displacement(delta, motion, motion_prev);
+	});
+}
+
+// forward-only gather using the unified motion
+static gather_result gather_forward_unified(const int2& coord,
+											const float& delta,
+											const_image_2d<float> img_color,
+											const_image_2d<float> img_motion) {
+	return gather_forward(coord, img_color, [&delta, &img_motion](const float2& p) {
+		return delta * decode_unified_motion(img_motion.read(p)).xy;
+	});
+}
+
+kernel_2d() void libwarp_warp_gather_forward(const_image_2d<float> img_color,
+											 const_image_2d<uint1> img_motion,
+											 image_2d<float4, true> img_out_color,
+											 param<float> delta) {
 	screen_check();
 	
-	// iterate
-	const float2 p_init = (float2(global_id.xy) + 0.5f) * warp_camera::inv_screen_size; // start at pixel center (this is p_t+alpha)
-	// dual init, opposing init
-	float2 p_fwd = p_init + delta * decode_2d_motion(img_motion_backward.read(p_init));
-	float2 p_bwd = p_init + (1.0f - delta) * decode_2d_motion(img_motion_forward.read(p_init));
-#pragma unroll
-	for (uint32_t i = 0; i < gather_search_iterations; ++i) {
-		const auto motion = decode_2d_motion(img_motion_forward.read(p_fwd));
-		p_fwd = p_init - delta * motion;
-	}
-#pragma unroll
-	for (uint32_t i = 0; i < gather_search_iterations; ++i) {
-		const auto motion = decode_2d_motion(img_motion_backward.read(p_bwd));
-		p_bwd = p_init - (1.0f - delta) * motion;
-	}
+	const int2 coord { global_id.xy };
+	img_out_color.write(coord, gather_forward(coord, delta, img_color, img_motion).color);
+}
+
+kernel_2d() void libwarp_warp_gather_forward_accel(const_image_2d<float> img_color,
+												   const_image_2d<uint1> img_motion,
+												   const_image_2d<uint1> img_motion_prev,
+												   image_2d<float4, true> img_out_color,
+												   param<float> delta) {
+	screen_check();
 	
-	// read fwd/bwd color for the found pixel locations
-	const auto color_fwd = img_color_prev.read_linear_repeat_mirrored(p_fwd);
-	const auto color_bwd = img_color.read_linear_repeat_mirrored(p_bwd);
+	const int2 coord { global_id.xy };
+	img_out_color.write(coord, gather_forward_accel(coord, delta, img_color, img_motion, img_motion_prev).color);
+}
+
+kernel_2d() void libwarp_warp_gather_forward_unified(const_image_2d<float> img_color,
+													 const_image_2d<float> img_motion,
+													 image_2d<float4, true> img_out_color,
+													 param<float> delta) {
+	screen_check();
 	
-	// read final motion vector + depth (packed)
-	const auto motion_fwd = decode_2d_motion(img_motion_forward.read(p_fwd));
-	const auto motion_bwd = decode_2d_motion(img_motion_backward.read(p_bwd));
-	const auto depth_fwd = img_motion_depth_forward.read(p_fwd).x;
-	const auto depth_bwd = img_motion_depth_backward.read(p_bwd).y;
+	const int2 coord { global_id.xy };
+	img_out_color.write(coord, gather_forward_unified(coord, delta, img_color, img_motion).color);
+}
+
+// same as libwarp_warp_gather_forward, but also outputs the per-pixel confidence and marks low-confidence tiles
+kernel_2d() void libwarp_warp_gather_forward_confidence(const_image_2d<float> img_color,
+														const_image_2d<uint1> img_motion,
+														image_2d<float4, true> img_out_color,
+														image_2d<float, true> img_out_confidence,
+														buffer<uint32_t> tile_mask,
+														param<float> delta) {
+	screen_check();
 	
-	// compute screen space error
-	const auto err_fwd = ((p_fwd + delta * motion_fwd - p_init).dot() +
-						  // account for out-of-bound access (-> large error so any checks will fail)
-						  ((p_fwd < 0.0f).any() || (p_fwd > 1.0f).any() ? 1.0e10f : 0.0f));
-	const auto err_bwd = ((p_bwd + (1.0f - delta) * motion_bwd - p_init).dot() +
-						  ((p_bwd < 0.0f).any() || (p_bwd > 1.0f).any() ? 1.0e10f : 0.0f));
-	// TODO: should have a more tangible epsilon, e.g. max pixel offset -> (max_offset / screen_size).max_element()
+	const int2 coord { global_id.xy };
+	const auto result = gather_forward(coord, delta, img_color, img_motion);
+	img_out_color.write(coord, result.color);
+	img_out_confidence.write(coord, float4 { result.confidence });
+	mark_low_confidence_tile(global_id.xy, result.confidence, tile_mask);
+}
+
+// LIBWARP_GATHER_SEED_OFFSET: pixel offset of the additional search seeds of the depth-aware forward-only gather
+#if !defined(LIBWARP_GATHER_SEED_OFFSET)
+#define LIBWARP_GATHER_SEED_OFFSET 8.0f
+#endif
+
+// depth-aware forward-only gather: starts the search from multiple seeds around the pixel, so that the search can converge
+// onto different surfaces (foreground and background) -> picks the nearest converged surface (occlusion),
+// or the farthest surface if none converged (disocclusion -> uncovered background)
+static gather_result gather_forward_depth(const int2& coord,
+										  const float& delta,
+										  const_image_2d<float> img_color,
+										  depth_image_type img_depth,
+										  const_image_2d<uint1> img_motion) {
+	static constexpr const float2 seed_offset { LIBWARP_GATHER_SEED_OFFSET * warp_camera::inv_screen_size };
+	static constexpr const float2 seed_offsets[] {
+		{ 0.0f, 0.0f },
+		{ -seed_offset.x, 0.0f },
+		{ seed_offset.x, 0.0f },
+		{ 0.0f, -seed_offset.y },
+		{ 0.0f, seed_offset.y },
+	};
 	const float epsilon_1 { 0.00025f };
 	const float epsilon_1_sq { epsilon_1 * epsilon_1 };
 	
-	// NOTE: scene depth type is dependent on the renderer (-> use the default), motion depth is always z/w
-	// -> need to linearize both to properly add + compare them
-	const auto z_fwd = (warp_camera::linearize_depth(img_depth_prev.read(p_fwd)) +
-						delta * warp_camera::linearize_depth<depth_type::z_div_w>(depth_fwd));
-	const auto z_bwd = (warp_camera::linearize_depth(img_depth.read(p_bwd)) +
-						(1.0f - delta) * warp_camera::linearize_depth<depth_type::z_div_w>(depth_bwd));
-	const auto depth_diff = abs(z_fwd - z_bwd);
-	constexpr const float epsilon_2 { 2.0f }; // aka "max depth difference between fwd and bwd"
-	
-	// check if fwd/bwd pass the screen-space error check
-	const bool fwd_valid = (err_fwd < epsilon_1_sq);
-	const bool bwd_valid = (err_bwd < epsilon_1_sq);
-	// interpolation between fwd/bwd color and back-projection/forward-projection from the other color frame using the fwd/bwd motion
-	const auto proj_color_fwd = color_fwd.interpolated(img_color.read_linear_repeat_mirrored(p_fwd + motion_fwd), delta);
-	const auto proj_color_bwd = img_color_prev.read_linear_repeat_mirrored(p_bwd + motion_bwd).interpolated(color_bwd, delta);
-	float4 color;
-	if (fwd_valid && bwd_valid) {
+	const float2 p_init = (float2(coord) + 0.5f) * warp_camera::inv_screen_size; // start at pixel center (this is p_t+alpha)
+	float2 p_nearest, p_farthest;
+	float z_nearest { 1.0e10f }, z_farthest { -1.0f };
+	bool converged { false };
+#pragma unroll
+	for (const auto& offset : seed_offsets) {
+		float2 p_fwd = p_init + offset;
+#pragma unroll
+		for (uint32_t i = 0; i < gather_search_iterations; ++i) {
+			const auto motion = decode_2d_motion(img_motion.read(p_fwd));
+			p_fwd = p_init - delta * motion;
+		}
+		
+		const auto motion_fwd = decode_2d_motion(img_motion.read(p_fwd));
+		const auto err_fwd = ((p_fwd + delta * motion_fwd - p_init).dot() +
+							  // account for out-of-bound access (-> large error so any checks will fail)
+							  ((p_fwd < 0.0f).any() || (p_fwd > 1.0f).any() ? 1.0e10f : 0.0f));
+		const auto z_fwd = warp_camera::linearize_depth(img_depth.read(p_fwd));
+		if (err_fwd < epsilon_1_sq && z_fwd < z_nearest) {
+			z_nearest = z_fwd;
+			p_nearest = p_fwd;
+			converged = true;
+		}
+		if (z_fwd > z_farthest) {
+			z_farthest = z_fwd;
+			p_farthest = p_fwd;
+		}
+	}
+	
+	if (converged) {
+		return { img_color.read_linear(p_nearest), warp_confidence::valid };
+	}
+	return { img_color.read_linear_repeat_mirrored(p_farthest), warp_confidence::partial };
+}
+
+kernel_2d() void libwarp_warp_gather_forward_depth(const_image_2d<float> img_color,
+												   depth_image_type img_depth,
+												   const_image_2d<uint1> img_motion,
+												   image_2d<float4, true> img_out_color,
+												   param<float> delta) {
+	screen_check();
+	
+	const int2 coord { global_id.xy };
+	img_out_color.write(coord, gather_forward_depth(coord, delta, img_color, img_depth, img_motion).color);
+}
+
+// LIBWARP_DEPTH_PYRAMID_LEVELS: amount of levels of the min/max depth pyramid
+#if !defined(LIBWARP_DEPTH_PYRAMID_LEVELS)
+#define LIBWARP_DEPTH_PYRAMID_LEVELS 5u
+#endif
+
+// per-frame min/max (linear) depth pyramid, used by the bidirectional gather to rule out occluders without any full-resolution
+// depth reads: all levels (1 .. LIBWARP_DEPTH_PYRAMID_LEVELS) are packed into a single buffer (finest level first), texel i of
+// level L covers the 2^(L+1) px footprint starting at pixel i * 2^L, i.e. footprints overlap by half, so that any box with an
+// extent of at most 2^L px is covered by a single texel
+namespace warp_depth_pyramid {
+	floor_inline_always static constexpr uint32_t level_width(const uint32_t level) {
+		return (LIBWARP_SCREEN_WIDTH + ((1u << level) - 1u)) >> level;
+	}
+	floor_inline_always static constexpr uint32_t level_height(const uint32_t level) {
+		return (LIBWARP_SCREEN_HEIGHT + ((1u << level) - 1u)) >> level;
+	}
+	floor_inline_always static constexpr uint32_t level_offset(const uint32_t level) {
+		uint32_t offset = 0;
+		for (uint32_t i = 1; i < level; ++i) {
+			offset += level_width(i) * level_height(i);
+		}
+		return offset;
+	}
+	
+	//! reads the <min, max> depth range of the pyramid texel that covers the specified box (in px),
+	//! returns false if the box is too large for the coarsest level
+	floor_inline_always static bool read_range(const float2& box_min, const float2& box_max,
+											   buffer<const float2> pyramid, float2& range) {
+		constexpr const float2 max_px { float(LIBWARP_SCREEN_WIDTH - 1u), float(LIBWARP_SCREEN_HEIGHT - 1u) };
+		// NOTE: all depth reads are clamped to the screen
+		const auto clamped_min = box_min.clamped(float2(0.0f), max_px);
+		const auto clamped_max = box_max.clamped(float2(0.0f), max_px);
+		const auto extent = (clamped_max - clamped_min).max_element();
+		// smallest level whose texels cover the extent
+		uint32_t level = 1u;
+		while (float(1u << level) < extent) {
+			if (++level > LIBWARP_DEPTH_PYRAMID_LEVELS) {
+				return false;
+			}
+		}
+		const auto texel = uint2(clamped_min) >> level;
+		range = pyramid[level_offset(level) + texel.y * level_width(level) + texel.x];
+		return true;
+	}
+	
+	//! returns true if the depth range of both frames within the box is smaller than 'max_depth_range'
+	//! (i.e. any two depth reads within the box, one in each frame, are guaranteed to differ by less than that)
+	floor_inline_always static bool is_occluder_free(const float2& box_min, const float2& box_max, const float& max_depth_range,
+													 buffer<const float2> pyramid, buffer<const float2> pyramid_prev) {
+		float2 range, range_prev;
+		if (!read_range(box_min, box_max, pyramid, range) ||
+			!read_range(box_min, box_max, pyramid_prev, range_prev)) {
+			return false;
+		}
+		return (max(range.y, range_prev.y) - min(range.x, range_prev.x) < max_depth_range);
+	}
+};
+
+// builds the finest level of the depth pyramid of a frame (one work-item per level texel)
+kernel_2d() void libwarp_depth_pyramid_base(depth_image_type img_depth,
+											buffer<float2> pyramid) {
+	constexpr const uint32_t width = warp_depth_pyramid::level_width(1u);
+	constexpr const uint32_t height = warp_depth_pyramid::level_height(1u);
+	if (global_id.x >= width || global_id.y >= height) {
+		return;
+	}
+	
+	// 4x4 px footprint
+	constexpr const int2 max_coord { int(LIBWARP_SCREEN_WIDTH - 1u), int(LIBWARP_SCREEN_HEIGHT - 1u) };
+	const int2 base_coord { global_id.xy * 2u };
+	float2 range { numeric_limits<float>::max(), -numeric_limits<float>::max() };
+#pragma unroll
+	for (int y = 0; y < 4; ++y) {
+#pragma unroll
+		for (int x = 0; x < 4; ++x) {
+			const auto linear_depth = warp_camera::linearize_depth(img_depth.read((base_coord + int2 { x, y }).minned(max_coord)));
+			range.x = min(range.x, linear_depth);
+			range.y = max(range.y, linear_depth);
+		}
+	}
+	pyramid[global_id.y * width + global_id.x] = range;
+}
+
+// builds the next coarser level of the depth pyramid from level 'level' - 1
+// NOTE: texels 2i and 2i + 2 of the finer level cover the footprint of texel i (see warp_depth_pyramid)
+kernel_2d() void libwarp_depth_pyramid_downsample(buffer<float2> pyramid,
+												  param<uint32_t> level) {
+	const auto width = warp_depth_pyramid::level_width(level);
+	if (global_id.x >= width || global_id.y >= warp_depth_pyramid::level_height(level)) {
+		return;
+	}
+	
+	const auto src_width = warp_depth_pyramid::level_width(level - 1u);
+	const uint2 src_max { src_width - 1u, warp_depth_pyramid::level_height(level - 1u) - 1u };
+	const auto src_offset = warp_depth_pyramid::level_offset(level - 1u);
+	const auto src_coord = global_id.xy * 2u;
+	const auto read_src = [&](const uint2& offset) {
+		const auto coord = (src_coord + offset).minned(src_max);
+		return pyramid[src_offset + coord.y * src_width + coord.x];
+	};
+	const auto range_0 = read_src({ 0u, 0u });
+	const auto range_1 = read_src({ 2u, 0u });
+	const auto range_2 = read_src({ 0u, 2u });
+	const auto range_3 = read_src({ 2u, 2u });
+	pyramid[warp_depth_pyramid::level_offset(level) + global_id.y * width + global_id.x] = float2 {
+		min(min(range_0.x, range_1.x), min(range_2.x, range_3.x)),
+		max(max(range_0.y, range_1.y), max(range_2.y, range_3.y)),
+	};
+}
+
+// source of a bidirectional gather result
+enum class GATHER_SOURCE : uint32_t {
+	//! fwd color, interpolated with its forward-projection into the current frame
+	PROJECTED_FWD,
+	//! bwd color, interpolated with its back-projection into the previous frame
+	PROJECTED_BWD,
+	//! only the fwd color
+	FWD,
+	//! only the bwd color
+	BWD,
+	//! linear interpolation between fwd and bwd color
+	INTERPOLATED,
+};
+
+// resolved bidirectional gather of a single pixel: converged fwd/bwd positions + motion and the selected source
+struct gather_bidirectional_state {
+	float2 p_fwd;
+	float2 p_bwd;
+	float2 motion_fwd;
+	float2 motion_bwd;
+	GATHER_SOURCE source;
+	float confidence;
+};
+
+// color of a resolved bidirectional gather at 'sample_delta' (== 'delta' for the regular gather)
+// NOTE: for other sample deltas, the converged positions are moved along their motion (no new search is necessary)
+static float4 gather_bidirectional_color(const gather_bidirectional_state& state,
+										 const float& delta,
+										 const float& sample_delta,
+										 const_image_2d<float> img_color,
+										 const_image_2d<float> img_color_prev) {
+	const auto p_fwd = state.p_fwd + (delta - sample_delta) * state.motion_fwd;
+	const auto p_bwd = state.p_bwd + (sample_delta - delta) * state.motion_bwd;
+	switch (state.source) {
+		case GATHER_SOURCE::PROJECTED_FWD:
+			return img_color_prev.read_linear_repeat_mirrored(p_fwd).interpolated(img_color.read_linear_repeat_mirrored(p_fwd + state.motion_fwd),
+																				  sample_delta);
+		case GATHER_SOURCE::PROJECTED_BWD:
+			return img_color_prev.read_linear_repeat_mirrored(p_bwd + state.motion_bwd).interpolated(img_color.read_linear_repeat_mirrored(p_bwd),
+																									 sample_delta);
+		case GATHER_SOURCE::FWD:
+			return img_color_prev.read_linear_repeat_mirrored(p_fwd);
+		case GATHER_SOURCE::BWD:
+			return img_color.read_linear_repeat_mirrored(p_bwd);
+		case GATHER_SOURCE::INTERPOLATED:
+		default:
+			return img_color_prev.read_linear_repeat_mirrored(p_fwd).interpolated(img_color.read_linear_repeat_mirrored(p_bwd), sample_delta);
+	}
+}
+
+// gather result of a resolved bidirectional gather at 'delta': the source is the converged position in the current color input
+// that is actually sampled, i.e. the forward-projected fwd position or the bwd position, there is none if only the previous
+// color input is sampled or fwd and bwd are interpolated (neither has converged)
+static gather_result gather_bidirectional_result(const gather_bidirectional_state& state,
+												 const float& delta,
+												 const_image_2d<float> img_color,
+												 const_image_2d<float> img_color_prev) {
+	const auto color = gather_bidirectional_color(state, delta, delta, img_color, img_color_prev);
+	switch (state.source) {
+		case GATHER_SOURCE::PROJECTED_FWD:
+			return { color, state.confidence, state.p_fwd + state.motion_fwd };
+		case GATHER_SOURCE::PROJECTED_BWD:
+		case GATHER_SOURCE::BWD:
+			return { color, state.confidence, state.p_bwd };
+		case GATHER_SOURCE::FWD:
+		case GATHER_SOURCE::INTERPOLATED:
+		default:
+			return { color, state.confidence, state.p_bwd, false };
+	}
+}
+
+// default occluder test of the bidirectional gather: occluders can never be ruled out upfront
+struct no_occluder_test {
+	constexpr bool operator()(const float2&, const float2&, const float&) const {
+		return false;
+	}
+};
+
+// bidirectional gather search, the motion accessors return the screen-space fwd (t-1 -> t, at t-1) or bwd (t -> t-1, at t) motion,
+// the depth delta accessors return the fwd/bwd depth delta (in the same space as 'linearize_depth_delta' expects)
+// 'is_occluder_free' returns true if the depth range of both frames within the specified screen-space box (in px) is smaller
+// than the specified max depth range, in which case no depth needs to be read (see warp_depth_pyramid)
+template <typename motion_fwd_func_type, typename motion_bwd_func_type,
+		  typename depth_delta_fwd_func_type, typename depth_delta_bwd_func_type, typename linearize_depth_delta_func_type,
+		  typename occluder_free_func_type>
+static gather_bidirectional_state gather_bidirectional_resolve(const uint2& coord,
+										  const float& delta,
+										  const_image_2d<float> img_color,
+										  depth_image_type img_depth,
+										  const_image_2d<float> img_color_prev,
+										  depth_image_type img_depth_prev,
+										  motion_fwd_func_type&& read_motion_fwd,
+										  motion_bwd_func_type&& read_motion_bwd,
+										  depth_delta_fwd_func_type&& read_depth_delta_fwd,
+										  depth_delta_bwd_func_type&& read_depth_delta_bwd,
+										  linearize_depth_delta_func_type&& linearize_depth_delta,
+										  occluder_free_func_type&& is_occluder_free) {
+	// iterate
+	const float2 p_init = (float2(coord) + 0.5f) * warp_camera::inv_screen_size; // start at pixel center (this is p_t+alpha)
+	// dual init, opposing init
+	float2 p_fwd = p_init + delta * read_motion_bwd(p_init);
+	float2 p_bwd = p_init + (1.0f - delta) * read_motion_fwd(p_init);
+#pragma unroll
+	for (uint32_t i = 0; i < gather_search_iterations; ++i) {
+		const auto motion = read_motion_fwd(p_fwd);
+		p_fwd = p_init - delta * motion;
+	}
+#pragma unroll
+	for (uint32_t i = 0; i < gather_search_iterations; ++i) {
+		const auto motion = read_motion_bwd(p_bwd);
+		p_bwd = p_init - (1.0f - delta) * motion;
+	}
+	
+	// read final motion vector
+	const auto motion_fwd = read_motion_fwd(p_fwd);
+	const auto motion_bwd = read_motion_bwd(p_bwd);
+	
+	// compute screen space error
+	const auto err_fwd = ((p_fwd + delta * motion_fwd - p_init).dot() +
+						  // account for out-of-bound access (-> large error so any checks will fail)
+						  ((p_fwd < 0.0f).any() || (p_fwd > 1.0f).any() ? 1.0e10f : 0.0f));
+	const auto err_bwd = ((p_bwd + (1.0f - delta) * motion_bwd - p_init).dot() +
+						  ((p_bwd < 0.0f).any() || (p_bwd > 1.0f).any() ? 1.0e10f : 0.0f));
+	// TODO: should have a more tangible epsilon, e.g. max pixel offset -> (max_offset / screen_size).max_element()
+	const float epsilon_1 { 0.00025f };
+	const float epsilon_1_sq { epsilon_1 * epsilon_1 };
+	constexpr const float epsilon_2 { 2.0f }; // aka "max depth difference between fwd and bwd"
+	
+	// check if fwd/bwd pass the screen-space error check
+	const bool fwd_valid = (err_fwd < epsilon_1_sq);
+	const bool bwd_valid = (err_bwd < epsilon_1_sq);
+	// projected sources: interpolation between fwd/bwd color and back-projection/forward-projection from the other color frame
+	// using the fwd/bwd motion (see gather_bidirectional_color)
+	const auto resolved = [&](const GATHER_SOURCE source, const float confidence) {
+		return gather_bidirectional_state { p_fwd, p_bwd, motion_fwd, motion_bwd, source, confidence };
+	};
+	if (fwd_valid && bwd_valid) {
+		// NOTE: scene depth type is dependent on the renderer (-> use the default), packed motion depth is always z/w
+		// -> need to linearize both to properly add + compare them
+		const auto z_delta_fwd = delta * linearize_depth_delta(read_depth_delta_fwd(p_fwd));
+		const auto z_delta_bwd = (1.0f - delta) * linearize_depth_delta(read_depth_delta_bwd(p_bwd));
+		
+		// |z_fwd - z_bwd| is bounded by the depth range of both frames at p_fwd/p_bwd plus |z_delta_fwd - z_delta_bwd|:
+		// if that bound is below epsilon_2, this is always case 1 (up to float rounding) and no depth needs to be read
+		const auto box_min = p_fwd.minned(p_bwd) * warp_camera::screen_size;
+		const auto box_max = p_fwd.maxed(p_bwd) * warp_camera::screen_size;
+		if (is_occluder_free(box_min, box_max, epsilon_2 - abs(z_delta_fwd - z_delta_bwd))) {
+			return resolved(err_fwd < err_bwd ? GATHER_SOURCE::PROJECTED_FWD : GATHER_SOURCE::PROJECTED_BWD, warp_confidence::valid);
+		}
+		
+		const auto z_fwd = warp_camera::linearize_depth(img_depth_prev.read(p_fwd)) + z_delta_fwd;
+		const auto z_bwd = warp_camera::linearize_depth(img_depth.read(p_bwd)) + z_delta_bwd;
+		const auto p_fwd_other = p_fwd + motion_fwd;
+		const auto p_bwd_other = p_bwd + motion_bwd;
+		const auto depth_diff = abs(z_fwd - z_bwd);
 		if (depth_diff < epsilon_2) {
 			// case 1: both fwd and bwd are valid
-			color = (err_fwd < err_bwd ? proj_color_fwd : proj_color_bwd);
+			return resolved(err_fwd < err_bwd ? GATHER_SOURCE::PROJECTED_FWD : GATHER_SOURCE::PROJECTED_BWD, warp_confidence::valid);
 		} else {
 			// case 2: select the one closer to the camera (occlusion)
 			if (z_fwd < z_bwd) {
 				// depth from other frame
-				const auto z_fwd_other = (img_depth.read(p_fwd + motion_fwd) +
-										  (1.0f - delta) * img_motion_depth_backward.read(p_fwd + motion_fwd).y);
-				color = (abs(z_fwd - z_fwd_other) < epsilon_2 ? proj_color_fwd : color_fwd);
+				const auto z_fwd_other = (img_depth.read(p_fwd_other) +
+										  (1.0f - delta) * read_depth_delta_bwd(p_fwd_other));
+				if (abs(z_fwd - z_fwd_other) < epsilon_2) {
+					return resolved(GATHER_SOURCE::PROJECTED_FWD, warp_confidence::occlusion_projected);
+				}
+				return resolved(GATHER_SOURCE::FWD, warp_confidence::partial);
 			} else { // bwd < fwd
-				const auto z_bwd_other = (img_depth_prev.read(p_bwd + motion_bwd) +
-										  delta * img_motion_depth_forward.read(p_bwd + motion_bwd).x);
-				color = (abs(z_bwd - z_bwd_other) < epsilon_2 ? proj_color_bwd : color_bwd);
+				const auto z_bwd_other = (img_depth_prev.read(p_bwd_other) +
+										  delta * read_depth_delta_fwd(p_bwd_other));
+				if (abs(z_bwd - z_bwd_other) < epsilon_2) {
+					return resolved(GATHER_SOURCE::PROJECTED_BWD, warp_confidence::occlusion_projected);
+				}
+				return resolved(GATHER_SOURCE::BWD, warp_confidence::partial);
 			}
 		}
 	} else if (fwd_valid) {
-		color = color_fwd;
+		return resolved(GATHER_SOURCE::FWD, warp_confidence::partial);
 	} else if (bwd_valid) {
-		color = color_bwd;
+		return resolved(GATHER_SOURCE::BWD, warp_confidence::partial);
 	}
 	// case 3 / else: both are invalid -> just do a linear interpolation between the two
-	else {
-		color = color_fwd.interpolated(color_bwd, delta);
+	return resolved(GATHER_SOURCE::INTERPOLATED, warp_confidence::invalid);
+}
+
+// bidirectional gather search + color at 'delta' (see gather_bidirectional_resolve)
+template <typename motion_fwd_func_type, typename motion_bwd_func_type,
+		  typename depth_delta_fwd_func_type, typename depth_delta_bwd_func_type, typename linearize_depth_delta_func_type>
+static gather_result gather_bidirectional(const uint2& coord,
+										  const float& delta,
+										  const_image_2d<float> img_color,
+										  depth_image_type img_depth,
+										  const_image_2d<float> img_color_prev,
+										  depth_image_type img_depth_prev,
+										  motion_fwd_func_type&& read_motion_fwd,
+										  motion_bwd_func_type&& read_motion_bwd,
+										  depth_delta_fwd_func_type&& read_depth_delta_fwd,
+										  depth_delta_bwd_func_type&& read_depth_delta_bwd,
+										  linearize_depth_delta_func_type&& linearize_depth_delta) {
+	const auto state = gather_bidirectional_resolve(coord, delta, img_color, img_depth, img_color_prev, img_depth_prev,
+													read_motion_fwd, read_motion_bwd, read_depth_delta_fwd, read_depth_delta_bwd,
+													linearize_depth_delta, no_occluder_test {});
+	return gather_bidirectional_result(state, delta, img_color, img_color_prev);
+}
+
+// bidirectional gather using the packed 2D motion and z/w motion depth
+template <typename occluder_free_func_type = no_occluder_test>
+static gather_bidirectional_state gather_bidirectional_resolve(const uint2& coord,
+															   const float& delta,
+															   const_image_2d<float> img_color,
+															   depth_image_type img_depth,
+															   const_image_2d<float> img_color_prev,
+															   depth_image_type img_depth_prev,
+															   const_image_2d<uint1> img_motion_forward,
+															   const_image_2d<uint1> img_motion_backward,
+															   const_image_2d<float2> img_motion_depth_forward,
+															   const_image_2d<float2> img_motion_depth_backward,
+															   occluder_free_func_type&& is_occluder_free = {}) {
+	return gather_bidirectional_resolve(coord, delta, img_color, img_depth, img_color_prev, img_depth_prev,
+										[&img_motion_forward](const float2& p) { return decode_2d_motion(img_motion_forward.read(p)); },
+										[&img_motion_backward](const float2& p) { return decode_2d_motion(img_motion_backward.read(p)); },
+										[&img_motion_depth_forward](const float2& p) { return img_motion_depth_forward.read(p).x; },
+										[&img_motion_depth_backward](const float2& p) { return img_motion_depth_backward.read(p).y; },
+										[](const float& depth_delta) { return warp_camera::linearize_depth<depth_type::z_div_w>(depth_delta); },
+										is_occluder_free);
+}
+
+static gather_result gather_bidirectional(const uint2& coord,
+										  const float& delta,
+										  const_image_2d<float> img_color,
+										  depth_image_type img_depth,
+										  const_image_2d<float> img_color_prev,
+										  depth_image_type img_depth_prev,
+										  const_image_2d<uint1> img_motion_forward,
+										  const_image_2d<uint1> img_motion_backward,
+										  const_image_2d<float2> img_motion_depth_forward,
+										  const_image_2d<float2> img_motion_depth_backward) {
+	const auto state = gather_bidirectional_resolve(coord, delta, img_color, img_depth, img_color_prev, img_depth_prev,
+													img_motion_forward, img_motion_backward,
+													img_motion_depth_forward, img_motion_depth_backward);
+	return gather_bidirectional_result(state, delta, img_color, img_color_prev);
+}
+
+// bidirectional gather using the unified motion of the current and previous frame (see decode_unified_motion)
+// NOTE: the fwd motion (t-1 -> t) is approximated by the motion of the previous frame (t-2 -> t-1, constant velocity),
+//       the bwd motion (t -> t-1) is the negated motion of the current frame
+static gather_result gather_bidirectional_unified(const uint2& coord,
+												  const float& delta,
+												  const_image_2d<float> img_color,
+												  depth_image_type img_depth,
+												  const_image_2d<float> img_color_prev,
+												  depth_image_type img_depth_prev,
+												  const_image_2d<float> img_motion,
+												  const_image_2d<float> img_motion_prev) {
+	return gather_bidirectional(coord, delta, img_color, img_depth, img_color_prev, img_depth_prev,
+								[&img_motion_prev](const float2& p) { return decode_unified_motion(img_motion_prev.read(p)).xy; },
+								[&img_motion](const float2& p) { return -decode_unified_motion(img_motion.read(p)).xy; },
+								[&img_motion_prev](const float2& p) { return decode_unified_motion(img_motion_prev.read(p)).z; },
+								[&img_motion](const float2& p) { return -decode_unified_motion(img_motion.read(p)).z; },
+								// already linear
+								[](const float& depth_delta) { return depth_delta; });
+}
+
+kernel_2d() void libwarp_warp_gather(const_image_2d<float> img_color,
+									 depth_image_type img_depth,
+									 const_image_2d<float> img_color_prev,
+									 depth_image_type img_depth_prev,
+									 const_image_2d<uint1> img_motion_forward,
+									 const_image_2d<uint1> img_motion_backward,
+									 // packed <forward depth: fwd t-1 -> t (used here), backward depth: bwd t-1 -> t-2 (unused here)>
+									 const_image_2d<float2> img_motion_depth_forward,
+									 // packed <forward depth: t+1 -> t (unused here), backward depth: t -> t-1 (used here)>
+									 const_image_2d<float2> img_motion_depth_backward,
+									 image_2d<float4, true> img_out_color,
+									 param<float> delta) {
+	screen_check();
+	
+	const auto result = gather_bidirectional(global_id.xy, delta, img_color, img_depth, img_color_prev, img_depth_prev,
+											 img_motion_forward, img_motion_backward,
+											 img_motion_depth_forward, img_motion_depth_backward);
+	img_out_color.write(global_id.xy, result.color);
+}
+
+// same as libwarp_warp_gather, but uses the depth pyramids of both frames to skip the depth reads of the occlusion check
+// wherever no occluder can exist (see warp_depth_pyramid)
+kernel_2d() void libwarp_warp_gather_depth_pyramid(const_image_2d<float> img_color,
+												   depth_image_type img_depth,
+												   const_image_2d<float> img_color_prev,
+												   depth_image_type img_depth_prev,
+												   const_image_2d<uint1> img_motion_forward,
+												   const_image_2d<uint1> img_motion_backward,
+												   const_image_2d<float2> img_motion_depth_forward,
+												   const_image_2d<float2> img_motion_depth_backward,
+												   buffer<const float2> depth_pyramid,
+												   buffer<const float2> depth_pyramid_prev,
+												   image_2d<float4, true> img_out_color,
+												   param<float> delta) {
+	screen_check();
+	
+	const auto state = gather_bidirectional_resolve(global_id.xy, delta, img_color, img_depth, img_color_prev, img_depth_prev,
+													img_motion_forward, img_motion_backward,
+													img_motion_depth_forward, img_motion_depth_backward,
+													[&depth_pyramid, &depth_pyramid_prev](const float2& box_min, const float2& box_max,
+																							  const float& max_depth_range) {
+		return warp_depth_pyramid::is_occluder_free(box_min, box_max, max_depth_range, depth_pyramid, depth_pyramid_prev);
+	});
+	img_out_color.write(global_id.xy, gather_bidirectional_color(state, delta, delta, img_color, img_color_prev));
+}
+
+kernel_2d() void libwarp_warp_gather_unified(const_image_2d<float> img_color,
+											 depth_image_type img_depth,
+											 const_image_2d<float> img_color_prev,
+											 depth_image_type img_depth_prev,
+											 const_image_2d<float> img_motion,
+											 const_image_2d<float> img_motion_prev,
+											 image_2d<float4, true> img_out_color,
+											 param<float> delta) {
+	screen_check();
+	
+	const auto result = gather_bidirectional_unified(global_id.xy, delta, img_color, img_depth, img_color_prev, img_depth_prev,
+													 img_motion, img_motion_prev);
+	img_out_color.write(global_id.xy, result.color);
+}
+
+// same as libwarp_warp_gather, but also outputs the per-pixel confidence and marks low-confidence tiles
+kernel_2d() void libwarp_warp_gather_confidence(const_image_2d<float> img_color,
+												depth_image_type img_depth,
+												const_image_2d<float> img_color_prev,
+												depth_image_type img_depth_prev,
+												const_image_2d<uint1> img_motion_forward,
+												const_image_2d<uint1> img_motion_backward,
+												const_image_2d<float2> img_motion_depth_forward,
+												const_image_2d<float2> img_motion_depth_backward,
+												image_2d<float4, true> img_out_color,
+												image_2d<float, true> img_out_confidence,
+												buffer<uint32_t> tile_mask,
+												param<float> delta) {
+	screen_check();
+	
+	const auto result = gather_bidirectional(global_id.xy, delta, img_color, img_depth, img_color_prev, img_depth_prev,
+											 img_motion_forward, img_motion_backward,
+											 img_motion_depth_forward, img_motion_depth_backward);
+	img_out_color.write(global_id.xy, result.color);
+	img_out_confidence.write(global_id.xy, float4 { result.confidence });
+	mark_low_confidence_tile(global_id.xy, result.confidence, tile_mask);
+}
+
+// block motion export (e.g. to seed the motion search of a video encoder): while warping, each converged pixel accumulates its
+// motion from the output to its source in the current color input into its block, a per-block resolve then computes the average
+// motion and the SAD between the output block and the motion compensated source block
+namespace warp_block_motion {
+	//! per-pixel motion: <16-bit y, 16-bit x> signed quarter pixels, or invalid_motion if the search didn't converge
+	static constexpr const uint32_t invalid_motion { 0x80008000u };
+	//! max per-component difference (in quarter pixels) of a pixel motion to a candidate motion, for it to support the candidate
+	static constexpr const int32_t support_tolerance { 2 };
+	//! dominant motion candidates are the pixel motions on a regular grid of candidate_grid^2 pixels per block
+	static constexpr const uint32_t candidate_grid { 4u };
+	//! values per block of the resolved output: <mv x, mv y, SAD, confidence>
+	static constexpr const uint32_t output_stride { 4u };
+	
+	floor_inline_always static uint32_t encode_motion(const int2& motion) {
+		return (uint32_t(motion.y) << 16u) | (uint32_t(motion.x) & 0xFFFFu);
+	}
+	floor_inline_always static int2 decode_motion(const uint32_t& encoded_motion) {
+		// NOTE: arithmetic shifts sign-extend each 16-bit component
+		return { int32_t(encoded_motion << 16u) >> 16, int32_t(encoded_motion) >> 16 };
+	}
+	floor_inline_always static bool is_supporting(const int2& motion, const int2& candidate) {
+		const auto diff = (motion - candidate).abs();
+		return (diff.x <= support_tolerance && diff.y <= support_tolerance);
+	}
+	
+	//! stores the motion of a gathered pixel (invalid if its search didn't converge or it wasn't sampled from the current color input)
+	floor_inline_always static void store(const uint2& coord, const gather_result& result, buffer<uint32_t> motion_pixels) {
+		const auto idx = coord.y * LIBWARP_SCREEN_WIDTH + coord.x;
+		if (!result.has_source || result.confidence < LIBWARP_CONFIDENCE_THRESHOLD) {
+			motion_pixels[idx] = invalid_motion;
+			return;
+		}
+		const auto motion = (result.source - (float2(coord) + 0.5f) * warp_camera::inv_screen_size) * warp_camera::screen_size;
+		// NOTE: -32768 is reserved for invalid_motion
+		motion_pixels[idx] = encode_motion(int2 { (motion * 4.0f).rounded().clamped(-32767.0f, 32767.0f) });
+	}
+	
+	floor_inline_always static float luma(const float4& color) {
+		return color.xyz.dot(float3 { 0.2126f, 0.7152f, 0.0722f });
+	}
+};
+
+// forward-only/bidirectional gather variants that additionally store the per-pixel motion for the block motion resolve
+kernel_2d() void libwarp_warp_gather_forward_block_motion(const_image_2d<float> img_color,
+														  const_image_2d<uint1> img_motion,
+														  image_2d<float4, true> img_out_color,
+														  buffer<uint32_t> block_motion_pixels,
+														  param<float> delta) {
+	screen_check();
+	
+	const int2 coord { global_id.xy };
+	const auto result = gather_forward(coord, delta, img_color, img_motion);
+	img_out_color.write(coord, result.color);
+	warp_block_motion::store(global_id.xy, result, block_motion_pixels);
+}
+//
+kernel_2d() void libwarp_warp_gather_block_motion(const_image_2d<float> img_color,
+												  depth_image_type img_depth,
+												  const_image_2d<float> img_color_prev,
+												  depth_image_type img_depth_prev,
+												  const_image_2d<uint1> img_motion_forward,
+												  const_image_2d<uint1> img_motion_backward,
+												  const_image_2d<float2> img_motion_depth_forward,
+												  const_image_2d<float2> img_motion_depth_backward,
+												  image_2d<float4, true> img_out_color,
+												  buffer<uint32_t> block_motion_pixels,
+												  param<float> delta) {
+	screen_check();
+	
+	const auto result = gather_bidirectional(global_id.xy, delta, img_color, img_depth, img_color_prev, img_depth_prev,
+											 img_motion_forward, img_motion_backward,
+											 img_motion_depth_forward, img_motion_depth_backward);
+	img_out_color.write(global_id.xy, result.color);
+	warp_block_motion::store(global_id.xy, result, block_motion_pixels);
+}
+
+// resolves the block motion (one work-item per block), writes <mv x, mv y (int32, 1/4 px), SAD, confidence (16-bit unorm)>
+// per block: the motion is the dominant motion of all converged pixels, i.e. the candidate motion (pixel motions on a regular
+// grid) that is supported by the most pixels, refined to the average of its supporting pixels -> unlike an average over all
+// pixels, this isn't skewed by a second surface with a different motion in the block (e.g. at object boundaries)
+// SAD is the sum of absolute luma differences (8-bit scale) between the output block and the source block at the dominant
+// motion, confidence is the fraction of pixels that support the dominant motion, reduced by the mean absolute luma difference
+kernel_2d() void libwarp_block_motion_resolve(const_image_2d<float> img_color,
+											  const_image_2d<float> img_out_color,
+											  buffer<const uint32_t> block_motion_pixels,
+											  buffer<uint32_t> block_motion,
+											  param<uint32_t> block_size) {
+	const uint2 block_count = (uint2 { LIBWARP_SCREEN_WIDTH, LIBWARP_SCREEN_HEIGHT } + block_size - 1u) / block_size;
+	if (global_id.x >= block_count.x || global_id.y >= block_count.y) {
+		return;
+	}
+	
+	const auto origin = global_id.xy * block_size;
+	const auto block_end = (origin + block_size).minned(uint2 { LIBWARP_SCREEN_WIDTH, LIBWARP_SCREEN_HEIGHT });
+	const auto read_motion = [&block_motion_pixels](const uint32_t& x, const uint32_t& y) {
+		return block_motion_pixels[y * LIBWARP_SCREEN_WIDTH + x];
+	};
+	
+	// find the candidate with the most support
+	const auto candidate_step = max(block_size / warp_block_motion::candidate_grid, 1u);
+	int2 dominant;
+	uint32_t dominant_support { 0u };
+	for (uint32_t cy = origin.y; cy < block_end.y; cy += candidate_step) {
+		for (uint32_t cx = origin.x; cx < block_end.x; cx += candidate_step) {
+			const auto encoded_candidate = read_motion(cx, cy);
+			if (encoded_candidate == warp_block_motion::invalid_motion) {
+				continue;
+			}
+			const auto candidate = warp_block_motion::decode_motion(encoded_candidate);
+			uint32_t support { 0u };
+			for (uint32_t y = origin.y; y < block_end.y; ++y) {
+				for (uint32_t x = origin.x; x < block_end.x; ++x) {
+					const auto encoded_motion = read_motion(x, y);
+					if (encoded_motion != warp_block_motion::invalid_motion &&
+						warp_block_motion::is_supporting(warp_block_motion::decode_motion(encoded_motion), candidate)) {
+						++support;
+					}
+				}
+			}
+			if (support > dominant_support) {
+				dominant = candidate;
+				dominant_support = support;
+			}
+		}
 	}
 	
-	img_out_color.write(global_id.xy, color);
+	// refine: average of all supporting pixel motions
+	float2 motion;
+	if (dominant_support > 0u) {
+		int2 motion_sum;
+		for (uint32_t y = origin.y; y < block_end.y; ++y) {
+			for (uint32_t x = origin.x; x < block_end.x; ++x) {
+				const auto encoded_motion = read_motion(x, y);
+				if (encoded_motion == warp_block_motion::invalid_motion) {
+					continue;
+				}
+				const auto pixel_motion = warp_block_motion::decode_motion(encoded_motion);
+				if (warp_block_motion::is_supporting(pixel_motion, dominant)) {
+					motion_sum += pixel_motion;
+				}
+			}
+		}
+		motion = float2(motion_sum) / (4.0f * float(dominant_support));
+	}
+	
+	const auto motion_norm = motion * warp_camera::inv_screen_size;
+	float sad { 0.0f };
+	for (uint32_t y = origin.y; y < block_end.y; ++y) {
+		for (uint32_t x = origin.x; x < block_end.x; ++x) {
+			const uint2 coord { x, y };
+			const auto p_src = (float2(coord) + 0.5f) * warp_camera::inv_screen_size + motion_norm;
+			sad += abs(warp_block_motion::luma(img_out_color.read(coord)) -
+					   warp_block_motion::luma(img_color.read_linear_repeat_mirrored(p_src)));
+		}
+	}
+	const auto pixel_count = float((block_end - origin).x * (block_end - origin).y);
+	const auto confidence = (float(dominant_support) / pixel_count) * (1.0f - min((sad / pixel_count) * 4.0f, 1.0f));
+	
+	const int2 quarter_pel_motion { (motion * 4.0f).rounded() };
+	const auto out_idx = (global_id.y * block_count.x + global_id.x) * warp_block_motion::output_stride;
+	block_motion[out_idx] = uint32_t(quarter_pel_motion.x);
+	block_motion[out_idx + 1u] = uint32_t(quarter_pel_motion.y);
+	block_motion[out_idx + 2u] = uint32_t(sad * 255.0f + 0.5f);
+	block_motion[out_idx + 3u] = uint32_t(confidence * 65535.0f + 0.5f);
+}
+
+// motion blur: averages 'sample_count' sub-frame samples that are evenly distributed over the shutter interval
+// [delta - shutter / 2, delta + shutter / 2], 'sample_color' returns the color at a sub-frame delta
+template <typename sample_color_func_type>
+floor_inline_always static float4 motion_blur_average(const float& delta,
+													  const float& shutter,
+													  const uint32_t& sample_count,
+													  sample_color_func_type&& sample_color) {
+	const float step = shutter / float(sample_count);
+	float sample_delta = delta - 0.5f * shutter + 0.5f * step;
+	float4 color;
+	for (uint32_t i = 0; i < sample_count; ++i, sample_delta += step) {
+		color += sample_color(sample_delta);
+	}
+	return color * (1.0f / float(sample_count));
+}
+
+// motion blurred forward-only gather: the search only runs once (at delta), all sub-frame samples reuse the converged position
+// and the motion at it, i.e. each additional sample only costs one color fetch
+// NOTE: unconverged pixels already use a directional blur
+static float4 gather_forward_motion_blur(const int2& coord,
+										 const float& delta,
+										 const float& shutter,
+										 const uint32_t& sample_count,
+										 const_image_2d<float> img_color,
+										 const_image_2d<uint1> img_motion) {
+	return gather_forward(coord, img_color, [&delta, &img_motion](const float2& p) {
+		return delta * decode_2d_motion(img_motion.read(p));
+	}, [&](const float2& p_fwd) {
+		const auto motion = decode_2d_motion(img_motion.read(p_fwd));
+		return motion_blur_average(delta, shutter, sample_count, [&](const float& sample_delta) {
+			return img_color.read_linear_repeat_mirrored(p_fwd + (delta - sample_delta) * motion);
+		});
+	}).color;
+}
+
+// motion blurred bidirectional gather: the search and the source selection only run once (at delta),
+// all sub-frame samples reuse the converged positions and motion (see gather_bidirectional_color)
+// NOTE: sub-frame deltas are clamped to [0, 1] (interpolation between the previous and current frame)
+static float4 gather_bidirectional_motion_blur(const uint2& coord,
+											   const float& delta,
+											   const float& shutter,
+											   const uint32_t& sample_count,
+											   const_image_2d<float> img_color,
+											   depth_image_type img_depth,
+											   const_image_2d<float> img_color_prev,
+											   depth_image_type img_depth_prev,
+											   const_image_2d<uint1> img_motion_forward,
+											   const_image_2d<uint1> img_motion_backward,
+											   const_image_2d<float2> img_motion_depth_forward,
+											   const_image_2d<float2> img_motion_depth_backward) {
+	const auto state = gather_bidirectional_resolve(coord, delta, img_color, img_depth, img_color_prev, img_depth_prev,
+													img_motion_forward, img_motion_backward,
+													img_motion_depth_forward, img_motion_depth_backward);
+	return motion_blur_average(delta, shutter, sample_count, [&](const float& sample_delta) {
+		return gather_bidirectional_color(state, delta, clamp(sample_delta, 0.0f, 1.0f), img_color, img_color_prev);
+	});
+}
+
+kernel_2d() void libwarp_warp_gather_forward_motion_blur(const_image_2d<float> img_color,
+														 const_image_2d<uint1> img_motion,
+														 image_2d<float4, true> img_out_color,
+														 param<float> delta,
+														 param<float> shutter,
+														 param<uint32_t> sample_count) {
+	screen_check();
+	
+	const int2 coord { global_id.xy };
+	img_out_color.write(coord, gather_forward_motion_blur(coord, delta, shutter, sample_count, img_color, img_motion));
+}
+
+kernel_2d() void libwarp_warp_gather_motion_blur(const_image_2d<float> img_color,
+												 depth_image_type img_depth,
+												 const_image_2d<float> img_color_prev,
+												 depth_image_type img_depth_prev,
+												 const_image_2d<uint1> img_motion_forward,
+												 const_image_2d<uint1> img_motion_backward,
+												 const_image_2d<float2> img_motion_depth_forward,
+												 const_image_2d<float2> img_motion_depth_backward,
+												 image_2d<float4, true> img_out_color,
+												 param<float> delta,
+												 param<float> shutter,
+												 param<uint32_t> sample_count) {
+	screen_check();
+	
+	img_out_color.write(global_id.xy, gather_bidirectional_motion_blur(global_id.xy, delta, shutter, sample_count,
+																	   img_color, img_depth, img_color_prev, img_depth_prev,
+																	   img_motion_forward, img_motion_backward,
+																	   img_motion_depth_forward, img_motion_depth_backward));
+}
+
+// composes two consecutive 2D motion fields (packed, see decode_2d_motion): 'img_motion_first' is the motion from frame a to b
+// (at frame a), 'img_motion_second' the motion from frame b to c (at frame b) -> writes the motion from frame a to c (at frame a)
+// NOTE: since both motion fields are stored at their source positions (like the gather inputs), this is a forward lookup of the
+//       second motion at the position reached by the first, positions that leave the screen are clamped to the edge
+// NOTE: inputs are sampled at normalized coordinates (may have a reduced resolution), the output has the screen resolution
+kernel_2d() void libwarp_compose_motion(const_image_2d<uint1> img_motion_first,
+										const_image_2d<uint1> img_motion_second,
+										image_2d<uint1, true> img_out_motion) {
+	screen_check();
+	
+	const float2 p = (float2(global_id.xy) + 0.5f) * warp_camera::inv_screen_size;
+	const auto motion_first = decode_2d_motion(img_motion_first.read(p));
+	const auto p_second = (p + motion_first).clamped(0.0f, 1.0f);
+	const auto motion = motion_first + decode_2d_motion(img_motion_second.read(p_second));
+	// inverse of decode_2d_motion
+	img_out_motion.write(global_id.xy, uint1 { pack_snorm_2x16(motion * 2.0f) });
+}
+
+// LIBWARP_FLOW_BLOCK_SIZE: block size (in pixels of each pyramid level) of the block-matching motion estimation
+#if !defined(LIBWARP_FLOW_BLOCK_SIZE)
+#define LIBWARP_FLOW_BLOCK_SIZE 8u
+#endif
+// LIBWARP_FLOW_SEARCH_RADIUS: full search radius (in pixels) at the coarsest pyramid level
+#if !defined(LIBWARP_FLOW_SEARCH_RADIUS)
+#define LIBWARP_FLOW_SEARCH_RADIUS 6
+#endif
+
+// hierarchical block-matching motion estimation: the source and target frames are converted to luma pyramids, the coarsest
+// level is searched exhaustively, each finer level only evaluates the upsampled motion of its parent block and the parent's
+// neighbors and refines the best one by +/-1px, followed by a sub-pixel parabola fit -> one work-item per block
+namespace warp_flow {
+	static constexpr const int32_t block_size { int32_t(LIBWARP_FLOW_BLOCK_SIZE) };
+	//! amount of blocks at the finest level (== screen resolution)
+	static constexpr const int2 block_count {
+		int32_t((LIBWARP_SCREEN_WIDTH + LIBWARP_FLOW_BLOCK_SIZE - 1u) / LIBWARP_FLOW_BLOCK_SIZE),
+		int32_t((LIBWARP_SCREEN_HEIGHT + LIBWARP_FLOW_BLOCK_SIZE - 1u) / LIBWARP_FLOW_BLOCK_SIZE),
+	};
+	//! SAD cost per pixel of motion (in luma units per block), favors small motion in flat/ambiguous regions
+	static constexpr const float motion_penalty { 0.01f * float(block_size * block_size) / 64.0f };
+	
+	//! computes the matching cost of the block at 'origin' in the source level and at 'origin + offset' in the target level
+	floor_inline_always static float block_cost(const_image_2d<float1> img_luma_src,
+												const_image_2d<float1> img_luma_dst,
+												const int2& origin,
+												const int2& offset,
+												const int2& level_dim) {
+		float sad { 0.0f };
+		for (int32_t y = 0; y < block_size; ++y) {
+#pragma unroll
+			for (int32_t x = 0; x < block_size; ++x) {
+				const int2 src_coord = (origin + int2 { x, y }).clamped(int2(0), level_dim - 1);
+				const int2 dst_coord = (src_coord + offset).clamped(int2(0), level_dim - 1);
+				sad += abs(img_luma_src.read(src_coord).x - img_luma_dst.read(dst_coord).x);
+			}
+		}
+		return sad + motion_penalty * float(abs(offset.x) + abs(offset.y));
+	}
+	
+	//! returns the sub-pixel offset of the cost minimum from the costs at -1, 0 and +1 (parabola fit)
+	floor_inline_always static float sub_pixel_offset(const float& cost_neg, const float& cost, const float& cost_pos) {
+		const auto denom = cost_neg - 2.0f * cost + cost_pos;
+		return (denom > 0.0f ? clamp(0.5f * (cost_neg - cost_pos) / denom, -0.5f, 0.5f) : 0.0f);
+	}
+	
+	//! bilinearly interpolates the finest level block motion (in pixels) at the pixel 'coord'
+	floor_inline_always static float2 sample_flow(const_image_2d<float2> img_flow, const uint2& coord) {
+		const float2 p = (float2(coord) + 0.5f) * (1.0f / float(block_size)) - 0.5f;
+		const float2 p_floor = p.floored();
+		const float2 frac = p - p_floor;
+		const int2 base { p_floor };
+		const auto read_block = [&img_flow](const int2& block) {
+			return img_flow.read(block.clamped(int2(0), block_count - 1)).xy;
+		};
+		return (read_block(base).interpolated(read_block(base + int2 { 1, 0 }), frac.x).interpolated(
+				read_block(base + int2 { 0, 1 }).interpolated(read_block(base + int2 { 1, 1 }), frac.x), frac.y));
+	}
+};
+
+// converts a color frame into the finest level of its luma pyramid
+kernel_2d() void libwarp_flow_luma(const_image_2d<float> img_color,
+								   image_2d<float1, true> img_luma) {
+	screen_check();
+	
+	const auto color = img_color.read(global_id.xy);
+	img_luma.write(global_id.xy, float1 { color.xyz.dot(float3 { 0.2126f, 0.7152f, 0.0722f }) });
+}
+
+// computes the next coarser luma pyramid level (2x2 box filter), 'src_dim' is the dim of the finer level
+kernel_2d() void libwarp_flow_downsample(const_image_2d<float1> img_luma,
+										 image_2d<float1, true> img_luma_half,
+										 param<uint2> src_dim) {
+	const auto half_dim = (src_dim + 1u) / 2u;
+	if (global_id.x >= half_dim.x || global_id.y >= half_dim.y) {
+		return;
+	}
+	
+	const auto src_coord = global_id.xy * 2u;
+	const auto src_max = src_dim - 1u;
+	const float luma = (img_luma.read(src_coord).x +
+						img_luma.read((src_coord + uint2 { 1u, 0u }).minned(src_max)).x +
+						img_luma.read((src_coord + uint2 { 0u, 1u }).minned(src_max)).x +
+						img_luma.read((src_coord + 1u).minned(src_max)).x);
+	img_luma_half.write(global_id.xy, float1 { luma * 0.25f });
+}
+
+// block search of one pyramid level, writes the motion (in pixels of this level) of each block to 'img_flow'
+// 'img_coarse_flow' is the motion of the next coarser level (unused at the coarsest level)
+kernel_2d() void libwarp_flow_search(const_image_2d<float1> img_luma_src,
+									 const_image_2d<float1> img_luma_dst,
+									 const_image_2d<float2> img_coarse_flow,
+									 image_2d<float2, true> img_flow,
+									 param<uint2> level_dim,
+									 param<uint32_t> is_coarsest) {
+	const auto level_block_count = (level_dim + LIBWARP_FLOW_BLOCK_SIZE - 1u) / LIBWARP_FLOW_BLOCK_SIZE;
+	if (global_id.x >= level_block_count.x || global_id.y >= level_block_count.y) {
+		return;
+	}
+	
+	const int2 block { global_id.xy };
+	const int2 origin = block * warp_flow::block_size;
+	const int2 dim { level_dim };
+	const auto cost = [&](const int2& offset) {
+		return warp_flow::block_cost(img_luma_src, img_luma_dst, origin, offset, dim);
+	};
+	
+	int2 best_offset;
+	float best_cost = cost(best_offset);
+	if (is_coarsest) {
+		// exhaustive search
+		for (int32_t y = -LIBWARP_FLOW_SEARCH_RADIUS; y <= LIBWARP_FLOW_SEARCH_RADIUS; ++y) {
+			for (int32_t x = -LIBWARP_FLOW_SEARCH_RADIUS; x <= LIBWARP_FLOW_SEARCH_RADIUS; ++x) {
+				const int2 offset { x, y };
+				const auto offset_cost = cost(offset);
+				if (offset_cost < best_cost) {
+					best_cost = offset_cost;
+					best_offset = offset;
+				}
+			}
+		}
+	} else {
+		// predictive search: upsampled motion of the parent block and its neighbors (+ zero motion from above)
+		const int2 parent = block / 2;
+		const int2 parent_max = int2((level_block_count + 1u) / 2u) - 1;
+		static constexpr const int2 parent_offsets[] { { 0, 0 }, { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+#pragma unroll
+		for (const auto& parent_offset : parent_offsets) {
+			const auto coarse_flow = img_coarse_flow.read((parent + parent_offset).clamped(int2(0), parent_max)).xy;
+			const int2 offset { (coarse_flow * 2.0f).rounded() };
+			const auto offset_cost = cost(offset);
+			if (offset_cost < best_cost) {
+				best_cost = offset_cost;
+				best_offset = offset;
+			}
+		}
+		// refine
+		const auto center = best_offset;
+#pragma unroll
+		for (int32_t y = -1; y <= 1; ++y) {
+#pragma unroll
+			for (int32_t x = -1; x <= 1; ++x) {
+				const int2 offset = center + int2 { x, y };
+				if (x == 0 && y == 0) {
+					continue;
+				}
+				const auto offset_cost = cost(offset);
+				if (offset_cost < best_cost) {
+					best_cost = offset_cost;
+					best_offset = offset;
+				}
+			}
+		}
+	}
+	
+	// sub-pixel refinement
+	const float2 flow {
+		float(best_offset.x) + warp_flow::sub_pixel_offset(cost(best_offset - int2 { 1, 0 }), best_cost,
+														   cost(best_offset + int2 { 1, 0 })),
+		float(best_offset.y) + warp_flow::sub_pixel_offset(cost(best_offset - int2 { 0, 1 }), best_cost,
+														   cost(best_offset + int2 { 0, 1 })),
+	};
+	img_flow.write(global_id.xy, flow);
+}
+
+// writes the per-pixel 2D motion (packed, see decode_2d_motion) from the finest level block motion,
+// 'motion_scale' is 1 or -1 (inverted motion)
+kernel_2d() void libwarp_flow_output(const_image_2d<float2> img_flow,
+									 image_2d<uint1, true> img_out_motion,
+									 param<float> motion_scale) {
+	screen_check();
+	
+	const auto motion = warp_flow::sample_flow(img_flow, global_id.xy) * warp_camera::inv_screen_size * motion_scale;
+	// inverse of decode_2d_motion
+	img_out_motion.write(global_id.xy, uint1 { pack_snorm_2x16(motion * 2.0f) });
+}
+
+// same as libwarp_flow_output, but also writes the motion depth (packed z/w depth delta along the motion, see gather_bidirectional)
+kernel_2d() void libwarp_flow_output_depth(const_image_2d<float2> img_flow,
+										   depth_image_type img_depth_src,
+										   depth_image_type img_depth_dst,
+										   image_2d<uint1, true> img_out_motion,
+										   image_2d<float2, true> img_out_motion_depth,
+										   param<float> motion_scale) {
+	screen_check();
+	
+	const auto flow = warp_flow::sample_flow(img_flow, global_id.xy);
+	const auto motion = flow * warp_camera::inv_screen_size * motion_scale;
+	img_out_motion.write(global_id.xy, uint1 { pack_snorm_2x16(motion * 2.0f) });
+	
+	// depth change of the source pixel along its motion
+	const int2 dst_coord = int2((float2(global_id.xy) + 0.5f + flow).floored()).clamped(int2(0), int2(warp_camera::screen_size) - 1);
+	const auto linear_depth_delta = (warp_camera::linearize_depth(img_depth_dst.read(dst_coord)) -
+									 warp_camera::linearize_depth(img_depth_src.read(global_id.xy))) * motion_scale;
+	// inverse of linearize_depth<depth_type::z_div_w>, which is how the gather modes linearize the motion depth
+	constexpr const float inv_z_div_w_scale { 1.0f / (1.0f - warp_camera::near_far_plane.x / warp_camera::near_far_plane.y) };
+	const auto depth_delta = (linear_depth_delta - warp_camera::near_far_plane.x) * inv_z_div_w_scale;
+	// same value for fwd (.x) and bwd (.y) use
+	img_out_motion_depth.write(global_id.xy, float2 { depth_delta, depth_delta });
+}
+
+// scatter confidence: a pixel is covered if any scattered pixel passed its depth test (same as in the history resolve)
+// NOTE: the output alpha can't be used for this, since it is stale in holes if the frame isn't cleared
+// (if there is no second layer, both depth buffers refer to the same buffer)
+kernel_2d() void libwarp_scatter_confidence(buffer<const float> depth_buffer,
+											buffer<const float> depth_buffer_layer2,
+											image_2d<float, true> img_out_confidence,
+											buffer<uint32_t> tile_mask) {
+	screen_check();
+	
+	const auto idx = global_id.y * LIBWARP_SCREEN_WIDTH + global_id.x;
+	const bool is_covered = (min(depth_buffer[idx], depth_buffer_layer2[idx]) != numeric_limits<float>::max());
+	const auto confidence = (is_covered ? warp_confidence::valid : warp_confidence::invalid);
+	img_out_confidence.write(global_id.xy, float4 { confidence });
+	mark_low_confidence_tile(global_id.xy, confidence, tile_mask);
+}
+
+// LIBWARP_HISTORY_MAX_AGE: max age (in warped frames since the pixel was last covered) of a history sample,
+// for it to still be used for hole filling
+#if !defined(LIBWARP_HISTORY_MAX_AGE)
+#define LIBWARP_HISTORY_MAX_AGE 8u
+#endif
+// LIBWARP_HISTORY_DEPTH_TOLERANCE: max relative linear depth a history sample may be in front of the background around a hole
+#if !defined(LIBWARP_HISTORY_DEPTH_TOLERANCE)
+#define LIBWARP_HISTORY_DEPTH_TOLERANCE 0.05f
+#endif
+
+// LIBWARP_HISTORY_REPROJECTION_ITERATIONS: amount of fixed-point iterations that are used to find the history pixel of a hole
+#if !defined(LIBWARP_HISTORY_REPROJECTION_ITERATIONS)
+#define LIBWARP_HISTORY_REPROJECTION_ITERATIONS 2u
+#endif
+
+// scatter history reprojection: the history was written by the previous warp job, 'step' frames earlier
+// -> the history pixel of a hole is the one that moves onto the hole within 'step' frames, which is found via fixed-point
+//    iteration, since the motion is only known at the history pixel itself
+// NOTE: the motion of a history pixel is approximated by the scatter input motion at the same screen position
+namespace warp_history {
+	static constexpr const float no_depth { numeric_limits<float>::max() };
+	static constexpr const uint32_t invalid_age { ~0u };
+	
+	//! screen-space displacement (in pixels) of the history pixel at 'coord' within 'step' frames
+	floor_inline_always static float2 displacement(const uint2& coord,
+												   const float& linear_depth,
+												   const float& step,
+												   const_image_2d<uint1> img_motion) {
+		const auto motion = decode_3d_motion(img_motion.read(warp_input::input_coord(coord)));
+		const auto pos = warp_camera::reconstruct_position(coord, linear_depth);
+		return warp_camera::reproject_position(pos + step * motion) - warp_camera::reproject_position(pos);
+	}
+	//! unified motion variant (the linear depth isn't needed)
+	floor_inline_always static float2 displacement(const uint2& coord,
+												   const float&,
+												   const float& step,
+												   const_image_2d<float> img_motion) {
+		const auto motion = decode_unified_motion(img_motion.read(warp_input::input_coord(coord)));
+		return step * motion.xy * warp_camera::screen_size;
+	}
+	
+	//! returns the index of the history pixel that is reprojected onto 'coord', or ~0u if it lies off-screen
+	template <typename motion_image_type>
+	floor_inline_always static uint32_t reproject(const int2& coord,
+												  const float& step,
+												  buffer<const float4> history,
+												  motion_image_type img_motion) {
+		uint2 px { uint2(coord) };
+#pragma unroll
+		for (uint32_t i = 0; i < LIBWARP_HISTORY_REPROJECTION_ITERATIONS; ++i) {
+			const auto linear_depth = history[px.y * LIBWARP_SCREEN_WIDTH + px.x].w;
+			if (linear_depth == no_depth) {
+				break; // no history at the current estimate -> its motion is unknown
+			}
+			const auto pos = float2(coord) - displacement(px, linear_depth, step, img_motion) + 0.5f;
+			if ((pos < 0.0f).any() || (pos >= warp_camera::screen_size).any()) {
+				return ~0u;
+			}
+			px = uint2(pos);
+		}
+		return px.y * LIBWARP_SCREEN_WIDTH + px.x;
+	}
+};
+
+// scatter history resolve: replaces the clear and fixup passes when temporal hole filling is enabled
+// covered pixels (determined via the depth buffers) update the history, holes are filled from the reprojected history
+// (weighted by its age) and the covered 4-neighborhood
+// the history of the previous job is read from 'history_in'/'history_age_in', the updated history of this job is written to
+// 'history_out'/'history_age_out' (every pixel is written, color and age always together)
+// NOTE: the output isn't cleared in this mode, so 'img_out_color' may still contain stale colors in holes
+template <typename motion_image_type, typename confidence_func_type>
+floor_inline_always static void scatter_history_resolve(const int2& coord,
+														image_2d<float4> img_out_color,
+														buffer<const float> depth_buffer,
+														buffer<const float> depth_buffer_layer2,
+														buffer<const float4> history_in,
+														buffer<const uint32_t> history_age_in,
+														buffer<float4> history_out,
+														buffer<uint32_t> history_age_out,
+														motion_image_type img_motion,
+														const float& step,
+														confidence_func_type&& write_confidence) {
+	using warp_history::no_depth;
+	using warp_history::invalid_age;
+	// NOTE: the second layer is only written where the first layer is empty
+	// (if there is no second layer, both refer to the same buffer)
+	const auto covered_depth = [&depth_buffer, &depth_buffer_layer2](const uint32_t& idx) {
+		return min(depth_buffer[idx], depth_buffer_layer2[idx]);
+	};
+	
+	const auto idx = uint32_t(coord.y) * LIBWARP_SCREEN_WIDTH + uint32_t(coord.x);
+	if (const auto depth = covered_depth(idx); depth != no_depth) {
+		// covered in this frame: output has already been written by the color pass -> only update the history
+		history_out[idx] = float4 { img_out_color.read(coord).xyz, depth };
+		history_age_out[idx] = 0u;
+		write_confidence(true);
+		return;
+	}
+	write_confidence(false);
+	
+	// hole: average of the covered 4-neighborhood, the farthest neighbor determines the background depth
+	// NOTE: covered pixels are never written by this kernel, so reading them is race-free
+	static constexpr const int2 offsets[4] { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+	float3 avg;
+	float sum { 0.0f };
+	float background_depth { 0.0f };
+#pragma unroll
+	for (const auto& offset : offsets) {
+		const auto neighbor = coord + offset;
+		if (neighbor.x < 0 || neighbor.x >= int32_t(LIBWARP_SCREEN_WIDTH) ||
+			neighbor.y < 0 || neighbor.y >= int32_t(LIBWARP_SCREEN_HEIGHT)) {
+			continue;
+		}
+		const auto neighbor_depth = covered_depth(uint32_t(neighbor.y) * LIBWARP_SCREEN_WIDTH + uint32_t(neighbor.x));
+		if (neighbor_depth == no_depth) {
+			continue;
+		}
+		avg += img_out_color.read(neighbor).xyz;
+		sum += 1.0f;
+		background_depth = max(background_depth, neighbor_depth);
+	}
+	
+	// reproject and age the history sample (saturates at invalid_age)
+	const auto hist_idx = warp_history::reproject(coord, step, history_in, img_motion);
+	const auto hist = (hist_idx != ~0u ? history_in[hist_idx] : float4 { 0.0f, 0.0f, 0.0f, no_depth });
+	const auto prev_age = (hist_idx != ~0u ? history_age_in[hist_idx] : invalid_age);
+	const auto age = (prev_age >= LIBWARP_HISTORY_MAX_AGE ? invalid_age : prev_age + 1u);
+	// the reprojected sample becomes the history of this pixel
+	history_out[idx] = hist;
+	history_age_out[idx] = age;
+	
+	// the history of a disoccluded pixel may still contain the occluder -> must not be in front of the background
+	const bool is_hist_valid = (age != invalid_age &&
+								(sum == 0.0f || hist.w >= background_depth * (1.0f - LIBWARP_HISTORY_DEPTH_TOLERANCE)));
+	const float hist_weight = (is_hist_valid ? 1.0f - float(age) / float(LIBWARP_HISTORY_MAX_AGE + 1u) : 0.0f);
+	// NOTE: without any covered neighbors, the history is the best guess (regardless of its age)
+	const auto color = (sum > 0.0f ? (avg / sum) * (1.0f - hist_weight) + hist.xyz * hist_weight : hist.xyz);
+	img_out_color.write(coord, float4 { color, 1.0f });
+}
+
+// history resolve with confidence output: filled holes are still reported as holes
+template <typename motion_image_type>
+floor_inline_always static void scatter_history_resolve_confidence(image_2d<float4> img_out_color,
+																   buffer<const float> depth_buffer,
+																   buffer<const float> depth_buffer_layer2,
+																   buffer<const float4> history_in,
+																   buffer<const uint32_t> history_age_in,
+																   buffer<float4> history_out,
+																   buffer<uint32_t> history_age_out,
+																   motion_image_type img_motion,
+																   const float& step,
+																   image_2d<float, true> img_out_confidence,
+																   buffer<uint32_t> tile_mask) {
+	scatter_history_resolve(global_id.xy, img_out_color, depth_buffer, depth_buffer_layer2,
+							history_in, history_age_in, history_out, history_age_out, img_motion, step,
+							[&img_out_confidence, &tile_mask](const bool& is_covered) {
+		const auto confidence = (is_covered ? warp_confidence::valid : warp_confidence::invalid);
+		img_out_confidence.write(global_id.xy, float4 { confidence });
+		mark_low_confidence_tile(global_id.xy, confidence, tile_mask);
+	});
+}
+
+kernel_2d() void libwarp_scatter_history_resolve(image_2d<float4> img_out_color,
+												 buffer<const float> depth_buffer,
+												 buffer<const float> depth_buffer_layer2,
+												 buffer<const float4> history_in,
+												 buffer<const uint32_t> history_age_in,
+												 buffer<float4> history_out,
+												 buffer<uint32_t> history_age_out,
+												 const_image_2d<uint1> img_motion,
+												 param<float> step) {
+	screen_check();
+	
+	scatter_history_resolve(global_id.xy, img_out_color, depth_buffer, depth_buffer_layer2,
+							history_in, history_age_in, history_out, history_age_out, img_motion, step,
+							[](const bool&) {});
+}
+//
+kernel_2d() void libwarp_scatter_history_resolve_confidence(image_2d<float4> img_out_color,
+															buffer<const float> depth_buffer,
+															buffer<const float> depth_buffer_layer2,
+															buffer<const float4> history_in,
+															buffer<const uint32_t> history_age_in,
+															buffer<float4> history_out,
+															buffer<uint32_t> history_age_out,
+															const_image_2d<uint1> img_motion,
+															param<float> step,
+															image_2d<float, true> img_out_confidence,
+															buffer<uint32_t> tile_mask) {
+	screen_check();
+	
+	scatter_history_resolve_confidence(img_out_color, depth_buffer, depth_buffer_layer2,
+									   history_in, history_age_in, history_out, history_age_out, img_motion, step,
+									   img_out_confidence, tile_mask);
+}
+
+// unified motion variants of the history resolve
+kernel_2d() void libwarp_scatter_history_resolve_unified(image_2d<float4> img_out_color,
+														 buffer<const float> depth_buffer,
+														 buffer<const float> depth_buffer_layer2,
+														 buffer<const float4> history_in,
+														 buffer<const uint32_t> history_age_in,
+														 buffer<float4> history_out,
+														 buffer<uint32_t> history_age_out,
+														 const_image_2d<float> img_motion,
+														 param<float> step) {
+	screen_check();
+	
+	scatter_history_resolve(global_id.xy, img_out_color, depth_buffer, depth_buffer_layer2,
+							history_in, history_age_in, history_out, history_age_out, img_motion, step,
+							[](const bool&) {});
+}
+//
+kernel_2d() void libwarp_scatter_history_resolve_unified_confidence(image_2d<float4> img_out_color,
+																	buffer<const float> depth_buffer,
+																	buffer<const float> depth_buffer_layer2,
+																	buffer<const float4> history_in,
+																	buffer<const uint32_t> history_age_in,
+																	buffer<float4> history_out,
+																	buffer<uint32_t> history_age_out,
+																	const_image_2d<float> img_motion,
+																	param<float> step,
+																	image_2d<float, true> img_out_confidence,
+																	buffer<uint32_t> tile_mask) {
+	screen_check();
+	
+	scatter_history_resolve_confidence(img_out_color, depth_buffer, depth_buffer_layer2,
+									   history_in, history_age_in, history_out, history_age_out, img_motion, step,
+									   img_out_confidence, tile_mask);
+}
+
+// replaces all low-confidence tiles of the warped image with the re-rendered image
+kernel_2d() void libwarp_merge_tiles(const_image_2d<float> img_rerendered,
+									 buffer<const uint32_t> tile_mask,
+									 image_2d<float4, true> img_out_color) {
+	screen_check();
+	
+	const uint2 coord { global_id.xy };
+	if (tile_mask[tile_index(coord)] == 0u) {
+		return;
+	}
+	auto color = img_rerendered.read(coord);
+	color.w = 1.0f;
+	img_out_color.write(coord, color);
+}
+
+// LIBWARP_AUTO_CONSISTENCY_THRESHOLD: max forward/backward motion mismatch (in pixels) for a pixel to be considered simple
+#if !defined(LIBWARP_AUTO_CONSISTENCY_THRESHOLD)
+#define LIBWARP_AUTO_CONSISTENCY_THRESHOLD 0.5f
+#endif
+
+// returns true if the motion at 'p' in one frame does not map back onto 'p' via the motion of the other frame,
+// i.e. the pixel is (dis)occluded, leaves the screen or has non-rigid/complex motion
+floor_inline_always static bool is_motion_inconsistent(const float2& p,
+													   const_image_2d<uint1> img_motion,
+													   const_image_2d<uint1> img_motion_other) {
+	const auto motion = decode_2d_motion(img_motion.read(p));
+	const auto p_other = p + motion;
+	if ((p_other < 0.0f).any() || (p_other > 1.0f).any()) {
+		return true;
+	}
+	const auto motion_other = decode_2d_motion(img_motion_other.read(p_other));
+	constexpr const float threshold_sq { LIBWARP_AUTO_CONSISTENCY_THRESHOLD * LIBWARP_AUTO_CONSISTENCY_THRESHOLD };
+	return (((motion + motion_other) * warp_camera::screen_size).dot() > threshold_sq);
+}
+
+// auto mode: computes the per-tile warp mode (0: forward-only gather, 1: bidirectional gather)
+// 'tile_modes' must be cleared to 0 beforehand, the amount of complex tiles is counted in tile_modes[tile count]
+kernel_2d() void libwarp_auto_tile_stats(const_image_2d<uint1> img_motion_forward,
+										 const_image_2d<uint1> img_motion_backward,
+										 buffer<uint32_t> tile_modes) {
+	screen_check();
+	
+	// check the forward motion of the previous frame and the backward motion of the current frame,
+	// which catches occlusions in the previous frame as well as disocclusions in the current frame
+	const float2 p = (float2(global_id.xy) + 0.5f) * warp_camera::inv_screen_size;
+	if (is_motion_inconsistent(p, img_motion_forward, img_motion_backward) ||
+		is_motion_inconsistent(p, img_motion_backward, img_motion_forward)) {
+		const auto idx = tile_index(global_id.xy);
+		// only the first work-item that flags the tile increments the counter
+		if (tile_modes[idx] == 0u && atomic_or(&tile_modes[idx], 1u) == 0u) {
+			static constexpr const uint32_t tile_count_y { (LIBWARP_SCREEN_HEIGHT + TILE_SIZE_Y - 1u) / TILE_SIZE_Y };
+			atomic_inc(&tile_modes[tile_count_x * tile_count_y]);
+		}
+	}
+}
+
+// auto mode: mixed gather-based warp, using forward-only warping for simple tiles and bidirectional warping for complex ones
+// NOTE: since tiles == work-groups, the branch is uniform within each work-group
+kernel_2d() void libwarp_warp_gather_auto(const_image_2d<float> img_color,
+										  depth_image_type img_depth,
+										  const_image_2d<float> img_color_prev,
+										  depth_image_type img_depth_prev,
+										  const_image_2d<uint1> img_motion_forward,
+										  const_image_2d<uint1> img_motion_backward,
+										  const_image_2d<float2> img_motion_depth_forward,
+										  const_image_2d<float2> img_motion_depth_backward,
+										  image_2d<float4, true> img_out_color,
+										  buffer<const uint32_t> tile_modes,
+										  param<float> delta) {
+	screen_check();
+	
+	const uint2 coord { global_id.xy };
+	if (tile_modes[tile_index(coord)] == 0u) {
+		// forward-only: previous frame + forward motion (prev -> cur)
+		img_out_color.write(coord, gather_forward(int2(coord), delta, img_color_prev, img_motion_forward).color);
+	} else {
+		img_out_color.write(coord, gather_bidirectional(coord, delta, img_color, img_depth, img_color_prev, img_depth_prev,
+														img_motion_forward, img_motion_backward,
+														img_motion_depth_forward, img_motion_depth_backward).color);
+	}
 }
 
 kernel_2d() void libwarp_single_px_fixup(image_2d<float4> warp_img) {
@@ -17,6 +17,7 @@
  */
 
 #include "libwarp_internal.hpp"
+#include <libwarp/libwarp.hpp>
 
 #if defined(FLOOR_COMPUTE_HOST)
 #include <libwarp/warp_kernels.hpp>
@@ -41,6 +42,8 @@ LIBWARP_ERROR_CODE libwarp_init() {
 		}
 		
 		atexit([] {
+			libwarp_stop_job_worker();
+			libwarp_stop_prebuild();
 			const auto destroy_libfloor = (libwarp_state && libwarp_state->did_init_libfloor);
 			libwarp_state = nullptr;
 			if (destroy_libfloor) {
@@ -58,6 +61,10 @@ LIBWARP_ERROR_CODE libwarp_init() {
 		libwarp_state->dev_queue = libwarp_state->ctx->create_queue(*libwarp_state->dev);
 		if(libwarp_state->dev_queue == nullptr) return LIBWARP_NO_QUEUE;
 		
+		// by default, only one warp job is in flight at a time (blocking execution on the device queue)
+		libwarp_state->slots.resize(1);
+		libwarp_state->slots[0].queue = libwarp_state->dev_queue;
+		
 		// check if device supports 1024 work-items and tile-size of 32*32px (use it, if so)
 		if(libwarp_state->dev->max_total_local_size == 1024 &&
 		   libwarp_state->dev->max_local_size.x >= 32 &&
@@ -74,20 +81,42 @@ LIBWARP_ERROR_CODE libwarp_init() {
 }
 
 void libwarp_cleanup() REQUIRES(!libwarp_lock) {
+	// pending jobs are cancelled and the running one is waited on before any state is cleared,
+	// must be stopped before acquiring the lock (worker may be waiting on it), is restarted on the next submit
+	libwarp_stop_job_worker();
+	
 	GUARD(libwarp_lock);
 	if (libwarp_state == nullptr) return;
 	
 	libwarp_state->programs.clear();
+	libwarp_cancel_prebuild();
+	
+	libwarp_finish_slots();
+	for (auto& slot : libwarp_state->slots) {
+		slot.depth_buffer = nullptr;
+		slot.depth_buffer_layer2 = nullptr;
+		slot.tile_mask = nullptr;
+		slot.block_motion_pixels = nullptr;
+		slot.block_motion = nullptr;
+		slot.tile_modes = nullptr;
+		slot.depth_pyramid[0] = slot.depth_pyramid[1] = nullptr;
+		slot.depth_pyramid_built_from[0] = slot.depth_pyramid_built_from[1] = nullptr;
+	}
 	
 	libwarp_state->scatter.color = nullptr;
 	libwarp_state->scatter.depth = nullptr;
 	libwarp_state->scatter.motion = nullptr;
 	libwarp_state->scatter.output = nullptr;
-	libwarp_state->scatter.depth_buffer = nullptr;
+	libwarp_state->scatter.motion_prev = nullptr;
+	libwarp_state->scatter.color_layer2 = nullptr;
+	libwarp_state->scatter.depth_layer2 = nullptr;
+	libwarp_state->scatter.motion_layer2 = nullptr;
 	
 	libwarp_state->gather_forward.color = nullptr;
 	libwarp_state->gather_forward.motion = nullptr;
 	libwarp_state->gather_forward.output = nullptr;
+	libwarp_state->gather_forward.depth = nullptr;
+	libwarp_state->gather_forward.motion_prev = nullptr;
 	
 	libwarp_state->gather.color[0] = nullptr;
 	libwarp_state->gather.color[1] = nullptr;
@@ -105,10 +134,55 @@ void libwarp_cleanup() REQUIRES(!libwarp_lock) {
 	libwarp_state->debug.depth = nullptr;
 	libwarp_state->debug.motion = nullptr;
 	libwarp_state->debug.motion_depth = nullptr;
+	
+	libwarp_state->history.colors[0] = libwarp_state->history.colors[1] = nullptr;
+	libwarp_state->history.ages[0] = libwarp_state->history.ages[1] = nullptr;
+	libwarp_state->history.source = nullptr;
+	
+	libwarp_state->compose.cache.clear();
+	libwarp_state->compose.scratch = nullptr;
+	libwarp_state->compose.inputs.clear();
+	
+	libwarp_state->stream.color = nullptr;
+	libwarp_state->stream.depth = nullptr;
+	libwarp_state->stream.motion = nullptr;
+	libwarp_state->stream.output = nullptr;
+	
+	libwarp_state->flow.luma_src = {};
+	libwarp_state->flow.luma_dst = {};
+	libwarp_state->flow.block_flow = {};
+	libwarp_state->flow.color_src = nullptr;
+	libwarp_state->flow.color_dst = nullptr;
+	libwarp_state->flow.depth_src = nullptr;
+	libwarp_state->flow.depth_dst = nullptr;
+	libwarp_state->flow.output = nullptr;
+	libwarp_state->flow.output_depth = nullptr;
+	
+	libwarp_state->confidence.image = nullptr;
+	libwarp_state->block_motion.source = nullptr;
+	libwarp_state->block_motion.output = nullptr;
+	// NOTE: this also disables the host output ring
+	libwarp_state->host_output.ring.clear();
+	libwarp_state->merge.rerendered = nullptr;
+	libwarp_state->merge.output = nullptr;
+	libwarp_state->depth_pyramid.last_img_set = ~0u;
+	
+	libwarp_state->recordings.clear();
+	
+	libwarp_vulkan_cleanup();
 }
 
 void libwarp_destroy() REQUIRES(!libwarp_lock) {
+	// must be stopped before acquiring the lock (worker may be waiting on it)
+	libwarp_stop_job_worker();
+	// prebuild workers must be done before the context is destroyed
+	libwarp_stop_prebuild();
+	
 	GUARD(libwarp_lock);
+	if (libwarp_state) {
+		libwarp_finish_slots();
+		libwarp_vulkan_cleanup();
+	}
 	const auto destroy_libfloor = (libwarp_state && libwarp_state->did_init_libfloor);
 	libwarp_state = nullptr;
 	if (destroy_libfloor) {
@@ -116,22 +190,206 @@ void libwarp_destroy() REQUIRES(!libwarp_lock) {
 	}
 }
 
-pair<LIBWARP_ERROR_CODE, shared_ptr<libwarp_state_struct::camera_setup_program>>
-libwarp_build(const libwarp_camera_setup* const camera_setup) {
-	// just in case ...
-	if(camera_setup->screen_width == 0 || camera_setup->screen_height == 0) {
-		return { LIBWARP_INVALID_SCREEN_DIM, {} };
+void libwarp_state_struct::in_flight_slot::retain(initializer_list<reference_wrapper<const shared_ptr<compute_image>>> images) {
+	if (!libwarp_state->is_async()) {
+		return; // blocking execution, nothing to retain
+	}
+	for (const auto& img : images) {
+		retained_images.emplace_back(img.get());
+	}
+}
+
+void libwarp_state_struct::in_flight_slot::retain(const vector<shared_ptr<compute_image>>& images) {
+	if (!libwarp_state->is_async()) {
+		return; // blocking execution, nothing to retain
+	}
+	retained_images.insert(retained_images.end(), images.begin(), images.end());
+}
+
+libwarp_state_struct::in_flight_slot& libwarp_acquire_slot() {
+	libwarp_state->cur_slot = (libwarp_state->cur_slot + 1u) % uint32_t(libwarp_state->slots.size());
+	auto& slot = libwarp_state->slots[libwarp_state->cur_slot];
+	// previous job on this slot must have completed before its resources can be reused
+	libwarp_finish_slot(slot);
+	return slot;
+}
+
+void libwarp_finish_slot(libwarp_state_struct::in_flight_slot& slot) {
+	if (slot.busy) {
+		slot.queue->finish();
+		slot.busy = false;
+	}
+	slot.retained_images.clear();
+}
+
+void libwarp_finish_slots() {
+	for (auto& slot : libwarp_state->slots) {
+		libwarp_finish_slot(slot);
+	}
+}
+
+LIBWARP_ERROR_CODE libwarp_alloc_depth_buffer(libwarp_state_struct::in_flight_slot& slot,
+											  const libwarp_camera_setup* const camera_setup) {
+	const auto depth_buffer_size = sizeof(float) * camera_setup->screen_width * camera_setup->screen_height;
+	if(slot.depth_buffer == nullptr ||
+	   slot.depth_buffer->get_size() < depth_buffer_size) {
+		slot.depth_buffer = libwarp_state->ctx->create_buffer(*slot.queue, depth_buffer_size);
+		if(slot.depth_buffer == nullptr) {
+			return LIBWARP_DEPTH_BUFFER_FAILURE;
+		}
+	}
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_alloc_depth_buffer_layer2(libwarp_state_struct::in_flight_slot& slot,
+													 const libwarp_camera_setup* const camera_setup) {
+	const auto depth_buffer_size = sizeof(float) * camera_setup->screen_width * camera_setup->screen_height;
+	if (slot.depth_buffer_layer2 == nullptr ||
+		slot.depth_buffer_layer2->get_size() < depth_buffer_size) {
+		slot.depth_buffer_layer2 = libwarp_state->ctx->create_buffer(*slot.queue, depth_buffer_size);
+		if (slot.depth_buffer_layer2 == nullptr) {
+			return LIBWARP_DEPTH_BUFFER_FAILURE;
+		}
+	}
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_alloc_history(libwarp_state_struct::in_flight_slot& slot,
+										 const libwarp_camera_setup* const camera_setup) {
+	auto& history = libwarp_state->history;
+	const uint2 dim { camera_setup->screen_width, camera_setup->screen_height };
+	if (history.colors[0] != nullptr && history.dim == dim) {
+		return LIBWARP_SUCCESS;
 	}
 	
-	// check if prog already exists for this setup
-	for(const auto& prog : libwarp_state->programs) {
-		if(memcmp(&prog.first, camera_setup, sizeof(libwarp_camera_setup)) == 0) {
-			// does already exist, return it
-			return { LIBWARP_SUCCESS, prog.second };
+	// (re)create and reset: no pixel has any history yet
+	// NOTE: the current history may still be in use by the job that last wrote it
+	libwarp_finish_slot(libwarp_state->slots[history.slot]);
+	const auto pixel_count = size_t(dim.x) * size_t(dim.y);
+	const float4 clear_color { 0.0f, 0.0f, 0.0f, numeric_limits<float>::max() };
+	const uint32_t invalid_age = ~0u;
+	for (uint32_t i = 0; i < 2u; ++i) {
+		history.colors[i] = libwarp_state->ctx->create_buffer(*slot.queue, sizeof(float4) * pixel_count);
+		history.ages[i] = libwarp_state->ctx->create_buffer(*slot.queue, sizeof(uint32_t) * pixel_count);
+		if (history.colors[i] == nullptr || history.ages[i] == nullptr) {
+			history.colors[0] = history.colors[1] = nullptr;
+			history.ages[0] = history.ages[1] = nullptr;
+			return LIBWARP_HISTORY_BUFFER_FAILURE;
+		}
+		history.colors[i]->fill(*slot.queue, &clear_color, sizeof(clear_color));
+		history.ages[i]->fill(*slot.queue, &invalid_age, sizeof(invalid_age));
+	}
+	history.dim = dim;
+	history.cur = 0;
+	history.source = nullptr;
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_set_scatter_history(const bool enable) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	// history buffers may still be in use
+	libwarp_finish_slots();
+	auto& history = libwarp_state->history;
+	history.enabled = enable;
+	history.colors[0] = history.colors[1] = nullptr;
+	history.ages[0] = history.ages[1] = nullptr;
+	history.source = nullptr;
+	return LIBWARP_SUCCESS;
+}
+
+uint2 libwarp_tile_count(const libwarp_camera_setup* const camera_setup) {
+	return uint2(camera_setup->screen_width, camera_setup->screen_height).rounded_next_multiple(libwarp_state->tile_size) / libwarp_state->tile_size;
+}
+
+LIBWARP_ERROR_CODE libwarp_alloc_tile_mask(libwarp_state_struct::in_flight_slot& slot,
+										   const libwarp_camera_setup* const camera_setup) {
+	const auto tile_count = libwarp_tile_count(camera_setup);
+	const auto tile_mask_size = sizeof(uint32_t) * tile_count.x * tile_count.y;
+	if (slot.tile_mask == nullptr || slot.tile_mask->get_size() < tile_mask_size) {
+		slot.tile_mask = libwarp_state->ctx->create_buffer(*slot.queue, tile_mask_size);
+		if (slot.tile_mask == nullptr) {
+			return LIBWARP_TILE_MASK_FAILURE;
 		}
 	}
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_set_in_flight_count(const uint32_t count) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	if (count == 0 || count > LIBWARP_MAX_IN_FLIGHT) {
+		return LIBWARP_INVALID_IN_FLIGHT_COUNT;
+	}
+	
+	libwarp_finish_slots();
+	const auto prev_count = uint32_t(libwarp_state->slots.size());
+	libwarp_state->slots.resize(count);
+	for (uint32_t i = prev_count; i < count; ++i) {
+		libwarp_state->slots[i].queue = libwarp_state->ctx->create_queue(*libwarp_state->dev);
+		if (libwarp_state->slots[i].queue == nullptr) {
+			libwarp_state->slots.resize(prev_count);
+			return LIBWARP_NO_QUEUE;
+		}
+	}
+	libwarp_state->cur_slot = 0;
+	// all work has completed, but the slot may no longer exist
+	libwarp_state->history.slot = 0;
+	libwarp_state->compose.scratch_slot = 0;
+	libwarp_state->flow.slot = 0;
+	for (auto& composed : libwarp_state->compose.cache) {
+		composed.slot = 0;
+	}
+	for (auto& recording : libwarp_state->recordings) {
+		recording->slot = 0;
+	}
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_finish() REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	libwarp_finish_slots();
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_check_camera_setup(const libwarp_camera_setup* const camera_setup) {
+	if(camera_setup == nullptr) {
+		return LIBWARP_INVALID_CAMERA_SETUP;
+	}
+	// just in case ...
+	if(camera_setup->screen_width == 0 || camera_setup->screen_height == 0) {
+		return LIBWARP_INVALID_SCREEN_DIM;
+	}
+	if(camera_setup->input_downscale != 1u && camera_setup->input_downscale != 2u && camera_setup->input_downscale != 4u) {
+		return LIBWARP_INVALID_INPUT_DOWNSCALE;
+	}
+	if(uint32_t(camera_setup->projection) > uint32_t(LIBWARP_PROJECTION_CUBEMAP_FACE) || camera_setup->cube_face >= 6u) {
+		return LIBWARP_INVALID_PROJECTION;
+	}
+	return LIBWARP_SUCCESS;
+}
+
+bool libwarp_is_same_camera_setup(const libwarp_camera_setup& lhs, const libwarp_camera_setup& rhs) {
+	return (lhs.screen_width == rhs.screen_width &&
+			lhs.screen_height == rhs.screen_height &&
+			lhs.field_of_view == rhs.field_of_view &&
+			lhs.near_plane == rhs.near_plane &&
+			lhs.far_plane == rhs.far_plane &&
+			lhs.depth_type == rhs.depth_type &&
+			lhs.is_screen_origin_top_left == rhs.is_screen_origin_top_left &&
+			lhs.input_downscale == rhs.input_downscale &&
+			lhs.splat_mode == rhs.splat_mode &&
+			lhs.projection == rhs.projection &&
+			lhs.frustum_shift_x == rhs.frustum_shift_x &&
+			lhs.frustum_shift_y == rhs.frustum_shift_y &&
+			lhs.ortho_height == rhs.ortho_height &&
+			lhs.cube_face == rhs.cube_face);
+}
+
+pair<LIBWARP_ERROR_CODE, shared_ptr<libwarp_state_struct::camera_setup_program>>
+libwarp_compile_program(compute_context& ctx, const uint2& tile_size, const libwarp_camera_setup* const camera_setup) {
+	if(const auto err = libwarp_check_camera_setup(camera_setup); err != LIBWARP_SUCCESS) {
+		return { err, {} };
+	}
 	
-	// build it
 	auto program = make_shared<libwarp_state_struct::camera_setup_program>();
 #if !defined(__WINDOWS__)
 	const string kernel_file_name = "/opt/libwarp/include/libwarp/warp_kernels.hpp";
@@ -142,25 +400,34 @@ libwarp_build(const libwarp_camera_setup* const camera_setup) {
 	}
 #endif
 
-	program->program = libwarp_state->ctx->add_program_file(kernel_file_name,
-															// camera setup
-															" -DLIBWARP_SCREEN_WIDTH=" + to_string(camera_setup->screen_width) +
-															" -DLIBWARP_SCREEN_HEIGHT=" + to_string(camera_setup->screen_height) +
-															" -DLIBWARP_SCREEN_FOV=" + to_string(camera_setup->field_of_view) + "f" +
-															" -DLIBWARP_NEAR_PLANE=" + to_string(camera_setup->near_plane) + "f" +
-															" -DLIBWARP_FAR_PLANE=" + to_string(camera_setup->far_plane) + "f" +
-															" -DTILE_SIZE_X=" + to_string(libwarp_state->tile_size.x) +
-															" -DTILE_SIZE_Y=" + to_string(libwarp_state->tile_size.y) +
-															" -DDEFAULT_DEPTH_TYPE=" +
-															(camera_setup->depth_type == LIBWARP_DEPTH_NORMALIZED ?
-															 "depth_type::normalized" :
-															 (camera_setup->depth_type == LIBWARP_DEPTH_Z_DIV_W ?
-															  "depth_type::z_div_w" : "depth_type::linear")) +
-															" -DNATIVE_DEPTH_IMAGE=" +
-															(camera_setup->depth_type == LIBWARP_DEPTH_Z_DIV_W ? "0" : "1") +
-															(camera_setup->is_screen_origin_top_left ?
-															 " -DSCREEN_ORIGIN_LEFT_TOP=1" : " -DSCREEN_ORIGIN_LEFT_BOTTOM=1"));
-	if(program == nullptr) return { LIBWARP_COMPILATION_FAILURE, {} };
+	program->program = ctx.add_program_file(kernel_file_name,
+											// camera setup
+											" -DLIBWARP_SCREEN_WIDTH=" + to_string(camera_setup->screen_width) +
+											" -DLIBWARP_SCREEN_HEIGHT=" + to_string(camera_setup->screen_height) +
+											" -DLIBWARP_SCREEN_FOV=" + to_string(camera_setup->field_of_view) + "f" +
+											" -DLIBWARP_NEAR_PLANE=" + to_string(camera_setup->near_plane) + "f" +
+											" -DLIBWARP_FAR_PLANE=" + to_string(camera_setup->far_plane) + "f" +
+											" -DLIBWARP_INPUT_DOWNSCALE=" + to_string(camera_setup->input_downscale) + "u" +
+											" -DLIBWARP_SPLAT_MODE=" + to_string(uint32_t(camera_setup->splat_mode)) +
+											" -DLIBWARP_PROJECTION=" + to_string(uint32_t(camera_setup->projection)) +
+											" -DLIBWARP_FRUSTUM_SHIFT_X=" + to_string(camera_setup->frustum_shift_x) + "f" +
+											" -DLIBWARP_FRUSTUM_SHIFT_Y=" + to_string(camera_setup->frustum_shift_y) + "f" +
+											" -DLIBWARP_ORTHO_HEIGHT=" + to_string(camera_setup->ortho_height) + "f" +
+											" -DLIBWARP_CUBE_FACE=" + to_string(camera_setup->cube_face) +
+											" -DLIBWARP_FLOW_BLOCK_SIZE=" + to_string(libwarp_flow_block_size) + "u" +
+											" -DLIBWARP_DEPTH_PYRAMID_LEVELS=" + to_string(libwarp_depth_pyramid_levels) + "u" +
+											" -DTILE_SIZE_X=" + to_string(tile_size.x) +
+											" -DTILE_SIZE_Y=" + to_string(tile_size.y) +
+											" -DDEFAULT_DEPTH_TYPE=" +
+											(camera_setup->depth_type == LIBWARP_DEPTH_NORMALIZED ?
+											 "depth_type::normalized" :
+											 (camera_setup->depth_type == LIBWARP_DEPTH_Z_DIV_W ?
+											  "depth_type::z_div_w" : "depth_type::linear")) +
+											" -DNATIVE_DEPTH_IMAGE=" +
+											(camera_setup->depth_type == LIBWARP_DEPTH_Z_DIV_W ? "0" : "1") +
+											(camera_setup->is_screen_origin_top_left ?
+											 " -DSCREEN_ORIGIN_LEFT_TOP=1" : " -DSCREEN_ORIGIN_LEFT_BOTTOM=1"));
+	if(program->program == nullptr) return { LIBWARP_COMPILATION_FAILURE, {} };
 	
 	// retrieve kernels
 	// NOTE: corresponds to WARP_KERNEL
@@ -171,6 +438,42 @@ libwarp_build(const libwarp_camera_setup* const camera_setup) {
 		"libwarp_single_px_fixup",
 		"libwarp_warp_gather_forward",
 		"libwarp_warp_gather",
+		"libwarp_warp_gather_forward_depth",
+		"libwarp_warp_scatter_depth_accel",
+		"libwarp_warp_scatter_color_accel",
+		"libwarp_warp_gather_forward_accel",
+		"libwarp_warp_scatter_depth_unified",
+		"libwarp_warp_scatter_color_unified",
+		"libwarp_warp_gather_forward_unified",
+		"libwarp_warp_gather_unified",
+		"libwarp_warp_scatter_depth_layer2",
+		"libwarp_warp_scatter_color_layer2",
+		"libwarp_scatter_history_resolve",
+		"libwarp_scatter_history_resolve_confidence",
+		"libwarp_scatter_history_resolve_unified",
+		"libwarp_scatter_history_resolve_unified_confidence",
+		"libwarp_warp_gather_forward_motion_blur",
+		"libwarp_warp_gather_motion_blur",
+		"libwarp_compose_motion",
+		"libwarp_warp_scatter_depth_band",
+		"libwarp_warp_scatter_color_band",
+		"libwarp_flow_luma",
+		"libwarp_flow_downsample",
+		"libwarp_flow_search",
+		"libwarp_flow_output",
+		"libwarp_flow_output_depth",
+		"libwarp_warp_gather_forward_block_motion",
+		"libwarp_warp_gather_block_motion",
+		"libwarp_block_motion_resolve",
+		"libwarp_scatter_confidence",
+		"libwarp_warp_gather_forward_confidence",
+		"libwarp_warp_gather_confidence",
+		"libwarp_merge_tiles",
+		"libwarp_auto_tile_stats",
+		"libwarp_warp_gather_auto",
+		"libwarp_depth_pyramid_base",
+		"libwarp_depth_pyramid_downsample",
+		"libwarp_warp_gather_depth_pyramid",
 		"libwarp_debug_depth_output",
 		"libwarp_debug_motion_2d_output",
 		"libwarp_debug_motion_3d_output",
@@ -182,58 +485,595 @@ libwarp_build(const libwarp_camera_setup* const camera_setup) {
 			return { LIBWARP_NO_KERNEL, {} };
 		}
 	}
-	libwarp_state->programs.emplace_back(*camera_setup, program);
 	
 	// success
 	return { LIBWARP_SUCCESS, program };
 }
 
+pair<LIBWARP_ERROR_CODE, shared_ptr<libwarp_state_struct::camera_setup_program>>
+libwarp_build(const libwarp_camera_setup* const camera_setup) {
+	if(const auto err = libwarp_check_camera_setup(camera_setup); err != LIBWARP_SUCCESS) {
+		return { err, {} };
+	}
+	
+	// check if prog already exists for this setup
+	for(const auto& prog : libwarp_state->programs) {
+		if(libwarp_is_same_camera_setup(prog.first, *camera_setup)) {
+			// does already exist, return it
+			return { LIBWARP_SUCCESS, prog.second };
+		}
+	}
+	
+	// build it (or take it from an async prebuild, if it is part of one)
+	auto prog = libwarp_take_prebuilt_program(camera_setup);
+	if(!prog) {
+		prog = libwarp_compile_program(*libwarp_state->ctx, libwarp_state->tile_size, camera_setup);
+	}
+	if(prog->first != LIBWARP_SUCCESS) {
+		return *prog;
+	}
+	libwarp_state->programs.emplace_back(*camera_setup, prog->second);
+	return *prog;
+}
+
 LIBWARP_ERROR_CODE libwarp_prebuild(const libwarp_camera_setup* const camera_setup) REQUIRES(!libwarp_lock) {
 	LIBWARP_INIT_AND_LOCK
 	return libwarp_build(camera_setup).first;
 }
 
-LIBWARP_ERROR_CODE libwarp_scatter_floor(const libwarp_camera_setup* const camera_setup,
-										 const float delta,
-										 const bool clear_frame,
-										 shared_ptr<compute_image> color_texture,
-										 shared_ptr<compute_image> depth_texture,
-										 shared_ptr<compute_image> motion_texture,
-										 shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
-	LIBWARP_INIT_AND_LOCK
-	
-	libwarp_state->scatter.color = color_texture;
-	libwarp_state->scatter.depth = depth_texture;
-	libwarp_state->scatter.motion = motion_texture;
-	libwarp_state->scatter.output = output_texture;
-	
-	//
-	const auto depth_buffer_size = sizeof(float) * camera_setup->screen_width * camera_setup->screen_height;
-	if(libwarp_state->scatter.depth_buffer == nullptr ||
-	   libwarp_state->scatter.depth_buffer->get_size() < depth_buffer_size) {
-		libwarp_state->scatter.depth_buffer = libwarp_state->ctx->create_buffer(*libwarp_state->dev_queue, depth_buffer_size);
-		if(libwarp_state->scatter.depth_buffer == nullptr) {
-			return LIBWARP_DEPTH_BUFFER_FAILURE;
+LIBWARP_ERROR_CODE libwarp_exec_scatter(const libwarp_camera_setup* const camera_setup,
+										const float delta,
+										const bool clear_frame,
+										const atomic<bool>* cancelled) {
+	auto& slot = libwarp_acquire_slot();
+	slot.retain({
+		libwarp_state->scatter.color, libwarp_state->scatter.depth, libwarp_state->scatter.motion, libwarp_state->scatter.output,
+		libwarp_state->scatter.motion_prev, libwarp_state->confidence.image,
+		libwarp_state->scatter.color_layer2, libwarp_state->scatter.depth_layer2, libwarp_state->scatter.motion_layer2
+	});
+	if (const auto depth_buffer_err = libwarp_alloc_depth_buffer(slot, camera_setup); depth_buffer_err != LIBWARP_SUCCESS) {
+		return depth_buffer_err;
+	}
+	const bool with_layer2 = (libwarp_state->scatter.color_layer2 != nullptr);
+	if (with_layer2) {
+		if (const auto depth_buffer_err = libwarp_alloc_depth_buffer_layer2(slot, camera_setup); depth_buffer_err != LIBWARP_SUCCESS) {
+			return depth_buffer_err;
+		}
+	}
+	const bool with_confidence = (libwarp_state->confidence.image != nullptr);
+	if (with_confidence) {
+		if (const auto tile_mask_err = libwarp_alloc_tile_mask(slot, camera_setup); tile_mask_err != LIBWARP_SUCCESS) {
+			return tile_mask_err;
+		}
+	}
+	const bool with_history = libwarp_state->history.enabled;
+	if (with_history) {
+		if (const auto history_err = libwarp_alloc_history(slot, camera_setup); history_err != LIBWARP_SUCCESS) {
+			return history_err;
 		}
 	}
 	
-	// finally: exec kernels
+	// exec kernels, checking for cancellation in between
+	const auto is_cancelled = [&cancelled] {
+		return (cancelled != nullptr && cancelled->load());
+	};
 	auto err = LIBWARP_SUCCESS;
-	if(clear_frame) {
-		err = run_warp_kernel<KERNEL_SCATTER_CLEAR>(camera_setup, delta);
+	// NOTE: with temporal hole filling, every hole is written by the history resolve -> no clear necessary
+	if(clear_frame && !with_history) {
+		err = (is_cancelled() ? LIBWARP_JOB_CANCELLED : run_warp_kernel<KERNEL_SCATTER_CLEAR>(camera_setup, delta));
 	}
-	if(err == LIBWARP_SUCCESS) {
-		err = run_warp_kernel<KERNEL_SCATTER_DEPTH_PASS>(camera_setup, delta);
+	if(libwarp_state->scatter.unified_motion) {
+		if(err == LIBWARP_SUCCESS) {
+			err = (is_cancelled() ? LIBWARP_JOB_CANCELLED : run_warp_kernel<KERNEL_SCATTER_DEPTH_PASS_UNIFIED>(camera_setup, delta));
+		}
+		if(err == LIBWARP_SUCCESS) {
+			err = (is_cancelled() ? LIBWARP_JOB_CANCELLED : run_warp_kernel<KERNEL_SCATTER_COLOR_DEPTH_TEST_UNIFIED>(camera_setup, delta));
+		}
+	} else if(libwarp_state->scatter.motion_prev != nullptr) {
+		// second-order extrapolation
+		if(err == LIBWARP_SUCCESS) {
+			err = (is_cancelled() ? LIBWARP_JOB_CANCELLED : run_warp_kernel<KERNEL_SCATTER_DEPTH_PASS_ACCEL>(camera_setup, delta));
+		}
+		if(err == LIBWARP_SUCCESS) {
+			err = (is_cancelled() ? LIBWARP_JOB_CANCELLED : run_warp_kernel<KERNEL_SCATTER_COLOR_DEPTH_TEST_ACCEL>(camera_setup, delta));
+		}
+	} else {
+		if(err == LIBWARP_SUCCESS) {
+			err = (is_cancelled() ? LIBWARP_JOB_CANCELLED : run_warp_kernel<KERNEL_SCATTER_DEPTH_PASS>(camera_setup, delta));
+		}
+		if(err == LIBWARP_SUCCESS) {
+			err = (is_cancelled() ? LIBWARP_JOB_CANCELLED : run_warp_kernel<KERNEL_SCATTER_COLOR_DEPTH_TEST>(camera_setup, delta));
+		}
 	}
-	if(err == LIBWARP_SUCCESS) {
-		err = run_warp_kernel<KERNEL_SCATTER_COLOR_DEPTH_TEST>(camera_setup, delta);
+	if(with_layer2) {
+		// scatter the second layer into the holes of the first layer
+		if(err == LIBWARP_SUCCESS) {
+			err = (is_cancelled() ? LIBWARP_JOB_CANCELLED : run_warp_kernel<KERNEL_SCATTER_DEPTH_PASS_LAYER2>(camera_setup, delta));
+		}
+		if(err == LIBWARP_SUCCESS) {
+			err = (is_cancelled() ? LIBWARP_JOB_CANCELLED : run_warp_kernel<KERNEL_SCATTER_COLOR_DEPTH_TEST_LAYER2>(camera_setup, delta));
+		}
+	}
+	if(with_history) {
+		// single history-aware write instead of the confidence and fixup passes
+		if(err == LIBWARP_SUCCESS && is_cancelled()) {
+			err = LIBWARP_JOB_CANCELLED;
+		}
+		if(err == LIBWARP_SUCCESS) {
+			auto& history = libwarp_state->history;
+			// the history of the previous job must be complete, and nothing may still read the buffers that are written here
+			// NOTE: all jobs before the previous one have already been waited on by the previous one
+			if(history.slot != libwarp_state->cur_slot) {
+				libwarp_finish_slot(libwarp_state->slots[history.slot]);
+			}
+			// time since the previous job (in frames): a different color input is assumed to be the next frame
+			if(history.source == nullptr) {
+				history.step = 0.0f;
+			} else if(history.source == libwarp_state->scatter.color.get()) {
+				history.step = delta - history.delta;
+			} else {
+				history.step = delta + 1.0f - history.delta;
+			}
+			
+			if(libwarp_state->scatter.unified_motion) {
+				err = (with_confidence ?
+					   run_warp_kernel<KERNEL_SCATTER_HISTORY_RESOLVE_UNIFIED_CONFIDENCE>(camera_setup, delta) :
+					   run_warp_kernel<KERNEL_SCATTER_HISTORY_RESOLVE_UNIFIED>(camera_setup, delta));
+			} else {
+				err = (with_confidence ?
+					   run_warp_kernel<KERNEL_SCATTER_HISTORY_RESOLVE_CONFIDENCE>(camera_setup, delta) :
+					   run_warp_kernel<KERNEL_SCATTER_HISTORY_RESOLVE>(camera_setup, delta));
+			}
+			if(err == LIBWARP_SUCCESS) {
+				history.cur = 1u - history.cur;
+				history.slot = libwarp_state->cur_slot;
+				history.source = libwarp_state->scatter.color.get();
+				history.delta = delta;
+			}
+		}
+		return err;
+	}
+	if(err == LIBWARP_SUCCESS && with_confidence) {
+		// NOTE: coverage is determined via the depth buffers, so this is independent of the fixup and 'clear_frame'
+		err = (is_cancelled() ? LIBWARP_JOB_CANCELLED : run_warp_kernel<KERNEL_SCATTER_CONFIDENCE>(camera_setup, delta));
 	}
 	if(err == LIBWARP_SUCCESS) {
-		err = run_warp_kernel<KERNEL_SCATTER_FIXUP>(camera_setup, delta);
+		err = (is_cancelled() ? LIBWARP_JOB_CANCELLED : run_warp_kernel<KERNEL_SCATTER_FIXUP>(camera_setup, delta));
+	}
+	return err;
+}
+
+// (re)builds the depth pyramids of both bidirectional gather frames in the specified slot if necessary: the pyramid of a frame
+// is built once per slot when it becomes the current frame, it is then reused for all warps of this frame on that slot and as
+// the pyramid of the previous frame
+// NOTE: slot pyramids are only ever accessed by work on the slot queue, so rebuilding them never races with other slots
+static LIBWARP_ERROR_CODE libwarp_update_depth_pyramids(libwarp_state_struct::in_flight_slot& slot,
+														const libwarp_camera_setup* const camera_setup,
+														const uint32_t img_set) {
+	auto& depth_pyramid = libwarp_state->depth_pyramid;
+	const uint2 dim { camera_setup->screen_width, camera_setup->screen_height };
+	// pyramids depend on the screen dim and depth linearization of the camera setup -> all must be rebuilt if it changes
+	if (!libwarp_is_same_camera_setup(depth_pyramid.camera_setup, *camera_setup)) {
+		depth_pyramid.camera_setup = *camera_setup;
+		depth_pyramid.set_frame[0] = depth_pyramid.set_frame[1] = ++depth_pyramid.frame;
+	}
+	// a different image set means a new frame (the previous frame keeps its pyramids)
+	if (depth_pyramid.last_img_set != img_set) {
+		depth_pyramid.set_frame[img_set] = ++depth_pyramid.frame;
+		depth_pyramid.last_img_set = img_set;
+	}
+	
+	size_t texel_count = 0;
+	for (uint32_t level = 1; level <= libwarp_depth_pyramid_levels; ++level) {
+		const auto level_dim = libwarp_depth_pyramid_level_dim(dim, level);
+		texel_count += size_t(level_dim.x) * size_t(level_dim.y);
+	}
+	const auto pyramid_size = sizeof(float2) * texel_count;
+	
+	auto err = LIBWARP_SUCCESS;
+	for (const auto set : { img_set, 1u - img_set }) {
+		if (slot.depth_pyramid_built_from[set] != nullptr &&
+			slot.depth_pyramid_built_from[set] == libwarp_state->gather.depth[set] &&
+			slot.depth_pyramid_built_frame[set] == depth_pyramid.set_frame[set]) {
+			continue;
+		}
+		if (slot.depth_pyramid[set] == nullptr || slot.depth_pyramid[set]->get_size() < pyramid_size) {
+			slot.depth_pyramid[set] = libwarp_state->ctx->create_buffer(*slot.queue, pyramid_size);
+			if (slot.depth_pyramid[set] == nullptr) {
+				err = LIBWARP_DEPTH_PYRAMID_FAILURE;
+				break;
+			}
+		}
+		// NOTE: built_from is reset first, so that a failed build is never considered valid
+		slot.depth_pyramid_built_from[set] = nullptr;
+		depth_pyramid.img_set = set;
+		libwarp_state->work_dim_override = libwarp_depth_pyramid_level_dim(dim, 1u);
+		err = run_warp_kernel<KERNEL_DEPTH_PYRAMID_BASE>(camera_setup, 0.0f);
+		for (depth_pyramid.level = 2; depth_pyramid.level <= libwarp_depth_pyramid_levels && err == LIBWARP_SUCCESS; ++depth_pyramid.level) {
+			libwarp_state->work_dim_override = libwarp_depth_pyramid_level_dim(dim, depth_pyramid.level);
+			err = run_warp_kernel<KERNEL_DEPTH_PYRAMID_DOWNSAMPLE>(camera_setup, 0.0f);
+		}
+		if (err != LIBWARP_SUCCESS) {
+			break;
+		}
+		slot.depth_pyramid_built_from[set] = libwarp_state->gather.depth[set];
+		slot.depth_pyramid_built_frame[set] = depth_pyramid.set_frame[set];
 	}
+	libwarp_state->work_dim_override = {};
 	return err;
 }
 
+LIBWARP_ERROR_CODE libwarp_set_gather_depth_pyramid(const bool enable) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	// pyramids may still be in use
+	libwarp_finish_slots();
+	auto& depth_pyramid = libwarp_state->depth_pyramid;
+	depth_pyramid.enabled = enable;
+	// all pyramids must be rebuilt
+	depth_pyramid.set_frame[0] = depth_pyramid.set_frame[1] = ++depth_pyramid.frame;
+	depth_pyramid.last_img_set = ~0u;
+	for (auto& slot : libwarp_state->slots) {
+		slot.depth_pyramid_built_from[0] = slot.depth_pyramid_built_from[1] = nullptr;
+		if (!enable) {
+			slot.depth_pyramid[0] = slot.depth_pyramid[1] = nullptr;
+		}
+	}
+	return LIBWARP_SUCCESS;
+}
+
+bool libwarp_has_enabled_features() {
+	return (libwarp_state->confidence.image != nullptr ||
+			libwarp_state->block_motion.block_size > 0u ||
+			libwarp_state->history.enabled ||
+			libwarp_state->depth_pyramid.enabled);
+}
+
+LIBWARP_ERROR_CODE libwarp_exec_gather(const libwarp_camera_setup* const camera_setup,
+									   const float delta,
+									   const uint32_t img_set,
+									   const atomic<bool>* cancelled) {
+	// there is no kernel variant that combines any of these
+	const uint32_t feature_count = ((libwarp_state->gather.unified_motion ? 1u : 0u) +
+									(libwarp_state->block_motion.block_size > 0u ? 1u : 0u) +
+									(libwarp_state->confidence.image != nullptr ? 1u : 0u) +
+									(libwarp_state->depth_pyramid.enabled ? 1u : 0u));
+	if (feature_count > 1u) {
+		return LIBWARP_UNSUPPORTED_COMBINATION;
+	}
+	
+	auto& slot = libwarp_acquire_slot();
+	slot.retain({
+		libwarp_state->gather.color[0], libwarp_state->gather.color[1],
+		libwarp_state->gather.depth[0], libwarp_state->gather.depth[1],
+		libwarp_state->gather.motion[img_set * 2], libwarp_state->gather.motion[img_set * 2 + 1],
+		libwarp_state->gather.motion[(1u - img_set) * 2],
+		libwarp_state->gather.motion_depth[0], libwarp_state->gather.motion_depth[1],
+		libwarp_state->gather.output, libwarp_state->confidence.image
+	});
+	if (cancelled != nullptr && cancelled->load()) {
+		return LIBWARP_JOB_CANCELLED;
+	}
+	if (libwarp_state->gather.unified_motion) {
+		return run_warp_kernel<KERNEL_GATHER_BIDIRECTIONAL_UNIFIED>(camera_setup, delta, img_set);
+	}
+	if (libwarp_state->block_motion.block_size > 0u) {
+		if (const auto block_motion_err = libwarp_alloc_block_motion(slot, camera_setup); block_motion_err != LIBWARP_SUCCESS) {
+			return block_motion_err;
+		}
+		if (const auto err = run_warp_kernel<KERNEL_GATHER_BIDIRECTIONAL_BLOCK_MOTION>(camera_setup, delta, img_set); err != LIBWARP_SUCCESS) {
+			return err;
+		}
+		libwarp_state->block_motion.source = libwarp_state->gather.color[img_set];
+		libwarp_state->block_motion.output = libwarp_state->gather.output;
+		return libwarp_exec_block_motion_resolve(camera_setup);
+	}
+	if (libwarp_state->confidence.image != nullptr) {
+		if (const auto tile_mask_err = libwarp_alloc_tile_mask(slot, camera_setup); tile_mask_err != LIBWARP_SUCCESS) {
+			return tile_mask_err;
+		}
+		return run_warp_kernel<KERNEL_GATHER_BIDIRECTIONAL_CONFIDENCE>(camera_setup, delta, img_set);
+	}
+	if (libwarp_state->depth_pyramid.enabled) {
+		if (const auto pyramid_err = libwarp_update_depth_pyramids(slot, camera_setup, img_set); pyramid_err != LIBWARP_SUCCESS) {
+			return pyramid_err;
+		}
+		return run_warp_kernel<KERNEL_GATHER_BIDIRECTIONAL_DEPTH_PYRAMID>(camera_setup, delta, img_set);
+	}
+	return run_warp_kernel<KERNEL_GATHER_BIDIRECTIONAL>(camera_setup, delta, img_set);
+}
+
+LIBWARP_ERROR_CODE libwarp_exec_gather_forward_only(const libwarp_camera_setup* const camera_setup,
+													const float delta,
+													const atomic<bool>* cancelled) {
+	// there is no kernel variant that combines any of these
+	const uint32_t feature_count = ((libwarp_state->gather_forward.unified_motion ? 1u : 0u) +
+									(libwarp_state->gather_forward.motion_prev != nullptr ? 1u : 0u) +
+									(libwarp_state->block_motion.block_size > 0u ? 1u : 0u) +
+									(libwarp_state->confidence.image != nullptr ? 1u : 0u));
+	if (feature_count > 1u) {
+		return LIBWARP_UNSUPPORTED_COMBINATION;
+	}
+	
+	auto& slot = libwarp_acquire_slot();
+	slot.retain({
+		libwarp_state->gather_forward.color, libwarp_state->gather_forward.motion, libwarp_state->gather_forward.output,
+		libwarp_state->gather_forward.motion_prev, libwarp_state->confidence.image
+	});
+	if (cancelled != nullptr && cancelled->load()) {
+		return LIBWARP_JOB_CANCELLED;
+	}
+	if (libwarp_state->gather_forward.unified_motion) {
+		return run_warp_kernel<KERNEL_GATHER_FORWARD_ONLY_UNIFIED>(camera_setup, delta);
+	}
+	if (libwarp_state->gather_forward.motion_prev != nullptr) {
+		// second-order extrapolation
+		return run_warp_kernel<KERNEL_GATHER_FORWARD_ONLY_ACCEL>(camera_setup, delta);
+	}
+	if (libwarp_state->block_motion.block_size > 0u) {
+		if (const auto block_motion_err = libwarp_alloc_block_motion(slot, camera_setup); block_motion_err != LIBWARP_SUCCESS) {
+			return block_motion_err;
+		}
+		if (const auto err = run_warp_kernel<KERNEL_GATHER_FORWARD_ONLY_BLOCK_MOTION>(camera_setup, delta); err != LIBWARP_SUCCESS) {
+			return err;
+		}
+		libwarp_state->block_motion.source = libwarp_state->gather_forward.color;
+		libwarp_state->block_motion.output = libwarp_state->gather_forward.output;
+		return libwarp_exec_block_motion_resolve(camera_setup);
+	}
+	if (libwarp_state->confidence.image != nullptr) {
+		if (const auto tile_mask_err = libwarp_alloc_tile_mask(slot, camera_setup); tile_mask_err != LIBWARP_SUCCESS) {
+			return tile_mask_err;
+		}
+		return run_warp_kernel<KERNEL_GATHER_FORWARD_ONLY_CONFIDENCE>(camera_setup, delta);
+	}
+	return run_warp_kernel<KERNEL_GATHER_FORWARD_ONLY>(camera_setup, delta);
+}
+
+LIBWARP_ERROR_CODE libwarp_exec_gather_forward_only_depth(const libwarp_camera_setup* const camera_setup,
+														  const float delta) {
+	// there is no depth-aware forward-only kernel variant for any of the optional features
+	if (libwarp_has_enabled_features()) {
+		return LIBWARP_UNSUPPORTED_COMBINATION;
+	}
+	
+	libwarp_acquire_slot().retain({
+		libwarp_state->gather_forward.color, libwarp_state->gather_forward.depth,
+		libwarp_state->gather_forward.motion, libwarp_state->gather_forward.output
+	});
+	return run_warp_kernel<KERNEL_GATHER_FORWARD_ONLY_DEPTH>(camera_setup, delta);
+}
+
+LIBWARP_ERROR_CODE libwarp_exec_gather_motion_blur(const libwarp_camera_setup* const camera_setup,
+												   const float delta,
+												   const float shutter,
+												   const uint32_t sample_count,
+												   const uint32_t img_set) {
+	if (sample_count == 0 || sample_count > LIBWARP_MAX_MOTION_BLUR_SAMPLES) {
+		return LIBWARP_INVALID_MOTION_BLUR_SAMPLES;
+	}
+	// there is no motion blur kernel variant for any of the optional features
+	if (libwarp_has_enabled_features()) {
+		return LIBWARP_UNSUPPORTED_COMBINATION;
+	}
+	libwarp_acquire_slot().retain({
+		libwarp_state->gather.color[0], libwarp_state->gather.color[1],
+		libwarp_state->gather.depth[0], libwarp_state->gather.depth[1],
+		libwarp_state->gather.motion[img_set * 2], libwarp_state->gather.motion[img_set * 2 + 1],
+		libwarp_state->gather.motion_depth[0], libwarp_state->gather.motion_depth[1],
+		libwarp_state->gather.output
+	});
+	libwarp_state->motion_blur.shutter = shutter;
+	libwarp_state->motion_blur.sample_count = sample_count;
+	return run_warp_kernel<KERNEL_GATHER_BIDIRECTIONAL_MOTION_BLUR>(camera_setup, delta, img_set);
+}
+
+LIBWARP_ERROR_CODE libwarp_exec_gather_forward_only_motion_blur(const libwarp_camera_setup* const camera_setup,
+																const float delta,
+																const float shutter,
+																const uint32_t sample_count) {
+	if (sample_count == 0 || sample_count > LIBWARP_MAX_MOTION_BLUR_SAMPLES) {
+		return LIBWARP_INVALID_MOTION_BLUR_SAMPLES;
+	}
+	// there is no motion blur kernel variant for any of the optional features
+	if (libwarp_has_enabled_features()) {
+		return LIBWARP_UNSUPPORTED_COMBINATION;
+	}
+	libwarp_acquire_slot().retain({
+		libwarp_state->gather_forward.color, libwarp_state->gather_forward.motion, libwarp_state->gather_forward.output
+	});
+	libwarp_state->motion_blur.shutter = shutter;
+	libwarp_state->motion_blur.sample_count = sample_count;
+	return run_warp_kernel<KERNEL_GATHER_FORWARD_ONLY_MOTION_BLUR>(camera_setup, delta);
+}
+
+void libwarp_bind_scatter_floor(const shared_ptr<compute_image>& color_texture,
+								const shared_ptr<compute_image>& depth_texture,
+								const shared_ptr<compute_image>& motion_texture,
+								const shared_ptr<compute_image>& output_texture) {
+	libwarp_bind_image(libwarp_state->scatter.color, color_texture);
+	libwarp_bind_image(libwarp_state->scatter.depth, depth_texture);
+	libwarp_bind_image(libwarp_state->scatter.motion, motion_texture);
+	libwarp_bind_image(libwarp_state->scatter.output, output_texture);
+	libwarp_state->scatter.motion_prev = nullptr;
+	libwarp_state->scatter.unified_motion = false;
+	libwarp_state->scatter.color_layer2 = nullptr;
+	libwarp_state->scatter.depth_layer2 = nullptr;
+	libwarp_state->scatter.motion_layer2 = nullptr;
+}
+
+void libwarp_bind_scatter_two_layer_floor(const shared_ptr<compute_image>& color_texture,
+										  const shared_ptr<compute_image>& depth_texture,
+										  const shared_ptr<compute_image>& motion_texture,
+										  const shared_ptr<compute_image>& color_layer2_texture,
+										  const shared_ptr<compute_image>& depth_layer2_texture,
+										  const shared_ptr<compute_image>& motion_layer2_texture,
+										  const shared_ptr<compute_image>& output_texture) {
+	libwarp_bind_scatter_floor(color_texture, depth_texture, motion_texture, output_texture);
+	libwarp_bind_image(libwarp_state->scatter.color_layer2, color_layer2_texture);
+	libwarp_bind_image(libwarp_state->scatter.depth_layer2, depth_layer2_texture);
+	libwarp_bind_image(libwarp_state->scatter.motion_layer2, motion_layer2_texture);
+}
+
+void libwarp_bind_scatter_unified_floor(const shared_ptr<compute_image>& color_texture,
+										const shared_ptr<compute_image>& depth_texture,
+										const shared_ptr<compute_image>& motion_texture,
+										const shared_ptr<compute_image>& output_texture) {
+	libwarp_bind_scatter_floor(color_texture, depth_texture, motion_texture, output_texture);
+	libwarp_state->scatter.unified_motion = true;
+}
+
+void libwarp_bind_scatter_accel_floor(const shared_ptr<compute_image>& color_texture,
+									  const shared_ptr<compute_image>& depth_texture,
+									  const shared_ptr<compute_image>& motion_texture,
+									  const shared_ptr<compute_image>& motion_prev_texture,
+									  const shared_ptr<compute_image>& output_texture) {
+	libwarp_bind_scatter_floor(color_texture, depth_texture, motion_texture, output_texture);
+	libwarp_bind_image(libwarp_state->scatter.motion_prev, motion_prev_texture);
+}
+
+uint32_t libwarp_bind_gather_floor(const shared_ptr<compute_image>& color_current_texture,
+								   const shared_ptr<compute_image>& depth_current_texture,
+								   const shared_ptr<compute_image>& color_prev_texture,
+								   const shared_ptr<compute_image>& depth_prev_texture,
+								   const shared_ptr<compute_image>& motion_forward_texture,
+								   const shared_ptr<compute_image>& motion_backward_texture,
+								   const shared_ptr<compute_image>& motion_depth_forward_texture,
+								   const shared_ptr<compute_image>& motion_depth_backward_texture,
+								   const shared_ptr<compute_image>& output_texture) {
+	// gather swaps images every other frame, so determine which set to use
+	uint32_t img_set = 0;
+	if(libwarp_state->gather.color[0] != nullptr &&
+	   libwarp_state->gather.color[0] != color_current_texture) {
+		img_set = 1; // use second set
+	}
+	
+	libwarp_bind_image(libwarp_state->gather.color[img_set], color_current_texture);
+	libwarp_bind_image(libwarp_state->gather.depth[img_set], depth_current_texture);
+	libwarp_bind_image(libwarp_state->gather.color[1u - img_set], color_prev_texture);
+	libwarp_bind_image(libwarp_state->gather.depth[1u - img_set], depth_prev_texture);
+	libwarp_bind_image(libwarp_state->gather.motion_depth[img_set], motion_depth_forward_texture);
+	libwarp_bind_image(libwarp_state->gather.motion_depth[1u - img_set], motion_depth_backward_texture);
+	libwarp_bind_image(libwarp_state->gather.motion[img_set * 2], motion_forward_texture);
+	libwarp_bind_image(libwarp_state->gather.motion[img_set * 2 + 1], motion_backward_texture);
+	libwarp_bind_image(libwarp_state->gather.output, output_texture);
+	libwarp_state->gather.unified_motion = false;
+	return img_set;
+}
+
+uint32_t libwarp_bind_gather_unified_floor(const shared_ptr<compute_image>& color_current_texture,
+										   const shared_ptr<compute_image>& depth_current_texture,
+										   const shared_ptr<compute_image>& color_prev_texture,
+										   const shared_ptr<compute_image>& depth_prev_texture,
+										   const shared_ptr<compute_image>& motion_current_texture,
+										   const shared_ptr<compute_image>& motion_prev_texture,
+										   const shared_ptr<compute_image>& output_texture) {
+	// gather swaps images every other frame, so determine which set to use
+	uint32_t img_set = 0;
+	if(libwarp_state->gather.color[0] != nullptr &&
+	   libwarp_state->gather.color[0] != color_current_texture) {
+		img_set = 1; // use second set
+	}
+	
+	// unified motion belongs to its frame (like color and depth)
+	libwarp_bind_image(libwarp_state->gather.color[img_set], color_current_texture);
+	libwarp_bind_image(libwarp_state->gather.depth[img_set], depth_current_texture);
+	libwarp_bind_image(libwarp_state->gather.motion[img_set * 2], motion_current_texture);
+	libwarp_bind_image(libwarp_state->gather.color[1u - img_set], color_prev_texture);
+	libwarp_bind_image(libwarp_state->gather.depth[1u - img_set], depth_prev_texture);
+	libwarp_bind_image(libwarp_state->gather.motion[(1u - img_set) * 2], motion_prev_texture);
+	libwarp_bind_image(libwarp_state->gather.output, output_texture);
+	libwarp_state->gather.unified_motion = true;
+	return img_set;
+}
+
+void libwarp_bind_gather_forward_only_floor(const shared_ptr<compute_image>& color_texture,
+											const shared_ptr<compute_image>& motion_texture,
+											const shared_ptr<compute_image>& output_texture) {
+	libwarp_bind_image(libwarp_state->gather_forward.color, color_texture);
+	libwarp_bind_image(libwarp_state->gather_forward.motion, motion_texture);
+	libwarp_bind_image(libwarp_state->gather_forward.output, output_texture);
+	libwarp_state->gather_forward.motion_prev = nullptr;
+	libwarp_state->gather_forward.unified_motion = false;
+}
+
+void libwarp_bind_gather_forward_only_unified_floor(const shared_ptr<compute_image>& color_texture,
+													const shared_ptr<compute_image>& motion_texture,
+													const shared_ptr<compute_image>& output_texture) {
+	libwarp_bind_gather_forward_only_floor(color_texture, motion_texture, output_texture);
+	libwarp_state->gather_forward.unified_motion = true;
+}
+
+void libwarp_bind_gather_forward_only_accel_floor(const shared_ptr<compute_image>& color_texture,
+												  const shared_ptr<compute_image>& motion_texture,
+												  const shared_ptr<compute_image>& motion_prev_texture,
+												  const shared_ptr<compute_image>& output_texture) {
+	libwarp_bind_gather_forward_only_floor(color_texture, motion_texture, output_texture);
+	libwarp_bind_image(libwarp_state->gather_forward.motion_prev, motion_prev_texture);
+}
+
+void libwarp_bind_gather_forward_only_depth_floor(const shared_ptr<compute_image>& color_texture,
+												  const shared_ptr<compute_image>& depth_texture,
+												  const shared_ptr<compute_image>& motion_texture,
+												  const shared_ptr<compute_image>& output_texture) {
+	libwarp_bind_gather_forward_only_floor(color_texture, motion_texture, output_texture);
+	libwarp_bind_image(libwarp_state->gather_forward.depth, depth_texture);
+}
+
+LIBWARP_ERROR_CODE libwarp_scatter_floor(const libwarp_camera_setup* const camera_setup,
+										 const float delta,
+										 const bool clear_frame,
+										 shared_ptr<compute_image> color_texture,
+										 shared_ptr<compute_image> depth_texture,
+										 shared_ptr<compute_image> motion_texture,
+										 shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
+	if (camera_setup == nullptr) {
+		return LIBWARP_INVALID_CAMERA_SETUP;
+	}
+	return libwarp::scatter(*camera_setup, delta, clear_frame, { color_texture, depth_texture, motion_texture, output_texture });
+}
+
+LIBWARP_ERROR_CODE libwarp_scatter_accel_floor(const libwarp_camera_setup* const camera_setup,
+											   const float delta,
+											   const bool clear_frame,
+											   shared_ptr<compute_image> color_texture,
+											   shared_ptr<compute_image> depth_texture,
+											   shared_ptr<compute_image> motion_texture,
+											   shared_ptr<compute_image> motion_prev_texture,
+											   shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	libwarp_bind_scatter_accel_floor(color_texture, depth_texture, motion_texture, motion_prev_texture, output_texture);
+	return libwarp_exec_scatter(camera_setup, delta, clear_frame);
+}
+
+LIBWARP_ERROR_CODE libwarp_scatter_unified_floor(const libwarp_camera_setup* const camera_setup,
+												 const float delta,
+												 const bool clear_frame,
+												 shared_ptr<compute_image> color_texture,
+												 shared_ptr<compute_image> depth_texture,
+												 shared_ptr<compute_image> motion_texture,
+												 shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	libwarp_bind_scatter_unified_floor(color_texture, depth_texture, motion_texture, output_texture);
+	return libwarp_exec_scatter(camera_setup, delta, clear_frame);
+}
+
+LIBWARP_ERROR_CODE libwarp_scatter_two_layer_floor(const libwarp_camera_setup* const camera_setup,
+												   const float delta,
+												   const bool clear_frame,
+												   shared_ptr<compute_image> color_texture,
+												   shared_ptr<compute_image> depth_texture,
+												   shared_ptr<compute_image> motion_texture,
+												   shared_ptr<compute_image> color_layer2_texture,
+												   shared_ptr<compute_image> depth_layer2_texture,
+												   shared_ptr<compute_image> motion_layer2_texture,
+												   shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	libwarp_bind_scatter_two_layer_floor(color_texture, depth_texture, motion_texture,
+										 color_layer2_texture, depth_layer2_texture, motion_layer2_texture,
+										 output_texture);
+	return libwarp_exec_scatter(camera_setup, delta, clear_frame);
+}
+
 LIBWARP_ERROR_CODE libwarp_gather_floor(const libwarp_camera_setup* const camera_setup,
 										const float delta,
 										shared_ptr<compute_image> color_current_texture,
@@ -245,27 +1085,33 @@ LIBWARP_ERROR_CODE libwarp_gather_floor(const libwarp_camera_setup* const camera
 										shared_ptr<compute_image> motion_depth_forward_texture,
 										shared_ptr<compute_image> motion_depth_backward_texture,
 										shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
-	LIBWARP_INIT_AND_LOCK
-	
-	// gather swaps images every other frame, so determine which set to use
-	uint32_t img_set = 0;
-	if(libwarp_state->gather.color[0] != nullptr &&
-	   libwarp_state->gather.color[0] != color_current_texture) {
-		img_set = 1; // use second set
+	if (camera_setup == nullptr) {
+		return LIBWARP_INVALID_CAMERA_SETUP;
 	}
-	
-	libwarp_state->gather.color[img_set] = color_current_texture;
-	libwarp_state->gather.depth[img_set] = depth_current_texture;
-	libwarp_state->gather.color[1u - img_set] = color_prev_texture;
-	libwarp_state->gather.depth[1u - img_set] = depth_prev_texture;
-	libwarp_state->gather.motion_depth[img_set] = motion_depth_forward_texture;
-	libwarp_state->gather.motion_depth[1u - img_set] = motion_depth_backward_texture;
-	libwarp_state->gather.motion[img_set * 2] = motion_forward_texture;
-	libwarp_state->gather.motion[img_set * 2 + 1] = motion_backward_texture;
-	libwarp_state->gather.output = output_texture;
-	
-	// exec kernel
-	return run_warp_kernel<KERNEL_GATHER_BIDIRECTIONAL>(camera_setup, delta, img_set);
+	return libwarp::gather(*camera_setup, delta, {
+		color_current_texture, depth_current_texture,
+		color_prev_texture, depth_prev_texture,
+		motion_forward_texture, motion_backward_texture,
+		motion_depth_forward_texture, motion_depth_backward_texture,
+		output_texture
+	});
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_unified_floor(const libwarp_camera_setup* const camera_setup,
+												const float delta,
+												shared_ptr<compute_image> color_current_texture,
+												shared_ptr<compute_image> depth_current_texture,
+												shared_ptr<compute_image> color_prev_texture,
+												shared_ptr<compute_image> depth_prev_texture,
+												shared_ptr<compute_image> motion_current_texture,
+												shared_ptr<compute_image> motion_prev_texture,
+												shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	const auto img_set = libwarp_bind_gather_unified_floor(color_current_texture, depth_current_texture,
+														   color_prev_texture, depth_prev_texture,
+														   motion_current_texture, motion_prev_texture,
+														   output_texture);
+	return libwarp_exec_gather(camera_setup, delta, img_set);
 }
 
 LIBWARP_ERROR_CODE libwarp_gather_forward_only_floor(const libwarp_camera_setup* const camera_setup,
@@ -273,12 +1119,139 @@ LIBWARP_ERROR_CODE libwarp_gather_forward_only_floor(const libwarp_camera_setup*
 													 shared_ptr<compute_image> color_texture,
 													 shared_ptr<compute_image> motion_texture,
 													 shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
+	if (camera_setup == nullptr) {
+		return LIBWARP_INVALID_CAMERA_SETUP;
+	}
+	return libwarp::gather_forward_only(*camera_setup, delta, { color_texture, motion_texture, output_texture });
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_forward_only_accel_floor(const libwarp_camera_setup* const camera_setup,
+														   const float delta,
+														   shared_ptr<compute_image> color_texture,
+														   shared_ptr<compute_image> motion_texture,
+														   shared_ptr<compute_image> motion_prev_texture,
+														   shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	libwarp_bind_gather_forward_only_accel_floor(color_texture, motion_texture, motion_prev_texture, output_texture);
+	return libwarp_exec_gather_forward_only(camera_setup, delta);
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_forward_only_unified_floor(const libwarp_camera_setup* const camera_setup,
+															 const float delta,
+															 shared_ptr<compute_image> color_texture,
+															 shared_ptr<compute_image> motion_texture,
+															 shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	libwarp_bind_gather_forward_only_unified_floor(color_texture, motion_texture, output_texture);
+	return libwarp_exec_gather_forward_only(camera_setup, delta);
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_forward_only_depth_floor(const libwarp_camera_setup* const camera_setup,
+														   const float delta,
+														   shared_ptr<compute_image> color_texture,
+														   shared_ptr<compute_image> depth_texture,
+														   shared_ptr<compute_image> motion_texture,
+														   shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	libwarp_bind_gather_forward_only_depth_floor(color_texture, depth_texture, motion_texture, output_texture);
+	return libwarp_exec_gather_forward_only_depth(camera_setup, delta);
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_motion_blur_floor(const libwarp_camera_setup* const camera_setup,
+													const float delta,
+													const float shutter,
+													const uint32_t sample_count,
+													shared_ptr<compute_image> color_current_texture,
+													shared_ptr<compute_image> depth_current_texture,
+													shared_ptr<compute_image> color_prev_texture,
+													shared_ptr<compute_image> depth_prev_texture,
+													shared_ptr<compute_image> motion_forward_texture,
+													shared_ptr<compute_image> motion_backward_texture,
+													shared_ptr<compute_image> motion_depth_forward_texture,
+													shared_ptr<compute_image> motion_depth_backward_texture,
+													shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	const auto img_set = libwarp_bind_gather_floor(color_current_texture, depth_current_texture,
+												   color_prev_texture, depth_prev_texture,
+												   motion_forward_texture, motion_backward_texture,
+												   motion_depth_forward_texture, motion_depth_backward_texture,
+												   output_texture);
+	return libwarp_exec_gather_motion_blur(camera_setup, delta, shutter, sample_count, img_set);
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_forward_only_motion_blur_floor(const libwarp_camera_setup* const camera_setup,
+																 const float delta,
+																 const float shutter,
+																 const uint32_t sample_count,
+																 shared_ptr<compute_image> color_texture,
+																 shared_ptr<compute_image> motion_texture,
+																 shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	libwarp_bind_gather_forward_only_floor(color_texture, motion_texture, output_texture);
+	return libwarp_exec_gather_forward_only_motion_blur(camera_setup, delta, shutter, sample_count);
+}
+
+LIBWARP_ERROR_CODE libwarp_set_confidence_output_floor(shared_ptr<compute_image> confidence_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	libwarp_state->confidence.image = confidence_texture;
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_get_low_confidence_tiles(const libwarp_camera_setup* const camera_setup,
+													uint32_t* tile_mask,
+													const uint32_t tile_mask_count,
+													libwarp_tile_info* tile_info) REQUIRES(!libwarp_lock) {
 	LIBWARP_INIT_AND_LOCK
 	
-	libwarp_state->gather_forward.color = color_texture;
-	libwarp_state->gather_forward.motion = motion_texture;
-	libwarp_state->gather_forward.output = output_texture;
+	const auto tile_count = libwarp_tile_count(camera_setup);
+	if (tile_info != nullptr) {
+		*tile_info = {
+			.tile_width = libwarp_state->tile_size.x,
+			.tile_height = libwarp_state->tile_size.y,
+			.tile_count_x = tile_count.x,
+			.tile_count_y = tile_count.y,
+		};
+	}
+	if (tile_mask == nullptr) {
+		return LIBWARP_SUCCESS; // only queried the tile info
+	}
+	
+	auto& slot = libwarp_state->slots[libwarp_state->confidence_slot];
+	if (slot.tile_mask == nullptr || tile_mask_count < tile_count.x * tile_count.y) {
+		return LIBWARP_TILE_MASK_FAILURE;
+	}
+	// wait until the job that wrote the tile mask has completed
+	if (slot.busy) {
+		slot.queue->finish();
+		slot.busy = false;
+	}
+	slot.tile_mask->read(*slot.queue, tile_mask, sizeof(uint32_t) * tile_count.x * tile_count.y);
+	return LIBWARP_SUCCESS;
+}
 
-	// exec kernel
-	return run_warp_kernel<KERNEL_GATHER_FORWARD_ONLY>(camera_setup, delta);
+LIBWARP_ERROR_CODE libwarp_exec_merge(const libwarp_camera_setup* const camera_setup) {
+	auto& confidence_slot = libwarp_state->slots[libwarp_state->confidence_slot];
+	if (confidence_slot.tile_mask == nullptr) {
+		return LIBWARP_TILE_MASK_FAILURE;
+	}
+	if (confidence_slot.busy) {
+		confidence_slot.queue->finish();
+		confidence_slot.busy = false;
+	}
+	// always executes on the slot of the confidence job (keeps the tile mask in place)
+	const auto prev_slot = libwarp_state->cur_slot;
+	libwarp_state->cur_slot = libwarp_state->confidence_slot;
+	confidence_slot.retain({ libwarp_state->merge.rerendered, libwarp_state->merge.output });
+	const auto err = run_warp_kernel<KERNEL_MERGE_TILES>(camera_setup, 0.0f);
+	libwarp_state->cur_slot = prev_slot;
+	return err;
+}
+
+LIBWARP_ERROR_CODE libwarp_merge_floor(const libwarp_camera_setup* const camera_setup,
+									   shared_ptr<compute_image> rerendered_texture,
+									   shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	libwarp_state->merge.rerendered = rerendered_texture;
+	libwarp_state->merge.output = output_texture;
+	return libwarp_exec_merge(camera_setup);
 }
@@ -37,6 +37,40 @@ floor_inline_always static bool libwarp_wrap_metal_texture(shared_ptr<compute_im
 	return (img != nullptr);
 }
 
+// wraps all bidirectional gather textures into the gather image set, 'img_set' is set to the current image set
+static bool libwarp_wrap_metal_gather_textures(id <MTLTexture> color_current_texture,
+											   id <MTLTexture> depth_current_texture,
+											   id <MTLTexture> color_prev_texture,
+											   id <MTLTexture> depth_prev_texture,
+											   id <MTLTexture> motion_forward_texture,
+											   id <MTLTexture> motion_backward_texture,
+											   id <MTLTexture> motion_depth_forward_texture,
+											   id <MTLTexture> motion_depth_backward_texture,
+											   id <MTLTexture> output_texture,
+											   uint32_t& img_set) {
+	// gather swaps images every other frame, so determine which set to use
+	img_set = 0;
+	if(libwarp_state->gather.color[0] != nullptr &&
+	   ((metal_image*)libwarp_state->gather.color[0].get())->get_metal_image() != color_current_texture) {
+		img_set = 1; // use second set
+	}
+	
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather.color[img_set], color_current_texture)) return false;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather.depth[img_set], depth_current_texture)) return false;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather.color[1u - img_set], color_prev_texture)) return false;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather.depth[1u - img_set], depth_prev_texture)) return false;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather.motion_depth[img_set], motion_depth_forward_texture)) return false;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather.motion_depth[1u - img_set], motion_depth_backward_texture)) return false;
+	
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather.motion[img_set * 2], motion_forward_texture)) return false;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather.motion[img_set * 2 + 1], motion_backward_texture)) return false;
+	
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather.output, output_texture, true)) return false;
+	libwarp_state->gather.unified_motion = false;
+	
+	return true;
+}
+
 LIBWARP_ERROR_CODE libwarp_scatter_metal(const libwarp_camera_setup* const camera_setup,
 										 const float delta,
 										 const bool clear_frame,
@@ -51,32 +85,90 @@ LIBWARP_ERROR_CODE libwarp_scatter_metal(const libwarp_camera_setup* const camer
 	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.depth, depth_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
 	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.motion, motion_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
 	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.output, output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	libwarp_state->scatter.motion_prev = nullptr;
+	libwarp_state->scatter.unified_motion = false;
+	libwarp_state->scatter.color_layer2 = nullptr;
+	libwarp_state->scatter.depth_layer2 = nullptr;
+	libwarp_state->scatter.motion_layer2 = nullptr;
 	
-	//
-	const auto depth_buffer_size = sizeof(float) * camera_setup->screen_width * camera_setup->screen_height;
-	if(libwarp_state->scatter.depth_buffer == nullptr ||
-	   libwarp_state->scatter.depth_buffer->get_size() < depth_buffer_size) {
-		libwarp_state->scatter.depth_buffer = libwarp_state->ctx->create_buffer(*libwarp_state->dev_queue, depth_buffer_size);
-		if(libwarp_state->scatter.depth_buffer == nullptr) {
-			return LIBWARP_DEPTH_BUFFER_FAILURE;
-		}
-	}
+	// exec kernels
+	return libwarp_exec_scatter(camera_setup, delta, clear_frame);
+}
+
+LIBWARP_ERROR_CODE libwarp_scatter_accel_metal(const libwarp_camera_setup* const camera_setup,
+											   const float delta,
+											   const bool clear_frame,
+											   id <MTLTexture> color_texture,
+											   id <MTLTexture> depth_texture,
+											   id <MTLTexture> motion_texture,
+											   id <MTLTexture> motion_prev_texture,
+											   id <MTLTexture> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.color, color_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.depth, depth_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.motion, motion_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.motion_prev, motion_prev_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.output, output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	libwarp_state->scatter.unified_motion = false;
+	libwarp_state->scatter.color_layer2 = nullptr;
+	libwarp_state->scatter.depth_layer2 = nullptr;
+	libwarp_state->scatter.motion_layer2 = nullptr;
 	
 	// exec kernels
-	auto err = LIBWARP_SUCCESS;
-	if(clear_frame) {
-		err = run_warp_kernel<KERNEL_SCATTER_CLEAR>(camera_setup, delta);
-	}
-	if(err == LIBWARP_SUCCESS) {
-		err = run_warp_kernel<KERNEL_SCATTER_DEPTH_PASS>(camera_setup, delta);
-	}
-	if(err == LIBWARP_SUCCESS) {
-		err = run_warp_kernel<KERNEL_SCATTER_COLOR_DEPTH_TEST>(camera_setup, delta);
-	}
-	if(err == LIBWARP_SUCCESS) {
-		err = run_warp_kernel<KERNEL_SCATTER_FIXUP>(camera_setup, delta);
-	}
-	return err;
+	return libwarp_exec_scatter(camera_setup, delta, clear_frame);
+}
+
+LIBWARP_ERROR_CODE libwarp_scatter_unified_metal(const libwarp_camera_setup* const camera_setup,
+												 const float delta,
+												 const bool clear_frame,
+												 id <MTLTexture> color_texture,
+												 id <MTLTexture> depth_texture,
+												 id <MTLTexture> motion_texture,
+												 id <MTLTexture> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.color, color_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.depth, depth_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.motion, motion_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.output, output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	libwarp_state->scatter.motion_prev = nullptr;
+	libwarp_state->scatter.unified_motion = true;
+	libwarp_state->scatter.color_layer2 = nullptr;
+	libwarp_state->scatter.depth_layer2 = nullptr;
+	libwarp_state->scatter.motion_layer2 = nullptr;
+	
+	// exec kernels
+	return libwarp_exec_scatter(camera_setup, delta, clear_frame);
+}
+
+LIBWARP_ERROR_CODE libwarp_scatter_two_layer_metal(const libwarp_camera_setup* const camera_setup,
+												   const float delta,
+												   const bool clear_frame,
+												   id <MTLTexture> color_texture,
+												   id <MTLTexture> depth_texture,
+												   id <MTLTexture> motion_texture,
+												   id <MTLTexture> color_layer2_texture,
+												   id <MTLTexture> depth_layer2_texture,
+												   id <MTLTexture> motion_layer2_texture,
+												   id <MTLTexture> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.color, color_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.depth, depth_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.motion, motion_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.color_layer2, color_layer2_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.depth_layer2, depth_layer2_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.motion_layer2, motion_layer2_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->scatter.output, output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	libwarp_state->scatter.motion_prev = nullptr;
+	libwarp_state->scatter.unified_motion = false;
+	
+	// exec kernels
+	return libwarp_exec_scatter(camera_setup, delta, clear_frame);
 }
 
 LIBWARP_ERROR_CODE libwarp_gather_metal(const libwarp_camera_setup* const camera_setup,
@@ -92,6 +184,30 @@ LIBWARP_ERROR_CODE libwarp_gather_metal(const libwarp_camera_setup* const camera
 										id <MTLTexture> output_texture) REQUIRES(!libwarp_lock) {
 	LIBWARP_INIT_AND_LOCK
 	
+	// wrap textures
+	uint32_t img_set = 0;
+	if (!libwarp_wrap_metal_gather_textures(color_current_texture, depth_current_texture, color_prev_texture, depth_prev_texture,
+											motion_forward_texture, motion_backward_texture,
+											motion_depth_forward_texture, motion_depth_backward_texture,
+											output_texture, img_set)) {
+		return LIBWARP_IMAGE_WRAP_FAILURE;
+	}
+	
+	// exec kernel
+	return libwarp_exec_gather(camera_setup, delta, img_set);
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_unified_metal(const libwarp_camera_setup* const camera_setup,
+												const float delta,
+												id <MTLTexture> color_current_texture,
+												id <MTLTexture> depth_current_texture,
+												id <MTLTexture> color_prev_texture,
+												id <MTLTexture> depth_prev_texture,
+												id <MTLTexture> motion_current_texture,
+												id <MTLTexture> motion_prev_texture,
+												id <MTLTexture> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
 	// wrap textures
 	// gather swaps images every other frame, so determine which set to use
 	uint32_t img_set = 0;
@@ -100,20 +216,18 @@ LIBWARP_ERROR_CODE libwarp_gather_metal(const libwarp_camera_setup* const camera
 		img_set = 1; // use second set
 	}
 	
+	// unified motion belongs to its frame (like color and depth)
 	if(!libwarp_wrap_metal_texture(libwarp_state->gather.color[img_set], color_current_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
 	if(!libwarp_wrap_metal_texture(libwarp_state->gather.depth[img_set], depth_current_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather.motion[img_set * 2], motion_current_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
 	if(!libwarp_wrap_metal_texture(libwarp_state->gather.color[1u - img_set], color_prev_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
 	if(!libwarp_wrap_metal_texture(libwarp_state->gather.depth[1u - img_set], depth_prev_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
-	if(!libwarp_wrap_metal_texture(libwarp_state->gather.motion_depth[img_set], motion_depth_forward_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
-	if(!libwarp_wrap_metal_texture(libwarp_state->gather.motion_depth[1u - img_set], motion_depth_backward_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
-	
-	if(!libwarp_wrap_metal_texture(libwarp_state->gather.motion[img_set * 2], motion_forward_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
-	if(!libwarp_wrap_metal_texture(libwarp_state->gather.motion[img_set * 2 + 1], motion_backward_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
-	
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather.motion[(1u - img_set) * 2], motion_prev_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
 	if(!libwarp_wrap_metal_texture(libwarp_state->gather.output, output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	libwarp_state->gather.unified_motion = true;
 	
 	// exec kernel
-	return run_warp_kernel<KERNEL_GATHER_BIDIRECTIONAL>(camera_setup, delta, img_set);
+	return libwarp_exec_gather(camera_setup, delta, img_set);
 }
 
 LIBWARP_ERROR_CODE libwarp_gather_forward_only_metal(const libwarp_camera_setup* const camera_setup,
@@ -127,8 +241,409 @@ LIBWARP_ERROR_CODE libwarp_gather_forward_only_metal(const libwarp_camera_setup*
 	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.color, color_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
 	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.motion, motion_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
 	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.output, output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	libwarp_state->gather_forward.motion_prev = nullptr;
+	libwarp_state->gather_forward.unified_motion = false;
+	
+	// exec kernel
+	return libwarp_exec_gather_forward_only(camera_setup, delta);
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_forward_only_unified_metal(const libwarp_camera_setup* const camera_setup,
+															 const float delta,
+															 id <MTLTexture> color_texture,
+															 id <MTLTexture> motion_texture,
+															 id <MTLTexture> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.color, color_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.motion, motion_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.output, output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	libwarp_state->gather_forward.motion_prev = nullptr;
+	libwarp_state->gather_forward.unified_motion = true;
+	
+	// exec kernel
+	return libwarp_exec_gather_forward_only(camera_setup, delta);
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_forward_only_accel_metal(const libwarp_camera_setup* const camera_setup,
+														   const float delta,
+														   id <MTLTexture> color_texture,
+														   id <MTLTexture> motion_texture,
+														   id <MTLTexture> motion_prev_texture,
+														   id <MTLTexture> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.color, color_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.motion, motion_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.motion_prev, motion_prev_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.output, output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	libwarp_state->gather_forward.unified_motion = false;
+	
+	// exec kernel
+	return libwarp_exec_gather_forward_only(camera_setup, delta);
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_forward_only_depth_metal(const libwarp_camera_setup* const camera_setup,
+														   const float delta,
+														   id <MTLTexture> color_texture,
+														   id <MTLTexture> depth_texture,
+														   id <MTLTexture> motion_texture,
+														   id <MTLTexture> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.color, color_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.depth, depth_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.motion, motion_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.output, output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	// exec kernel
+	return libwarp_exec_gather_forward_only_depth(camera_setup, delta);
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_motion_blur_metal(const libwarp_camera_setup* const camera_setup,
+													const float delta,
+													const float shutter,
+													const uint32_t sample_count,
+													id <MTLTexture> color_current_texture,
+													id <MTLTexture> depth_current_texture,
+													id <MTLTexture> color_prev_texture,
+													id <MTLTexture> depth_prev_texture,
+													id <MTLTexture> motion_forward_texture,
+													id <MTLTexture> motion_backward_texture,
+													id <MTLTexture> motion_depth_forward_texture,
+													id <MTLTexture> motion_depth_backward_texture,
+													id <MTLTexture> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures
+	uint32_t img_set = 0;
+	if (!libwarp_wrap_metal_gather_textures(color_current_texture, depth_current_texture, color_prev_texture, depth_prev_texture,
+											motion_forward_texture, motion_backward_texture,
+											motion_depth_forward_texture, motion_depth_backward_texture,
+											output_texture, img_set)) {
+		return LIBWARP_IMAGE_WRAP_FAILURE;
+	}
+	
+	// exec kernel
+	return libwarp_exec_gather_motion_blur(camera_setup, delta, shutter, sample_count, img_set);
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_forward_only_motion_blur_metal(const libwarp_camera_setup* const camera_setup,
+																 const float delta,
+																 const float shutter,
+																 const uint32_t sample_count,
+																 id <MTLTexture> color_texture,
+																 id <MTLTexture> motion_texture,
+																 id <MTLTexture> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.color, color_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.motion, motion_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.output, output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	libwarp_state->gather_forward.motion_prev = nullptr;
+	libwarp_state->gather_forward.unified_motion = false;
 	
 	// exec kernel
-	return run_warp_kernel<KERNEL_GATHER_FORWARD_ONLY>(camera_setup, delta);
+	return libwarp_exec_gather_forward_only_motion_blur(camera_setup, delta, shutter, sample_count);
+}
+
+LIBWARP_ERROR_CODE libwarp_estimate_motion_metal(const libwarp_camera_setup* const camera_setup,
+												 const bool invert_motion,
+												 id <MTLTexture> color_src_texture,
+												 id <MTLTexture> color_dst_texture,
+												 id <MTLTexture> depth_src_texture,
+												 id <MTLTexture> depth_dst_texture,
+												 id <MTLTexture> motion_texture,
+												 id <MTLTexture> motion_depth_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures
+	auto& flow = libwarp_state->flow;
+	if(!libwarp_wrap_metal_texture(flow.color_src, color_src_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(flow.color_dst, color_dst_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(flow.output, motion_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if (depth_src_texture != nil && depth_dst_texture != nil && motion_depth_texture != nil) {
+		if(!libwarp_wrap_metal_texture(flow.depth_src, depth_src_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+		if(!libwarp_wrap_metal_texture(flow.depth_dst, depth_dst_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+		if(!libwarp_wrap_metal_texture(flow.output_depth, motion_depth_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	} else {
+		flow.depth_src = nullptr;
+		flow.depth_dst = nullptr;
+		flow.output_depth = nullptr;
+	}
+	
+	// exec kernels
+	return libwarp_exec_estimate_motion(camera_setup, invert_motion);
+}
+
+LIBWARP_ERROR_CODE libwarp_compose_motion_metal(const libwarp_camera_setup* const camera_setup,
+												const uint64_t composition_id,
+												const id <MTLTexture>* motion_textures,
+												const uint32_t motion_texture_count) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	if (motion_textures == nullptr) {
+		return LIBWARP_MOTION_COMPOSITION_FAILURE;
+	}
+	
+	// wrap textures
+	auto& inputs = libwarp_state->compose.inputs;
+	if (inputs.size() < motion_texture_count) {
+		inputs.resize(motion_texture_count);
+	}
+	for (uint32_t i = 0; i < motion_texture_count; ++i) {
+		if(!libwarp_wrap_metal_texture(inputs[i], motion_textures[i])) return LIBWARP_IMAGE_WRAP_FAILURE;
+	}
+	
+	// exec kernel(s)
+	return libwarp_exec_compose_motion(camera_setup, composition_id,
+									   vector<shared_ptr<compute_image>>(inputs.begin(), inputs.begin() + motion_texture_count));
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_forward_only_composed_metal(const libwarp_camera_setup* const camera_setup,
+															  const uint64_t composition_id,
+															  const float delta,
+															  id <MTLTexture> color_texture,
+															  id <MTLTexture> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.color, color_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->gather_forward.output, output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	// exec kernel
+	return libwarp_exec_gather_forward_only_composed(camera_setup, composition_id, delta);
+}
+
+LIBWARP_ERROR_CODE libwarp_record_scatter_metal(const libwarp_camera_setup* const camera_setup,
+												const bool clear_frame,
+												id <MTLTexture> color_texture,
+												id <MTLTexture> depth_texture,
+												id <MTLTexture> motion_texture,
+												id <MTLTexture> output_texture,
+												libwarp_recording* recording) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures (these are owned by the recording)
+	array<shared_ptr<compute_image>, LIBWARP_BINDING_COUNT> images;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_COLOR], color_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_DEPTH], depth_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_MOTION], motion_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_OUTPUT], output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	return libwarp_record(camera_setup, libwarp_recording_t::MODE::SCATTER, clear_frame, std::move(images), recording);
+}
+
+LIBWARP_ERROR_CODE libwarp_record_gather_metal(const libwarp_camera_setup* const camera_setup,
+											   id <MTLTexture> color_current_texture,
+											   id <MTLTexture> depth_current_texture,
+											   id <MTLTexture> color_prev_texture,
+											   id <MTLTexture> depth_prev_texture,
+											   id <MTLTexture> motion_forward_texture,
+											   id <MTLTexture> motion_backward_texture,
+											   id <MTLTexture> motion_depth_forward_texture,
+											   id <MTLTexture> motion_depth_backward_texture,
+											   id <MTLTexture> output_texture,
+											   libwarp_recording* recording) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures (these are owned by the recording)
+	array<shared_ptr<compute_image>, LIBWARP_BINDING_COUNT> images;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_COLOR], color_current_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_DEPTH], depth_current_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_COLOR_PREV], color_prev_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_DEPTH_PREV], depth_prev_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_MOTION], motion_forward_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_MOTION_BACKWARD], motion_backward_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_MOTION_DEPTH_FORWARD], motion_depth_forward_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_MOTION_DEPTH_BACKWARD], motion_depth_backward_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_OUTPUT], output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	return libwarp_record(camera_setup, libwarp_recording_t::MODE::GATHER_BIDIRECTIONAL, false, std::move(images), recording);
+}
+
+LIBWARP_ERROR_CODE libwarp_record_gather_forward_only_metal(const libwarp_camera_setup* const camera_setup,
+															id <MTLTexture> color_texture,
+															id <MTLTexture> motion_texture,
+															id <MTLTexture> output_texture,
+															libwarp_recording* recording) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures (these are owned by the recording)
+	array<shared_ptr<compute_image>, LIBWARP_BINDING_COUNT> images;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_COLOR], color_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_MOTION], motion_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_OUTPUT], output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	return libwarp_record(camera_setup, libwarp_recording_t::MODE::GATHER_FORWARD_ONLY, false, std::move(images), recording);
+}
+
+LIBWARP_ERROR_CODE libwarp_rebind_metal(libwarp_recording recording_handle,
+										const LIBWARP_BINDING binding,
+										id <MTLTexture> texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	auto recording = libwarp_find_recording(recording_handle);
+	if (recording == nullptr) {
+		return LIBWARP_INVALID_RECORDING;
+	}
+	if (!libwarp_is_recording_binding(*recording, binding) || texture == nil) {
+		return LIBWARP_INVALID_BINDING;
+	}
+	if (((metal_image*)recording->images[binding].get())->get_metal_image() == texture) {
+		return LIBWARP_SUCCESS; // nothing to do
+	}
+	if(!libwarp_wrap_metal_texture(recording->images[binding], texture, binding == LIBWARP_BINDING_OUTPUT)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	return libwarp_encode_recording(*recording);
+}
+
+LIBWARP_ERROR_CODE libwarp_submit_scatter_metal(const libwarp_camera_setup* const camera_setup,
+												const float delta,
+												const bool clear_frame,
+												id <MTLTexture> color_texture,
+												id <MTLTexture> depth_texture,
+												id <MTLTexture> motion_texture,
+												id <MTLTexture> output_texture,
+												const LIBWARP_SUBMIT_MODE submit_mode,
+												libwarp_job* job) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures (these are owned by the job)
+	auto scatter_job = make_unique<libwarp_job_t>();
+	if(!libwarp_wrap_metal_texture(scatter_job->images[LIBWARP_BINDING_COLOR], color_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(scatter_job->images[LIBWARP_BINDING_DEPTH], depth_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(scatter_job->images[LIBWARP_BINDING_MOTION], motion_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(scatter_job->images[LIBWARP_BINDING_OUTPUT], output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	if(camera_setup == nullptr) return LIBWARP_INVALID_CAMERA_SETUP;
+	scatter_job->mode = libwarp_recording_t::MODE::SCATTER;
+	scatter_job->camera_setup = *camera_setup;
+	scatter_job->delta = delta;
+	scatter_job->clear_frame = clear_frame;
+	return libwarp_submit_job(std::move(scatter_job), submit_mode, job);
+}
+
+LIBWARP_ERROR_CODE libwarp_submit_gather_metal(const libwarp_camera_setup* const camera_setup,
+											   const float delta,
+											   id <MTLTexture> color_current_texture,
+											   id <MTLTexture> depth_current_texture,
+											   id <MTLTexture> color_prev_texture,
+											   id <MTLTexture> depth_prev_texture,
+											   id <MTLTexture> motion_forward_texture,
+											   id <MTLTexture> motion_backward_texture,
+											   id <MTLTexture> motion_depth_forward_texture,
+											   id <MTLTexture> motion_depth_backward_texture,
+											   id <MTLTexture> output_texture,
+											   const LIBWARP_SUBMIT_MODE submit_mode,
+											   libwarp_job* job) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures (these are owned by the job)
+	auto gather_job = make_unique<libwarp_job_t>();
+	auto& images = gather_job->images;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_COLOR], color_current_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_DEPTH], depth_current_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_COLOR_PREV], color_prev_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_DEPTH_PREV], depth_prev_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_MOTION], motion_forward_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_MOTION_BACKWARD], motion_backward_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_MOTION_DEPTH_FORWARD], motion_depth_forward_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_MOTION_DEPTH_BACKWARD], motion_depth_backward_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(images[LIBWARP_BINDING_OUTPUT], output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	if(camera_setup == nullptr) return LIBWARP_INVALID_CAMERA_SETUP;
+	gather_job->mode = libwarp_recording_t::MODE::GATHER_BIDIRECTIONAL;
+	gather_job->camera_setup = *camera_setup;
+	gather_job->delta = delta;
+	return libwarp_submit_job(std::move(gather_job), submit_mode, job);
+}
+
+LIBWARP_ERROR_CODE libwarp_submit_gather_forward_only_metal(const libwarp_camera_setup* const camera_setup,
+															const float delta,
+															id <MTLTexture> color_texture,
+															id <MTLTexture> motion_texture,
+															id <MTLTexture> output_texture,
+															const LIBWARP_SUBMIT_MODE submit_mode,
+															libwarp_job* job) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures (these are owned by the job)
+	auto gather_job = make_unique<libwarp_job_t>();
+	if(!libwarp_wrap_metal_texture(gather_job->images[LIBWARP_BINDING_COLOR], color_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(gather_job->images[LIBWARP_BINDING_MOTION], motion_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(gather_job->images[LIBWARP_BINDING_OUTPUT], output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	if(camera_setup == nullptr) return LIBWARP_INVALID_CAMERA_SETUP;
+	gather_job->mode = libwarp_recording_t::MODE::GATHER_FORWARD_ONLY;
+	gather_job->camera_setup = *camera_setup;
+	gather_job->delta = delta;
+	return libwarp_submit_job(std::move(gather_job), submit_mode, job);
+}
+
+LIBWARP_ERROR_CODE libwarp_set_confidence_output_metal(id <MTLTexture> confidence_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	if (confidence_texture == nil) {
+		libwarp_state->confidence.image = nullptr;
+		return LIBWARP_SUCCESS;
+	}
+	if(!libwarp_wrap_metal_texture(libwarp_state->confidence.image, confidence_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_acquire_host_output_metal(const libwarp_camera_setup* const camera_setup,
+													 id <MTLTexture>* output_texture,
+													 uint32_t* frame) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	if (output_texture == nullptr || frame == nullptr) {
+		return LIBWARP_HOST_OUTPUT_FAILURE;
+	}
+	shared_ptr<compute_image> output_image;
+	if (const auto err = libwarp_acquire_host_output(camera_setup, output_image, *frame); err != LIBWARP_SUCCESS) {
+		return err;
+	}
+	*output_texture = ((metal_image*)output_image.get())->get_metal_image();
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_merge_metal(const libwarp_camera_setup* const camera_setup,
+									   id <MTLTexture> rerendered_texture,
+									   id <MTLTexture> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures
+	if(!libwarp_wrap_metal_texture(libwarp_state->merge.rerendered, rerendered_texture)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	if(!libwarp_wrap_metal_texture(libwarp_state->merge.output, output_texture, true)) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	// exec kernel
+	return libwarp_exec_merge(camera_setup);
+}
+
+LIBWARP_ERROR_CODE libwarp_auto_metal(const libwarp_camera_setup* const camera_setup,
+									  const float delta,
+									  id <MTLTexture> color_current_texture,
+									  id <MTLTexture> depth_current_texture,
+									  id <MTLTexture> color_prev_texture,
+									  id <MTLTexture> depth_prev_texture,
+									  id <MTLTexture> motion_forward_texture,
+									  id <MTLTexture> motion_backward_texture,
+									  id <MTLTexture> motion_depth_forward_texture,
+									  id <MTLTexture> motion_depth_backward_texture,
+									  id <MTLTexture> output_texture,
+									  LIBWARP_WARP_MODE* selected_mode) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// wrap textures
+	uint32_t img_set = 0;
+	if (!libwarp_wrap_metal_gather_textures(color_current_texture, depth_current_texture, color_prev_texture, depth_prev_texture,
+											motion_forward_texture, motion_backward_texture,
+											motion_depth_forward_texture, motion_depth_backward_texture,
+											output_texture, img_set)) {
+		return LIBWARP_IMAGE_WRAP_FAILURE;
+	}
+	
+	// select + exec kernel(s)
+	return libwarp_exec_auto(camera_setup, delta, img_set, selected_mode);
 }
 #endif
@@ -0,0 +1,175 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "libwarp_internal.hpp"
+#include <chrono>
+
+// weight of a new measurement in the kernel cost moving averages
+static constexpr const float auto_cost_ema_weight { 0.1f };
+
+static void libwarp_update_cost(float& cost, const float measured_cost) {
+	cost += (measured_cost - cost) * auto_cost_ema_weight;
+}
+
+// folds the measurements of all completed auto mode warps into the measured costs
+static void libwarp_update_costs() {
+	auto& costs = libwarp_state->auto_mode;
+	erase_if(costs.pending, [&costs](const shared_ptr<libwarp_auto_measurement>& measurement) {
+		if (measurement->completed < measurement->dispatched) {
+			return false; // still in flight
+		}
+		const float cost = measurement->cost;
+		switch (measurement->mode) {
+			case LIBWARP_WARP_MODE_GATHER_FORWARD_ONLY:
+				libwarp_update_cost(costs.cost_forward_only, cost);
+				break;
+			case LIBWARP_WARP_MODE_GATHER_BIDIRECTIONAL:
+				libwarp_update_cost(costs.cost_bidirectional, cost);
+				break;
+			case LIBWARP_WARP_MODE_GATHER_MIXED:
+				libwarp_update_cost(costs.mixed_overhead, cost / max(measurement->est_mixed_cost, 0.0001f));
+				break;
+		}
+		return true;
+	});
+}
+
+LIBWARP_ERROR_CODE libwarp_exec_auto(const libwarp_camera_setup* const camera_setup,
+									 const float delta,
+									 const uint32_t img_set,
+									 LIBWARP_WARP_MODE* selected_mode) {
+	// compute per-tile statistics (tile modes + amount of complex tiles)
+	auto& slot = libwarp_acquire_slot();
+	slot.retain({ libwarp_state->gather.motion[img_set * 2], libwarp_state->gather.motion[img_set * 2 + 1] });
+	const auto tile_count = libwarp_tile_count(camera_setup);
+	const auto total_tiles = tile_count.x * tile_count.y;
+	const auto tile_modes_size = sizeof(uint32_t) * (total_tiles + 1u);
+	if (slot.tile_modes == nullptr || slot.tile_modes->get_size() < tile_modes_size) {
+		slot.tile_modes = libwarp_state->ctx->create_buffer(*slot.queue, tile_modes_size);
+		if (slot.tile_modes == nullptr) {
+			return LIBWARP_TILE_MASK_FAILURE;
+		}
+	}
+	const uint32_t clear_modes = 0u;
+	slot.tile_modes->fill(*slot.queue, &clear_modes, sizeof(clear_modes));
+	if (const auto err = run_warp_kernel<KERNEL_AUTO_TILE_STATS>(camera_setup, delta, img_set); err != LIBWARP_SUCCESS) {
+		return err;
+	}
+	// NOTE: this has to wait for the stats kernel, but only reads back a single value
+	uint32_t complex_tiles = 0u;
+	slot.tile_modes->read(*slot.queue, &complex_tiles, sizeof(uint32_t), sizeof(uint32_t) * total_tiles);
+	
+	// select the cheapest mode: forward-only if all tiles are simple, bidirectional if all tiles are complex,
+	// otherwise mixed if its estimated cost (based on the measured costs of the pure modes) is lower than bidirectional
+	// NOTE: the mixed kernel has no variant for any of the optional features -> always use bidirectional if one is enabled
+	libwarp_update_costs();
+	auto& costs = libwarp_state->auto_mode;
+	const auto complex_fraction = float(complex_tiles) / float(total_tiles);
+	const auto est_mixed_cost = ((1.0f - complex_fraction) * costs.cost_forward_only +
+								 complex_fraction * costs.cost_bidirectional);
+	LIBWARP_WARP_MODE mode = LIBWARP_WARP_MODE_GATHER_BIDIRECTIONAL;
+	if (complex_tiles == 0u) {
+		mode = LIBWARP_WARP_MODE_GATHER_FORWARD_ONLY;
+	} else if (complex_tiles < total_tiles && !libwarp_has_enabled_features() &&
+			   costs.mixed_overhead * est_mixed_cost < costs.cost_bidirectional) {
+		mode = LIBWARP_WARP_MODE_GATHER_MIXED;
+	}
+	if (selected_mode != nullptr) {
+		*selected_mode = mode;
+	}
+	
+	// exec the selected mode, measuring its cost on the queue
+	// NOTE: the queue of the warp is idle at this point (the stats read-back has completed, other modes use a newly acquired
+	//       slot), so the time until its last kernel has completed is the cost of the warp
+	auto measurement = make_shared<libwarp_auto_measurement>();
+	measurement->mode = mode;
+	measurement->est_mixed_cost = est_mixed_cost;
+	measurement->start = chrono::steady_clock::now();
+	costs.measurement = measurement;
+	LIBWARP_ERROR_CODE err = LIBWARP_SUCCESS;
+	switch (mode) {
+		case LIBWARP_WARP_MODE_GATHER_FORWARD_ONLY: {
+			// forward-only warping from the previous frame using the forward motion (prev -> cur)
+			// NOTE: the forward-only gather bindings of the application are restored afterwards
+			auto& gather_forward = libwarp_state->gather_forward;
+			const auto prev_color = gather_forward.color;
+			const auto prev_motion = gather_forward.motion;
+			const auto prev_output = gather_forward.output;
+			const auto prev_motion_prev = gather_forward.motion_prev;
+			const auto prev_unified_motion = gather_forward.unified_motion;
+			libwarp_bind_gather_forward_only_floor(libwarp_state->gather.color[1u - img_set],
+												   libwarp_state->gather.motion[img_set * 2],
+												   libwarp_state->gather.output);
+			err = libwarp_exec_gather_forward_only(camera_setup, delta);
+			libwarp_bind_image(gather_forward.color, prev_color);
+			libwarp_bind_image(gather_forward.motion, prev_motion);
+			libwarp_bind_image(gather_forward.output, prev_output);
+			libwarp_bind_image(gather_forward.motion_prev, prev_motion_prev);
+			gather_forward.unified_motion = prev_unified_motion;
+			break;
+		}
+		case LIBWARP_WARP_MODE_GATHER_BIDIRECTIONAL:
+			err = libwarp_exec_gather(camera_setup, delta, img_set);
+			break;
+		case LIBWARP_WARP_MODE_GATHER_MIXED:
+			// executes on the same slot as the stats kernel, since it needs the tile modes
+			slot.retain({
+				libwarp_state->gather.color[0], libwarp_state->gather.color[1],
+				libwarp_state->gather.depth[0], libwarp_state->gather.depth[1],
+				libwarp_state->gather.motion_depth[0], libwarp_state->gather.motion_depth[1],
+				libwarp_state->gather.output
+			});
+			err = run_warp_kernel<KERNEL_GATHER_AUTO>(camera_setup, delta, img_set);
+			break;
+	}
+	costs.measurement = nullptr;
+	if (err == LIBWARP_SUCCESS && measurement->dispatched > 0u) {
+		// NOTE: at most one measurement per slot can still be in flight, anything beyond that never completed
+		if (costs.pending.size() > libwarp_state->slots.size()) {
+			costs.pending.erase(costs.pending.begin());
+		}
+		costs.pending.emplace_back(std::move(measurement));
+	}
+	if (!libwarp_state->is_async()) {
+		// blocking execution: all kernels have already completed
+		libwarp_update_costs();
+	}
+	return err;
+}
+
+LIBWARP_ERROR_CODE libwarp_auto_floor(const libwarp_camera_setup* const camera_setup,
+									  const float delta,
+									  shared_ptr<compute_image> color_current_texture,
+									  shared_ptr<compute_image> depth_current_texture,
+									  shared_ptr<compute_image> color_prev_texture,
+									  shared_ptr<compute_image> depth_prev_texture,
+									  shared_ptr<compute_image> motion_forward_texture,
+									  shared_ptr<compute_image> motion_backward_texture,
+									  shared_ptr<compute_image> motion_depth_forward_texture,
+									  shared_ptr<compute_image> motion_depth_backward_texture,
+									  shared_ptr<compute_image> output_texture,
+									  LIBWARP_WARP_MODE* selected_mode) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	const auto img_set = libwarp_bind_gather_floor(color_current_texture, depth_current_texture,
+												   color_prev_texture, depth_prev_texture,
+												   motion_forward_texture, motion_backward_texture,
+												   motion_depth_forward_texture, motion_depth_backward_texture,
+												   output_texture);
+	return libwarp_exec_auto(camera_setup, delta, img_set, selected_mode);
+}
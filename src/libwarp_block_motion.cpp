@@ -0,0 +1,109 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "libwarp_internal.hpp"
+
+uint2 libwarp_block_motion_count(const libwarp_camera_setup* const camera_setup, const uint32_t block_size) {
+	return (uint2 { camera_setup->screen_width, camera_setup->screen_height } + (block_size - 1u)) / block_size;
+}
+
+LIBWARP_ERROR_CODE libwarp_alloc_block_motion(libwarp_state_struct::in_flight_slot& slot,
+											  const libwarp_camera_setup* const camera_setup) {
+	const auto block_count = libwarp_block_motion_count(camera_setup, libwarp_state->block_motion.block_size);
+	// one packed motion per pixel, output uses 4 uint32_t per block
+	const auto pixels_size = sizeof(uint32_t) * camera_setup->screen_width * camera_setup->screen_height;
+	const auto block_motion_size = sizeof(uint32_t) * 4u * block_count.x * block_count.y;
+	if (slot.block_motion_pixels == nullptr || slot.block_motion_pixels->get_size() < pixels_size ||
+		slot.block_motion == nullptr || slot.block_motion->get_size() < block_motion_size) {
+		slot.block_motion_pixels = libwarp_state->ctx->create_buffer(*slot.queue, pixels_size);
+		slot.block_motion = libwarp_state->ctx->create_buffer(*slot.queue, block_motion_size);
+		if (slot.block_motion_pixels == nullptr || slot.block_motion == nullptr) {
+			slot.block_motion_pixels = nullptr;
+			slot.block_motion = nullptr;
+			return LIBWARP_BLOCK_MOTION_FAILURE;
+		}
+	}
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_exec_block_motion_resolve(const libwarp_camera_setup* const camera_setup) {
+	// one work-item per block
+	libwarp_state->work_dim_override = libwarp_block_motion_count(camera_setup, libwarp_state->block_motion.block_size);
+	const auto err = run_warp_kernel<KERNEL_BLOCK_MOTION_RESOLVE>(camera_setup, 0.0f);
+	libwarp_state->work_dim_override = {};
+	return err;
+}
+
+LIBWARP_ERROR_CODE libwarp_set_block_motion_output(const uint32_t block_size) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	if (block_size != 0u && block_size != 8u && block_size != 16u) {
+		return LIBWARP_BLOCK_MOTION_FAILURE;
+	}
+	if (block_size != libwarp_state->block_motion.block_size) {
+		// buffers are sized for the block size, previous block motion output is no longer valid
+		libwarp_finish_slots();
+		for (auto& slot : libwarp_state->slots) {
+			slot.block_motion_pixels = nullptr;
+			slot.block_motion = nullptr;
+		}
+	}
+	libwarp_state->block_motion.block_size = block_size;
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_get_block_motion(const libwarp_camera_setup* const camera_setup,
+											libwarp_block_motion* blocks,
+											const uint32_t block_capacity,
+											libwarp_block_motion_info* block_info) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	const auto block_size = libwarp_state->block_motion.block_size;
+	const auto block_count = (block_size > 0u ? libwarp_block_motion_count(camera_setup, block_size) : uint2 {});
+	if (block_info != nullptr) {
+		*block_info = {
+			.block_size = block_size,
+			.block_count_x = block_count.x,
+			.block_count_y = block_count.y,
+		};
+	}
+	if (blocks == nullptr) {
+		return LIBWARP_SUCCESS; // only queried the block info
+	}
+	
+	auto& slot = libwarp_state->slots[libwarp_state->block_motion_slot];
+	const auto total_block_count = block_count.x * block_count.y;
+	if (block_size == 0u || slot.block_motion == nullptr || block_capacity < total_block_count ||
+		slot.block_motion->get_size() < sizeof(uint32_t) * 4u * total_block_count) {
+		return LIBWARP_BLOCK_MOTION_FAILURE;
+	}
+	// wait until the job that wrote the block motion has completed
+	libwarp_finish_slot(slot);
+	vector<uint32_t> resolved(4u * total_block_count);
+	slot.block_motion->read(*slot.queue, resolved.data(), sizeof(uint32_t) * resolved.size());
+	for (uint32_t i = 0; i < total_block_count; ++i) {
+		blocks[i] = {
+			.mv_x = int32_t(resolved[i * 4u]),
+			.mv_y = int32_t(resolved[i * 4u + 1u]),
+			.sad = resolved[i * 4u + 2u],
+			// 16-bit unorm
+			.confidence = float(resolved[i * 4u + 3u]) / 65535.0f,
+		};
+	}
+	return LIBWARP_SUCCESS;
+}
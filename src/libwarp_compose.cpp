@@ -0,0 +1,166 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+
+#include "libwarp_internal.hpp"
+
+// max amount of cached composed motion fields
+static constexpr const size_t composed_motion_cache_size { 4u };
+
+const libwarp_state_struct::composed_motion* libwarp_find_composed_motion(const libwarp_camera_setup* const camera_setup,
+																		 const uint64_t composition_id) {
+	const uint2 dim { camera_setup->screen_width, camera_setup->screen_height };
+	auto& cache = libwarp_state->compose.cache;
+	for (auto iter = cache.begin(); iter != cache.end(); ++iter) {
+		if (iter->composition_id == composition_id && iter->dim == dim) {
+			// move to front (most recently used)
+			rotate(cache.begin(), iter, iter + 1);
+			return &cache.front();
+		}
+	}
+	return nullptr;
+}
+
+// creates a screen-sized packed 2D motion image that can be written by the composition kernel
+static shared_ptr<compute_image> libwarp_create_motion_image(libwarp_state_struct::in_flight_slot& slot, const uint2& dim) {
+	return libwarp_state->ctx->create_image(*slot.queue, uint4 { dim.x, dim.y, 0u, 0u },
+											COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::R32UI | COMPUTE_IMAGE_TYPE::READ_WRITE,
+											COMPUTE_MEMORY_FLAG::READ_WRITE);
+}
+
+LIBWARP_ERROR_CODE libwarp_exec_compose_motion(const libwarp_camera_setup* const camera_setup,
+											   const uint64_t composition_id,
+											   const vector<shared_ptr<compute_image>>& motion_textures) {
+	if (motion_textures.size() < 2u) {
+		return LIBWARP_MOTION_COMPOSITION_FAILURE;
+	}
+	for (const auto& motion_texture : motion_textures) {
+		if (motion_texture == nullptr) {
+			return LIBWARP_MOTION_COMPOSITION_FAILURE;
+		}
+	}
+	
+	// already composed -> reuse
+	if (libwarp_find_composed_motion(camera_setup, composition_id) != nullptr) {
+		return LIBWARP_SUCCESS;
+	}
+	
+	auto& slot = libwarp_acquire_slot();
+	slot.retain(motion_textures);
+	
+	// new cache entry: evict the least recently used entry if the cache is full
+	// NOTE: the evicted image is never reused, since in-flight warps on other slots may still read it (they retain it)
+	const uint2 dim { camera_setup->screen_width, camera_setup->screen_height };
+	auto& cache = libwarp_state->compose.cache;
+	if (cache.size() >= composed_motion_cache_size) {
+		cache.pop_back();
+	}
+	auto composed = libwarp_create_motion_image(slot, dim);
+	auto& scratch = libwarp_state->compose.scratch;
+	if (motion_textures.size() > 2u) {
+		if (scratch == nullptr || libwarp_state->compose.scratch_dim != dim) {
+			scratch = libwarp_create_motion_image(slot, dim);
+			libwarp_state->compose.scratch_dim = dim;
+		} else if (libwarp_state->compose.scratch_slot != libwarp_state->cur_slot) {
+			// scratch image may still be in use by the last composition on another slot
+			libwarp_finish_slot(libwarp_state->slots[libwarp_state->compose.scratch_slot]);
+		}
+		libwarp_state->compose.scratch_slot = libwarp_state->cur_slot;
+	}
+	if (composed == nullptr || (motion_textures.size() > 2u && scratch == nullptr)) {
+		return LIBWARP_MOTION_COMPOSITION_FAILURE;
+	}
+	
+	// compose pairwise, ping-ponging between the scratch and the composed image, so that the last step writes the composed image
+	const auto step_count = uint32_t(motion_textures.size() - 1u);
+	auto err = LIBWARP_SUCCESS;
+	for (uint32_t step = 0; step < step_count && err == LIBWARP_SUCCESS; ++step) {
+		libwarp_state->compose.first = (step == 0 ? motion_textures[0] : libwarp_state->compose.output);
+		libwarp_state->compose.second = motion_textures[step + 1u];
+		libwarp_state->compose.output = ((step_count - 1u - step) % 2u == 0u ? composed : scratch);
+		err = run_warp_kernel<KERNEL_COMPOSE_MOTION>(camera_setup, 0.0f);
+	}
+	libwarp_state->compose.first = nullptr;
+	libwarp_state->compose.second = nullptr;
+	libwarp_state->compose.output = nullptr;
+	if (err != LIBWARP_SUCCESS) {
+		return err;
+	}
+	
+	cache.insert(cache.begin(), libwarp_state_struct::composed_motion {
+		.composition_id = composition_id,
+		.dim = dim,
+		.motion = composed,
+		.slot = libwarp_state->cur_slot,
+	});
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_exec_gather_forward_only_composed(const libwarp_camera_setup* const camera_setup,
+															 const uint64_t composition_id,
+															 const float delta) {
+	const auto entry = libwarp_find_composed_motion(camera_setup, composition_id);
+	if (entry == nullptr) {
+		return LIBWARP_MOTION_COMPOSITION_FAILURE;
+	}
+	// the composition may still be in flight on another slot than the one the gather executes on
+	libwarp_finish_slot(libwarp_state->slots[entry->slot]);
+	const auto composed = entry->motion;
+	// the composed motion is only bound for this warp, the previous motion bindings are restored afterwards
+	auto& gather_forward = libwarp_state->gather_forward;
+	const auto prev_motion = gather_forward.motion;
+	const auto prev_motion_prev = gather_forward.motion_prev;
+	const auto prev_unified_motion = gather_forward.unified_motion;
+	libwarp_bind_gather_forward_only_floor(gather_forward.color, composed, gather_forward.output);
+	const auto err = libwarp_exec_gather_forward_only(camera_setup, delta);
+	libwarp_bind_image(gather_forward.motion, prev_motion);
+	libwarp_bind_image(gather_forward.motion_prev, prev_motion_prev);
+	gather_forward.unified_motion = prev_unified_motion;
+	return err;
+}
+
+LIBWARP_ERROR_CODE libwarp_compose_motion_floor(const libwarp_camera_setup* const camera_setup,
+												const uint64_t composition_id,
+												const shared_ptr<compute_image>* motion_textures,
+												const uint32_t motion_texture_count) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	if (motion_textures == nullptr) {
+		return LIBWARP_MOTION_COMPOSITION_FAILURE;
+	}
+	return libwarp_exec_compose_motion(camera_setup, composition_id,
+									   vector<shared_ptr<compute_image>>(motion_textures, motion_textures + motion_texture_count));
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_forward_only_composed_floor(const libwarp_camera_setup* const camera_setup,
+															  const uint64_t composition_id,
+															  const float delta,
+															  shared_ptr<compute_image> color_texture,
+															  shared_ptr<compute_image> output_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	// color/output are only bound for this warp, the previous bindings are restored afterwards
+	auto& gather_forward = libwarp_state->gather_forward;
+	const auto prev_color = gather_forward.color;
+	const auto prev_output = gather_forward.output;
+	libwarp_bind_image(gather_forward.color, color_texture);
+	libwarp_bind_image(gather_forward.output, output_texture);
+	const auto err = libwarp_exec_gather_forward_only_composed(camera_setup, composition_id, delta);
+	libwarp_bind_image(gather_forward.color, prev_color);
+	libwarp_bind_image(gather_forward.output, prev_output);
+	return err;
+}
@@ -0,0 +1,948 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+// standalone CPU implementation of the scatter, bidirectional gather and forward-only gather warp kernels
+// (see warp_kernels.hpp), using host memory images and a small thread pool, without any libfloor runtime dependency
+// NOTE: this is a scalar port: pixels are processed one at a time (multithreaded over row chunks), since the per-pixel
+//       work is dominated by data-dependent fetches and iteration counts (gather fixed-point iteration, scatter depth
+//       test), the loops are not explicitly vectorized
+// NOTE: this must be kept in sync with the corresponding kernels
+
+#include <libwarp/libwarp.h>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+using namespace std;
+
+namespace {
+
+//////////////////////////////////////////
+// minimal vector math (mirrors the used subset of the libfloor vector types)
+
+struct vec2 {
+	float x { 0.0f }, y { 0.0f };
+	vec2 operator+(const vec2& v) const { return { x + v.x, y + v.y }; }
+	vec2 operator-(const vec2& v) const { return { x - v.x, y - v.y }; }
+	vec2 operator*(const vec2& v) const { return { x * v.x, y * v.y }; }
+	vec2 operator/(const vec2& v) const { return { x / v.x, y / v.y }; }
+	vec2 operator+(const float& f) const { return { x + f, y + f }; }
+	vec2 operator-(const float& f) const { return { x - f, y - f }; }
+	vec2 operator*(const float& f) const { return { x * f, y * f }; }
+	vec2 operator-() const { return { -x, -y }; }
+	float dot(const vec2& v) const { return x * v.x + y * v.y; }
+	float dot() const { return dot(*this); }
+	bool is_outside_unit() const { return (x < 0.0f || y < 0.0f || x > 1.0f || y > 1.0f); }
+};
+vec2 operator*(const float& f, const vec2& v) { return v * f; }
+
+struct vec3 {
+	float x { 0.0f }, y { 0.0f }, z { 0.0f };
+	vec3 operator+(const vec3& v) const { return { x + v.x, y + v.y, z + v.z }; }
+	vec3 operator-(const vec3& v) const { return { x - v.x, y - v.y, z - v.z }; }
+	vec3 operator*(const vec3& v) const { return { x * v.x, y * v.y, z * v.z }; }
+	vec3 operator*(const float& f) const { return { x * f, y * f, z * f }; }
+	vec3 operator/(const float& f) const { return { x / f, y / f, z / f }; }
+	vec3& operator+=(const vec3& v) { x += v.x; y += v.y; z += v.z; return *this; }
+	float dot(const vec3& v) const { return x * v.x + y * v.y + z * v.z; }
+	float length() const { return sqrt(dot(*this)); }
+};
+vec3 operator*(const float& f, const vec3& v) { return v * f; }
+
+struct vec4 {
+	float x { 0.0f }, y { 0.0f }, z { 0.0f }, w { 0.0f };
+	vec4 operator+(const vec4& v) const { return { x + v.x, y + v.y, z + v.z, w + v.w }; }
+	vec4 operator*(const float& f) const { return { x * f, y * f, z * f, w * f }; }
+	vec4& operator+=(const vec4& v) { x += v.x; y += v.y; z += v.z; w += v.w; return *this; }
+	vec4 interpolated(const vec4& v, const float& t) const {
+		return { x + (v.x - x) * t, y + (v.y - y) * t, z + (v.z - z) * t, w + (v.w - w) * t };
+	}
+};
+vec4 operator*(const float& f, const vec4& v) { return v * f; }
+
+//////////////////////////////////////////
+// host memory image access (mirrors the libfloor image read/sampling semantics)
+
+template <typename texel_type>
+struct cpu_image {
+	const uint8_t* data { nullptr };
+	int32_t width { 0 }, height { 0 };
+	size_t row_pitch { 0 };
+	
+	explicit cpu_image(const libwarp_cpu_image& img) :
+	data((const uint8_t*)img.data), width(int32_t(img.width)), height(int32_t(img.height)), row_pitch(img.row_pitch) {}
+	
+	const texel_type& texel(const int32_t x, const int32_t y) const {
+		return ((const texel_type*)(data + size_t(y) * row_pitch))[x];
+	}
+	// integer coordinate read (clamped to the edge)
+	texel_type read(const int32_t x, const int32_t y) const {
+		return texel(min(max(x, 0), width - 1), min(max(y, 0), height - 1));
+	}
+	// normalized coordinate read (nearest, clamped to the edge)
+	texel_type read(const vec2& p) const {
+		return read(int32_t(floor(p.x * float(width))), int32_t(floor(p.y * float(height))));
+	}
+	// integer coordinate read with mirrored repeat addressing
+	texel_type read_repeat_mirrored(const int32_t x, const int32_t y) const {
+		return texel(mirror(x, width), mirror(y, height));
+	}
+	
+	static int32_t mirror(const int32_t coord, const int32_t size) {
+		const auto period = 2 * size;
+		auto m = coord % period;
+		if (m < 0) {
+			m += period;
+		}
+		return (m < size ? m : period - 1 - m);
+	}
+};
+
+// bilinear read at a normalized coordinate, 'read_texel' performs the addressing
+template <typename read_texel_func_type>
+static vec4 read_bilinear(const vec2& p, const int32_t width, const int32_t height, read_texel_func_type&& read_texel) {
+	const float tx = p.x * float(width) - 0.5f;
+	const float ty = p.y * float(height) - 0.5f;
+	const float fx0 = floor(tx), fy0 = floor(ty);
+	const float fx = tx - fx0, fy = ty - fy0;
+	const auto x0 = int32_t(fx0), y0 = int32_t(fy0);
+	const auto top = read_texel(x0, y0).interpolated(read_texel(x0 + 1, y0), fx);
+	const auto bottom = read_texel(x0, y0 + 1).interpolated(read_texel(x0 + 1, y0 + 1), fx);
+	return top.interpolated(bottom, fy);
+}
+
+static vec4 read_linear(const cpu_image<vec4>& img, const vec2& p) {
+	return read_bilinear(p, img.width, img.height, [&img](const int32_t x, const int32_t y) { return img.read(x, y); });
+}
+
+static vec4 read_linear_repeat_mirrored(const cpu_image<vec4>& img, const vec2& p) {
+	return read_bilinear(p, img.width, img.height, [&img](const int32_t x, const int32_t y) {
+		return img.read_repeat_mirrored(x, y);
+	});
+}
+
+//////////////////////////////////////////
+// camera setup dependent state (runtime equivalent of the camera setup defines in warp_kernels.hpp)
+
+struct cpu_camera_setup {
+	static constexpr const float pi { 3.14159265358979323846f };
+	uint32_t width, height;
+	vec2 screen_size;
+	vec2 inv_screen_size;
+	float y_sign;
+	float near_plane, far_plane;
+	uint32_t input_downscale;
+	// perspective
+	float right_vec, up_vec;
+	vec2 shift;
+	// orthographic
+	vec2 half_extent;
+	// equirectangular
+	vec2 angle_scale;
+	// cubemap face
+	vec3 right_axis, up_axis, forward_axis;
+	vec2 ndc_scale;
+	
+	explicit cpu_camera_setup(const libwarp_camera_setup& setup) :
+	width(setup.screen_width), height(setup.screen_height),
+	screen_size { float(setup.screen_width), float(setup.screen_height) },
+	inv_screen_size { 1.0f / float(setup.screen_width), 1.0f / float(setup.screen_height) },
+	y_sign(setup.is_screen_origin_top_left ? -1.0f : 1.0f),
+	near_plane(setup.near_plane), far_plane(setup.far_plane),
+	input_downscale(setup.input_downscale) {
+		const auto aspect_ratio = screen_size.x / screen_size.y;
+		const auto up = tan(setup.field_of_view * (pi / 180.0f) * 0.5f);
+		right_vec = up * aspect_ratio;
+		up_vec = up * y_sign;
+		shift = { setup.frustum_shift_x, setup.frustum_shift_y * y_sign };
+		half_extent = { 0.5f * setup.ortho_height * aspect_ratio, 0.5f * setup.ortho_height * y_sign };
+		angle_scale = { 2.0f * pi, pi * y_sign };
+		static constexpr const vec3 face_axes[6][3] {
+			{ { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f } }, // +X
+			{ { 0.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f }, { -1.0f, 0.0f, 0.0f } }, // -X
+			{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f } }, // +Y
+			{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f, 0.0f } }, // -Y
+			{ { 1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } }, // +Z
+			{ { -1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } }, // -Z
+		};
+		const auto face = min(setup.cube_face, 5u);
+		right_axis = face_axes[face][0];
+		up_axis = face_axes[face][1];
+		forward_axis = face_axes[face][2];
+		ndc_scale = { aspect_ratio, y_sign };
+	}
+};
+
+// the projection and depth type are compile-time constants, so that no mode switch remains in the per-pixel code
+// (all of it can be inlined), the matching camera is selected once per warp (see dispatch_camera)
+template <LIBWARP_PROJECTION projection, LIBWARP_DEPTH_TYPE depth_type>
+struct cpu_camera : cpu_camera_setup {
+	using cpu_camera_setup::cpu_camera_setup;
+	
+	vec3 reconstruct_position(const vec2& coord, const float& linear_depth) const {
+		if constexpr (projection == LIBWARP_PROJECTION_PERSPECTIVE) {
+			const auto xy = (((coord + 0.5f) * 2.0f * inv_screen_size - 1.0f) + shift) * vec2 { right_vec, up_vec } * linear_depth;
+			return { xy.x, xy.y, -linear_depth };
+		} else if constexpr (projection == LIBWARP_PROJECTION_ORTHOGRAPHIC) {
+			const auto xy = ((coord + 0.5f) * 2.0f * inv_screen_size - 1.0f) * half_extent;
+			return { xy.x, xy.y, -linear_depth };
+		} else if constexpr (projection == LIBWARP_PROJECTION_EQUIRECTANGULAR) {
+			const auto angles = ((coord + 0.5f) * inv_screen_size - 0.5f) * angle_scale;
+			const auto cos_lat = cos(angles.y);
+			return vec3 { sin(angles.x) * cos_lat, sin(angles.y), -cos(angles.x) * cos_lat } * linear_depth;
+		} else {
+			static_assert(projection == LIBWARP_PROJECTION_CUBEMAP_FACE, "unhandled projection");
+			const auto ndc = ((coord + 0.5f) * 2.0f * inv_screen_size - 1.0f) * ndc_scale;
+			return (right_axis * ndc.x + up_axis * ndc.y + forward_axis) * linear_depth;
+		}
+	}
+	
+	vec2 reproject_position(const vec3& position) const {
+		if constexpr (projection == LIBWARP_PROJECTION_PERSPECTIVE) {
+			const auto proj_dst_coord = (vec2 { position.x / right_vec, position.y / up_vec } * (1.0f / -position.z)) - shift;
+			return ((proj_dst_coord * 0.5f + 0.5f) * screen_size);
+		} else if constexpr (projection == LIBWARP_PROJECTION_ORTHOGRAPHIC) {
+			return ((vec2 { position.x, position.y } * (vec2 { 0.5f, 0.5f } / half_extent) + 0.5f) * screen_size);
+		} else if constexpr (projection == LIBWARP_PROJECTION_EQUIRECTANGULAR) {
+			const vec2 angles {
+				atan2(position.x, -position.z),
+				asin(min(max(position.y / position.length(), -1.0f), 1.0f)),
+			};
+			return ((angles / angle_scale + 0.5f) * screen_size);
+		} else {
+			static_assert(projection == LIBWARP_PROJECTION_CUBEMAP_FACE, "unhandled projection");
+			const vec2 face_xy { position.dot(right_axis), position.dot(up_axis) };
+			const auto proj_dst_coord = (face_xy / ndc_scale) * (1.0f / position.dot(forward_axis));
+			return ((proj_dst_coord * 0.5f + 0.5f) * screen_size);
+		}
+	}
+	
+	template <LIBWARP_DEPTH_TYPE type = depth_type>
+	float linearize_depth(const float& depth) const {
+		if constexpr (type == LIBWARP_DEPTH_NORMALIZED) {
+			if constexpr (projection == LIBWARP_PROJECTION_ORTHOGRAPHIC) {
+				return (depth == 1.0f ? 1.0f : near_plane + depth * (far_plane - near_plane));
+			} else {
+				const vec2 near_far_projection {
+					-(far_plane + near_plane) / (near_plane - far_plane),
+					(2.0f * far_plane * near_plane) / (near_plane - far_plane),
+				};
+				return (depth == 1.0f ? 1.0f : near_far_projection.y / (depth - near_far_projection.x));
+			}
+		} else if constexpr (type == LIBWARP_DEPTH_Z_DIV_W) {
+			return depth + near_plane - (depth * (near_plane / far_plane));
+		} else {
+			return depth;
+		}
+	}
+};
+
+// calls 'func(cam)' with the cpu_camera that matches the projection and depth type of the camera setup
+// NOTE: unknown depth types are handled as linear depth
+template <typename func_type>
+static void dispatch_camera(const libwarp_camera_setup& setup, func_type&& func) {
+	const auto dispatch_depth_type = [&setup, &func](auto projection) {
+		constexpr const auto proj = decltype(projection)::value;
+		switch (setup.depth_type) {
+			case LIBWARP_DEPTH_NORMALIZED:
+				func(cpu_camera<proj, LIBWARP_DEPTH_NORMALIZED> { setup });
+				break;
+			case LIBWARP_DEPTH_Z_DIV_W:
+				func(cpu_camera<proj, LIBWARP_DEPTH_Z_DIV_W> { setup });
+				break;
+			case LIBWARP_DEPTH_LINEAR:
+			default:
+				func(cpu_camera<proj, LIBWARP_DEPTH_LINEAR> { setup });
+				break;
+		}
+	};
+	switch (setup.projection) {
+		case LIBWARP_PROJECTION_PERSPECTIVE:
+			dispatch_depth_type(integral_constant<LIBWARP_PROJECTION, LIBWARP_PROJECTION_PERSPECTIVE> {});
+			break;
+		case LIBWARP_PROJECTION_ORTHOGRAPHIC:
+			dispatch_depth_type(integral_constant<LIBWARP_PROJECTION, LIBWARP_PROJECTION_ORTHOGRAPHIC> {});
+			break;
+		case LIBWARP_PROJECTION_EQUIRECTANGULAR:
+			dispatch_depth_type(integral_constant<LIBWARP_PROJECTION, LIBWARP_PROJECTION_EQUIRECTANGULAR> {});
+			break;
+		case LIBWARP_PROJECTION_CUBEMAP_FACE:
+			dispatch_depth_type(integral_constant<LIBWARP_PROJECTION, LIBWARP_PROJECTION_CUBEMAP_FACE> {});
+			break;
+	}
+}
+
+//////////////////////////////////////////
+// motion decoding
+
+static vec3 decode_3d_motion(const uint32_t& encoded_motion) {
+	const auto sign = [&encoded_motion](const uint32_t bit) { return ((encoded_motion >> bit) & 1u) != 0u ? -1.0f : 1.0f; };
+	static const float log2_65 = log2(65.0f);
+	return {
+		sign(31u) * (exp2(float((encoded_motion >> 19u) & 0x3FFu) * (log2_65 / 1024.0f)) - 1.0f),
+		sign(30u) * (exp2(float((encoded_motion >> 10u) & 0x1FFu) * (log2_65 / 512.0f)) - 1.0f),
+		sign(29u) * (exp2(float(encoded_motion & 0x3FFu) * (log2_65 / 1024.0f)) - 1.0f),
+	};
+}
+
+static vec2 decode_2d_motion(const uint32_t& encoded_motion) {
+	// unpack_snorm_2x16(encoded_motion) * 0.5
+	const auto unpack = [](const uint16_t& val) { return max(float(int16_t(val)) / 32767.0f, -1.0f); };
+	return vec2 { unpack(uint16_t(encoded_motion & 0xFFFFu)), unpack(uint16_t(encoded_motion >> 16u)) } * 0.5f;
+}
+
+//////////////////////////////////////////
+// thread pool: rows are processed in chunks by all workers + the calling thread
+
+class cpu_thread_pool {
+public:
+	explicit cpu_thread_pool(const uint32_t thread_count) {
+		// the calling thread also works on the rows
+		for (uint32_t i = 1; i < thread_count; ++i) {
+			workers.emplace_back([this] { run_worker(); });
+		}
+	}
+	~cpu_thread_pool() {
+		{
+			unique_lock<mutex> guard(job_lock);
+			stop = true;
+		}
+		job_cv.notify_all();
+		for (auto& worker : workers) {
+			worker.join();
+		}
+	}
+	
+	uint32_t get_thread_count() const {
+		return uint32_t(workers.size()) + 1u;
+	}
+	
+	// calls 'func(first_row, end_row)' for all chunks of [0, row_count), returns once all rows have been processed
+	void parallel_rows(const uint32_t row_count, const function<void(uint32_t, uint32_t)>& func) {
+		{
+			unique_lock<mutex> guard(job_lock);
+			job = &func;
+			job_rows = row_count;
+			next_row = 0;
+			busy_workers = uint32_t(workers.size());
+			++generation;
+		}
+		job_cv.notify_all();
+		process_rows();
+		unique_lock<mutex> guard(job_lock);
+		done_cv.wait(guard, [this] { return (busy_workers == 0u); });
+		job = nullptr;
+	}
+	
+protected:
+	static constexpr const uint32_t chunk_rows { 8u };
+	vector<thread> workers;
+	mutex job_lock;
+	condition_variable job_cv;
+	condition_variable done_cv;
+	const function<void(uint32_t, uint32_t)>* job { nullptr };
+	uint32_t job_rows { 0u };
+	atomic<uint32_t> next_row { 0u };
+	uint32_t busy_workers { 0u };
+	uint64_t generation { 0u };
+	bool stop { false };
+	
+	void process_rows() {
+		for (;;) {
+			const auto first_row = next_row.fetch_add(chunk_rows);
+			if (first_row >= job_rows) {
+				return;
+			}
+			(*job)(first_row, min(first_row + chunk_rows, job_rows));
+		}
+	}
+	
+	void run_worker() {
+		uint64_t done_generation { 0u };
+		for (;;) {
+			{
+				unique_lock<mutex> guard(job_lock);
+				job_cv.wait(guard, [this, &done_generation] { return (stop || generation != done_generation); });
+				if (stop) {
+					return;
+				}
+				done_generation = generation;
+			}
+			process_rows();
+			{
+				unique_lock<mutex> guard(job_lock);
+				--busy_workers;
+			}
+			done_cv.notify_one();
+		}
+	}
+};
+
+// all CPU warp state, protected by cpu_lock (independent of the libfloor-based state)
+mutex cpu_lock;
+uint32_t cpu_thread_count { 0u };
+unique_ptr<cpu_thread_pool> cpu_pool;
+// scatter depth buffer (float bits, see libwarp_warp_scatter_depth)
+vector<atomic<uint32_t>> cpu_depth_buffer;
+
+static cpu_thread_pool& get_cpu_pool() {
+	if (!cpu_pool) {
+		cpu_pool = make_unique<cpu_thread_pool>(cpu_thread_count > 0u ? cpu_thread_count : max(thread::hardware_concurrency(), 1u));
+	}
+	return *cpu_pool;
+}
+
+static LIBWARP_ERROR_CODE validate_camera_setup(const libwarp_camera_setup* const camera_setup) {
+	if (camera_setup == nullptr) {
+		return LIBWARP_INVALID_CAMERA_SETUP;
+	}
+	if (camera_setup->screen_width == 0 || camera_setup->screen_height == 0) {
+		return LIBWARP_INVALID_SCREEN_DIM;
+	}
+	if (camera_setup->input_downscale != 1u && camera_setup->input_downscale != 2u && camera_setup->input_downscale != 4u) {
+		return LIBWARP_INVALID_INPUT_DOWNSCALE;
+	}
+	if (uint32_t(camera_setup->projection) > uint32_t(LIBWARP_PROJECTION_CUBEMAP_FACE) || camera_setup->cube_face >= 6u) {
+		return LIBWARP_INVALID_PROJECTION;
+	}
+	return LIBWARP_SUCCESS;
+}
+
+// checks that the image exists and has at least the specified dim and a large enough row pitch for the texel size
+static bool is_valid_image(const libwarp_cpu_image* const img, const uint32_t width, const uint32_t height, const size_t texel_size) {
+	return (img != nullptr && img->data != nullptr && img->width >= width && img->height >= height &&
+			img->row_pitch >= size_t(width) * texel_size);
+}
+
+//////////////////////////////////////////
+// scatter (see scatter(), warp_input::read_depth_and_motion and warp_splat::for_each_pixel)
+
+// NOTE: uses the default LIBWARP_UPSAMPLE_DEPTH_TOLERANCE, LIBWARP_SPLAT_MAX_FOOTPRINT and LIBWARP_SPLAT_DEPTH_TOLERANCE
+struct scattered_pixel {
+	// < 0 or >= screen dim if off-screen
+	int32_t x, y;
+	vec2 pos;
+	float linear_depth;
+};
+
+template <typename camera_type>
+static scattered_pixel cpu_scatter(const camera_type& cam, const int32_t x, const int32_t y, const float& delta,
+								   const cpu_image<float>& img_depth, const cpu_image<uint32_t>& img_motion) {
+	float linear_depth { 0.0f };
+	vec3 motion;
+	if (cam.input_downscale == 1u) {
+		linear_depth = cam.linearize_depth(img_depth.texel(x, y));
+		motion = decode_3d_motion(img_motion.texel(x, y));
+	} else {
+		// depth-edge-aware upsampling of the reduced resolution inputs
+		const auto scale = 1.0f / float(cam.input_downscale);
+		const vec2 p { (float(x) + 0.5f) * scale - 0.5f, (float(y) + 0.5f) * scale - 0.5f };
+		const vec2 p_floor { floor(p.x), floor(p.y) };
+		const auto frac = p - p_floor;
+		const int32_t base_x = int32_t(p_floor.x), base_y = int32_t(p_floor.y);
+		const int32_t input_width = int32_t((cam.width + cam.input_downscale - 1u) / cam.input_downscale);
+		const int32_t input_height = int32_t((cam.height + cam.input_downscale - 1u) / cam.input_downscale);
+		static constexpr const int32_t tap_offsets[4][2] { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } };
+		const float bilinear_weights[4] {
+			(1.0f - frac.x) * (1.0f - frac.y),
+			frac.x * (1.0f - frac.y),
+			(1.0f - frac.x) * frac.y,
+			frac.x * frac.y,
+		};
+		int32_t taps[4][2];
+		float depths[4];
+		float nearest_depth { 1.0e10f };
+		uint32_t nearest_tap { 0u };
+		for (uint32_t i = 0; i < 4u; ++i) {
+			taps[i][0] = min(max(base_x + tap_offsets[i][0], 0), input_width - 1);
+			taps[i][1] = min(max(base_y + tap_offsets[i][1], 0), input_height - 1);
+			depths[i] = cam.linearize_depth(img_depth.texel(taps[i][0], taps[i][1]));
+			if (depths[i] < nearest_depth) {
+				nearest_depth = depths[i];
+				nearest_tap = i;
+			}
+		}
+		float weight_sum { 0.0f };
+		for (uint32_t i = 0; i < 4u; ++i) {
+			// see LIBWARP_UPSAMPLE_DEPTH_TOLERANCE
+			const bool same_surface = (abs(depths[i] - nearest_depth) <= 0.05f * nearest_depth);
+			const float weight = (same_surface ? bilinear_weights[i] : 0.0f) + (i == nearest_tap ? 1.0e-4f : 0.0f);
+			linear_depth += weight * depths[i];
+			motion += weight * decode_3d_motion(img_motion.texel(taps[i][0], taps[i][1]));
+			weight_sum += weight;
+		}
+		linear_depth /= weight_sum;
+		motion = motion / weight_sum;
+	}
+	
+	const auto new_pos = cam.reconstruct_position(vec2 { float(x), float(y) }, linear_depth) + delta * motion;
+	const auto dst_pos = cam.reproject_position(new_pos);
+	// NOTE: float -> int conversion truncates towards zero, same as the float -> uint conversion in the kernel
+	const auto to_coord = [](const float& pos) { return (pos > -1.0f && pos < 2147483647.0f) ? int32_t(pos) : -1; };
+	return { to_coord(dst_pos.x), to_coord(dst_pos.y), dst_pos, linear_depth };
+}
+
+// calls 'func(dst_x, dst_y, test_depth)' for each on-screen pixel that is covered by the scattered pixel at (x, y)
+template <LIBWARP_SPLAT_MODE splat_mode, typename scatter_func_type, typename func_type>
+static void for_each_splat_pixel(const cpu_camera_setup& cam, const int32_t x, const int32_t y,
+								 scatter_func_type&& scatter_func, func_type&& func) {
+	const int32_t width = int32_t(cam.width), height = int32_t(cam.height);
+	const auto scattered = scatter_func(x, y);
+	if constexpr (splat_mode == LIBWARP_SPLAT_NONE) {
+		if (scattered.x >= 0 && scattered.x < width && scattered.y >= 0 && scattered.y < height) {
+			func(scattered.x, scattered.y, scattered.linear_depth);
+		}
+		return;
+	}
+	
+	// see LIBWARP_SPLAT_MAX_FOOTPRINT, LIBWARP_SPLAT_DEPTH_TOLERANCE and warp_splat::footprint_depth_scale
+	constexpr const int32_t max_footprint = (splat_mode == LIBWARP_SPLAT_2X2 ? 2 : 4);
+	vec2 half_extent { 1.0f, 1.0f };
+	if constexpr (splat_mode == LIBWARP_SPLAT_ADAPTIVE) {
+		vec2 dx { 1.0f, 0.0f }, dy { 0.0f, 1.0f };
+		const auto is_same_surface = [&scattered](const scattered_pixel& neighbor) {
+			return (abs(neighbor.linear_depth - scattered.linear_depth) <=
+					0.05f * min(neighbor.linear_depth, scattered.linear_depth));
+		};
+		if (x + 1 < width) {
+			const auto right = scatter_func(x + 1, y);
+			if (is_same_surface(right)) {
+				dx = right.pos - scattered.pos;
+			}
+		}
+		if (y + 1 < height) {
+			const auto bottom = scatter_func(x, y + 1);
+			if (is_same_surface(bottom)) {
+				dy = bottom.pos - scattered.pos;
+			}
+		}
+		half_extent = {
+			min(max(0.5f * (abs(dx.x) + abs(dy.x)), 0.5f), 0.5f * float(max_footprint)),
+			min(max(0.5f * (abs(dx.y) + abs(dy.y)), 0.5f), 0.5f * float(max_footprint)),
+		};
+	}
+	const int32_t center_x = int32_t(floor(scattered.pos.x)), center_y = int32_t(floor(scattered.pos.y));
+	const int32_t min_x = int32_t(ceil(scattered.pos.x - half_extent.x - 0.5f));
+	const int32_t min_y = int32_t(ceil(scattered.pos.y - half_extent.y - 0.5f));
+	const int32_t max_x = min(int32_t(floor(scattered.pos.x + half_extent.x - 0.5f)), min_x + max_footprint - 1);
+	const int32_t max_y = min(int32_t(floor(scattered.pos.y + half_extent.y - 0.5f)), min_y + max_footprint - 1);
+	for (int32_t py = max(min_y, 0); py <= min(max_y, height - 1); ++py) {
+		for (int32_t px = max(min_x, 0); px <= min(max_x, width - 1); ++px) {
+			const bool is_center = (px == center_x && py == center_y);
+			func(px, py, is_center ? scattered.linear_depth : scattered.linear_depth * 1.001f);
+		}
+	}
+}
+
+template <LIBWARP_SPLAT_MODE splat_mode, typename camera_type>
+static void cpu_exec_scatter(const camera_type& cam, const float delta, const bool clear_frame,
+							 const cpu_image<vec4>& img_color, const cpu_image<float>& img_depth,
+							 const cpu_image<uint32_t>& img_motion, const libwarp_cpu_image& output) {
+	auto& pool = get_cpu_pool();
+	const auto pixel_count = size_t(cam.width) * size_t(cam.height);
+	if (cpu_depth_buffer.size() != pixel_count) {
+		cpu_depth_buffer = vector<atomic<uint32_t>>(pixel_count);
+	}
+	const auto output_row = [&output](const uint32_t y) {
+		return (vec4*)((uint8_t*)output.data + size_t(y) * output.row_pitch);
+	};
+	const auto scatter_func = [&](const int32_t x, const int32_t y) {
+		return cpu_scatter(cam, x, y, delta, img_depth, img_motion);
+	};
+	
+	// clear
+	uint32_t clear_depth;
+	const float clear_depth_f = numeric_limits<float>::max();
+	memcpy(&clear_depth, &clear_depth_f, sizeof(clear_depth));
+	pool.parallel_rows(cam.height, [&](const uint32_t first_row, const uint32_t end_row) {
+		for (uint32_t y = first_row; y < end_row; ++y) {
+			auto depth_row = &cpu_depth_buffer[size_t(y) * cam.width];
+			for (uint32_t x = 0; x < cam.width; ++x) {
+				depth_row[x].store(clear_depth, memory_order_relaxed);
+			}
+			if (clear_frame) {
+				auto out = output_row(y);
+				for (uint32_t x = 0; x < cam.width; ++x) {
+					out[x] = {};
+				}
+			}
+		}
+	});
+	
+	// depth pass
+	pool.parallel_rows(cam.height, [&](const uint32_t first_row, const uint32_t end_row) {
+		for (uint32_t y = first_row; y < end_row; ++y) {
+			for (uint32_t x = 0; x < cam.width; ++x) {
+				for_each_splat_pixel<splat_mode>(cam, int32_t(x), int32_t(y), scatter_func, [&cam](const int32_t dst_x, const int32_t dst_y,
+																					   const float& linear_depth) {
+					// NOTE: same as the kernel: for values >= 0, the uint32_t min is the float min
+					uint32_t depth_bits;
+					memcpy(&depth_bits, &linear_depth, sizeof(depth_bits));
+					auto& dst_depth = cpu_depth_buffer[size_t(dst_y) * cam.width + size_t(dst_x)];
+					auto cur_depth = dst_depth.load(memory_order_relaxed);
+					while (depth_bits < cur_depth && !dst_depth.compare_exchange_weak(cur_depth, depth_bits, memory_order_relaxed)) {
+						// retry
+					}
+				});
+			}
+		}
+	});
+	
+	// color pass
+	pool.parallel_rows(cam.height, [&](const uint32_t first_row, const uint32_t end_row) {
+		for (uint32_t y = first_row; y < end_row; ++y) {
+			for (uint32_t x = 0; x < cam.width; ++x) {
+				for_each_splat_pixel<splat_mode>(cam, int32_t(x), int32_t(y), scatter_func, [&](const int32_t dst_x, const int32_t dst_y,
+																					const float& linear_depth) {
+					const auto depth_bits = cpu_depth_buffer[size_t(dst_y) * cam.width + size_t(dst_x)].load(memory_order_relaxed);
+					float depth;
+					memcpy(&depth, &depth_bits, sizeof(depth));
+					if (linear_depth > depth) {
+						return;
+					}
+					auto color = img_color.texel(int32_t(x), int32_t(y));
+					color.w = 1.0f; // px fixup
+					output_row(uint32_t(dst_y))[dst_x] = color;
+				});
+			}
+		}
+	});
+	
+	// single pixel fixup (see libwarp_single_px_fixup)
+	const cpu_image<vec4> img_out { output };
+	pool.parallel_rows(cam.height, [&](const uint32_t first_row, const uint32_t end_row) {
+		for (uint32_t y = first_row; y < end_row; ++y) {
+			for (uint32_t x = 0; x < cam.width; ++x) {
+				if (img_out.texel(int32_t(x), int32_t(y)).w >= 1.0f) {
+					continue;
+				}
+				const vec4 colors[] {
+					img_out.read_repeat_mirrored(int32_t(x), int32_t(y) - 1),
+					img_out.read_repeat_mirrored(int32_t(x) + 1, int32_t(y)),
+					img_out.read_repeat_mirrored(int32_t(x), int32_t(y) + 1),
+					img_out.read_repeat_mirrored(int32_t(x) - 1, int32_t(y)),
+				};
+				vec3 avg;
+				float sum = 0.0f;
+				for (const auto& col : colors) {
+					avg += vec3 { col.x, col.y, col.z } * col.w;
+					sum += col.w;
+				}
+				avg = avg * (1.0f / sum);
+				output_row(y)[x] = { avg.x, avg.y, avg.z, 1.0f };
+			}
+		}
+	});
+}
+
+//////////////////////////////////////////
+// gather (see gather_forward() and gather_bidirectional_resolve())
+
+//! see gather_search_iterations
+static constexpr const uint32_t gather_search_iterations { 6u };
+//! see TAP_COUNT
+static constexpr const uint32_t blur_tap_count { 21u };
+
+// see compute_coefficients()
+static const vector<float>& blur_coefficients() {
+	static const vector<float> coeffs = [] {
+		const auto binomial = [](const uint32_t n, const uint32_t k) {
+			long double ret = 1.0L;
+			for (uint32_t i = 1; i <= k; ++i) {
+				ret = ret * (long double)(n - k + i) / (long double)i;
+			}
+			return ret;
+		};
+		// find the effective row of pascal's triangle (see find_effective_n())
+		constexpr const auto min_contribution = 1.0L / 255.0L;
+		uint32_t effective_n = 0;
+		for (uint32_t count = blur_tap_count; count < 64u && effective_n == 0; count += 2) {
+			const long double sum_div = 1.0L / powl(2.0L, (long double)(count - 1));
+			for (uint32_t i = 0u; i <= count; ++i) {
+				if ((sum_div * binomial(count - 1u, i)) > min_contribution) {
+					if ((count - i * 2) >= blur_tap_count) {
+						effective_n = count;
+					}
+					break;
+				}
+			}
+		}
+		vector<float> ret(blur_tap_count);
+		const long double sum_div = 1.0L / powl(2.0L, (long double)(effective_n - 1));
+		for (uint32_t i = 0u, k = (effective_n - blur_tap_count) / 2u; i < blur_tap_count; ++i, ++k) {
+			ret[i] = float(sum_div * binomial(effective_n - 1, k));
+		}
+		return ret;
+	}();
+	return coeffs;
+}
+
+template <typename camera_type>
+static vec4 cpu_gather_forward(const camera_type& cam, const int32_t x, const int32_t y, const float& delta,
+							   const cpu_image<vec4>& img_color, const cpu_image<uint32_t>& img_motion) {
+	const auto displacement = [&](const vec2& p) {
+		return delta * decode_2d_motion(img_motion.read(p));
+	};
+	const vec2 p_init = (vec2 { float(x), float(y) } + 0.5f) * cam.inv_screen_size;
+	auto p_fwd = p_init;
+	vec4 fallback_color;
+	for (uint32_t i = 0; i < gather_search_iterations; ++i) {
+		p_fwd = p_init - displacement(p_fwd);
+		fallback_color += (1.0f / float(gather_search_iterations)) * read_linear_repeat_mirrored(img_color, p_fwd);
+	}
+	
+	const auto displacement_fwd = displacement(p_fwd);
+	const auto err_fwd = ((p_fwd + displacement_fwd - p_init).dot() + (p_fwd.is_outside_unit() ? 1.0e10f : 0.0f));
+	const float epsilon_1 { 0.00025f };
+	if (err_fwd >= epsilon_1 * epsilon_1) {
+		// directional blur in the motion direction of the pixel
+		const auto& coeffs = blur_coefficients();
+		const int32_t overlap = int32_t(blur_tap_count / 2u);
+		const auto dir = displacement_fwd * (1.0f / sqrt(displacement_fwd.dot()));
+		vec4 color;
+		for (int32_t i = -overlap; i <= overlap; ++i) {
+			color += coeffs[size_t(overlap + i)] * img_color.read(x + int32_t(float(i) * dir.x), y + int32_t(float(i) * dir.y));
+		}
+		return (color + fallback_color) * 0.5f;
+	}
+	return read_linear(img_color, p_fwd);
+}
+
+template <typename camera_type>
+static vec4 cpu_gather_bidirectional(const camera_type& cam, const int32_t x, const int32_t y, const float& delta,
+									 const cpu_image<vec4>& img_color, const cpu_image<float>& img_depth,
+									 const cpu_image<vec4>& img_color_prev, const cpu_image<float>& img_depth_prev,
+									 const cpu_image<uint32_t>& img_motion_forward, const cpu_image<uint32_t>& img_motion_backward,
+									 const cpu_image<vec2>& img_motion_depth_forward, const cpu_image<vec2>& img_motion_depth_backward) {
+	const auto read_motion_fwd = [&](const vec2& p) { return decode_2d_motion(img_motion_forward.read(p)); };
+	const auto read_motion_bwd = [&](const vec2& p) { return decode_2d_motion(img_motion_backward.read(p)); };
+	const auto read_depth_delta_fwd = [&](const vec2& p) { return img_motion_depth_forward.read(p).x; };
+	const auto read_depth_delta_bwd = [&](const vec2& p) { return img_motion_depth_backward.read(p).y; };
+	const auto linearize_depth_delta = [&cam](const float& depth_delta) {
+		return cam.template linearize_depth<LIBWARP_DEPTH_Z_DIV_W>(depth_delta);
+	};
+	
+	const vec2 p_init = (vec2 { float(x), float(y) } + 0.5f) * cam.inv_screen_size;
+	auto p_fwd = p_init + delta * read_motion_bwd(p_init);
+	auto p_bwd = p_init + (1.0f - delta) * read_motion_fwd(p_init);
+	for (uint32_t i = 0; i < gather_search_iterations; ++i) {
+		p_fwd = p_init - delta * read_motion_fwd(p_fwd);
+	}
+	for (uint32_t i = 0; i < gather_search_iterations; ++i) {
+		p_bwd = p_init - (1.0f - delta) * read_motion_bwd(p_bwd);
+	}
+	
+	const auto motion_fwd = read_motion_fwd(p_fwd);
+	const auto motion_bwd = read_motion_bwd(p_bwd);
+	const auto depth_fwd = read_depth_delta_fwd(p_fwd);
+	const auto depth_bwd = read_depth_delta_bwd(p_bwd);
+	
+	const auto err_fwd = ((p_fwd + delta * motion_fwd - p_init).dot() + (p_fwd.is_outside_unit() ? 1.0e10f : 0.0f));
+	const auto err_bwd = ((p_bwd + (1.0f - delta) * motion_bwd - p_init).dot() + (p_bwd.is_outside_unit() ? 1.0e10f : 0.0f));
+	const float epsilon_1 { 0.00025f };
+	const float epsilon_1_sq { epsilon_1 * epsilon_1 };
+	
+	const auto z_fwd = cam.linearize_depth(img_depth_prev.read(p_fwd)) + delta * linearize_depth_delta(depth_fwd);
+	const auto z_bwd = cam.linearize_depth(img_depth.read(p_bwd)) + (1.0f - delta) * linearize_depth_delta(depth_bwd);
+	const auto depth_diff = abs(z_fwd - z_bwd);
+	constexpr const float epsilon_2 { 2.0f };
+	
+	const auto projected_fwd = [&] {
+		return read_linear_repeat_mirrored(img_color_prev, p_fwd).interpolated(read_linear_repeat_mirrored(img_color, p_fwd + motion_fwd), delta);
+	};
+	const auto projected_bwd = [&] {
+		return read_linear_repeat_mirrored(img_color_prev, p_bwd + motion_bwd).interpolated(read_linear_repeat_mirrored(img_color, p_bwd), delta);
+	};
+	const bool fwd_valid = (err_fwd < epsilon_1_sq);
+	const bool bwd_valid = (err_bwd < epsilon_1_sq);
+	if (fwd_valid && bwd_valid) {
+		if (depth_diff < epsilon_2) {
+			return (err_fwd < err_bwd ? projected_fwd() : projected_bwd());
+		} else if (z_fwd < z_bwd) {
+			// NOTE: same as the kernel, the depth of the other frame isn't linearized here
+			const auto z_fwd_other = img_depth.read(p_fwd + motion_fwd) + (1.0f - delta) * read_depth_delta_bwd(p_fwd + motion_fwd);
+			return (abs(z_fwd - z_fwd_other) < epsilon_2 ? projected_fwd() : read_linear_repeat_mirrored(img_color_prev, p_fwd));
+		} else {
+			const auto z_bwd_other = img_depth_prev.read(p_bwd + motion_bwd) + delta * read_depth_delta_fwd(p_bwd + motion_bwd);
+			return (abs(z_bwd - z_bwd_other) < epsilon_2 ? projected_bwd() : read_linear_repeat_mirrored(img_color, p_bwd));
+		}
+	} else if (fwd_valid) {
+		return read_linear_repeat_mirrored(img_color_prev, p_fwd);
+	} else if (bwd_valid) {
+		return read_linear_repeat_mirrored(img_color, p_bwd);
+	}
+	return read_linear_repeat_mirrored(img_color_prev, p_fwd).interpolated(read_linear_repeat_mirrored(img_color, p_bwd), delta);
+}
+
+// runs 'func(x, y)' for all pixels of the camera setup and writes its result to the output image
+template <typename func_type>
+static void cpu_exec_per_pixel(const cpu_camera_setup& cam, const libwarp_cpu_image& output, func_type&& func) {
+	get_cpu_pool().parallel_rows(cam.height, [&](const uint32_t first_row, const uint32_t end_row) {
+		for (uint32_t y = first_row; y < end_row; ++y) {
+			auto out = (vec4*)((uint8_t*)output.data + size_t(y) * output.row_pitch);
+			for (uint32_t x = 0; x < cam.width; ++x) {
+				out[x] = func(int32_t(x), int32_t(y));
+			}
+		}
+	});
+}
+
+} // namespace
+
+LIBWARP_ERROR_CODE libwarp_scatter_cpu(const libwarp_camera_setup* const camera_setup,
+									   const float delta,
+									   const bool clear_frame,
+									   const libwarp_cpu_image* const color_image,
+									   const libwarp_cpu_image* const depth_image,
+									   const libwarp_cpu_image* const motion_image,
+									   const libwarp_cpu_image* output_image) {
+	if (const auto err = validate_camera_setup(camera_setup); err != LIBWARP_SUCCESS) {
+		return err;
+	}
+	const auto width = camera_setup->screen_width, height = camera_setup->screen_height;
+	const auto input_width = (width + camera_setup->input_downscale - 1u) / camera_setup->input_downscale;
+	const auto input_height = (height + camera_setup->input_downscale - 1u) / camera_setup->input_downscale;
+	if (!is_valid_image(color_image, width, height, sizeof(vec4)) ||
+		!is_valid_image(depth_image, input_width, input_height, sizeof(float)) ||
+		!is_valid_image(motion_image, input_width, input_height, sizeof(uint32_t)) ||
+		!is_valid_image(output_image, width, height, sizeof(vec4))) {
+		return LIBWARP_CPU_IMAGE_FAILURE;
+	}
+	
+	unique_lock<mutex> guard(cpu_lock);
+	const cpu_image<vec4> img_color { *color_image };
+	const cpu_image<float> img_depth { *depth_image };
+	const cpu_image<uint32_t> img_motion { *motion_image };
+	dispatch_camera(*camera_setup, [&](const auto& cam) {
+		switch (camera_setup->splat_mode) {
+			case LIBWARP_SPLAT_NONE:
+				cpu_exec_scatter<LIBWARP_SPLAT_NONE>(cam, delta, clear_frame, img_color, img_depth, img_motion, *output_image);
+				break;
+			case LIBWARP_SPLAT_2X2:
+			default:
+				cpu_exec_scatter<LIBWARP_SPLAT_2X2>(cam, delta, clear_frame, img_color, img_depth, img_motion, *output_image);
+				break;
+			case LIBWARP_SPLAT_ADAPTIVE:
+				cpu_exec_scatter<LIBWARP_SPLAT_ADAPTIVE>(cam, delta, clear_frame, img_color, img_depth, img_motion, *output_image);
+				break;
+		}
+	});
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_cpu(const libwarp_camera_setup* const camera_setup,
+									  const float delta,
+									  const libwarp_cpu_image* const color_current_image,
+									  const libwarp_cpu_image* const depth_current_image,
+									  const libwarp_cpu_image* const color_prev_image,
+									  const libwarp_cpu_image* const depth_prev_image,
+									  const libwarp_cpu_image* const motion_forward_image,
+									  const libwarp_cpu_image* const motion_backward_image,
+									  const libwarp_cpu_image* const motion_depth_forward_image,
+									  const libwarp_cpu_image* const motion_depth_backward_image,
+									  const libwarp_cpu_image* output_image) {
+	if (const auto err = validate_camera_setup(camera_setup); err != LIBWARP_SUCCESS) {
+		return err;
+	}
+	// NOTE: all inputs besides the output are sampled at normalized coordinates, so they may have any (non-zero) size
+	if (!is_valid_image(color_current_image, 1u, 1u, sizeof(vec4)) ||
+		!is_valid_image(depth_current_image, 1u, 1u, sizeof(float)) ||
+		!is_valid_image(color_prev_image, 1u, 1u, sizeof(vec4)) ||
+		!is_valid_image(depth_prev_image, 1u, 1u, sizeof(float)) ||
+		!is_valid_image(motion_forward_image, 1u, 1u, sizeof(uint32_t)) ||
+		!is_valid_image(motion_backward_image, 1u, 1u, sizeof(uint32_t)) ||
+		!is_valid_image(motion_depth_forward_image, 1u, 1u, sizeof(vec2)) ||
+		!is_valid_image(motion_depth_backward_image, 1u, 1u, sizeof(vec2)) ||
+		!is_valid_image(output_image, camera_setup->screen_width, camera_setup->screen_height, sizeof(vec4))) {
+		return LIBWARP_CPU_IMAGE_FAILURE;
+	}
+	
+	unique_lock<mutex> guard(cpu_lock);
+	const cpu_image<vec4> img_color { *color_current_image }, img_color_prev { *color_prev_image };
+	const cpu_image<float> img_depth { *depth_current_image }, img_depth_prev { *depth_prev_image };
+	const cpu_image<uint32_t> img_motion_forward { *motion_forward_image }, img_motion_backward { *motion_backward_image };
+	const cpu_image<vec2> img_motion_depth_forward { *motion_depth_forward_image };
+	const cpu_image<vec2> img_motion_depth_backward { *motion_depth_backward_image };
+	dispatch_camera(*camera_setup, [&](const auto& cam) {
+		cpu_exec_per_pixel(cam, *output_image, [&](const int32_t x, const int32_t y) {
+			return cpu_gather_bidirectional(cam, x, y, delta, img_color, img_depth, img_color_prev, img_depth_prev,
+											img_motion_forward, img_motion_backward, img_motion_depth_forward, img_motion_depth_backward);
+		});
+	});
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_forward_only_cpu(const libwarp_camera_setup* const camera_setup,
+												   const float delta,
+												   const libwarp_cpu_image* const color_image,
+												   const libwarp_cpu_image* const motion_image,
+												   const libwarp_cpu_image* output_image) {
+	if (const auto err = validate_camera_setup(camera_setup); err != LIBWARP_SUCCESS) {
+		return err;
+	}
+	if (!is_valid_image(color_image, 1u, 1u, sizeof(vec4)) ||
+		!is_valid_image(motion_image, 1u, 1u, sizeof(uint32_t)) ||
+		!is_valid_image(output_image, camera_setup->screen_width, camera_setup->screen_height, sizeof(vec4))) {
+		return LIBWARP_CPU_IMAGE_FAILURE;
+	}
+	
+	unique_lock<mutex> guard(cpu_lock);
+	const cpu_image<vec4> img_color { *color_image };
+	const cpu_image<uint32_t> img_motion { *motion_image };
+	dispatch_camera(*camera_setup, [&](const auto& cam) {
+		cpu_exec_per_pixel(cam, *output_image, [&](const int32_t x, const int32_t y) {
+			return cpu_gather_forward(cam, x, y, delta, img_color, img_motion);
+		});
+	});
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_set_cpu_thread_count(const uint32_t count) {
+	unique_lock<mutex> guard(cpu_lock);
+	if (count != cpu_thread_count) {
+		cpu_thread_count = count;
+		cpu_pool = nullptr; // recreated on next use
+	}
+	return LIBWARP_SUCCESS;
+}
+
+#if defined(LIBWARP_CPU_ONLY)
+// CPU-only builds: there are no programs to build, only validate the camera setup
+LIBWARP_ERROR_CODE libwarp_prebuild(const libwarp_camera_setup* const camera_setup) {
+	return validate_camera_setup(camera_setup);
+}
+
+void libwarp_cleanup() {
+	unique_lock<mutex> guard(cpu_lock);
+	cpu_depth_buffer.clear();
+}
+
+void libwarp_destroy() {
+	unique_lock<mutex> guard(cpu_lock);
+	cpu_depth_buffer.clear();
+	cpu_pool = nullptr;
+}
+#endif
@@ -0,0 +1,168 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "libwarp_internal.hpp"
+#include <libwarp/libwarp.hpp>
+
+namespace libwarp {
+
+LIBWARP_ERROR_CODE scatter(const libwarp_camera_setup& camera_setup,
+						   const float delta,
+						   const bool clear_frame,
+						   const scatter_images& images) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	libwarp_bind_scatter_floor(images.color.get(), images.depth.get(), images.motion.get(), images.output.get());
+	return libwarp_exec_scatter(&camera_setup, delta, clear_frame);
+}
+
+LIBWARP_ERROR_CODE gather(const libwarp_camera_setup& camera_setup,
+						  const float delta,
+						  const gather_images& images) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	const auto img_set = libwarp_bind_gather_floor(images.color_current.get(), images.depth_current.get(),
+												   images.color_prev.get(), images.depth_prev.get(),
+												   images.motion_forward.get(), images.motion_backward.get(),
+												   images.motion_depth_forward.get(), images.motion_depth_backward.get(),
+												   images.output.get());
+	return libwarp_exec_gather(&camera_setup, delta, img_set);
+}
+
+LIBWARP_ERROR_CODE gather_forward_only(const libwarp_camera_setup& camera_setup,
+									   const float delta,
+									   const gather_forward_only_images& images) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	libwarp_bind_gather_forward_only_floor(images.color.get(), images.motion.get(), images.output.get());
+	return libwarp_exec_gather_forward_only(&camera_setup, delta);
+}
+
+LIBWARP_ERROR_CODE scatter(const libwarp_camera_setup& camera_setup,
+						   std::span<const scatter_frame> frames) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	for (const auto& frame : frames) {
+		libwarp_bind_scatter_floor(frame.images.color.get(), frame.images.depth.get(),
+								   frame.images.motion.get(), frame.images.output.get());
+		if (const auto err = libwarp_exec_scatter(&camera_setup, frame.delta, frame.clear_frame); err != LIBWARP_SUCCESS) {
+			return err;
+		}
+	}
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE gather(const libwarp_camera_setup& camera_setup,
+						  std::span<const gather_frame> frames) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	for (const auto& frame : frames) {
+		const auto& images = frame.images;
+		const auto img_set = libwarp_bind_gather_floor(images.color_current.get(), images.depth_current.get(),
+													   images.color_prev.get(), images.depth_prev.get(),
+													   images.motion_forward.get(), images.motion_backward.get(),
+													   images.motion_depth_forward.get(), images.motion_depth_backward.get(),
+													   images.output.get());
+		if (const auto err = libwarp_exec_gather(&camera_setup, frame.delta, img_set); err != LIBWARP_SUCCESS) {
+			return err;
+		}
+	}
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE gather_forward_only(const libwarp_camera_setup& camera_setup,
+									   std::span<const gather_forward_only_frame> frames) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	for (const auto& frame : frames) {
+		libwarp_bind_gather_forward_only_floor(frame.images.color.get(), frame.images.motion.get(), frame.images.output.get());
+		if (const auto err = libwarp_exec_gather_forward_only(&camera_setup, frame.delta); err != LIBWARP_SUCCESS) {
+			return err;
+		}
+	}
+	return LIBWARP_SUCCESS;
+}
+
+// submits the specified job and wraps its handle in 'submitted_job'
+static LIBWARP_ERROR_CODE submit(unique_ptr<libwarp_job_t>&& warp_job,
+								 const LIBWARP_SUBMIT_MODE submit_mode,
+								 job& submitted_job) {
+	libwarp_job handle { 0 };
+	const auto err = libwarp_submit_job(std::move(warp_job), submit_mode, &handle);
+	if (err == LIBWARP_SUCCESS) {
+		submitted_job = job { handle };
+	}
+	return err;
+}
+
+LIBWARP_ERROR_CODE submit_scatter(const libwarp_camera_setup& camera_setup,
+								  const float delta,
+								  const bool clear_frame,
+								  const scatter_images& images,
+								  job& submitted_job,
+								  const LIBWARP_SUBMIT_MODE submit_mode) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	auto scatter_job = make_unique<libwarp_job_t>();
+	scatter_job->mode = libwarp_recording_t::MODE::SCATTER;
+	scatter_job->camera_setup = camera_setup;
+	scatter_job->delta = delta;
+	scatter_job->clear_frame = clear_frame;
+	scatter_job->images[LIBWARP_BINDING_COLOR] = images.color.get();
+	scatter_job->images[LIBWARP_BINDING_DEPTH] = images.depth.get();
+	scatter_job->images[LIBWARP_BINDING_MOTION] = images.motion.get();
+	scatter_job->images[LIBWARP_BINDING_OUTPUT] = images.output.get();
+	return submit(std::move(scatter_job), submit_mode, submitted_job);
+}
+
+LIBWARP_ERROR_CODE submit_gather(const libwarp_camera_setup& camera_setup,
+								 const float delta,
+								 const gather_images& images,
+								 job& submitted_job,
+								 const LIBWARP_SUBMIT_MODE submit_mode) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	auto gather_job = make_unique<libwarp_job_t>();
+	gather_job->mode = libwarp_recording_t::MODE::GATHER_BIDIRECTIONAL;
+	gather_job->camera_setup = camera_setup;
+	gather_job->delta = delta;
+	gather_job->images[LIBWARP_BINDING_COLOR] = images.color_current.get();
+	gather_job->images[LIBWARP_BINDING_DEPTH] = images.depth_current.get();
+	gather_job->images[LIBWARP_BINDING_COLOR_PREV] = images.color_prev.get();
+	gather_job->images[LIBWARP_BINDING_DEPTH_PREV] = images.depth_prev.get();
+	gather_job->images[LIBWARP_BINDING_MOTION] = images.motion_forward.get();
+	gather_job->images[LIBWARP_BINDING_MOTION_BACKWARD] = images.motion_backward.get();
+	gather_job->images[LIBWARP_BINDING_MOTION_DEPTH_FORWARD] = images.motion_depth_forward.get();
+	gather_job->images[LIBWARP_BINDING_MOTION_DEPTH_BACKWARD] = images.motion_depth_backward.get();
+	gather_job->images[LIBWARP_BINDING_OUTPUT] = images.output.get();
+	return submit(std::move(gather_job), submit_mode, submitted_job);
+}
+
+LIBWARP_ERROR_CODE submit_gather_forward_only(const libwarp_camera_setup& camera_setup,
+											  const float delta,
+											  const gather_forward_only_images& images,
+											  job& submitted_job,
+											  const LIBWARP_SUBMIT_MODE submit_mode) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	auto gather_job = make_unique<libwarp_job_t>();
+	gather_job->mode = libwarp_recording_t::MODE::GATHER_FORWARD_ONLY;
+	gather_job->camera_setup = camera_setup;
+	gather_job->delta = delta;
+	gather_job->images[LIBWARP_BINDING_COLOR] = images.color.get();
+	gather_job->images[LIBWARP_BINDING_MOTION] = images.motion.get();
+	gather_job->images[LIBWARP_BINDING_OUTPUT] = images.output.get();
+	return submit(std::move(gather_job), submit_mode, submitted_job);
+}
+
+} // namespace libwarp
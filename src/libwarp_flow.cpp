@@ -0,0 +1,119 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "libwarp_internal.hpp"
+
+// makes sure the luma pyramids and block motion images can hold the screen dim of the camera setup
+static LIBWARP_ERROR_CODE libwarp_alloc_flow(libwarp_state_struct::in_flight_slot& slot,
+											 const libwarp_camera_setup* const camera_setup) {
+	auto& flow = libwarp_state->flow;
+	const uint2 dim { camera_setup->screen_width, camera_setup->screen_height };
+	if (flow.dim == dim && flow.block_flow[0] != nullptr) {
+		return LIBWARP_SUCCESS;
+	}
+	
+	const auto create_image = [&slot](const uint2& image_dim, const COMPUTE_IMAGE_TYPE format) {
+		return libwarp_state->ctx->create_image(*slot.queue, uint4 { image_dim.x, image_dim.y, 0u, 0u },
+												COMPUTE_IMAGE_TYPE::IMAGE_2D | format | COMPUTE_IMAGE_TYPE::READ_WRITE,
+												COMPUTE_MEMORY_FLAG::READ_WRITE);
+	};
+	for (uint32_t level = 0; level < libwarp_flow_levels; ++level) {
+		const auto level_dim = libwarp_flow_level_dim(dim, level);
+		const auto block_count = (level_dim + (libwarp_flow_block_size - 1u)) / libwarp_flow_block_size;
+		flow.luma_src[level] = create_image(level_dim, COMPUTE_IMAGE_TYPE::R32F);
+		flow.luma_dst[level] = create_image(level_dim, COMPUTE_IMAGE_TYPE::R32F);
+		flow.block_flow[level] = create_image(block_count, COMPUTE_IMAGE_TYPE::RG32F);
+		if (flow.luma_src[level] == nullptr || flow.luma_dst[level] == nullptr || flow.block_flow[level] == nullptr) {
+			flow.luma_src = {};
+			flow.luma_dst = {};
+			flow.block_flow = {};
+			return LIBWARP_MOTION_ESTIMATION_FAILURE;
+		}
+	}
+	flow.dim = dim;
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_exec_estimate_motion(const libwarp_camera_setup* const camera_setup,
+												const bool invert_motion) {
+	auto& flow = libwarp_state->flow;
+	if (flow.color_src == nullptr || flow.color_dst == nullptr || flow.output == nullptr) {
+		return LIBWARP_MOTION_ESTIMATION_FAILURE;
+	}
+	const bool with_depth = (flow.depth_src != nullptr && flow.depth_dst != nullptr && flow.output_depth != nullptr);
+	
+	auto& slot = libwarp_acquire_slot();
+	slot.retain({ flow.color_src, flow.color_dst, flow.depth_src, flow.depth_dst, flow.output, flow.output_depth });
+	if (flow.slot != libwarp_state->cur_slot) {
+		// pyramids and block motion may still be in use by the last estimation on another slot
+		libwarp_finish_slot(libwarp_state->slots[flow.slot]);
+	}
+	flow.slot = libwarp_state->cur_slot;
+	if (const auto alloc_err = libwarp_alloc_flow(slot, camera_setup); alloc_err != LIBWARP_SUCCESS) {
+		return alloc_err;
+	}
+	
+	// luma pyramids of the source and target frame
+	auto err = LIBWARP_SUCCESS;
+	for (flow.frame = 0; flow.frame < 2u && err == LIBWARP_SUCCESS; ++flow.frame) {
+		libwarp_state->work_dim_override = {};
+		err = run_warp_kernel<KERNEL_FLOW_LUMA>(camera_setup, 0.0f);
+		for (flow.level = 1; flow.level < libwarp_flow_levels && err == LIBWARP_SUCCESS; ++flow.level) {
+			libwarp_state->work_dim_override = libwarp_flow_level_dim(flow.dim, flow.level);
+			err = run_warp_kernel<KERNEL_FLOW_DOWNSAMPLE>(camera_setup, 0.0f);
+		}
+	}
+	
+	// coarse-to-fine block search (one work-item per block)
+	for (uint32_t level = libwarp_flow_levels; level > 0 && err == LIBWARP_SUCCESS; --level) {
+		flow.level = level - 1u;
+		libwarp_state->work_dim_override = ((libwarp_flow_level_dim(flow.dim, flow.level) + (libwarp_flow_block_size - 1u)) /
+											libwarp_flow_block_size);
+		err = run_warp_kernel<KERNEL_FLOW_SEARCH>(camera_setup, 0.0f);
+	}
+	libwarp_state->work_dim_override = {};
+	
+	// per-pixel output
+	if (err == LIBWARP_SUCCESS) {
+		flow.motion_scale = (invert_motion ? -1.0f : 1.0f);
+		err = (with_depth ?
+			   run_warp_kernel<KERNEL_FLOW_OUTPUT_DEPTH>(camera_setup, 0.0f) :
+			   run_warp_kernel<KERNEL_FLOW_OUTPUT>(camera_setup, 0.0f));
+	}
+	return err;
+}
+
+LIBWARP_ERROR_CODE libwarp_estimate_motion_floor(const libwarp_camera_setup* const camera_setup,
+												 const bool invert_motion,
+												 shared_ptr<compute_image> color_src_texture,
+												 shared_ptr<compute_image> color_dst_texture,
+												 shared_ptr<compute_image> depth_src_texture,
+												 shared_ptr<compute_image> depth_dst_texture,
+												 shared_ptr<compute_image> motion_texture,
+												 shared_ptr<compute_image> motion_depth_texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	auto& flow = libwarp_state->flow;
+	flow.color_src = color_src_texture;
+	flow.color_dst = color_dst_texture;
+	flow.depth_src = depth_src_texture;
+	flow.depth_dst = depth_dst_texture;
+	flow.output = motion_texture;
+	flow.output_depth = motion_depth_texture;
+	return libwarp_exec_estimate_motion(camera_setup, invert_motion);
+}
@@ -0,0 +1,190 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "libwarp_internal.hpp"
+
+using host_output_entry = libwarp_state_struct::host_output_entry;
+
+static COMPUTE_IMAGE_TYPE libwarp_host_output_image_type(const LIBWARP_HOST_OUTPUT_FORMAT format) {
+	switch (format) {
+		case LIBWARP_HOST_OUTPUT_RGBA8: return COMPUTE_IMAGE_TYPE::RGBA8UI_NORM;
+		case LIBWARP_HOST_OUTPUT_RGBA16F: return COMPUTE_IMAGE_TYPE::RGBA16F;
+		case LIBWARP_HOST_OUTPUT_RGBA32F: return COMPUTE_IMAGE_TYPE::RGBA32F;
+	}
+	floor_unreachable();
+}
+
+static size_t libwarp_host_output_pixel_size(const LIBWARP_HOST_OUTPUT_FORMAT format) {
+	switch (format) {
+		case LIBWARP_HOST_OUTPUT_RGBA8: return 4u;
+		case LIBWARP_HOST_OUTPUT_RGBA16F: return 8u;
+		case LIBWARP_HOST_OUTPUT_RGBA32F: return 16u;
+	}
+	floor_unreachable();
+}
+
+// returns the ring entry of the specified frame if it is still alive and in the specified state
+static host_output_entry* libwarp_find_host_output(const uint32_t frame, const host_output_entry::STATE state) {
+	auto& ring = libwarp_state->host_output.ring;
+	if (ring.empty()) {
+		return nullptr;
+	}
+	auto& entry = ring[frame % uint32_t(ring.size())];
+	if (entry.frame != frame || entry.state != state) {
+		return nullptr;
+	}
+	return &entry;
+}
+
+LIBWARP_ERROR_CODE libwarp_acquire_host_output(const libwarp_camera_setup* const camera_setup,
+											   shared_ptr<compute_image>& output_image,
+											   uint32_t& frame) {
+	auto& host_output = libwarp_state->host_output;
+	if (host_output.ring.empty()) {
+		return LIBWARP_HOST_OUTPUT_FAILURE;
+	}
+	
+	auto& entry = host_output.ring[host_output.next_frame % uint32_t(host_output.ring.size())];
+	if (entry.state != host_output_entry::STATE::FREE) {
+		// consumer hasn't released this entry yet
+		return LIBWARP_HOST_OUTPUT_NOT_READY;
+	}
+	
+	const uint2 dim { camera_setup->screen_width, camera_setup->screen_height };
+	if (entry.image == nullptr || entry.dim != dim) {
+		// host-visible, so that mapping doesn't require a copy on unified memory/host-coherent devices
+		entry.image = libwarp_state->ctx->create_image(*libwarp_state->dev_queue, uint4 { dim.x, dim.y, 0u, 0u },
+													   COMPUTE_IMAGE_TYPE::IMAGE_2D |
+													   libwarp_host_output_image_type(host_output.format) |
+													   COMPUTE_IMAGE_TYPE::READ_WRITE,
+													   COMPUTE_MEMORY_FLAG::READ_WRITE | COMPUTE_MEMORY_FLAG::HOST_READ);
+		if (entry.image == nullptr) {
+			return LIBWARP_HOST_OUTPUT_FAILURE;
+		}
+		entry.dim = dim;
+	}
+	
+	entry.state = host_output_entry::STATE::ACQUIRED;
+	entry.frame = host_output.next_frame++;
+	output_image = entry.image;
+	frame = entry.frame;
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_acquire_host_output_floor(const libwarp_camera_setup* const camera_setup,
+													 shared_ptr<compute_image>* output_texture,
+													 uint32_t* frame) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	if (output_texture == nullptr || frame == nullptr) {
+		return LIBWARP_HOST_OUTPUT_FAILURE;
+	}
+	return libwarp_acquire_host_output(camera_setup, *output_texture, *frame);
+}
+
+LIBWARP_ERROR_CODE libwarp_set_host_output(const uint32_t ring_size, const LIBWARP_HOST_OUTPUT_FORMAT format) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	if (ring_size == 1u || ring_size > LIBWARP_MAX_HOST_OUTPUT_RING ||
+		format < LIBWARP_HOST_OUTPUT_RGBA8 || format > LIBWARP_HOST_OUTPUT_RGBA32F) {
+		return LIBWARP_HOST_OUTPUT_FAILURE;
+	}
+	
+	auto& host_output = libwarp_state->host_output;
+	for (const auto& entry : host_output.ring) {
+		if (entry.state != host_output_entry::STATE::FREE) {
+			return LIBWARP_HOST_OUTPUT_NOT_READY;
+		}
+	}
+	if (host_output.ring.size() == ring_size && host_output.format == format) {
+		return LIBWARP_SUCCESS;
+	}
+	
+	// previous ring images may still be referenced by in-flight work
+	libwarp_finish_slots();
+	host_output.ring.clear();
+	host_output.ring.resize(ring_size);
+	host_output.format = format;
+	host_output.next_frame = 0u;
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_commit_host_output(const uint32_t frame) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	auto entry = libwarp_find_host_output(frame, host_output_entry::STATE::ACQUIRED);
+	if (entry == nullptr) {
+		return LIBWARP_HOST_OUTPUT_FAILURE;
+	}
+	// the warp was executed on the current slot, so the slot also serves as the completion fence of this frame
+	entry->fence_slot = libwarp_state->cur_slot;
+	entry->state = host_output_entry::STATE::COMMITTED;
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_map_host_output(const uint32_t frame, const bool wait, libwarp_host_frame* host_frame) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	auto entry = libwarp_find_host_output(frame, host_output_entry::STATE::COMMITTED);
+	if (entry == nullptr || host_frame == nullptr) {
+		return LIBWARP_HOST_OUTPUT_FAILURE;
+	}
+	
+	auto& slot = libwarp_state->slots[entry->fence_slot];
+	if (slot.busy && !wait) {
+		return LIBWARP_HOST_OUTPUT_NOT_READY;
+	}
+	libwarp_finish_slot(slot);
+	
+	entry->mapped_ptr = entry->image->map(*libwarp_state->dev_queue, COMPUTE_MEMORY_MAP_FLAG::READ | COMPUTE_MEMORY_MAP_FLAG::BLOCK);
+	if (entry->mapped_ptr == nullptr) {
+		return LIBWARP_HOST_OUTPUT_FAILURE;
+	}
+	entry->state = host_output_entry::STATE::MAPPED;
+	
+	const auto format = libwarp_state->host_output.format;
+	*host_frame = {
+		.data = entry->mapped_ptr,
+		.width = entry->dim.x,
+		.height = entry->dim.y,
+		.row_pitch = libwarp_host_output_pixel_size(format) * entry->dim.x,
+		.format = format,
+	};
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_release_host_output(const uint32_t frame) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	auto& ring = libwarp_state->host_output.ring;
+	if (ring.empty()) {
+		return LIBWARP_HOST_OUTPUT_FAILURE;
+	}
+	auto& entry = ring[frame % uint32_t(ring.size())];
+	if (entry.frame != frame || entry.state == host_output_entry::STATE::FREE) {
+		return LIBWARP_HOST_OUTPUT_FAILURE;
+	}
+	
+	// NOTE: acquired/committed, but never mapped entries may also be released (e.g. frame dropped by the consumer)
+	auto success = true;
+	if (entry.state == host_output_entry::STATE::COMMITTED) {
+		// the warp must have completed before the entry can be handed out again
+		libwarp_finish_slot(libwarp_state->slots[entry.fence_slot]);
+	} else if (entry.state == host_output_entry::STATE::MAPPED) {
+		success = entry.image->unmap(*libwarp_state->dev_queue, entry.mapped_ptr);
+		entry.mapped_ptr = nullptr;
+	}
+	entry.state = host_output_entry::STATE::FREE;
+	return (success ? LIBWARP_SUCCESS : LIBWARP_HOST_OUTPUT_FAILURE);
+}
@@ -22,6 +22,8 @@
 #include <libwarp/libwarp.h>
 #include <floor/floor/floor.hpp>
 #include <floor/threading/thread_base.hpp>
+#include <optional>
+#include <chrono>
 
 //
 enum WARP_KERNEL : uint32_t {
@@ -31,6 +33,42 @@ enum WARP_KERNEL : uint32_t {
 	KERNEL_SCATTER_FIXUP,
 	KERNEL_GATHER_FORWARD_ONLY,
 	KERNEL_GATHER_BIDIRECTIONAL,
+	KERNEL_GATHER_FORWARD_ONLY_DEPTH,
+	KERNEL_SCATTER_DEPTH_PASS_ACCEL,
+	KERNEL_SCATTER_COLOR_DEPTH_TEST_ACCEL,
+	KERNEL_GATHER_FORWARD_ONLY_ACCEL,
+	KERNEL_SCATTER_DEPTH_PASS_UNIFIED,
+	KERNEL_SCATTER_COLOR_DEPTH_TEST_UNIFIED,
+	KERNEL_GATHER_FORWARD_ONLY_UNIFIED,
+	KERNEL_GATHER_BIDIRECTIONAL_UNIFIED,
+	KERNEL_SCATTER_DEPTH_PASS_LAYER2,
+	KERNEL_SCATTER_COLOR_DEPTH_TEST_LAYER2,
+	KERNEL_SCATTER_HISTORY_RESOLVE,
+	KERNEL_SCATTER_HISTORY_RESOLVE_CONFIDENCE,
+	KERNEL_SCATTER_HISTORY_RESOLVE_UNIFIED,
+	KERNEL_SCATTER_HISTORY_RESOLVE_UNIFIED_CONFIDENCE,
+	KERNEL_GATHER_FORWARD_ONLY_MOTION_BLUR,
+	KERNEL_GATHER_BIDIRECTIONAL_MOTION_BLUR,
+	KERNEL_COMPOSE_MOTION,
+	KERNEL_SCATTER_DEPTH_PASS_BAND,
+	KERNEL_SCATTER_COLOR_DEPTH_TEST_BAND,
+	KERNEL_FLOW_LUMA,
+	KERNEL_FLOW_DOWNSAMPLE,
+	KERNEL_FLOW_SEARCH,
+	KERNEL_FLOW_OUTPUT,
+	KERNEL_FLOW_OUTPUT_DEPTH,
+	KERNEL_GATHER_FORWARD_ONLY_BLOCK_MOTION,
+	KERNEL_GATHER_BIDIRECTIONAL_BLOCK_MOTION,
+	KERNEL_BLOCK_MOTION_RESOLVE,
+	KERNEL_SCATTER_CONFIDENCE,
+	KERNEL_GATHER_FORWARD_ONLY_CONFIDENCE,
+	KERNEL_GATHER_BIDIRECTIONAL_CONFIDENCE,
+	KERNEL_MERGE_TILES,
+	KERNEL_AUTO_TILE_STATS,
+	KERNEL_GATHER_AUTO,
+	KERNEL_DEPTH_PYRAMID_BASE,
+	KERNEL_DEPTH_PYRAMID_DOWNSAMPLE,
+	KERNEL_GATHER_BIDIRECTIONAL_DEPTH_PYRAMID,
 	KERNEL_DEBUG_DEPTH,
 	KERNEL_DEBUG_MOTION_2D,
 	KERNEL_DEBUG_MOTION_3D,
@@ -41,11 +79,42 @@ floor_inline_always static constexpr size_t warp_kernel_count() {
 	return (size_t)WARP_KERNEL::__MAX_WARP_KERNEL;
 }
 
+// amount of luma pyramid levels of the block-matching motion estimation
+static constexpr const uint32_t libwarp_flow_levels { 3u };
+// block size of the block-matching motion estimation (passed to the kernels as LIBWARP_FLOW_BLOCK_SIZE)
+static constexpr const uint32_t libwarp_flow_block_size { 8u };
+// amount of levels of the min/max depth pyramid of the bidirectional gather (passed to the kernels as LIBWARP_DEPTH_PYRAMID_LEVELS)
+static constexpr const uint32_t libwarp_depth_pyramid_levels { 5u };
+// returns the dim of the specified luma pyramid level
+floor_inline_always static uint2 libwarp_flow_level_dim(const uint2& dim, const uint32_t level) {
+	return (dim + ((1u << level) - 1u)) >> level;
+}
+// returns the dim of the specified depth pyramid level (must match warp_depth_pyramid::level_width/level_height)
+floor_inline_always static uint2 libwarp_depth_pyramid_level_dim(const uint2& dim, const uint32_t level) {
+	return (dim + ((1u << level) - 1u)) >> level;
+}
+
+// cost measurement of an auto mode warp: the completion handlers of all kernels of the warp update it on the queue,
+// so that costs can also be measured when execution isn't blocking
+struct libwarp_auto_measurement {
+	LIBWARP_WARP_MODE mode { LIBWARP_WARP_MODE_GATHER_BIDIRECTIONAL };
+	// estimated cost of the mixed mode when it was selected
+	float est_mixed_cost { 0.0f };
+	chrono::steady_clock::time_point start;
+	// amount of kernels that have been dispatched (libwarp_lock must be held) and that have completed (completion handlers)
+	uint32_t dispatched { 0u };
+	atomic<uint32_t> completed { 0u };
+	// time (in ms) from the start until the completion of the last completed kernel
+	atomic<float> cost { 0.0f };
+};
+
 struct libwarp_state_struct {
 	shared_ptr<compute_context> ctx;
 	const compute_device* dev { nullptr };
 	shared_ptr<compute_queue> dev_queue;
 	uint2 tile_size { 32, 16 }; // == 512 work-items which should work everywhere
+	// if non-zero, kernels are dispatched over this dim instead of the screen dim (e.g. streaming bands, flow pyramid levels)
+	uint2 work_dim_override;
 	bool did_init_libfloor { false };
 	
 	//
@@ -55,18 +124,76 @@ struct libwarp_state_struct {
 	};
 	vector<pair<libwarp_camera_setup, shared_ptr<camera_setup_program>>> programs;
 	
+	// each in-flight slot has its own queue and internal resources, so that consecutive warp jobs can overlap
+	struct in_flight_slot {
+		shared_ptr<compute_queue> queue;
+		shared_ptr<compute_buffer> depth_buffer;
+		// depth buffer of the second scatter layer (only allocated if two-layer scatter is used)
+		shared_ptr<compute_buffer> depth_buffer_layer2;
+		// low-confidence tile mask (one uint32_t per tile, only allocated if confidence output is enabled)
+		shared_ptr<compute_buffer> tile_mask;
+		// per-pixel gathered motion (one uint32_t per pixel) + resolved block motion (4 uint32_t per block),
+		// only allocated if block motion output is enabled
+		shared_ptr<compute_buffer> block_motion_pixels;
+		shared_ptr<compute_buffer> block_motion;
+		// auto mode per-tile warp modes + complex tile counter (only allocated if auto mode is used)
+		shared_ptr<compute_buffer> tile_modes;
+		// min/max depth pyramids of both bidirectional gather image sets (only allocated if the depth pyramid is enabled)
+		// NOTE: per slot, so that a pyramid is never rebuilt while a warp job on another slot still reads it
+		shared_ptr<compute_buffer> depth_pyramid[2];
+		// depth image and frame (see libwarp_state_struct::depth_pyramid) each pyramid was built from
+		shared_ptr<compute_image> depth_pyramid_built_from[2];
+		uint64_t depth_pyramid_built_frame[2] {};
+		// images that are referenced by not yet completed work on this slot
+		vector<shared_ptr<compute_image>> retained_images;
+		// true if work has been enqueued that hasn't been waited on yet
+		bool busy { false };
+		
+		// retains the specified images until the work on this slot has completed (no-op if execution is blocking)
+		// NOTE: images are only referenced here, so that nothing is copied/ref-counted when execution is blocking
+		void retain(initializer_list<reference_wrapper<const shared_ptr<compute_image>>> images);
+		void retain(const vector<shared_ptr<compute_image>>& images);
+	};
+	// always contains at least one slot, slot #0 uses dev_queue
+	vector<in_flight_slot> slots;
+	// slot that is used by the current warp job
+	uint32_t cur_slot { 0 };
+	
+	// slot that was used by the last job that produced confidence output
+	uint32_t confidence_slot { 0 };
+	// slot that was used by the last job that produced block motion output
+	uint32_t block_motion_slot { 0 };
+	
+	// returns true if kernels are executed asynchronously (in-flight count > 1)
+	bool is_async() const {
+		return (slots.size() > 1);
+	}
+	
 	//
 	struct {
 		shared_ptr<compute_image> color;
 		shared_ptr<compute_image> depth;
 		shared_ptr<compute_image> motion;
 		shared_ptr<compute_image> output;
-		shared_ptr<compute_buffer> depth_buffer;
+		// motion of the previous frame: if set, second-order extrapolation is used
+		shared_ptr<compute_image> motion_prev;
+		// if set, 'motion' contains unified motion
+		bool unified_motion { false };
+		// optional second layer (second-nearest surface): if set, it is scattered into the holes of the first layer
+		shared_ptr<compute_image> color_layer2;
+		shared_ptr<compute_image> depth_layer2;
+		shared_ptr<compute_image> motion_layer2;
 	} scatter;
 	struct {
 		shared_ptr<compute_image> color;
 		shared_ptr<compute_image> motion;
 		shared_ptr<compute_image> output;
+		// only used by the depth-aware variant
+		shared_ptr<compute_image> depth;
+		// motion of the previous frame: if set, second-order extrapolation is used
+		shared_ptr<compute_image> motion_prev;
+		// if set, 'motion' contains unified motion
+		bool unified_motion { false };
 	} gather_forward;
 	struct {
 		shared_ptr<compute_image> color[2];
@@ -74,6 +201,8 @@ struct libwarp_state_struct {
 		shared_ptr<compute_image> motion[4];
 		shared_ptr<compute_image> motion_depth[2];
 		shared_ptr<compute_image> output;
+		// if set, the unified motion of each frame is stored in motion[set * 2] (motion depth is unused)
+		bool unified_motion { false };
 	} gather;
 	
 	struct {
@@ -82,7 +211,207 @@ struct libwarp_state_struct {
 		shared_ptr<compute_image> motion;
 		shared_ptr<compute_image> motion_depth;
 	} debug;
+	
+	// scatter temporal hole filling (replaces the clear and fixup passes if enabled)
+	// NOTE: shared by all in-flight slots, since each warp job must build upon the history of the previous one
+	//       -> the history resolve of a job waits until the job that last wrote the history has completed
+	struct {
+		bool enabled { false };
+		// screen dim the history buffers were allocated for
+		uint2 dim;
+		// per-pixel <color.rgb, linear depth> of the last frame in which the pixel was covered
+		// NOTE: ping-ponged, the resolve reads the history of the previous job from [cur] and writes the updated one to [1 - cur]
+		shared_ptr<compute_buffer> colors[2];
+		// per-pixel amount of frames since the pixel was last covered (ping-ponged together with the colors)
+		shared_ptr<compute_buffer> ages[2];
+		uint32_t cur { 0 };
+		// slot of the last job that wrote the history
+		uint32_t slot { 0 };
+		// color input and delta of the last job (identity only, never dereferenced)
+		const compute_image* source { nullptr };
+		float delta { 0.0f };
+		// amount of frames the history must be reprojected by in the current job
+		float step { 0.0f };
+	} history;
+	
+	// motion blur parameters of the current motion blurred gather
+	struct {
+		float shutter { 0.5f };
+		uint32_t sample_count { 1u };
+	} motion_blur;
+	
+	// composed (long-range) motion fields, cached by their composition id
+	struct composed_motion {
+		uint64_t composition_id { 0 };
+		// screen dim of the composed motion
+		uint2 dim;
+		shared_ptr<compute_image> motion;
+		// slot of the composition that wrote the motion (must have completed before it is read on another slot)
+		uint32_t slot { 0 };
+	};
+	struct {
+		// most recently used first
+		vector<composed_motion> cache;
+		// intermediate compositions (only needed when composing more than two motion fields)
+		shared_ptr<compute_image> scratch;
+		uint2 scratch_dim;
+		// slot of the last composition that used the scratch image
+		uint32_t scratch_slot { 0 };
+		// images of the current composition step
+		shared_ptr<compute_image> first;
+		shared_ptr<compute_image> second;
+		shared_ptr<compute_image> output;
+		// wrapped input motion textures (Metal)
+		vector<shared_ptr<compute_image>> inputs;
+	} compose;
+	
+	// host output ring: host-visible output images that are handed out round-robin
+	struct host_output_entry {
+		enum class STATE : uint32_t {
+			FREE,
+			// handed out to be written by a warp
+			ACQUIRED,
+			// warp has been executed/enqueued on 'fence_slot'
+			COMMITTED,
+			// mapped for host access
+			MAPPED,
+		};
+		STATE state { STATE::FREE };
+		shared_ptr<compute_image> image;
+		uint2 dim;
+		uint32_t frame { 0u };
+		uint32_t fence_slot { 0u };
+		void* mapped_ptr { nullptr };
+	};
+	struct {
+		vector<host_output_entry> ring;
+		LIBWARP_HOST_OUTPUT_FORMAT format { LIBWARP_HOST_OUTPUT_RGBA8 };
+		// frame number of the next acquired entry (ring index == frame % ring size)
+		uint32_t next_frame { 0u };
+	} host_output;
+	
+	// streaming (out-of-core) scatter: the frame is processed in bands, only band-sized images/buffers are allocated
+	struct {
+		// current band: { src_row, src_rows, dst_row, dst_rows }
+		uint4 band;
+		// allocated dim of the input and output band images
+		uint2 input_dim;
+		uint2 output_dim;
+		// depth type the input depth band image was allocated for
+		LIBWARP_DEPTH_TYPE depth_type;
+		shared_ptr<compute_image> color;
+		shared_ptr<compute_image> depth;
+		shared_ptr<compute_image> motion;
+		shared_ptr<compute_image> output;
+	} stream;
+	
+	// block-matching motion estimation
+	struct {
+		// screen dim the pyramids were allocated for
+		uint2 dim;
+		// source/target luma pyramids and per-level block motion (finest level first)
+		array<shared_ptr<compute_image>, libwarp_flow_levels> luma_src;
+		array<shared_ptr<compute_image>, libwarp_flow_levels> luma_dst;
+		array<shared_ptr<compute_image>, libwarp_flow_levels> block_flow;
+		// slot of the last estimation that used the pyramids and block motion
+		uint32_t slot { 0 };
+		// inputs/outputs of the current estimation (depth inputs and motion depth output are optional)
+		shared_ptr<compute_image> color_src;
+		shared_ptr<compute_image> color_dst;
+		shared_ptr<compute_image> depth_src;
+		shared_ptr<compute_image> depth_dst;
+		shared_ptr<compute_image> output;
+		shared_ptr<compute_image> output_depth;
+		// 1 or -1 (inverted motion)
+		float motion_scale { 1.0f };
+		// current pyramid level and frame (0: source, 1: target)
+		uint32_t level { 0u };
+		uint32_t frame { 0u };
+	} flow;
+	
+	// optional confidence output (enabled if image is non-null)
+	struct {
+		shared_ptr<compute_image> image;
+	} confidence;
+	// optional block motion output (enabled if block_size is non-zero)
+	struct {
+		uint32_t block_size { 0u };
+		// color input that the motion refers to (current frame) and warp output of the last gather with block motion output
+		shared_ptr<compute_image> source;
+		shared_ptr<compute_image> output;
+	} block_motion;
+	// merging of re-rendered tiles
+	struct {
+		shared_ptr<compute_image> rerendered;
+		shared_ptr<compute_image> output;
+	} merge;
+	
+	// optional min/max depth pyramids of both bidirectional gather frames (one per image set and slot, see warp_depth_pyramid)
+	struct {
+		bool enabled { false };
+		// camera setup of the last gather that used the pyramids
+		libwarp_camera_setup camera_setup {};
+		// image set of the last gather: a different set means a new frame
+		uint32_t last_img_set { ~0u };
+		// frame counter and the frame in which the contents of each image set last changed
+		// (a slot pyramid that was built in an older frame must be rebuilt)
+		uint64_t frame { 0u };
+		uint64_t set_frame[2] {};
+		// current build target (in the current slot)
+		uint32_t img_set { 0u };
+		uint32_t level { 0u };
+	} depth_pyramid;
+	
+	// auto mode: measured costs (in ms, exponential moving average) of the gather kernels over the full screen
+	struct {
+		float cost_forward_only { 1.0f };
+		float cost_bidirectional { 2.0f };
+		// measured cost of the mixed kernel relative to the cost estimated from the pure kernels
+		float mixed_overhead { 1.1f };
+		// if set, all dispatched kernels contribute to this measurement (only set while an auto mode warp is executed)
+		shared_ptr<libwarp_auto_measurement> measurement;
+		// measurements of in-flight auto mode warps (folded into the costs once all of their kernels have completed)
+		vector<shared_ptr<libwarp_auto_measurement>> pending;
+	} auto_mode;
+	
+	// all currently alive recordings (see libwarp_recording_t::id)
+	vector<unique_ptr<libwarp_recording_t>> recordings;
+};
+
+// a recorded warp command sequence: programs, kernels and arguments are all resolved when recording,
+// replaying only needs to update the time delta
+struct libwarp_recording_t {
+	enum class MODE : uint32_t {
+		SCATTER,
+		GATHER_BIDIRECTIONAL,
+		GATHER_FORWARD_ONLY,
+	};
+	// handle of this recording (unique over the lifetime of the process, so that stale handles never alias)
+	libwarp_recording id { 0 };
+	MODE mode { MODE::SCATTER };
+	bool clear_frame { false };
+	libwarp_camera_setup camera_setup {};
+	
+	// program of the camera setup (keeps the kernels alive)
+	shared_ptr<libwarp_state_struct::camera_setup_program> program;
+	// all images that are referenced by this recording (indexed by LIBWARP_BINDING)
+	array<shared_ptr<compute_image>, LIBWARP_BINDING_COUNT> images;
+	// scatter only: recording-owned depth buffer
+	shared_ptr<compute_buffer> depth_buffer;
+	// slot of the last replay
+	uint32_t slot { 0 };
+	
+	struct command {
+		const compute_kernel* kernel { nullptr };
+		compute_queue::execution_parameters_t params;
+		// index of the delta parameter in params.args (< 0 if the kernel has no delta parameter)
+		int32_t delta_arg_idx { -1 };
+		// if set, the depth buffer must be cleared before executing this command
+		bool clear_depth_buffer { false };
+	};
+	vector<command> commands;
 };
+
 // contains all global state, can simply be cleared by setting to nullptr
 extern unique_ptr<libwarp_state_struct> libwarp_state;
 // none of the libwarp functions are able to run concurrently, must protect them via a global lock
@@ -100,6 +429,251 @@ LIBWARP_ERROR_CODE libwarp_init();
 pair<LIBWARP_ERROR_CODE, shared_ptr<libwarp_state_struct::camera_setup_program>>
 libwarp_build(const libwarp_camera_setup* const camera_setup);
 
+// checks if the camera setup is valid (screen dim, input downscale, projection)
+LIBWARP_ERROR_CODE libwarp_check_camera_setup(const libwarp_camera_setup* const camera_setup);
+
+// returns true if both camera setups are equal (compared field-wise, since the struct contains padding)
+// NOTE: must be updated when fields are added to libwarp_camera_setup
+bool libwarp_is_same_camera_setup(const libwarp_camera_setup& lhs, const libwarp_camera_setup& rhs);
+
+// compiles the warp program for a specific camera setup, without adding it to the program cache
+// NOTE: doesn't access libwarp_state, so this can be called from any thread without holding libwarp_lock
+pair<LIBWARP_ERROR_CODE, shared_ptr<libwarp_state_struct::camera_setup_program>>
+libwarp_compile_program(compute_context& ctx, const uint2& tile_size, const libwarp_camera_setup* const camera_setup);
+
+// if the camera setup is part of an async prebuild, waits until its program has been built and returns it,
+// returns an empty optional if it isn't (-> must be built synchronously)
+// NOTE: libwarp_lock must be held
+optional<pair<LIBWARP_ERROR_CODE, shared_ptr<libwarp_state_struct::camera_setup_program>>>
+libwarp_take_prebuilt_program(const libwarp_camera_setup* const camera_setup);
+
+// cancels all pending async prebuilds and drops all prebuilt programs that haven't been taken yet
+// NOTE: libwarp_lock must be held, setups that are currently being built are finished, but their programs are dropped
+void libwarp_cancel_prebuild();
+
+// cancels all pending async prebuilds and stops the prebuild worker threads
+// NOTE: libwarp_lock must *not* be held
+void libwarp_stop_prebuild();
+
+// advances to the next in-flight slot, waiting for previous work on it to complete if necessary
+// NOTE: libwarp_lock must be held
+libwarp_state_struct::in_flight_slot& libwarp_acquire_slot();
+
+// waits for all in-flight work of the specified slot to complete and releases its retained resources
+// NOTE: libwarp_lock must be held
+void libwarp_finish_slot(libwarp_state_struct::in_flight_slot& slot);
+
+// waits for all in-flight work to complete and releases all retained resources
+// NOTE: libwarp_lock must be held
+void libwarp_finish_slots();
+
+// makes sure the scatter depth buffer of the specified slot can hold the screen dim of the camera setup
+LIBWARP_ERROR_CODE libwarp_alloc_depth_buffer(libwarp_state_struct::in_flight_slot& slot,
+											  const libwarp_camera_setup* const camera_setup);
+
+// binds 'img' to the specified state image: the state only takes (shared) ownership if the bound image actually changes,
+// so that re-binding the same images every frame doesn't cause any ref-count traffic
+inline void libwarp_bind_image(shared_ptr<compute_image>& bound_img, const shared_ptr<compute_image>& img) {
+	if (bound_img != img) {
+		bound_img = img;
+	}
+}
+
+// binds the specified images to the scatter/gather/forward-only gather state
+void libwarp_bind_scatter_floor(const shared_ptr<compute_image>& color_texture,
+								const shared_ptr<compute_image>& depth_texture,
+								const shared_ptr<compute_image>& motion_texture,
+								const shared_ptr<compute_image>& output_texture);
+void libwarp_bind_scatter_accel_floor(const shared_ptr<compute_image>& color_texture,
+									  const shared_ptr<compute_image>& depth_texture,
+									  const shared_ptr<compute_image>& motion_texture,
+									  const shared_ptr<compute_image>& motion_prev_texture,
+									  const shared_ptr<compute_image>& output_texture);
+void libwarp_bind_scatter_unified_floor(const shared_ptr<compute_image>& color_texture,
+										const shared_ptr<compute_image>& depth_texture,
+										const shared_ptr<compute_image>& motion_texture,
+										const shared_ptr<compute_image>& output_texture);
+void libwarp_bind_scatter_two_layer_floor(const shared_ptr<compute_image>& color_texture,
+										  const shared_ptr<compute_image>& depth_texture,
+										  const shared_ptr<compute_image>& motion_texture,
+										  const shared_ptr<compute_image>& color_layer2_texture,
+										  const shared_ptr<compute_image>& depth_layer2_texture,
+										  const shared_ptr<compute_image>& motion_layer2_texture,
+										  const shared_ptr<compute_image>& output_texture);
+// NOTE: returns the image set that must be used
+uint32_t libwarp_bind_gather_floor(const shared_ptr<compute_image>& color_current_texture,
+								   const shared_ptr<compute_image>& depth_current_texture,
+								   const shared_ptr<compute_image>& color_prev_texture,
+								   const shared_ptr<compute_image>& depth_prev_texture,
+								   const shared_ptr<compute_image>& motion_forward_texture,
+								   const shared_ptr<compute_image>& motion_backward_texture,
+								   const shared_ptr<compute_image>& motion_depth_forward_texture,
+								   const shared_ptr<compute_image>& motion_depth_backward_texture,
+								   const shared_ptr<compute_image>& output_texture);
+uint32_t libwarp_bind_gather_unified_floor(const shared_ptr<compute_image>& color_current_texture,
+										   const shared_ptr<compute_image>& depth_current_texture,
+										   const shared_ptr<compute_image>& color_prev_texture,
+										   const shared_ptr<compute_image>& depth_prev_texture,
+										   const shared_ptr<compute_image>& motion_current_texture,
+										   const shared_ptr<compute_image>& motion_prev_texture,
+										   const shared_ptr<compute_image>& output_texture);
+void libwarp_bind_gather_forward_only_floor(const shared_ptr<compute_image>& color_texture,
+											const shared_ptr<compute_image>& motion_texture,
+											const shared_ptr<compute_image>& output_texture);
+void libwarp_bind_gather_forward_only_accel_floor(const shared_ptr<compute_image>& color_texture,
+												  const shared_ptr<compute_image>& motion_texture,
+												  const shared_ptr<compute_image>& motion_prev_texture,
+												  const shared_ptr<compute_image>& output_texture);
+void libwarp_bind_gather_forward_only_unified_floor(const shared_ptr<compute_image>& color_texture,
+													const shared_ptr<compute_image>& motion_texture,
+													const shared_ptr<compute_image>& output_texture);
+void libwarp_bind_gather_forward_only_depth_floor(const shared_ptr<compute_image>& color_texture,
+												  const shared_ptr<compute_image>& depth_texture,
+												  const shared_ptr<compute_image>& motion_texture,
+												  const shared_ptr<compute_image>& output_texture);
+
+// returns true if any of the optional warp features is enabled (confidence output, block motion output, scatter history,
+// depth pyramid), none of which is supported by the specialized warp modes
+// NOTE: libwarp_lock must be held
+bool libwarp_has_enabled_features();
+
+// executes all kernels of the specified warp mode with the currently bound images (backend independent part)
+// if "cancelled" is non-null and set, no further kernels will be executed and LIBWARP_JOB_CANCELLED is returned
+// NOTE: libwarp_lock must be held
+LIBWARP_ERROR_CODE libwarp_exec_scatter(const libwarp_camera_setup* const camera_setup,
+										const float delta,
+										const bool clear_frame,
+										const atomic<bool>* cancelled = nullptr);
+LIBWARP_ERROR_CODE libwarp_exec_gather(const libwarp_camera_setup* const camera_setup,
+									   const float delta,
+									   const uint32_t img_set,
+									   const atomic<bool>* cancelled = nullptr);
+LIBWARP_ERROR_CODE libwarp_exec_gather_forward_only(const libwarp_camera_setup* const camera_setup,
+													const float delta,
+													const atomic<bool>* cancelled = nullptr);
+LIBWARP_ERROR_CODE libwarp_exec_gather_forward_only_depth(const libwarp_camera_setup* const camera_setup,
+														  const float delta);
+// motion blurred gather: averages 'sample_count' sub-frame warps over [delta - shutter / 2, delta + shutter / 2]
+LIBWARP_ERROR_CODE libwarp_exec_gather_motion_blur(const libwarp_camera_setup* const camera_setup,
+												   const float delta,
+												   const float shutter,
+												   const uint32_t sample_count,
+												   const uint32_t img_set);
+LIBWARP_ERROR_CODE libwarp_exec_gather_forward_only_motion_blur(const libwarp_camera_setup* const camera_setup,
+																const float delta,
+																const float shutter,
+																const uint32_t sample_count);
+// composes the specified consecutive 2D motion fields into a single motion field, which is cached under 'composition_id'
+// (no-op if it is already cached)
+LIBWARP_ERROR_CODE libwarp_exec_compose_motion(const libwarp_camera_setup* const camera_setup,
+											   const uint64_t composition_id,
+											   const vector<shared_ptr<compute_image>>& motion_textures);
+// returns the cached composed motion field of the specified composition id (or nullptr if it isn't cached)
+const libwarp_state_struct::composed_motion* libwarp_find_composed_motion(const libwarp_camera_setup* const camera_setup,
+																		 const uint64_t composition_id);
+// forward-only gather with the bound color/output images, using the cached composed motion field
+LIBWARP_ERROR_CODE libwarp_exec_gather_forward_only_composed(const libwarp_camera_setup* const camera_setup,
+															 const uint64_t composition_id,
+															 const float delta);
+// streaming scatter: warps the frame band by band, streaming inputs/outputs through the specified callbacks
+LIBWARP_ERROR_CODE libwarp_exec_scatter_streaming(const libwarp_camera_setup* const camera_setup,
+												  const float delta,
+												  const uint32_t band_height,
+												  const float max_displacement,
+												  const libwarp_stream_callbacks* const callbacks);
+// estimates the 2D motion from the bound flow source to target frame (see libwarp_estimate_motion_metal)
+LIBWARP_ERROR_CODE libwarp_exec_estimate_motion(const libwarp_camera_setup* const camera_setup,
+												const bool invert_motion);
+// auto mode: computes per-tile statistics, selects the warp mode and executes it using the bound gather images
+LIBWARP_ERROR_CODE libwarp_exec_auto(const libwarp_camera_setup* const camera_setup,
+									 const float delta,
+									 const uint32_t img_set,
+									 LIBWARP_WARP_MODE* selected_mode);
+// replaces all low-confidence tiles of the bound output image with the tiles of the bound re-rendered image
+LIBWARP_ERROR_CODE libwarp_exec_merge(const libwarp_camera_setup* const camera_setup);
+
+// an asynchronously submitted warp job (executed by the job worker thread)
+struct libwarp_job_t {
+	libwarp_job id { 0 };
+	// reuses the recording modes and bindings
+	libwarp_recording_t::MODE mode { libwarp_recording_t::MODE::SCATTER };
+	libwarp_camera_setup camera_setup {};
+	float delta { 0.0f };
+	bool clear_frame { false };
+	array<shared_ptr<compute_image>, LIBWARP_BINDING_COUNT> images;
+	
+	// set when the job is cancelled or superseded
+	atomic<bool> cancelled { false };
+	// set once the job has been executed or dropped (protected by the job lock)
+	bool done { false };
+	LIBWARP_ERROR_CODE result { LIBWARP_SUCCESS };
+};
+
+// submits a job to the job worker thread (starting it if necessary)
+// NOTE: libwarp_lock may be held
+LIBWARP_ERROR_CODE libwarp_submit_job(unique_ptr<libwarp_job_t>&& job,
+									  const LIBWARP_SUBMIT_MODE submit_mode,
+									  libwarp_job* job_handle);
+
+// destroys all imported Vulkan images/semaphores (nop if Vulkan isn't used or supported)
+// NOTE: libwarp_lock must be held and all in-flight work must have completed
+void libwarp_vulkan_cleanup();
+
+// cancels all pending jobs and stops the job worker thread
+// NOTE: libwarp_lock must *not* be held
+void libwarp_stop_job_worker();
+
+// makes sure the second layer depth buffer of the specified slot is large enough for the camera setup
+LIBWARP_ERROR_CODE libwarp_alloc_depth_buffer_layer2(libwarp_state_struct::in_flight_slot& slot,
+													 const libwarp_camera_setup* const camera_setup);
+
+// makes sure the scatter history buffers can hold the screen dim of the camera setup (history is reset if it changes)
+LIBWARP_ERROR_CODE libwarp_alloc_history(libwarp_state_struct::in_flight_slot& slot,
+										 const libwarp_camera_setup* const camera_setup);
+
+// makes sure the low-confidence tile mask of the specified slot can hold all tiles of the camera setup
+LIBWARP_ERROR_CODE libwarp_alloc_tile_mask(libwarp_state_struct::in_flight_slot& slot,
+										   const libwarp_camera_setup* const camera_setup);
+
+// makes sure the block motion buffers of the specified slot can hold all blocks of the camera setup
+LIBWARP_ERROR_CODE libwarp_alloc_block_motion(libwarp_state_struct::in_flight_slot& slot,
+											  const libwarp_camera_setup* const camera_setup);
+
+// returns the amount of blocks in x and y direction for the specified camera setup and block motion block size
+uint2 libwarp_block_motion_count(const libwarp_camera_setup* const camera_setup, const uint32_t block_size);
+
+// resolves the block motion that was accumulated by the last gather into the per-block output
+// NOTE: must be executed on the same slot as the gather
+LIBWARP_ERROR_CODE libwarp_exec_block_motion_resolve(const libwarp_camera_setup* const camera_setup);
+
+// acquires the next host output ring entry and (re)allocates its image for the camera setup if necessary
+// NOTE: libwarp_lock must be held
+LIBWARP_ERROR_CODE libwarp_acquire_host_output(const libwarp_camera_setup* const camera_setup,
+											   shared_ptr<compute_image>& output_image,
+											   uint32_t& frame);
+
+// returns the amount of tiles in x and y direction for the specified camera setup
+uint2 libwarp_tile_count(const libwarp_camera_setup* const camera_setup);
+
+// records the command sequence of the specified warp mode for the specified images (backend independent part)
+// NOTE: libwarp_lock must be held
+LIBWARP_ERROR_CODE libwarp_record(const libwarp_camera_setup* const camera_setup,
+								  const libwarp_recording_t::MODE mode,
+								  const bool clear_frame,
+								  array<shared_ptr<compute_image>, LIBWARP_BINDING_COUNT>&& images,
+								  libwarp_recording* recording);
+
+// returns the alive recording of the specified handle (or nullptr if it is invalid or has already been destroyed)
+// NOTE: libwarp_lock must be held
+libwarp_recording_t* libwarp_find_recording(const libwarp_recording recording);
+
+// returns true if the specified binding is used by the recording (and can thus be rebound)
+bool libwarp_is_recording_binding(const libwarp_recording_t& recording, const LIBWARP_BINDING binding);
+
+// (re-)encodes all commands of a recording from its current images
+// NOTE: libwarp_lock must be held
+LIBWARP_ERROR_CODE libwarp_encode_recording(libwarp_recording_t& recording);
+
 // runs the specified warp kernel, all inlined and DCE'ed
 template <WARP_KERNEL kernel_idx>
 floor_inline_always LIBWARP_ERROR_CODE run_warp_kernel(const libwarp_camera_setup* const camera_setup,
@@ -111,27 +685,31 @@ floor_inline_always LIBWARP_ERROR_CODE run_warp_kernel(const libwarp_camera_setu
 		return prog.first;
 	}
 	
-	// global work-size == round screen dim to tile size
-	const auto global_work_size = uint2(camera_setup->screen_width,
-										camera_setup->screen_height).rounded_next_multiple(libwarp_state->tile_size);
+	// global work-size == round screen dim (or the work dim override) to tile size
+	const auto global_work_size = (libwarp_state->work_dim_override.x > 0u ?
+								   libwarp_state->work_dim_override :
+								   uint2(camera_setup->screen_width,
+										 camera_setup->screen_height)).rounded_next_multiple(libwarp_state->tile_size);
 	
+	auto& slot = libwarp_state->slots[libwarp_state->cur_slot];
 	compute_queue::execution_parameters_t exec_params {
 		.execution_dim = 2,
 		.global_work_size = global_work_size,
 		.local_work_size = libwarp_state->tile_size,
 		.args = {},
-		// all kernels must be blocking in here
-		.wait_until_completion = true,
+		// all kernels must be blocking in here, unless multiple jobs may be in flight
+		// (in which case the slot is only waited on when it is reused or on libwarp_finish)
+		.wait_until_completion = !libwarp_state->is_async(),
 	};
 	switch (kernel_idx) {
 		case KERNEL_SCATTER_DEPTH_PASS: {
 			const float clear_depth = numeric_limits<float>::max();
-			libwarp_state->scatter.depth_buffer->fill(*libwarp_state->dev_queue, &clear_depth, sizeof(clear_depth));
+			slot.depth_buffer->fill(*slot.queue, &clear_depth, sizeof(clear_depth));
 			
 			exec_params.args = {
 				libwarp_state->scatter.depth,
 				libwarp_state->scatter.motion,
-				libwarp_state->scatter.depth_buffer,
+				slot.depth_buffer,
 				delta
 			};
 			break;
@@ -142,7 +720,7 @@ floor_inline_always LIBWARP_ERROR_CODE run_warp_kernel(const libwarp_camera_setu
 				libwarp_state->scatter.depth,
 				libwarp_state->scatter.motion,
 				libwarp_state->scatter.output,
-				libwarp_state->scatter.depth_buffer,
+				slot.depth_buffer,
 				delta
 			};
 			break;
@@ -155,6 +733,363 @@ floor_inline_always LIBWARP_ERROR_CODE run_warp_kernel(const libwarp_camera_setu
 		case KERNEL_SCATTER_FIXUP:
 			exec_params.args = { libwarp_state->scatter.output };
 			break;
+		case KERNEL_SCATTER_DEPTH_PASS_ACCEL: {
+			const float clear_depth = numeric_limits<float>::max();
+			slot.depth_buffer->fill(*slot.queue, &clear_depth, sizeof(clear_depth));
+			
+			exec_params.args = {
+				libwarp_state->scatter.depth,
+				libwarp_state->scatter.motion,
+				libwarp_state->scatter.motion_prev,
+				slot.depth_buffer,
+				delta
+			};
+			break;
+		}
+		case KERNEL_SCATTER_COLOR_DEPTH_TEST_ACCEL:
+			exec_params.args = {
+				libwarp_state->scatter.color,
+				libwarp_state->scatter.depth,
+				libwarp_state->scatter.motion,
+				libwarp_state->scatter.motion_prev,
+				libwarp_state->scatter.output,
+				slot.depth_buffer,
+				delta
+			};
+			break;
+		case KERNEL_GATHER_FORWARD_ONLY_ACCEL:
+			exec_params.args = {
+				libwarp_state->gather_forward.color,
+				libwarp_state->gather_forward.motion,
+				libwarp_state->gather_forward.motion_prev,
+				libwarp_state->gather_forward.output,
+				delta
+			};
+			break;
+		case KERNEL_SCATTER_DEPTH_PASS_UNIFIED: {
+			const float clear_depth = numeric_limits<float>::max();
+			slot.depth_buffer->fill(*slot.queue, &clear_depth, sizeof(clear_depth));
+			
+			exec_params.args = {
+				libwarp_state->scatter.depth,
+				libwarp_state->scatter.motion,
+				slot.depth_buffer,
+				delta
+			};
+			break;
+		}
+		case KERNEL_SCATTER_COLOR_DEPTH_TEST_UNIFIED:
+			exec_params.args = {
+				libwarp_state->scatter.color,
+				libwarp_state->scatter.depth,
+				libwarp_state->scatter.motion,
+				libwarp_state->scatter.output,
+				slot.depth_buffer,
+				delta
+			};
+			break;
+		case KERNEL_GATHER_FORWARD_ONLY_UNIFIED:
+			exec_params.args = {
+				libwarp_state->gather_forward.color,
+				libwarp_state->gather_forward.motion,
+				libwarp_state->gather_forward.output,
+				delta
+			};
+			break;
+		case KERNEL_GATHER_BIDIRECTIONAL_UNIFIED:
+			exec_params.args = {
+				libwarp_state->gather.color[img_set],
+				libwarp_state->gather.depth[img_set],
+				libwarp_state->gather.color[1u - img_set],
+				libwarp_state->gather.depth[1u - img_set],
+				libwarp_state->gather.motion[img_set * 2],
+				libwarp_state->gather.motion[(1u - img_set) * 2],
+				libwarp_state->gather.output,
+				delta
+			};
+			break;
+		case KERNEL_SCATTER_DEPTH_PASS_LAYER2: {
+			const float clear_depth = numeric_limits<float>::max();
+			slot.depth_buffer_layer2->fill(*slot.queue, &clear_depth, sizeof(clear_depth));
+			
+			exec_params.args = {
+				libwarp_state->scatter.depth_layer2,
+				libwarp_state->scatter.motion_layer2,
+				slot.depth_buffer,
+				slot.depth_buffer_layer2,
+				delta
+			};
+			break;
+		}
+		case KERNEL_SCATTER_COLOR_DEPTH_TEST_LAYER2:
+			exec_params.args = {
+				libwarp_state->scatter.color_layer2,
+				libwarp_state->scatter.depth_layer2,
+				libwarp_state->scatter.motion_layer2,
+				libwarp_state->scatter.output,
+				slot.depth_buffer,
+				slot.depth_buffer_layer2,
+				delta
+			};
+			break;
+		case KERNEL_GATHER_FORWARD_ONLY_MOTION_BLUR:
+			exec_params.args = {
+				libwarp_state->gather_forward.color,
+				libwarp_state->gather_forward.motion,
+				libwarp_state->gather_forward.output,
+				delta,
+				libwarp_state->motion_blur.shutter,
+				libwarp_state->motion_blur.sample_count
+			};
+			break;
+		case KERNEL_GATHER_BIDIRECTIONAL_MOTION_BLUR:
+			exec_params.args = {
+				libwarp_state->gather.color[img_set],
+				libwarp_state->gather.depth[img_set],
+				libwarp_state->gather.color[1u - img_set],
+				libwarp_state->gather.depth[1u - img_set],
+				libwarp_state->gather.motion[img_set * 2],
+				libwarp_state->gather.motion[img_set * 2 + 1],
+				libwarp_state->gather.motion_depth[img_set],
+				libwarp_state->gather.motion_depth[1u - img_set],
+				libwarp_state->gather.output,
+				delta,
+				libwarp_state->motion_blur.shutter,
+				libwarp_state->motion_blur.sample_count
+			};
+			break;
+		case KERNEL_COMPOSE_MOTION:
+			exec_params.args = {
+				libwarp_state->compose.first,
+				libwarp_state->compose.second,
+				libwarp_state->compose.output,
+			};
+			break;
+		case KERNEL_SCATTER_DEPTH_PASS_BAND: {
+			const float clear_depth = numeric_limits<float>::max();
+			slot.depth_buffer->fill(*slot.queue, &clear_depth, sizeof(clear_depth));
+			
+			exec_params.args = {
+				libwarp_state->stream.depth,
+				libwarp_state->stream.motion,
+				slot.depth_buffer,
+				delta,
+				libwarp_state->stream.band
+			};
+			break;
+		}
+		case KERNEL_SCATTER_COLOR_DEPTH_TEST_BAND:
+			exec_params.args = {
+				libwarp_state->stream.color,
+				libwarp_state->stream.depth,
+				libwarp_state->stream.motion,
+				libwarp_state->stream.output,
+				slot.depth_buffer,
+				delta,
+				libwarp_state->stream.band
+			};
+			break;
+		case KERNEL_FLOW_LUMA: {
+			const auto& flow = libwarp_state->flow;
+			exec_params.args = {
+				flow.frame == 0u ? flow.color_src : flow.color_dst,
+				flow.frame == 0u ? flow.luma_src[0] : flow.luma_dst[0],
+			};
+			break;
+		}
+		case KERNEL_FLOW_DOWNSAMPLE: {
+			const auto& flow = libwarp_state->flow;
+			const auto& pyramid = (flow.frame == 0u ? flow.luma_src : flow.luma_dst);
+			exec_params.args = {
+				pyramid[flow.level - 1u],
+				pyramid[flow.level],
+				libwarp_flow_level_dim(flow.dim, flow.level - 1u),
+			};
+			break;
+		}
+		case KERNEL_FLOW_SEARCH: {
+			const auto& flow = libwarp_state->flow;
+			const bool is_coarsest = (flow.level + 1u == libwarp_flow_levels);
+			exec_params.args = {
+				flow.luma_src[flow.level],
+				flow.luma_dst[flow.level],
+				// NOTE: not read at the coarsest level
+				flow.block_flow[is_coarsest ? 0u : flow.level + 1u],
+				flow.block_flow[flow.level],
+				libwarp_flow_level_dim(flow.dim, flow.level),
+				uint32_t(is_coarsest ? 1u : 0u),
+			};
+			break;
+		}
+		case KERNEL_FLOW_OUTPUT:
+			exec_params.args = {
+				libwarp_state->flow.block_flow[0],
+				libwarp_state->flow.output,
+				libwarp_state->flow.motion_scale,
+			};
+			break;
+		case KERNEL_FLOW_OUTPUT_DEPTH:
+			exec_params.args = {
+				libwarp_state->flow.block_flow[0],
+				libwarp_state->flow.depth_src,
+				libwarp_state->flow.depth_dst,
+				libwarp_state->flow.output,
+				libwarp_state->flow.output_depth,
+				libwarp_state->flow.motion_scale,
+			};
+			break;
+		case KERNEL_GATHER_FORWARD_ONLY_DEPTH:
+			exec_params.args = {
+				libwarp_state->gather_forward.color,
+				libwarp_state->gather_forward.depth,
+				libwarp_state->gather_forward.motion,
+				libwarp_state->gather_forward.output,
+				delta
+			};
+			break;
+		case KERNEL_SCATTER_HISTORY_RESOLVE:
+		case KERNEL_SCATTER_HISTORY_RESOLVE_UNIFIED: {
+			const auto& history = libwarp_state->history;
+			exec_params.args = {
+				libwarp_state->scatter.output,
+				slot.depth_buffer,
+				(libwarp_state->scatter.color_layer2 != nullptr ? slot.depth_buffer_layer2 : slot.depth_buffer),
+				history.colors[history.cur],
+				history.ages[history.cur],
+				history.colors[1u - history.cur],
+				history.ages[1u - history.cur],
+				libwarp_state->scatter.motion,
+				history.step,
+			};
+			break;
+		}
+		case KERNEL_GATHER_FORWARD_ONLY_BLOCK_MOTION:
+		case KERNEL_GATHER_BIDIRECTIONAL_BLOCK_MOTION: {
+			// NOTE: every pixel is written by the gather -> no clear necessary
+			libwarp_state->block_motion_slot = libwarp_state->cur_slot;
+			
+			if (kernel_idx == KERNEL_GATHER_FORWARD_ONLY_BLOCK_MOTION) {
+				exec_params.args = {
+					libwarp_state->gather_forward.color,
+					libwarp_state->gather_forward.motion,
+					libwarp_state->gather_forward.output,
+					slot.block_motion_pixels,
+					delta
+				};
+			} else {
+				exec_params.args = {
+					libwarp_state->gather.color[img_set],
+					libwarp_state->gather.depth[img_set],
+					libwarp_state->gather.color[1u - img_set],
+					libwarp_state->gather.depth[1u - img_set],
+					libwarp_state->gather.motion[img_set * 2],
+					libwarp_state->gather.motion[img_set * 2 + 1],
+					libwarp_state->gather.motion_depth[img_set],
+					libwarp_state->gather.motion_depth[1u - img_set],
+					libwarp_state->gather.output,
+					slot.block_motion_pixels,
+					delta
+				};
+			}
+			break;
+		}
+		case KERNEL_BLOCK_MOTION_RESOLVE:
+			exec_params.args = {
+				libwarp_state->block_motion.source,
+				libwarp_state->block_motion.output,
+				slot.block_motion_pixels,
+				slot.block_motion,
+				libwarp_state->block_motion.block_size
+			};
+			break;
+		case KERNEL_SCATTER_CONFIDENCE:
+		case KERNEL_SCATTER_HISTORY_RESOLVE_CONFIDENCE:
+		case KERNEL_SCATTER_HISTORY_RESOLVE_UNIFIED_CONFIDENCE:
+		case KERNEL_GATHER_FORWARD_ONLY_CONFIDENCE:
+		case KERNEL_GATHER_BIDIRECTIONAL_CONFIDENCE: {
+			const uint32_t clear_mask = 0u;
+			slot.tile_mask->fill(*slot.queue, &clear_mask, sizeof(clear_mask));
+			libwarp_state->confidence_slot = libwarp_state->cur_slot;
+			
+			if (kernel_idx == KERNEL_SCATTER_CONFIDENCE) {
+				exec_params.args = {
+					slot.depth_buffer,
+					(libwarp_state->scatter.color_layer2 != nullptr ? slot.depth_buffer_layer2 : slot.depth_buffer),
+					libwarp_state->confidence.image,
+					slot.tile_mask,
+				};
+			} else if (kernel_idx == KERNEL_SCATTER_HISTORY_RESOLVE_CONFIDENCE ||
+					   kernel_idx == KERNEL_SCATTER_HISTORY_RESOLVE_UNIFIED_CONFIDENCE) {
+				const auto& history = libwarp_state->history;
+				exec_params.args = {
+					libwarp_state->scatter.output,
+					slot.depth_buffer,
+					(libwarp_state->scatter.color_layer2 != nullptr ? slot.depth_buffer_layer2 : slot.depth_buffer),
+					history.colors[history.cur],
+					history.ages[history.cur],
+					history.colors[1u - history.cur],
+					history.ages[1u - history.cur],
+					libwarp_state->scatter.motion,
+					history.step,
+					libwarp_state->confidence.image,
+					slot.tile_mask,
+				};
+			} else if (kernel_idx == KERNEL_GATHER_FORWARD_ONLY_CONFIDENCE) {
+				exec_params.args = {
+					libwarp_state->gather_forward.color,
+					libwarp_state->gather_forward.motion,
+					libwarp_state->gather_forward.output,
+					libwarp_state->confidence.image,
+					slot.tile_mask,
+					delta
+				};
+			} else {
+				exec_params.args = {
+					libwarp_state->gather.color[img_set],
+					libwarp_state->gather.depth[img_set],
+					libwarp_state->gather.color[1u - img_set],
+					libwarp_state->gather.depth[1u - img_set],
+					libwarp_state->gather.motion[img_set * 2],
+					libwarp_state->gather.motion[img_set * 2 + 1],
+					libwarp_state->gather.motion_depth[img_set],
+					libwarp_state->gather.motion_depth[1u - img_set],
+					libwarp_state->gather.output,
+					libwarp_state->confidence.image,
+					slot.tile_mask,
+					delta
+				};
+			}
+			break;
+		}
+		case KERNEL_AUTO_TILE_STATS:
+			exec_params.args = {
+				libwarp_state->gather.motion[img_set * 2],
+				libwarp_state->gather.motion[img_set * 2 + 1],
+				slot.tile_modes,
+			};
+			break;
+		case KERNEL_GATHER_AUTO:
+			exec_params.args = {
+				libwarp_state->gather.color[img_set],
+				libwarp_state->gather.depth[img_set],
+				libwarp_state->gather.color[1u - img_set],
+				libwarp_state->gather.depth[1u - img_set],
+				libwarp_state->gather.motion[img_set * 2],
+				libwarp_state->gather.motion[img_set * 2 + 1],
+				libwarp_state->gather.motion_depth[img_set],
+				libwarp_state->gather.motion_depth[1u - img_set],
+				libwarp_state->gather.output,
+				slot.tile_modes,
+				delta
+			};
+			break;
+		case KERNEL_MERGE_TILES:
+			exec_params.args = {
+				libwarp_state->merge.rerendered,
+				libwarp_state->slots[libwarp_state->confidence_slot].tile_mask,
+				libwarp_state->merge.output,
+			};
+			break;
 		case KERNEL_GATHER_FORWARD_ONLY:
 			exec_params.args = {
 				libwarp_state->gather_forward.color,
@@ -163,6 +1098,38 @@ floor_inline_always LIBWARP_ERROR_CODE run_warp_kernel(const libwarp_camera_setu
 				delta
 			};
 			break;
+		case KERNEL_DEPTH_PYRAMID_BASE: {
+			const auto& depth_pyramid = libwarp_state->depth_pyramid;
+			exec_params.args = {
+				libwarp_state->gather.depth[depth_pyramid.img_set],
+				slot.depth_pyramid[depth_pyramid.img_set],
+			};
+			break;
+		}
+		case KERNEL_DEPTH_PYRAMID_DOWNSAMPLE: {
+			const auto& depth_pyramid = libwarp_state->depth_pyramid;
+			exec_params.args = {
+				slot.depth_pyramid[depth_pyramid.img_set],
+				depth_pyramid.level,
+			};
+			break;
+		}
+		case KERNEL_GATHER_BIDIRECTIONAL_DEPTH_PYRAMID:
+			exec_params.args = {
+				libwarp_state->gather.color[img_set],
+				libwarp_state->gather.depth[img_set],
+				libwarp_state->gather.color[1u - img_set],
+				libwarp_state->gather.depth[1u - img_set],
+				libwarp_state->gather.motion[img_set * 2],
+				libwarp_state->gather.motion[img_set * 2 + 1],
+				libwarp_state->gather.motion_depth[img_set],
+				libwarp_state->gather.motion_depth[1u - img_set],
+				slot.depth_pyramid[img_set],
+				slot.depth_pyramid[1u - img_set],
+				libwarp_state->gather.output,
+				delta
+			};
+			break;
 		case KERNEL_GATHER_BIDIRECTIONAL:
 			exec_params.args = {
 				libwarp_state->gather.color[img_set],
@@ -204,7 +1171,17 @@ floor_inline_always LIBWARP_ERROR_CODE run_warp_kernel(const libwarp_camera_setu
 		default:
 			return LIBWARP_NO_KERNEL;
 	}
-	libwarp_state->dev_queue->execute_with_parameters(*prog.second->kernels[kernel_idx], exec_params);
+	if (auto measurement = libwarp_state->auto_mode.measurement; measurement != nullptr) {
+		++measurement->dispatched;
+		slot.queue->execute_with_parameters(*prog.second->kernels[kernel_idx], exec_params, [measurement] {
+			// NOTE: kernels of a queue complete in order, so the last completion determines the cost
+			measurement->cost = chrono::duration<float, milli>(chrono::steady_clock::now() - measurement->start).count();
+			++measurement->completed;
+		});
+	} else {
+		slot.queue->execute_with_parameters(*prog.second->kernels[kernel_idx], exec_params);
+	}
+	slot.busy = libwarp_state->is_async();
 	return LIBWARP_SUCCESS;
 }
 
@@ -0,0 +1,258 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "libwarp_internal.hpp"
+#include <libwarp/libwarp.hpp>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
+
+// job state is independent of libwarp_state, since the worker must be stopped before libwarp_state is destroyed
+// NOTE: lock order is libwarp_lock -> job_lock (the worker never holds job_lock while acquiring libwarp_lock)
+static struct {
+	mutex job_lock;
+	condition_variable job_cv;
+	// jobs that haven't been picked up by the worker yet (in submission order)
+	deque<shared_ptr<libwarp_job_t>> pending;
+	// all jobs that haven't been waited on or released yet
+	unordered_map<libwarp_job, shared_ptr<libwarp_job_t>> jobs;
+	// job that is currently being executed by the worker
+	shared_ptr<libwarp_job_t> running;
+	libwarp_job next_id { 1 };
+	unique_ptr<thread> worker;
+	bool shutdown { false };
+} libwarp_jobs;
+
+static void libwarp_job_worker() {
+	for (;;) {
+		shared_ptr<libwarp_job_t> job;
+		{
+			unique_lock<mutex> lock(libwarp_jobs.job_lock);
+			libwarp_jobs.job_cv.wait(lock, [] { return (libwarp_jobs.shutdown || !libwarp_jobs.pending.empty()); });
+			if (libwarp_jobs.shutdown) {
+				return;
+			}
+			job = libwarp_jobs.pending.front();
+			libwarp_jobs.pending.pop_front();
+			libwarp_jobs.running = job;
+		}
+		
+		// superseded/cancelled jobs are dropped before dispatch
+		auto result = LIBWARP_JOB_CANCELLED;
+		if (!job->cancelled) {
+			GUARD(libwarp_lock);
+			if (libwarp_state == nullptr) {
+				result = LIBWARP_ERROR;
+			} else {
+				switch (job->mode) {
+					case libwarp_recording_t::MODE::SCATTER:
+						libwarp_bind_scatter_floor(job->images[LIBWARP_BINDING_COLOR],
+												   job->images[LIBWARP_BINDING_DEPTH],
+												   job->images[LIBWARP_BINDING_MOTION],
+												   job->images[LIBWARP_BINDING_OUTPUT]);
+						result = libwarp_exec_scatter(&job->camera_setup, job->delta, job->clear_frame, &job->cancelled);
+						break;
+					case libwarp_recording_t::MODE::GATHER_BIDIRECTIONAL: {
+						const auto img_set = libwarp_bind_gather_floor(job->images[LIBWARP_BINDING_COLOR],
+																	   job->images[LIBWARP_BINDING_DEPTH],
+																	   job->images[LIBWARP_BINDING_COLOR_PREV],
+																	   job->images[LIBWARP_BINDING_DEPTH_PREV],
+																	   job->images[LIBWARP_BINDING_MOTION],
+																	   job->images[LIBWARP_BINDING_MOTION_BACKWARD],
+																	   job->images[LIBWARP_BINDING_MOTION_DEPTH_FORWARD],
+																	   job->images[LIBWARP_BINDING_MOTION_DEPTH_BACKWARD],
+																	   job->images[LIBWARP_BINDING_OUTPUT]);
+						result = libwarp_exec_gather(&job->camera_setup, job->delta, img_set, &job->cancelled);
+						break;
+					}
+					case libwarp_recording_t::MODE::GATHER_FORWARD_ONLY:
+						libwarp_bind_gather_forward_only_floor(job->images[LIBWARP_BINDING_COLOR],
+															   job->images[LIBWARP_BINDING_MOTION],
+															   job->images[LIBWARP_BINDING_OUTPUT]);
+						result = libwarp_exec_gather_forward_only(&job->camera_setup, job->delta, &job->cancelled);
+						break;
+				}
+			}
+		}
+		
+		{
+			unique_lock<mutex> lock(libwarp_jobs.job_lock);
+			job->result = result;
+			job->done = true;
+			job->images = {};
+			libwarp_jobs.running = nullptr;
+		}
+		libwarp_jobs.job_cv.notify_all();
+	}
+}
+
+LIBWARP_ERROR_CODE libwarp_submit_job(unique_ptr<libwarp_job_t>&& job,
+									  const LIBWARP_SUBMIT_MODE submit_mode,
+									  libwarp_job* job_handle) {
+	if (job_handle == nullptr) {
+		return LIBWARP_INVALID_JOB;
+	}
+	
+	shared_ptr<libwarp_job_t> shared_job = std::move(job);
+	{
+		unique_lock<mutex> lock(libwarp_jobs.job_lock);
+		if (submit_mode == LIBWARP_SUBMIT_LATEST_WINS) {
+			for (auto& pending_job : libwarp_jobs.pending) {
+				pending_job->cancelled = true;
+			}
+			if (libwarp_jobs.running) {
+				libwarp_jobs.running->cancelled = true;
+			}
+		}
+		
+		shared_job->id = libwarp_jobs.next_id++;
+		libwarp_jobs.jobs.emplace(shared_job->id, shared_job);
+		libwarp_jobs.pending.emplace_back(shared_job);
+		*job_handle = shared_job->id;
+		
+		if (!libwarp_jobs.worker) {
+			libwarp_jobs.shutdown = false;
+			libwarp_jobs.worker = make_unique<thread>(libwarp_job_worker);
+		}
+	}
+	libwarp_jobs.job_cv.notify_all();
+	return LIBWARP_SUCCESS;
+}
+
+void libwarp_stop_job_worker() {
+	{
+		unique_lock<mutex> lock(libwarp_jobs.job_lock);
+		if (!libwarp_jobs.worker) {
+			return;
+		}
+		libwarp_jobs.shutdown = true;
+		// anything that is still pending won't be executed anymore
+		for (auto& pending_job : libwarp_jobs.pending) {
+			pending_job->cancelled = true;
+			pending_job->result = LIBWARP_JOB_CANCELLED;
+			pending_job->done = true;
+			pending_job->images = {};
+		}
+		libwarp_jobs.pending.clear();
+	}
+	libwarp_jobs.job_cv.notify_all();
+	libwarp_jobs.worker->join();
+	libwarp_jobs.worker = nullptr;
+}
+
+LIBWARP_ERROR_CODE libwarp_cancel_job(const libwarp_job job) {
+	unique_lock<mutex> lock(libwarp_jobs.job_lock);
+	const auto iter = libwarp_jobs.jobs.find(job);
+	if (iter == libwarp_jobs.jobs.end()) {
+		return LIBWARP_INVALID_JOB;
+	}
+	iter->second->cancelled = true;
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_wait_job(const libwarp_job job) {
+	unique_lock<mutex> lock(libwarp_jobs.job_lock);
+	const auto iter = libwarp_jobs.jobs.find(job);
+	if (iter == libwarp_jobs.jobs.end()) {
+		return LIBWARP_INVALID_JOB;
+	}
+	auto job_ptr = iter->second;
+	libwarp_jobs.job_cv.wait(lock, [&job_ptr] { return job_ptr->done; });
+	libwarp_jobs.jobs.erase(job);
+	return job_ptr->result;
+}
+
+LIBWARP_ERROR_CODE libwarp_release_job(const libwarp_job job) {
+	unique_lock<mutex> lock(libwarp_jobs.job_lock);
+	return (libwarp_jobs.jobs.erase(job) > 0 ? LIBWARP_SUCCESS : LIBWARP_INVALID_JOB);
+}
+
+LIBWARP_ERROR_CODE libwarp_submit_scatter_floor(const libwarp_camera_setup* const camera_setup,
+												const float delta,
+												const bool clear_frame,
+												shared_ptr<compute_image> color_texture,
+												shared_ptr<compute_image> depth_texture,
+												shared_ptr<compute_image> motion_texture,
+												shared_ptr<compute_image> output_texture,
+												const LIBWARP_SUBMIT_MODE submit_mode,
+												libwarp_job* job) REQUIRES(!libwarp_lock) {
+	if (job == nullptr) {
+		return LIBWARP_INVALID_JOB;
+	}
+	if (camera_setup == nullptr) {
+		return LIBWARP_INVALID_CAMERA_SETUP;
+	}
+	libwarp::job submitted_job;
+	const auto err = libwarp::submit_scatter(*camera_setup, delta, clear_frame,
+											 { color_texture, depth_texture, motion_texture, output_texture },
+											 submitted_job, submit_mode);
+	*job = submitted_job.detach();
+	return err;
+}
+
+LIBWARP_ERROR_CODE libwarp_submit_gather_floor(const libwarp_camera_setup* const camera_setup,
+											   const float delta,
+											   shared_ptr<compute_image> color_current_texture,
+											   shared_ptr<compute_image> depth_current_texture,
+											   shared_ptr<compute_image> color_prev_texture,
+											   shared_ptr<compute_image> depth_prev_texture,
+											   shared_ptr<compute_image> motion_forward_texture,
+											   shared_ptr<compute_image> motion_backward_texture,
+											   shared_ptr<compute_image> motion_depth_forward_texture,
+											   shared_ptr<compute_image> motion_depth_backward_texture,
+											   shared_ptr<compute_image> output_texture,
+											   const LIBWARP_SUBMIT_MODE submit_mode,
+											   libwarp_job* job) REQUIRES(!libwarp_lock) {
+	if (job == nullptr) {
+		return LIBWARP_INVALID_JOB;
+	}
+	if (camera_setup == nullptr) {
+		return LIBWARP_INVALID_CAMERA_SETUP;
+	}
+	libwarp::job submitted_job;
+	const auto err = libwarp::submit_gather(*camera_setup, delta, {
+		color_current_texture, depth_current_texture,
+		color_prev_texture, depth_prev_texture,
+		motion_forward_texture, motion_backward_texture,
+		motion_depth_forward_texture, motion_depth_backward_texture,
+		output_texture
+	}, submitted_job, submit_mode);
+	*job = submitted_job.detach();
+	return err;
+}
+
+LIBWARP_ERROR_CODE libwarp_submit_gather_forward_only_floor(const libwarp_camera_setup* const camera_setup,
+															const float delta,
+															shared_ptr<compute_image> color_texture,
+															shared_ptr<compute_image> motion_texture,
+															shared_ptr<compute_image> output_texture,
+															const LIBWARP_SUBMIT_MODE submit_mode,
+															libwarp_job* job) REQUIRES(!libwarp_lock) {
+	if (job == nullptr) {
+		return LIBWARP_INVALID_JOB;
+	}
+	if (camera_setup == nullptr) {
+		return LIBWARP_INVALID_CAMERA_SETUP;
+	}
+	libwarp::job submitted_job;
+	const auto err = libwarp::submit_gather_forward_only(*camera_setup, delta, { color_texture, motion_texture, output_texture },
+														 submitted_job, submit_mode);
+	*job = submitted_job.detach();
+	return err;
+}
@@ -0,0 +1,235 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "libwarp_internal.hpp"
+#include <thread>
+#include <condition_variable>
+#include <deque>
+
+// prebuild state is independent of libwarp_state, since the workers must be stopped before libwarp_state is destroyed
+// NOTE: lock order is libwarp_lock -> prebuild_lock, the workers never acquire libwarp_lock
+static struct {
+	mutex prebuild_lock;
+	condition_variable prebuild_cv;
+	struct prebuild_entry {
+		libwarp_camera_setup camera_setup;
+		libwarp_prebuild_callback callback { nullptr };
+		void* user_data { nullptr };
+		// set once the program has been built (or the prebuild was cancelled)
+		bool done { false };
+		pair<LIBWARP_ERROR_CODE, shared_ptr<libwarp_state_struct::camera_setup_program>> result;
+	};
+	// all setups that are pending, being built or have been built, but haven't been taken by libwarp_build yet
+	vector<shared_ptr<prebuild_entry>> entries;
+	// setups that haven't been picked up by a worker yet (in submission order)
+	deque<shared_ptr<prebuild_entry>> pending;
+	// amount of setups that are currently being built (incl. their progress callback)
+	uint32_t in_progress { 0 };
+	// context and tile size the programs are built for
+	shared_ptr<compute_context> ctx;
+	uint2 tile_size;
+	vector<thread> workers;
+	uint32_t active_workers { 0 };
+	// progress and first error of all outstanding prebuilds
+	uint32_t built_count { 0 };
+	uint32_t total_count { 0 };
+	LIBWARP_ERROR_CODE first_error { LIBWARP_SUCCESS };
+	bool shutdown { false };
+} libwarp_prebuilds;
+
+static void libwarp_prebuild_worker() {
+	for (;;) {
+		shared_ptr<decltype(libwarp_prebuilds)::prebuild_entry> entry;
+		shared_ptr<compute_context> ctx;
+		uint2 tile_size;
+		{
+			unique_lock<mutex> lock(libwarp_prebuilds.prebuild_lock);
+			if (libwarp_prebuilds.shutdown || libwarp_prebuilds.pending.empty()) {
+				--libwarp_prebuilds.active_workers;
+				return;
+			}
+			entry = libwarp_prebuilds.pending.front();
+			libwarp_prebuilds.pending.pop_front();
+			++libwarp_prebuilds.in_progress;
+			ctx = libwarp_prebuilds.ctx;
+			tile_size = libwarp_prebuilds.tile_size;
+		}
+		
+		// this is the expensive part that must not block any warps
+		auto result = libwarp_compile_program(*ctx, tile_size, &entry->camera_setup);
+		const auto result_code = result.first;
+		
+		uint32_t built_count = 0, total_count = 0;
+		{
+			unique_lock<mutex> lock(libwarp_prebuilds.prebuild_lock);
+			entry->result = move(result);
+			entry->done = true;
+			built_count = ++libwarp_prebuilds.built_count;
+			total_count = libwarp_prebuilds.total_count;
+			if (result_code != LIBWARP_SUCCESS && libwarp_prebuilds.first_error == LIBWARP_SUCCESS) {
+				libwarp_prebuilds.first_error = result_code;
+			}
+		}
+		// wake up warps that are waiting for this setup
+		libwarp_prebuilds.prebuild_cv.notify_all();
+		
+		if (entry->callback != nullptr) {
+			entry->callback(entry->user_data, &entry->camera_setup, result_code, built_count, total_count);
+		}
+		{
+			unique_lock<mutex> lock(libwarp_prebuilds.prebuild_lock);
+			--libwarp_prebuilds.in_progress;
+		}
+		libwarp_prebuilds.prebuild_cv.notify_all();
+	}
+}
+
+// marks all pending setups as cancelled and removes them from the outstanding prebuilds
+// NOTE: prebuild_lock must be held
+static void libwarp_cancel_pending_prebuilds() {
+	for (auto& entry : libwarp_prebuilds.pending) {
+		entry->result = { LIBWARP_JOB_CANCELLED, {} };
+		entry->done = true;
+	}
+	libwarp_prebuilds.total_count -= uint32_t(libwarp_prebuilds.pending.size());
+	libwarp_prebuilds.pending.clear();
+}
+
+optional<pair<LIBWARP_ERROR_CODE, shared_ptr<libwarp_state_struct::camera_setup_program>>>
+libwarp_take_prebuilt_program(const libwarp_camera_setup* const camera_setup) {
+	unique_lock<mutex> lock(libwarp_prebuilds.prebuild_lock);
+	const auto entry_iter = find_if(libwarp_prebuilds.entries.begin(), libwarp_prebuilds.entries.end(), [camera_setup](const auto& entry) {
+		return libwarp_is_same_camera_setup(entry->camera_setup, *camera_setup);
+	});
+	if (entry_iter == libwarp_prebuilds.entries.end()) {
+		return {};
+	}
+	
+	// still pending or being built -> wait for it
+	const auto entry = *entry_iter;
+	libwarp_prebuilds.prebuild_cv.wait(lock, [&entry] { return entry->done; });
+	erase(libwarp_prebuilds.entries, entry);
+	return move(entry->result);
+}
+
+void libwarp_cancel_prebuild() {
+	unique_lock<mutex> lock(libwarp_prebuilds.prebuild_lock);
+	libwarp_cancel_pending_prebuilds();
+	// NOTE: programs of setups that are currently being built are dropped once they are done
+	libwarp_prebuilds.entries.clear();
+}
+
+void libwarp_stop_prebuild() {
+	vector<thread> workers;
+	{
+		unique_lock<mutex> lock(libwarp_prebuilds.prebuild_lock);
+		libwarp_prebuilds.shutdown = true;
+		libwarp_cancel_pending_prebuilds();
+		libwarp_prebuilds.entries.clear();
+		workers.swap(libwarp_prebuilds.workers);
+	}
+	libwarp_prebuilds.prebuild_cv.notify_all();
+	// workers finish the setup they are currently building
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	
+	unique_lock<mutex> lock(libwarp_prebuilds.prebuild_lock);
+	libwarp_prebuilds.ctx = nullptr;
+	libwarp_prebuilds.shutdown = false;
+}
+
+LIBWARP_ERROR_CODE libwarp_prebuild_async(const libwarp_camera_setup* const camera_setups,
+										  const uint32_t count,
+										  const uint32_t thread_count,
+										  libwarp_prebuild_callback callback,
+										  void* user_data) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	// invalid setups are rejected upfront, so that nothing is built for an invalid list
+	for (uint32_t i = 0; i < count; ++i) {
+		if (const auto err = libwarp_check_camera_setup(&camera_setups[i]); err != LIBWARP_SUCCESS) {
+			return err;
+		}
+	}
+	
+	unique_lock<mutex> lock(libwarp_prebuilds.prebuild_lock);
+	if (libwarp_prebuilds.pending.empty() && libwarp_prebuilds.in_progress == 0) {
+		// all previous prebuilds are done -> start counting from scratch
+		libwarp_prebuilds.built_count = 0;
+		libwarp_prebuilds.total_count = 0;
+		libwarp_prebuilds.first_error = LIBWARP_SUCCESS;
+	}
+	if (libwarp_prebuilds.active_workers == 0) {
+		// all previous workers have exited (or are about to)
+		for (auto& worker : libwarp_prebuilds.workers) {
+			worker.join();
+		}
+		libwarp_prebuilds.workers.clear();
+	}
+	libwarp_prebuilds.ctx = libwarp_state->ctx;
+	libwarp_prebuilds.tile_size = libwarp_state->tile_size;
+	
+	for (uint32_t i = 0; i < count; ++i) {
+		const auto& camera_setup = camera_setups[i];
+		const auto is_camera_setup = [&camera_setup](const libwarp_camera_setup& setup) {
+			return libwarp_is_same_camera_setup(setup, camera_setup);
+		};
+		if (any_of(libwarp_state->programs.begin(), libwarp_state->programs.end(),
+				   [&is_camera_setup](const auto& prog) { return is_camera_setup(prog.first); }) ||
+			any_of(libwarp_prebuilds.entries.begin(), libwarp_prebuilds.entries.end(),
+				   [&is_camera_setup](const auto& entry) { return is_camera_setup(entry->camera_setup); })) {
+			continue; // already built or being built
+		}
+		auto entry = make_shared<decltype(libwarp_prebuilds)::prebuild_entry>();
+		entry->camera_setup = camera_setup;
+		entry->callback = callback;
+		entry->user_data = user_data;
+		libwarp_prebuilds.entries.emplace_back(entry);
+		libwarp_prebuilds.pending.emplace_back(entry);
+		++libwarp_prebuilds.total_count;
+	}
+	
+	const auto max_workers = min(thread_count > 0u ? thread_count : max(thread::hardware_concurrency(), 1u),
+								 libwarp_prebuilds.active_workers + uint32_t(libwarp_prebuilds.pending.size()));
+	while (libwarp_prebuilds.active_workers < max_workers) {
+		libwarp_prebuilds.workers.emplace_back(libwarp_prebuild_worker);
+		++libwarp_prebuilds.active_workers;
+	}
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_get_prebuild_progress(uint32_t* built_count, uint32_t* total_count) {
+	unique_lock<mutex> lock(libwarp_prebuilds.prebuild_lock);
+	if (built_count != nullptr) {
+		*built_count = libwarp_prebuilds.built_count;
+	}
+	if (total_count != nullptr) {
+		*total_count = libwarp_prebuilds.total_count;
+	}
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_wait_prebuild() {
+	unique_lock<mutex> lock(libwarp_prebuilds.prebuild_lock);
+	libwarp_prebuilds.prebuild_cv.wait(lock, [] {
+		return (libwarp_prebuilds.pending.empty() && libwarp_prebuilds.in_progress == 0);
+	});
+	return libwarp_prebuilds.first_error;
+}
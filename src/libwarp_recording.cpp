@@ -0,0 +1,312 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "libwarp_internal.hpp"
+
+// NOTE: independent of libwarp_state (protected by libwarp_lock), so that handles stay unique across libwarp_destroy
+static libwarp_recording libwarp_next_recording_id { 1 };
+
+libwarp_recording_t* libwarp_find_recording(const libwarp_recording recording) {
+	if (recording == 0) {
+		return nullptr;
+	}
+	for (const auto& rec : libwarp_state->recordings) {
+		if (rec->id == recording) {
+			return rec.get();
+		}
+	}
+	return nullptr;
+}
+
+// returns true if the bound state of the specified mode or any optional feature requires a kernel variant
+// that recordings don't support
+static bool libwarp_has_unrecordable_state(const libwarp_recording_t::MODE mode) {
+	if (libwarp_has_enabled_features()) {
+		return true;
+	}
+	switch (mode) {
+		case libwarp_recording_t::MODE::SCATTER:
+			return (libwarp_state->scatter.unified_motion ||
+					libwarp_state->scatter.motion_prev != nullptr ||
+					libwarp_state->scatter.color_layer2 != nullptr);
+		case libwarp_recording_t::MODE::GATHER_BIDIRECTIONAL:
+			return libwarp_state->gather.unified_motion;
+		case libwarp_recording_t::MODE::GATHER_FORWARD_ONLY:
+			return (libwarp_state->gather_forward.unified_motion ||
+					libwarp_state->gather_forward.motion_prev != nullptr);
+	}
+	return false;
+}
+
+bool libwarp_is_recording_binding(const libwarp_recording_t& recording, const LIBWARP_BINDING binding) {
+	switch (recording.mode) {
+		case libwarp_recording_t::MODE::SCATTER:
+		case libwarp_recording_t::MODE::GATHER_FORWARD_ONLY:
+			return (binding == LIBWARP_BINDING_COLOR ||
+					(binding == LIBWARP_BINDING_DEPTH && recording.mode == libwarp_recording_t::MODE::SCATTER) ||
+					binding == LIBWARP_BINDING_MOTION ||
+					binding == LIBWARP_BINDING_OUTPUT);
+		case libwarp_recording_t::MODE::GATHER_BIDIRECTIONAL:
+			return (binding < LIBWARP_BINDING_COUNT);
+	}
+	return false;
+}
+
+LIBWARP_ERROR_CODE libwarp_encode_recording(libwarp_recording_t& recording) {
+	// global work-size == round screen dim to tile size
+	const auto global_work_size = uint2(recording.camera_setup.screen_width,
+										recording.camera_setup.screen_height).rounded_next_multiple(libwarp_state->tile_size);
+	const auto add_command = [&recording, &global_work_size](const WARP_KERNEL kernel_idx,
+															 vector<compute_kernel_arg>&& args,
+															 const int32_t delta_arg_idx,
+															 const bool clear_depth_buffer = false) {
+		recording.commands.emplace_back(libwarp_recording_t::command {
+			.kernel = recording.program->kernels[kernel_idx].get(),
+			.params = {
+				.execution_dim = 2,
+				.global_work_size = global_work_size,
+				.local_work_size = libwarp_state->tile_size,
+				.args = std::move(args),
+				// set when replaying (depends on the in-flight count at that point)
+				.wait_until_completion = true,
+			},
+			.delta_arg_idx = delta_arg_idx,
+			.clear_depth_buffer = clear_depth_buffer,
+		});
+	};
+	
+	// the actual delta is only known when replaying -> use a dummy value for now
+	static constexpr const float dummy_delta { 0.0f };
+	const auto& img = recording.images;
+	recording.commands.clear();
+	switch (recording.mode) {
+		case libwarp_recording_t::MODE::SCATTER: {
+			const auto depth_buffer_size = sizeof(float) * recording.camera_setup.screen_width * recording.camera_setup.screen_height;
+			if (recording.depth_buffer == nullptr || recording.depth_buffer->get_size() < depth_buffer_size) {
+				recording.depth_buffer = libwarp_state->ctx->create_buffer(*libwarp_state->dev_queue, depth_buffer_size);
+				if (recording.depth_buffer == nullptr) {
+					return LIBWARP_DEPTH_BUFFER_FAILURE;
+				}
+			}
+			
+			// same command order as libwarp_scatter_*
+			if (recording.clear_frame) {
+				add_command(KERNEL_SCATTER_CLEAR, { img[LIBWARP_BINDING_OUTPUT], float4 { 0.0f } }, -1);
+			}
+			add_command(KERNEL_SCATTER_DEPTH_PASS, {
+				img[LIBWARP_BINDING_DEPTH],
+				img[LIBWARP_BINDING_MOTION],
+				recording.depth_buffer,
+				dummy_delta
+			}, 3, true);
+			add_command(KERNEL_SCATTER_COLOR_DEPTH_TEST, {
+				img[LIBWARP_BINDING_COLOR],
+				img[LIBWARP_BINDING_DEPTH],
+				img[LIBWARP_BINDING_MOTION],
+				img[LIBWARP_BINDING_OUTPUT],
+				recording.depth_buffer,
+				dummy_delta
+			}, 5);
+			add_command(KERNEL_SCATTER_FIXUP, { img[LIBWARP_BINDING_OUTPUT] }, -1);
+			break;
+		}
+		case libwarp_recording_t::MODE::GATHER_BIDIRECTIONAL:
+			add_command(KERNEL_GATHER_BIDIRECTIONAL, {
+				img[LIBWARP_BINDING_COLOR],
+				img[LIBWARP_BINDING_DEPTH],
+				img[LIBWARP_BINDING_COLOR_PREV],
+				img[LIBWARP_BINDING_DEPTH_PREV],
+				img[LIBWARP_BINDING_MOTION],
+				img[LIBWARP_BINDING_MOTION_BACKWARD],
+				img[LIBWARP_BINDING_MOTION_DEPTH_FORWARD],
+				img[LIBWARP_BINDING_MOTION_DEPTH_BACKWARD],
+				img[LIBWARP_BINDING_OUTPUT],
+				dummy_delta
+			}, 9);
+			break;
+		case libwarp_recording_t::MODE::GATHER_FORWARD_ONLY:
+			add_command(KERNEL_GATHER_FORWARD_ONLY, {
+				img[LIBWARP_BINDING_COLOR],
+				img[LIBWARP_BINDING_MOTION],
+				img[LIBWARP_BINDING_OUTPUT],
+				dummy_delta
+			}, 3);
+			break;
+	}
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_record(const libwarp_camera_setup* const camera_setup,
+								  const libwarp_recording_t::MODE mode,
+								  const bool clear_frame,
+								  array<shared_ptr<compute_image>, LIBWARP_BINDING_COUNT>&& images,
+								  libwarp_recording* recording) {
+	if (recording == nullptr) {
+		return LIBWARP_INVALID_RECORDING;
+	}
+	*recording = 0;
+	if (libwarp_has_unrecordable_state(mode)) {
+		return LIBWARP_UNSUPPORTED_COMBINATION;
+	}
+	
+	// build program for this camera setup if it hasn't been build already
+	const auto prog = libwarp_build(camera_setup);
+	if (prog.first != LIBWARP_SUCCESS) {
+		return prog.first;
+	}
+	
+	auto rec = make_unique<libwarp_recording_t>();
+	rec->mode = mode;
+	rec->clear_frame = clear_frame;
+	rec->camera_setup = *camera_setup;
+	rec->program = prog.second;
+	rec->images = std::move(images);
+	for (uint32_t binding = 0; binding < LIBWARP_BINDING_COUNT; ++binding) {
+		if (libwarp_is_recording_binding(*rec, (LIBWARP_BINDING)binding) && rec->images[binding] == nullptr) {
+			return LIBWARP_INVALID_BINDING;
+		}
+	}
+	
+	if (const auto err = libwarp_encode_recording(*rec); err != LIBWARP_SUCCESS) {
+		return err;
+	}
+	rec->id = libwarp_next_recording_id++;
+	*recording = rec->id;
+	libwarp_state->recordings.emplace_back(std::move(rec));
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_record_scatter_floor(const libwarp_camera_setup* const camera_setup,
+												const bool clear_frame,
+												shared_ptr<compute_image> color_texture,
+												shared_ptr<compute_image> depth_texture,
+												shared_ptr<compute_image> motion_texture,
+												shared_ptr<compute_image> output_texture,
+												libwarp_recording* recording) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	array<shared_ptr<compute_image>, LIBWARP_BINDING_COUNT> images;
+	images[LIBWARP_BINDING_COLOR] = color_texture;
+	images[LIBWARP_BINDING_DEPTH] = depth_texture;
+	images[LIBWARP_BINDING_MOTION] = motion_texture;
+	images[LIBWARP_BINDING_OUTPUT] = output_texture;
+	return libwarp_record(camera_setup, libwarp_recording_t::MODE::SCATTER, clear_frame, std::move(images), recording);
+}
+
+LIBWARP_ERROR_CODE libwarp_record_gather_floor(const libwarp_camera_setup* const camera_setup,
+											   shared_ptr<compute_image> color_current_texture,
+											   shared_ptr<compute_image> depth_current_texture,
+											   shared_ptr<compute_image> color_prev_texture,
+											   shared_ptr<compute_image> depth_prev_texture,
+											   shared_ptr<compute_image> motion_forward_texture,
+											   shared_ptr<compute_image> motion_backward_texture,
+											   shared_ptr<compute_image> motion_depth_forward_texture,
+											   shared_ptr<compute_image> motion_depth_backward_texture,
+											   shared_ptr<compute_image> output_texture,
+											   libwarp_recording* recording) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	array<shared_ptr<compute_image>, LIBWARP_BINDING_COUNT> images;
+	images[LIBWARP_BINDING_COLOR] = color_current_texture;
+	images[LIBWARP_BINDING_DEPTH] = depth_current_texture;
+	images[LIBWARP_BINDING_COLOR_PREV] = color_prev_texture;
+	images[LIBWARP_BINDING_DEPTH_PREV] = depth_prev_texture;
+	images[LIBWARP_BINDING_MOTION] = motion_forward_texture;
+	images[LIBWARP_BINDING_MOTION_BACKWARD] = motion_backward_texture;
+	images[LIBWARP_BINDING_MOTION_DEPTH_FORWARD] = motion_depth_forward_texture;
+	images[LIBWARP_BINDING_MOTION_DEPTH_BACKWARD] = motion_depth_backward_texture;
+	images[LIBWARP_BINDING_OUTPUT] = output_texture;
+	return libwarp_record(camera_setup, libwarp_recording_t::MODE::GATHER_BIDIRECTIONAL, false, std::move(images), recording);
+}
+
+LIBWARP_ERROR_CODE libwarp_record_gather_forward_only_floor(const libwarp_camera_setup* const camera_setup,
+															shared_ptr<compute_image> color_texture,
+															shared_ptr<compute_image> motion_texture,
+															shared_ptr<compute_image> output_texture,
+															libwarp_recording* recording) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	array<shared_ptr<compute_image>, LIBWARP_BINDING_COUNT> images;
+	images[LIBWARP_BINDING_COLOR] = color_texture;
+	images[LIBWARP_BINDING_MOTION] = motion_texture;
+	images[LIBWARP_BINDING_OUTPUT] = output_texture;
+	return libwarp_record(camera_setup, libwarp_recording_t::MODE::GATHER_FORWARD_ONLY, false, std::move(images), recording);
+}
+
+LIBWARP_ERROR_CODE libwarp_rebind_floor(libwarp_recording recording_handle,
+										const LIBWARP_BINDING binding,
+										shared_ptr<compute_image> texture) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	auto recording = libwarp_find_recording(recording_handle);
+	if (recording == nullptr) {
+		return LIBWARP_INVALID_RECORDING;
+	}
+	if (!libwarp_is_recording_binding(*recording, binding) || texture == nullptr) {
+		return LIBWARP_INVALID_BINDING;
+	}
+	if (recording->images[binding] == texture) {
+		return LIBWARP_SUCCESS; // nothing to do
+	}
+	recording->images[binding] = texture;
+	return libwarp_encode_recording(*recording);
+}
+
+LIBWARP_ERROR_CODE libwarp_replay(libwarp_recording recording_handle, const float delta) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	auto recording = libwarp_find_recording(recording_handle);
+	if (recording == nullptr) {
+		return LIBWARP_INVALID_RECORDING;
+	}
+	
+	// same as run_warp_kernel: replays are only blocking if a single job may be in flight
+	auto& slot = libwarp_acquire_slot();
+	slot.retain(vector<shared_ptr<compute_image>>(recording->images.begin(), recording->images.end()));
+	// the recording-owned depth buffer may still be in use by the previous replay on another slot
+	if (recording->slot != libwarp_state->cur_slot) {
+		libwarp_finish_slot(libwarp_state->slots[recording->slot]);
+		recording->slot = libwarp_state->cur_slot;
+	}
+	
+	const auto is_blocking = !libwarp_state->is_async();
+	for (auto& cmd : recording->commands) {
+		if (cmd.clear_depth_buffer) {
+			const float clear_depth = numeric_limits<float>::max();
+			recording->depth_buffer->fill(*slot.queue, &clear_depth, sizeof(clear_depth));
+		}
+		if (cmd.delta_arg_idx >= 0) {
+			cmd.params.args[size_t(cmd.delta_arg_idx)] = delta;
+		}
+		cmd.params.wait_until_completion = is_blocking;
+		slot.queue->execute_with_parameters(*cmd.kernel, cmd.params);
+	}
+	slot.busy = !is_blocking;
+	return LIBWARP_SUCCESS;
+}
+
+void libwarp_destroy_recording(libwarp_recording recording) REQUIRES(!libwarp_lock) {
+	GUARD(libwarp_lock);
+	if (libwarp_state == nullptr) return;
+	
+	const auto iter = find_if(libwarp_state->recordings.begin(), libwarp_state->recordings.end(),
+							  [&recording](const auto& rec) { return (rec->id == recording); });
+	if (iter != libwarp_state->recordings.end()) {
+		// the last replay may still be using the recording-owned depth buffer
+		libwarp_finish_slot(libwarp_state->slots[(*iter)->slot]);
+		libwarp_state->recordings.erase(iter);
+	}
+}
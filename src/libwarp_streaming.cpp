@@ -0,0 +1,194 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "libwarp_internal.hpp"
+
+// creates a band image of the specified dim and type that can be mapped on the host
+static shared_ptr<compute_image> libwarp_create_band_image(libwarp_state_struct::in_flight_slot& slot,
+														   const uint2& dim,
+														   const COMPUTE_IMAGE_TYPE type) {
+	return libwarp_state->ctx->create_image(*slot.queue, uint4 { dim.x, dim.y, 0u, 0u }, type,
+											COMPUTE_MEMORY_FLAG::READ_WRITE | COMPUTE_MEMORY_FLAG::HOST_READ_WRITE);
+}
+
+// makes sure all band images and the band depth buffer of the specified slot can hold the specified band dims
+static LIBWARP_ERROR_CODE libwarp_alloc_stream(libwarp_state_struct::in_flight_slot& slot,
+											   const libwarp_camera_setup* const camera_setup,
+											   const uint2& input_dim,
+											   const uint2& output_dim) {
+	auto& stream = libwarp_state->stream;
+	if (stream.color == nullptr || stream.input_dim != input_dim || stream.depth_type != camera_setup->depth_type) {
+		// native depth images for all depth types except z/w (see NATIVE_DEPTH_IMAGE)
+		const auto depth_image_type = (camera_setup->depth_type == LIBWARP_DEPTH_Z_DIV_W ?
+									   COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::R32F :
+									   COMPUTE_IMAGE_TYPE::IMAGE_DEPTH | COMPUTE_IMAGE_TYPE::D32F);
+		stream.color = libwarp_create_band_image(slot, input_dim, COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::RGBA32F |
+												 COMPUTE_IMAGE_TYPE::READ);
+		stream.depth = libwarp_create_band_image(slot, input_dim, depth_image_type | COMPUTE_IMAGE_TYPE::READ);
+		stream.motion = libwarp_create_band_image(slot, input_dim, COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::R32UI |
+												  COMPUTE_IMAGE_TYPE::READ);
+		stream.input_dim = input_dim;
+		stream.depth_type = camera_setup->depth_type;
+	}
+	if (stream.output == nullptr || stream.output_dim != output_dim) {
+		stream.output = libwarp_create_band_image(slot, output_dim, COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::RGBA32F |
+												  COMPUTE_IMAGE_TYPE::READ_WRITE);
+		stream.output_dim = output_dim;
+	}
+	if (stream.color == nullptr || stream.depth == nullptr || stream.motion == nullptr || stream.output == nullptr) {
+		stream.color = nullptr;
+		stream.depth = nullptr;
+		stream.motion = nullptr;
+		stream.output = nullptr;
+		return LIBWARP_STREAM_FAILURE;
+	}
+	
+	const auto depth_buffer_size = sizeof(float) * output_dim.x * output_dim.y;
+	if (slot.depth_buffer == nullptr || slot.depth_buffer->get_size() < depth_buffer_size) {
+		slot.depth_buffer = libwarp_state->ctx->create_buffer(*slot.queue, depth_buffer_size);
+		if (slot.depth_buffer == nullptr) {
+			return LIBWARP_DEPTH_BUFFER_FAILURE;
+		}
+	}
+	return LIBWARP_SUCCESS;
+}
+
+// reads the specified rows of an input from the host into its band image
+static bool libwarp_read_band(libwarp_state_struct::in_flight_slot& slot,
+							  const libwarp_stream_callbacks* const callbacks,
+							  const LIBWARP_STREAM_INPUT input,
+							  compute_image& img,
+							  const uint32_t first_row,
+							  const uint32_t row_count) {
+	auto mapped_ptr = img.map(*slot.queue, COMPUTE_MEMORY_MAP_FLAG::WRITE_INVALIDATE | COMPUTE_MEMORY_MAP_FLAG::BLOCK);
+	if (mapped_ptr == nullptr) {
+		return false;
+	}
+	const auto success = callbacks->read_rows(callbacks->user_data, input, first_row, row_count, mapped_ptr);
+	return (img.unmap(*slot.queue, mapped_ptr) && success);
+}
+
+LIBWARP_ERROR_CODE libwarp_exec_scatter_streaming(const libwarp_camera_setup* const camera_setup,
+												  const float delta,
+												  const uint32_t band_height,
+												  const float max_displacement,
+												  const libwarp_stream_callbacks* const callbacks) {
+	if (band_height == 0 || !(max_displacement >= 0.0f) ||
+		callbacks == nullptr || callbacks->read_rows == nullptr || callbacks->write_rows == nullptr) {
+		return LIBWARP_STREAM_FAILURE;
+	}
+	// band kernels read the depth/motion inputs directly
+	if (camera_setup->input_downscale != 1u) {
+		return LIBWARP_INVALID_INPUT_DOWNSCALE;
+	}
+	// there are no band kernel variants for any of these, silently dropping them would change the expected output
+	if (libwarp_state->history.enabled ||
+		libwarp_state->confidence.image != nullptr ||
+		libwarp_state->scatter.unified_motion ||
+		libwarp_state->scatter.motion_prev != nullptr ||
+		libwarp_state->scatter.color_layer2 != nullptr) {
+		return LIBWARP_UNSUPPORTED_COMBINATION;
+	}
+	if (const auto prog = libwarp_build(camera_setup); prog.first != LIBWARP_SUCCESS) {
+		return prog.first;
+	}
+	
+	// halo: any pixel that is scattered into the output band (including its splat footprint) must be part of the input band
+	static constexpr const uint32_t splat_extent[] { 1u /* NONE */, 2u /* 2X2 */, 4u /* ADAPTIVE */ };
+	const auto halo = uint32_t(ceil(max_displacement)) + splat_extent[camera_setup->splat_mode];
+	const auto screen_height = camera_setup->screen_height;
+	const auto output_rows = min(band_height, screen_height);
+	const auto input_rows = min(output_rows + 2u * halo, screen_height);
+	
+	// band images have a tile-size multiple height, so that the clear and fixup passes stay inside them
+	const auto tile_height = libwarp_state->tile_size.y;
+	const uint2 input_dim { camera_setup->screen_width, ((input_rows + tile_height - 1u) / tile_height) * tile_height };
+	const uint2 output_dim { camera_setup->screen_width, ((output_rows + tile_height - 1u) / tile_height) * tile_height };
+	
+	// each band depends on the previous band images -> always complete all in-flight work first
+	libwarp_finish_slots();
+	auto& slot = libwarp_acquire_slot();
+	if (const auto alloc_err = libwarp_alloc_stream(slot, camera_setup, input_dim, output_dim); alloc_err != LIBWARP_SUCCESS) {
+		return alloc_err;
+	}
+	
+	auto& stream = libwarp_state->stream;
+	// clear/fixup passes operate on the bound scatter output -> temporarily bind the output band (restored afterwards)
+	const auto prev_output = libwarp_state->scatter.output;
+	libwarp_bind_image(libwarp_state->scatter.output, stream.output);
+	
+	auto err = LIBWARP_SUCCESS;
+	for (uint32_t dst_row = 0; dst_row < screen_height && err == LIBWARP_SUCCESS; dst_row += output_rows) {
+		const auto dst_rows = min(output_rows, screen_height - dst_row);
+		const auto src_row = (dst_row > halo ? dst_row - halo : 0u);
+		const auto src_rows = min(dst_row + dst_rows + halo, screen_height) - src_row;
+		
+		// stream in
+		if (!libwarp_read_band(slot, callbacks, LIBWARP_STREAM_INPUT_COLOR, *stream.color, src_row, src_rows) ||
+			!libwarp_read_band(slot, callbacks, LIBWARP_STREAM_INPUT_DEPTH, *stream.depth, src_row, src_rows) ||
+			!libwarp_read_band(slot, callbacks, LIBWARP_STREAM_INPUT_MOTION, *stream.motion, src_row, src_rows)) {
+			err = LIBWARP_STREAM_FAILURE;
+			break;
+		}
+		
+		// warp
+		stream.band = { src_row, src_rows, dst_row, dst_rows };
+		libwarp_state->work_dim_override = output_dim;
+		err = run_warp_kernel<KERNEL_SCATTER_CLEAR>(camera_setup, delta);
+		libwarp_state->work_dim_override = input_dim;
+		if (err == LIBWARP_SUCCESS) {
+			err = run_warp_kernel<KERNEL_SCATTER_DEPTH_PASS_BAND>(camera_setup, delta);
+		}
+		if (err == LIBWARP_SUCCESS) {
+			err = run_warp_kernel<KERNEL_SCATTER_COLOR_DEPTH_TEST_BAND>(camera_setup, delta);
+		}
+		libwarp_state->work_dim_override = output_dim;
+		if (err == LIBWARP_SUCCESS) {
+			err = run_warp_kernel<KERNEL_SCATTER_FIXUP>(camera_setup, delta);
+		}
+		if (err != LIBWARP_SUCCESS) {
+			break;
+		}
+		
+		// stream out
+		slot.queue->finish();
+		auto mapped_ptr = stream.output->map(*slot.queue, COMPUTE_MEMORY_MAP_FLAG::READ | COMPUTE_MEMORY_MAP_FLAG::BLOCK);
+		if (mapped_ptr == nullptr) {
+			err = LIBWARP_STREAM_FAILURE;
+			break;
+		}
+		const auto success = callbacks->write_rows(callbacks->user_data, dst_row, dst_rows, mapped_ptr);
+		if (!stream.output->unmap(*slot.queue, mapped_ptr) || !success) {
+			err = LIBWARP_STREAM_FAILURE;
+		}
+	}
+	
+	libwarp_state->work_dim_override = {};
+	libwarp_bind_image(libwarp_state->scatter.output, prev_output);
+	return err;
+}
+
+LIBWARP_ERROR_CODE libwarp_scatter_streaming(const libwarp_camera_setup* const camera_setup,
+											 const float delta,
+											 const uint32_t band_height,
+											 const float max_displacement,
+											 const libwarp_stream_callbacks* const callbacks) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	return libwarp_exec_scatter_streaming(camera_setup, delta, band_height, max_displacement, callbacks);
+}
@@ -0,0 +1,568 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "libwarp_internal.hpp"
+#include <libwarp/libwarp_vulkan.h>
+
+#if !defined(FLOOR_NO_VULKAN)
+#include <floor/compute/vulkan/vulkan_device.hpp>
+#include <floor/compute/vulkan/vulkan_image.hpp>
+#include <optional>
+#if defined(__WINDOWS__)
+#include <vulkan/vulkan_win32.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__WINDOWS__)
+static constexpr const auto libwarp_vulkan_memory_handle_type { VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_WIN32_BIT };
+static constexpr const auto libwarp_vulkan_semaphore_handle_type { VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_WIN32_BIT };
+#else
+static constexpr const auto libwarp_vulkan_memory_handle_type { VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT };
+static constexpr const auto libwarp_vulkan_semaphore_handle_type { VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT };
+#endif
+
+// caller images/semaphores that have been imported into the libwarp device
+// NOTE: only accessed while libwarp_lock is held, Vulkan objects are created on/owned by the libwarp device
+static struct {
+	struct imported_image {
+		// identifies the caller image
+		VkImage caller_image { VK_NULL_HANDLE };
+		int64_t memory_handle { 0 };
+		uint64_t memory_offset { 0 };
+		// access mode of the import (an image that is used as input and output is imported once per mode)
+		bool read_write { false };
+		// the aliasing image on the libwarp device
+		VkImage image { VK_NULL_HANDLE };
+		VkImageView image_view { VK_NULL_HANDLE };
+		VkDeviceMemory memory { VK_NULL_HANDLE };
+		shared_ptr<compute_image> wrapped;
+	};
+	vector<imported_image> images;
+	
+	struct imported_semaphore {
+		VkSemaphore caller_semaphore { VK_NULL_HANDLE };
+		int64_t semaphore_handle { 0 };
+		VkSemaphore semaphore { VK_NULL_HANDLE };
+	};
+	vector<imported_semaphore> semaphores;
+} libwarp_vulkan_imports;
+
+static const vulkan_device* libwarp_vulkan_device() {
+	if (libwarp_state->ctx->get_compute_type() != COMPUTE_TYPE::VULKAN) {
+		log_error("libwarp: Vulkan interop requires the Vulkan backend");
+		return nullptr;
+	}
+	return (const vulkan_device*)libwarp_state->dev;
+}
+
+// image formats that can be used by the warp kernels
+static optional<COMPUTE_IMAGE_TYPE> libwarp_vulkan_image_type(const VkFormat format) {
+	switch (format) {
+		case VK_FORMAT_R8G8B8A8_UNORM: return COMPUTE_IMAGE_TYPE::RGBA8UI_NORM;
+		case VK_FORMAT_R16G16B16A16_SFLOAT: return COMPUTE_IMAGE_TYPE::RGBA16F;
+		case VK_FORMAT_R32G32B32A32_SFLOAT: return COMPUTE_IMAGE_TYPE::RGBA32F;
+		case VK_FORMAT_R16G16_SFLOAT: return COMPUTE_IMAGE_TYPE::RG16F;
+		case VK_FORMAT_R32G32_SFLOAT: return COMPUTE_IMAGE_TYPE::RG32F;
+		case VK_FORMAT_R32_SFLOAT: return COMPUTE_IMAGE_TYPE::R32F;
+		case VK_FORMAT_R32_UINT: return COMPUTE_IMAGE_TYPE::R32UI;
+		case VK_FORMAT_D32_SFLOAT: return COMPUTE_IMAGE_TYPE::IMAGE_DEPTH | COMPUTE_IMAGE_TYPE::D32F;
+		default: break;
+	}
+	return {};
+}
+
+static void libwarp_vulkan_destroy_import(const vulkan_device& vk_dev, const decltype(libwarp_vulkan_imports)::imported_image& import) {
+	if (import.image_view != VK_NULL_HANDLE) {
+		vkDestroyImageView(vk_dev.device, import.image_view, nullptr);
+	}
+	if (import.image != VK_NULL_HANDLE) {
+		vkDestroyImage(vk_dev.device, import.image, nullptr);
+	}
+	if (import.memory != VK_NULL_HANDLE) {
+		vkFreeMemory(vk_dev.device, import.memory, nullptr);
+	}
+}
+
+// creates an image on the libwarp device that aliases the caller image memory and wraps it into a compute_image
+static bool libwarp_vulkan_import_image(const vulkan_device& vk_dev,
+										const libwarp_vulkan_image& vk_img,
+										const bool read_write,
+										decltype(libwarp_vulkan_imports)::imported_image& import) {
+	const auto& info = vk_img.create_info;
+	const auto image_type = libwarp_vulkan_image_type(info.format);
+	if (!image_type) {
+		log_error("libwarp: unsupported Vulkan image format $", info.format);
+		return false;
+	}
+	if (info.imageType != VK_IMAGE_TYPE_2D || info.mipLevels != 1 || info.arrayLayers != 1) {
+		log_error("libwarp: only 2D Vulkan images with 1 mip level and 1 layer are supported");
+		return false;
+	}
+	const auto required_usage = (!read_write ? VK_IMAGE_USAGE_SAMPLED_BIT : VK_IMAGE_USAGE_STORAGE_BIT);
+	if ((info.usage & required_usage) == 0 ||
+		(read_write && vk_img.layout != VK_IMAGE_LAYOUT_GENERAL)) {
+		log_error("libwarp: invalid Vulkan image usage or layout");
+		return false;
+	}
+	
+	import.caller_image = vk_img.image;
+	import.memory_handle = vk_img.memory_handle;
+	import.memory_offset = vk_img.memory_offset;
+	import.read_write = read_write;
+	
+	// must be created with the same parameters as the caller image to alias its memory
+	const VkExternalMemoryImageCreateInfo ext_info {
+		.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
+		.pNext = nullptr,
+		.handleTypes = libwarp_vulkan_memory_handle_type,
+	};
+	auto image_info = info;
+	image_info.pNext = &ext_info;
+	image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	image_info.queueFamilyIndexCount = 0;
+	image_info.pQueueFamilyIndices = nullptr;
+	if (vkCreateImage(vk_dev.device, &image_info, nullptr, &import.image) != VK_SUCCESS) {
+		log_error("libwarp: failed to create the Vulkan import image");
+		return false;
+	}
+	
+	VkMemoryRequirements mem_req {};
+	vkGetImageMemoryRequirements(vk_dev.device, import.image, &mem_req);
+	if (vk_img.memory_offset + mem_req.size > vk_img.memory_size) {
+		log_error("libwarp: Vulkan image memory is too small ($ + $ > $)",
+				  vk_img.memory_offset, mem_req.size, vk_img.memory_size);
+		return false;
+	}
+	// NOTE: the memory type can't be queried for opaque handles (vkGet*PropertiesKHR don't accept opaque handle types),
+	//       the import must instead use the memory type of the exporting allocation, which must also be compatible with
+	//       the import image (intersected with its memory requirements)
+	VkPhysicalDeviceMemoryProperties mem_props {};
+	vkGetPhysicalDeviceMemoryProperties(vk_dev.physical_device, &mem_props);
+	const auto mem_type_index = vk_img.memory_type_index;
+	if (mem_type_index >= mem_props.memoryTypeCount ||
+		(mem_req.memoryTypeBits & (1u << mem_type_index)) == 0) {
+		log_error("libwarp: Vulkan image memory type $ is not compatible with the import image (supported type bits: $)",
+				  mem_type_index, mem_req.memoryTypeBits);
+		return false;
+	}
+	
+#if defined(__WINDOWS__)
+	// NOTE: importing a win32 handle does not transfer its ownership
+	const VkImportMemoryWin32HandleInfoKHR import_info {
+		.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_WIN32_HANDLE_INFO_KHR,
+		.pNext = nullptr,
+		.handleType = libwarp_vulkan_memory_handle_type,
+		.handle = (HANDLE)vk_img.memory_handle,
+		.name = nullptr,
+	};
+#else
+	// NOTE: a successful import transfers the fd ownership to the implementation -> import a duplicate
+	const auto fd = dup(int(vk_img.memory_handle));
+	if (fd < 0) {
+		log_error("libwarp: failed to duplicate the Vulkan memory fd");
+		return false;
+	}
+	const VkImportMemoryFdInfoKHR import_info {
+		.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR,
+		.pNext = nullptr,
+		.handleType = libwarp_vulkan_memory_handle_type,
+		.fd = fd,
+	};
+#endif
+	const VkMemoryAllocateInfo alloc_info {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.pNext = &import_info,
+		.allocationSize = vk_img.memory_size,
+		.memoryTypeIndex = mem_type_index,
+	};
+	if (vkAllocateMemory(vk_dev.device, &alloc_info, nullptr, &import.memory) != VK_SUCCESS) {
+#if !defined(__WINDOWS__)
+		close(fd);
+#endif
+		log_error("libwarp: failed to import the Vulkan image memory");
+		return false;
+	}
+	if (vkBindImageMemory(vk_dev.device, import.image, import.memory, vk_img.memory_offset) != VK_SUCCESS) {
+		log_error("libwarp: failed to bind the Vulkan image memory");
+		return false;
+	}
+	
+	const auto is_depth = has_flag<COMPUTE_IMAGE_TYPE::FLAG_DEPTH>(*image_type);
+	const VkImageViewCreateInfo view_info {
+		.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.image = import.image,
+		.viewType = VK_IMAGE_VIEW_TYPE_2D,
+		.format = info.format,
+		.components = {
+			VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+		},
+		.subresourceRange = {
+			.aspectMask = VkImageAspectFlags(is_depth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT),
+			.baseMipLevel = 0,
+			.levelCount = 1,
+			.baseArrayLayer = 0,
+			.layerCount = 1,
+		},
+	};
+	if (vkCreateImageView(vk_dev.device, &view_info, nullptr, &import.image_view) != VK_SUCCESS) {
+		log_error("libwarp: failed to create the Vulkan import image view");
+		return false;
+	}
+	
+	const vulkan_image::external_vulkan_image_info external_info {
+		.image = import.image,
+		.image_view = import.image_view,
+		.format = info.format,
+		.access_mask = (!read_write ? VK_ACCESS_2_SHADER_READ_BIT : VK_ACCESS_2_SHADER_WRITE_BIT),
+		.layout = vk_img.layout,
+		.image_base_type = COMPUTE_IMAGE_TYPE::IMAGE_2D | *image_type,
+		.dim = { info.extent.width, info.extent.height, 0u, 0u },
+	};
+	import.wrapped = make_shared<vulkan_image>(*libwarp_state->dev_queue, external_info, std::span<uint8_t> {},
+											   !read_write ? COMPUTE_MEMORY_FLAG::READ : COMPUTE_MEMORY_FLAG::READ_WRITE);
+	return (import.wrapped != nullptr);
+}
+
+// unbinds the specified wrapped image from all warp state it may have been bound to by the Vulkan warp functions
+static void libwarp_vulkan_unbind_image(const shared_ptr<compute_image>& img) {
+	const auto unbind = [&img](shared_ptr<compute_image>& bound_img) {
+		if (bound_img == img) {
+			bound_img = nullptr;
+		}
+	};
+	unbind(libwarp_state->scatter.color);
+	unbind(libwarp_state->scatter.depth);
+	unbind(libwarp_state->scatter.motion);
+	unbind(libwarp_state->scatter.output);
+	unbind(libwarp_state->gather_forward.color);
+	unbind(libwarp_state->gather_forward.motion);
+	unbind(libwarp_state->gather_forward.output);
+	for (auto& bound_img : libwarp_state->gather.color) unbind(bound_img);
+	for (auto& bound_img : libwarp_state->gather.depth) unbind(bound_img);
+	for (auto& bound_img : libwarp_state->gather.motion) unbind(bound_img);
+	for (auto& bound_img : libwarp_state->gather.motion_depth) unbind(bound_img);
+	unbind(libwarp_state->gather.output);
+}
+
+// returns the cached wrapper of the specified caller image, importing it on first use (nullptr on failure)
+static shared_ptr<compute_image> libwarp_wrap_vulkan_image(const vulkan_device& vk_dev,
+														   const libwarp_vulkan_image* const vk_img,
+														   const bool read_write = false) {
+	if (vk_img == nullptr) {
+		return {};
+	}
+	for (const auto& import : libwarp_vulkan_imports.images) {
+		if (import.caller_image == vk_img->image &&
+			import.memory_handle == vk_img->memory_handle &&
+			import.memory_offset == vk_img->memory_offset &&
+			import.read_write == read_write) {
+			return import.wrapped;
+		}
+	}
+	
+	decltype(libwarp_vulkan_imports)::imported_image import;
+	if (!libwarp_vulkan_import_image(vk_dev, *vk_img, read_write, import)) {
+		libwarp_vulkan_destroy_import(vk_dev, import);
+		return {};
+	}
+	libwarp_vulkan_imports.images.emplace_back(import);
+	return import.wrapped;
+}
+
+// returns the libwarp device semaphore of the specified caller timeline semaphore, importing it on first use
+static VkSemaphore libwarp_vulkan_import_semaphore(const vulkan_device& vk_dev, const libwarp_vulkan_sync& sync) {
+	for (const auto& import : libwarp_vulkan_imports.semaphores) {
+		if (import.caller_semaphore == sync.semaphore && import.semaphore_handle == sync.semaphore_handle) {
+			return import.semaphore;
+		}
+	}
+	
+	const VkSemaphoreTypeCreateInfo type_info {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+		.pNext = nullptr,
+		.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+		.initialValue = 0,
+	};
+	const VkSemaphoreCreateInfo sema_info {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		.pNext = &type_info,
+		.flags = 0,
+	};
+	VkSemaphore sema { VK_NULL_HANDLE };
+	if (vkCreateSemaphore(vk_dev.device, &sema_info, nullptr, &sema) != VK_SUCCESS) {
+		log_error("libwarp: failed to create the Vulkan import semaphore");
+		return VK_NULL_HANDLE;
+	}
+	
+#if defined(__WINDOWS__)
+	const auto import_func = (PFN_vkImportSemaphoreWin32HandleKHR)vkGetDeviceProcAddr(vk_dev.device, "vkImportSemaphoreWin32HandleKHR");
+	const VkImportSemaphoreWin32HandleInfoKHR import_info {
+		.sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_WIN32_HANDLE_INFO_KHR,
+		.pNext = nullptr,
+		.semaphore = sema,
+		.flags = 0,
+		.handleType = libwarp_vulkan_semaphore_handle_type,
+		.handle = (HANDLE)sync.semaphore_handle,
+		.name = nullptr,
+	};
+	const auto import_ok = (import_func != nullptr && import_func(vk_dev.device, &import_info) == VK_SUCCESS);
+#else
+	const auto import_func = (PFN_vkImportSemaphoreFdKHR)vkGetDeviceProcAddr(vk_dev.device, "vkImportSemaphoreFdKHR");
+	// NOTE: as with memory, a successful import transfers the fd ownership
+	const auto fd = dup(int(sync.semaphore_handle));
+	const VkImportSemaphoreFdInfoKHR import_info {
+		.sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_FD_INFO_KHR,
+		.pNext = nullptr,
+		.semaphore = sema,
+		.flags = 0,
+		.handleType = libwarp_vulkan_semaphore_handle_type,
+		.fd = fd,
+	};
+	const auto import_ok = (import_func != nullptr && fd >= 0 && import_func(vk_dev.device, &import_info) == VK_SUCCESS);
+	if (!import_ok && fd >= 0) {
+		close(fd);
+	}
+#endif
+	if (!import_ok) {
+		log_error("libwarp: failed to import the Vulkan timeline semaphore (external semaphore support is required)");
+		vkDestroySemaphore(vk_dev.device, sema, nullptr);
+		return VK_NULL_HANDLE;
+	}
+	libwarp_vulkan_imports.semaphores.emplace_back(decltype(libwarp_vulkan_imports)::imported_semaphore {
+		.caller_semaphore = sync.semaphore,
+		.semaphore_handle = sync.semaphore_handle,
+		.semaphore = sema,
+	});
+	return sema;
+}
+
+// host-side wait on the caller semaphore before any image is accessed
+// NOTE: libfloor queues don't expose semaphore waits/signals of their submissions, so synchronization happens on the host
+static LIBWARP_ERROR_CODE libwarp_vulkan_wait(const vulkan_device& vk_dev, const libwarp_vulkan_sync* const sync, VkSemaphore& sema) {
+	if (sync == nullptr) {
+		return LIBWARP_SUCCESS;
+	}
+	sema = libwarp_vulkan_import_semaphore(vk_dev, *sync);
+	if (sema == VK_NULL_HANDLE) {
+		return LIBWARP_VULKAN_SYNC_FAILURE;
+	}
+	const VkSemaphoreWaitInfo wait_info {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.semaphoreCount = 1,
+		.pSemaphores = &sema,
+		.pValues = &sync->wait_value,
+	};
+	if (vkWaitSemaphores(vk_dev.device, &wait_info, ~0ull) != VK_SUCCESS) {
+		log_error("libwarp: failed to wait on the Vulkan timeline semaphore");
+		return LIBWARP_VULKAN_SYNC_FAILURE;
+	}
+	return LIBWARP_SUCCESS;
+}
+
+// waits for the warp to complete and signals the caller semaphore
+static LIBWARP_ERROR_CODE libwarp_vulkan_signal(const vulkan_device& vk_dev, const libwarp_vulkan_sync* const sync, VkSemaphore sema,
+												const LIBWARP_ERROR_CODE warp_err) {
+	if (sync == nullptr) {
+		return warp_err;
+	}
+	// NOTE: the semaphore is also signaled if the warp failed, so that the caller never deadlocks
+	libwarp_state->slots[libwarp_state->cur_slot].queue->finish();
+	const VkSemaphoreSignalInfo signal_info {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO,
+		.pNext = nullptr,
+		.semaphore = sema,
+		.value = sync->signal_value,
+	};
+	if (vkSignalSemaphore(vk_dev.device, &signal_info) != VK_SUCCESS) {
+		log_error("libwarp: failed to signal the Vulkan timeline semaphore");
+		return (warp_err != LIBWARP_SUCCESS ? warp_err : LIBWARP_VULKAN_SYNC_FAILURE);
+	}
+	return warp_err;
+}
+
+LIBWARP_ERROR_CODE libwarp_get_vulkan_device_uuid(uint8_t* uuid) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	const auto vk_dev = libwarp_vulkan_device();
+	if (vk_dev == nullptr || uuid == nullptr) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	VkPhysicalDeviceIDProperties id_props {
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+		.pNext = nullptr,
+	};
+	VkPhysicalDeviceProperties2 props {
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+		.pNext = &id_props,
+	};
+	vkGetPhysicalDeviceProperties2(vk_dev->physical_device, &props);
+	memcpy(uuid, id_props.deviceUUID, VK_UUID_SIZE);
+	return LIBWARP_SUCCESS;
+}
+
+LIBWARP_ERROR_CODE libwarp_scatter_vulkan(const libwarp_camera_setup* const camera_setup,
+										  const float delta,
+										  const bool clear_frame,
+										  const libwarp_vulkan_image* const color_image,
+										  const libwarp_vulkan_image* const depth_image,
+										  const libwarp_vulkan_image* const motion_image,
+										  const libwarp_vulkan_image* const output_image,
+										  const libwarp_vulkan_sync* const sync) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	const auto vk_dev = libwarp_vulkan_device();
+	if (vk_dev == nullptr) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	// import/wrap images
+	const auto color = libwarp_wrap_vulkan_image(*vk_dev, color_image);
+	const auto depth = libwarp_wrap_vulkan_image(*vk_dev, depth_image);
+	const auto motion = libwarp_wrap_vulkan_image(*vk_dev, motion_image);
+	const auto output = libwarp_wrap_vulkan_image(*vk_dev, output_image, true);
+	if (!color || !depth || !motion || !output) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	VkSemaphore sema { VK_NULL_HANDLE };
+	if (const auto err = libwarp_vulkan_wait(*vk_dev, sync, sema); err != LIBWARP_SUCCESS) {
+		return err;
+	}
+	
+	libwarp_bind_scatter_floor(color, depth, motion, output);
+	return libwarp_vulkan_signal(*vk_dev, sync, sema, libwarp_exec_scatter(camera_setup, delta, clear_frame));
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_vulkan(const libwarp_camera_setup* const camera_setup,
+										 const float delta,
+										 const libwarp_vulkan_image* const color_current_image,
+										 const libwarp_vulkan_image* const depth_current_image,
+										 const libwarp_vulkan_image* const color_prev_image,
+										 const libwarp_vulkan_image* const depth_prev_image,
+										 const libwarp_vulkan_image* const motion_forward_image,
+										 const libwarp_vulkan_image* const motion_backward_image,
+										 const libwarp_vulkan_image* const motion_depth_forward_image,
+										 const libwarp_vulkan_image* const motion_depth_backward_image,
+										 const libwarp_vulkan_image* const output_image,
+										 const libwarp_vulkan_sync* const sync) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	const auto vk_dev = libwarp_vulkan_device();
+	if (vk_dev == nullptr) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	// import/wrap images
+	const auto color_current = libwarp_wrap_vulkan_image(*vk_dev, color_current_image);
+	const auto depth_current = libwarp_wrap_vulkan_image(*vk_dev, depth_current_image);
+	const auto color_prev = libwarp_wrap_vulkan_image(*vk_dev, color_prev_image);
+	const auto depth_prev = libwarp_wrap_vulkan_image(*vk_dev, depth_prev_image);
+	const auto motion_forward = libwarp_wrap_vulkan_image(*vk_dev, motion_forward_image);
+	const auto motion_backward = libwarp_wrap_vulkan_image(*vk_dev, motion_backward_image);
+	const auto motion_depth_forward = libwarp_wrap_vulkan_image(*vk_dev, motion_depth_forward_image);
+	const auto motion_depth_backward = libwarp_wrap_vulkan_image(*vk_dev, motion_depth_backward_image);
+	const auto output = libwarp_wrap_vulkan_image(*vk_dev, output_image, true);
+	if (!color_current || !depth_current || !color_prev || !depth_prev ||
+		!motion_forward || !motion_backward || !motion_depth_forward || !motion_depth_backward || !output) {
+		return LIBWARP_IMAGE_WRAP_FAILURE;
+	}
+	
+	VkSemaphore sema { VK_NULL_HANDLE };
+	if (const auto err = libwarp_vulkan_wait(*vk_dev, sync, sema); err != LIBWARP_SUCCESS) {
+		return err;
+	}
+	
+	const auto img_set = libwarp_bind_gather_floor(color_current, depth_current, color_prev, depth_prev,
+												   motion_forward, motion_backward, motion_depth_forward, motion_depth_backward,
+												   output);
+	return libwarp_vulkan_signal(*vk_dev, sync, sema, libwarp_exec_gather(camera_setup, delta, img_set));
+}
+
+LIBWARP_ERROR_CODE libwarp_gather_forward_only_vulkan(const libwarp_camera_setup* const camera_setup,
+													  const float delta,
+													  const libwarp_vulkan_image* const color_image,
+													  const libwarp_vulkan_image* const motion_image,
+													  const libwarp_vulkan_image* const output_image,
+													  const libwarp_vulkan_sync* const sync) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	const auto vk_dev = libwarp_vulkan_device();
+	if (vk_dev == nullptr) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	// import/wrap images
+	const auto color = libwarp_wrap_vulkan_image(*vk_dev, color_image);
+	const auto motion = libwarp_wrap_vulkan_image(*vk_dev, motion_image);
+	const auto output = libwarp_wrap_vulkan_image(*vk_dev, output_image, true);
+	if (!color || !motion || !output) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	VkSemaphore sema { VK_NULL_HANDLE };
+	if (const auto err = libwarp_vulkan_wait(*vk_dev, sync, sema); err != LIBWARP_SUCCESS) {
+		return err;
+	}
+	
+	libwarp_bind_gather_forward_only_floor(color, motion, output);
+	return libwarp_vulkan_signal(*vk_dev, sync, sema, libwarp_exec_gather_forward_only(camera_setup, delta));
+}
+
+LIBWARP_ERROR_CODE libwarp_release_vulkan_image(VkImage image) REQUIRES(!libwarp_lock) {
+	LIBWARP_INIT_AND_LOCK
+	
+	const auto vk_dev = libwarp_vulkan_device();
+	if (vk_dev == nullptr) return LIBWARP_IMAGE_WRAP_FAILURE;
+	
+	const auto released = [image](const decltype(libwarp_vulkan_imports)::imported_image& import) {
+		return (import.caller_image == image);
+	};
+	if (none_of(libwarp_vulkan_imports.images.begin(), libwarp_vulkan_imports.images.end(), released)) {
+		return LIBWARP_SUCCESS;
+	}
+	
+	// the import may still be in use by in-flight warps or bound to the warp state
+	libwarp_finish_slots();
+	for (const auto& import : libwarp_vulkan_imports.images) {
+		if (!released(import)) continue;
+		libwarp_vulkan_unbind_image(import.wrapped);
+		libwarp_vulkan_destroy_import(*vk_dev, import);
+	}
+	erase_if(libwarp_vulkan_imports.images, released);
+	return LIBWARP_SUCCESS;
+}
+
+void libwarp_vulkan_cleanup() {
+	if (libwarp_state == nullptr ||
+		libwarp_state->ctx->get_compute_type() != COMPUTE_TYPE::VULKAN) {
+		return;
+	}
+	const auto& vk_dev = *(const vulkan_device*)libwarp_state->dev;
+	for (const auto& import : libwarp_vulkan_imports.images) {
+		libwarp_vulkan_destroy_import(vk_dev, import);
+	}
+	libwarp_vulkan_imports.images.clear();
+	for (const auto& import : libwarp_vulkan_imports.semaphores) {
+		vkDestroySemaphore(vk_dev.device, import.semaphore, nullptr);
+	}
+	libwarp_vulkan_imports.semaphores.clear();
+}
+
+#else
+
+void libwarp_vulkan_cleanup() {
+	// nop
+}
+
+#endif
@@ -0,0 +1,680 @@
+/*
+ *  libwarp
+ *  Copyright (C) 2015 - 2021 Florian Ziesche
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; version 2 of the License only.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+// differential test of the libfloor backend against the CPU reference implementation (see libwarp_cpu.cpp):
+// generates inputs for each test case, warps them with the backend and with the CPU reference implementation
+// and compares both outputs, each test case starts with a fresh libwarp state (no bindings or options of a previous case)
+// NOTE: pixels at depth discontinuities or in between splat footprints may legitimately differ due to floating point
+//       differences (e.g. fast-math on the device), so a small ratio of mismatching pixels is allowed
+
+#include <libwarp/libwarp.h>
+#include <libwarp/libwarp.hpp>
+#include <floor/floor/floor.hpp>
+#include <random>
+#include <cstdio>
+
+// warp modes that are validated against the CPU reference implementation
+enum class VALIDATE_MODE {
+	SCATTER,
+	GATHER_BIDIRECTIONAL,
+	GATHER_FORWARD_ONLY,
+};
+
+// inputs that are generated for a test case
+enum class VALIDATE_INPUT {
+	// uniformly distributed random color, depth and motion per pixel
+	RANDOM,
+	// smooth background with overlapping moving rectangles at different depths (occlusions and disocclusions)
+	SYNTHETIC,
+	// only the background at a constant depth, with the same motion everywhere (see background_motion)
+	CONSTANT_MOTION,
+};
+
+// optional outputs/features that are enabled for a test case, none of these may change the warp output
+enum class VALIDATE_FEATURE {
+	NONE,
+	CONFIDENCE_OUTPUT,
+	BLOCK_MOTION_OUTPUT,
+	DEPTH_PYRAMID,
+};
+
+// per-pixel tolerances:
+// scatter only uses exact texel reads, gather is bounded by the sub-texel precision of hardware bilinear filtering
+static constexpr const float scatter_tolerance { 0.001f };
+static constexpr const float gather_tolerance { 0.02f };
+// max ratio of pixels that may exceed the tolerance
+static constexpr const float max_mismatch_ratio { 0.01f };
+// normalized 2D screen-space motion per frame of the background of the synthetic inputs
+static constexpr const float2 background_motion { 0.005f, -0.0025f };
+
+// compute context/device/queue of the test (libwarp uses the same context)
+static shared_ptr<compute_context> ctx;
+static shared_ptr<compute_queue> dev_queue;
+
+// tightly packed host image, that is both uploaded to the backend and used by the CPU reference
+struct validation_image {
+	vector<uint8_t> data;
+	uint32_t width { 0u };
+	uint32_t height { 0u };
+	size_t texel_size { 0u };
+	
+	validation_image(const uint2& dim, const size_t texel_size_) :
+	data(size_t(dim.x) * size_t(dim.y) * texel_size_), width(dim.x), height(dim.y), texel_size(texel_size_) {}
+	
+	template <typename texel_type>
+	texel_type& at(const uint32_t x, const uint32_t y) {
+		return ((texel_type*)data.data())[size_t(y) * size_t(width) + size_t(x)];
+	}
+	
+	libwarp_cpu_image cpu_image() {
+		return { data.data(), width, height, size_t(width) * texel_size };
+	}
+};
+
+// all inputs of a validation run
+// NOTE: depth and motion have the input resolution with scatter (see input_downscale), motion is encoded 3D motion with
+//       scatter and packed 2D motion with gather, the remaining images are only used by the bidirectional gather
+struct validation_inputs {
+	validation_image color;
+	validation_image depth;
+	validation_image motion;
+	validation_image color_prev;
+	validation_image depth_prev;
+	validation_image motion_backward;
+	validation_image motion_depth_forward;
+	validation_image motion_depth_backward;
+	
+	validation_inputs(const uint2& dim, const uint2& input_dim) :
+	color(dim, sizeof(float4)), depth(input_dim, sizeof(float)), motion(input_dim, sizeof(uint32_t)),
+	color_prev(dim, sizeof(float4)), depth_prev(dim, sizeof(float)), motion_backward(dim, sizeof(uint32_t)),
+	motion_depth_forward(dim, sizeof(float2)), motion_depth_backward(dim, sizeof(float2)) {}
+};
+
+// inverse of warp_camera::linearize_depth
+static float encode_depth(const libwarp_camera_setup* const camera_setup, const float linear_depth) {
+	const auto near_plane = camera_setup->near_plane;
+	const auto far_plane = camera_setup->far_plane;
+	switch (camera_setup->depth_type) {
+		case LIBWARP_DEPTH_NORMALIZED:
+			if (camera_setup->projection == LIBWARP_PROJECTION_ORTHOGRAPHIC) {
+				return (linear_depth - near_plane) / (far_plane - near_plane);
+			} else {
+				const float2 near_far_projection {
+					-(far_plane + near_plane) / (near_plane - far_plane),
+					(2.0f * far_plane * near_plane) / (near_plane - far_plane),
+				};
+				return near_far_projection.x + near_far_projection.y / linear_depth;
+			}
+		case LIBWARP_DEPTH_Z_DIV_W:
+			return (linear_depth - near_plane) / (1.0f - near_plane / far_plane);
+		case LIBWARP_DEPTH_LINEAR:
+			return linear_depth;
+	}
+	floor_unreachable();
+}
+
+// inverse of decode_3d_motion (log-encoded 10/9/10-bit magnitudes + sign bits)
+static uint32_t encode_3d_motion(const float3& motion) {
+	const auto encode = [](const float& val, const uint32_t max_val) {
+		const auto scale = float(max_val + 1u) / std::log2(65.0f);
+		return min(uint32_t(std::round(std::log2(std::abs(val) + 1.0f) * scale)), max_val);
+	};
+	return ((motion.x < 0.0f ? 0x80000000u : 0u) |
+			(motion.y < 0.0f ? 0x40000000u : 0u) |
+			(motion.z < 0.0f ? 0x20000000u : 0u) |
+			(encode(motion.x, 0x3FFu) << 19u) |
+			(encode(motion.y, 0x1FFu) << 10u) |
+			encode(motion.z, 0x3FFu));
+}
+
+// inverse of decode_2d_motion (2x snorm16, scaled by 0.5)
+static uint32_t encode_2d_motion(const float2& motion) {
+	const auto encode = [](const float& val) {
+		return uint32_t(uint16_t(int16_t(std::round(std::clamp(val * 2.0f, -1.0f, 1.0f) * 32767.0f))));
+	};
+	return (encode(motion.x) | (encode(motion.y) << 16u));
+}
+
+// fills all inputs according to the specified validation input type
+static void generate_inputs(const libwarp_camera_setup* const camera_setup,
+							const VALIDATE_MODE mode,
+							const VALIDATE_INPUT input,
+							const uint32_t seed,
+							validation_inputs& inputs) {
+	mt19937 gen { seed };
+	uniform_real_distribution<float> unit_dist { 0.0f, 1.0f };
+	const auto rand_unit = [&gen, &unit_dist] { return unit_dist(gen); };
+	const auto rand_snorm = [&gen, &unit_dist] { return unit_dist(gen) * 2.0f - 1.0f; };
+	const bool is_random = (input == VALIDATE_INPUT::RANDOM);
+	
+	// keep depth within the front half of the depth range
+	const auto near_plane = camera_setup->near_plane;
+	const auto depth_range = camera_setup->far_plane - near_plane;
+	const auto to_linear_depth = [&near_plane, &depth_range](const float& t) {
+		return near_plane + depth_range * (0.05f + 0.45f * t);
+	};
+	
+	// synthetic scene: textured background + textured rectangles at different depths, moving in different directions
+	struct scene_rect {
+		float2 min_pos;
+		float2 max_pos;
+		float depth;
+		float2 motion;
+		float3 color;
+	};
+	vector<scene_rect> rects;
+	if (input == VALIDATE_INPUT::SYNTHETIC) {
+		for (uint32_t i = 0; i < 4u; ++i) {
+			const float2 min_pos { rand_unit() * 0.7f, rand_unit() * 0.7f };
+			const float2 size { 0.1f + rand_unit() * 0.2f, 0.1f + rand_unit() * 0.2f };
+			const float depth = rand_unit() * 0.5f;
+			const float2 motion { rand_snorm() * 0.02f, rand_snorm() * 0.02f };
+			const float3 color { rand_unit(), rand_unit(), rand_unit() };
+			rects.emplace_back(scene_rect { min_pos, min_pos + size, depth, motion, color });
+		}
+	}
+	struct scene_sample {
+		float3 color;
+		// in [0, 1], see to_linear_depth
+		float depth;
+		// normalized 2D screen-space motion per frame
+		float2 motion;
+	};
+	// evaluates the synthetic scene at the normalized position and time (current frame: 0, previous frame: -1)
+	const auto eval_scene = [&rects, &input](const float2& pos, const float& time) {
+		const auto checker = [](const float2& p, const float& freq) {
+			return float(((uint32_t(p.x * freq) + uint32_t(p.y * freq)) & 1u) != 0u);
+		};
+		const auto bg_pos = pos - background_motion * time;
+		scene_sample ret {
+			float3 { bg_pos.x, bg_pos.y, 0.25f + 0.5f * checker(bg_pos, 32.0f) },
+			(input == VALIDATE_INPUT::CONSTANT_MOTION ? 0.6f : 0.6f + 0.4f * const_math::clamp(bg_pos.y, 0.0f, 1.0f)),
+			background_motion,
+		};
+		for (const auto& rect : rects) {
+			const auto rect_pos = pos - rect.motion * time;
+			if (rect_pos.x >= rect.min_pos.x && rect_pos.y >= rect.min_pos.y &&
+				rect_pos.x < rect.max_pos.x && rect_pos.y < rect.max_pos.y && rect.depth < ret.depth) {
+				ret = { rect.color * (0.75f + 0.25f * checker(rect_pos - rect.min_pos, 64.0f)), rect.depth, rect.motion };
+			}
+		}
+		return ret;
+	};
+	
+	// calls 'func(texel, sample)' for all texels of the image, with the random or synthetic scene sample of the texel
+	const auto fill = [&](validation_image& img, const float& time, const auto& func) {
+		for (uint32_t y = 0; y < img.height; ++y) {
+			for (uint32_t x = 0; x < img.width; ++x) {
+				scene_sample sample;
+				if (is_random) {
+					sample = {
+						float3 { rand_unit(), rand_unit(), rand_unit() },
+						rand_unit(),
+						float2 { rand_snorm(), rand_snorm() } * 0.02f,
+					};
+				} else {
+					sample = eval_scene((float2 { float(x), float(y) } + 0.5f) / float2 { float(img.width), float(img.height) }, time);
+				}
+				func(x, y, sample);
+			}
+		}
+	};
+	
+	fill(inputs.color, 0.0f, [&inputs](const uint32_t x, const uint32_t y, const scene_sample& sample) {
+		inputs.color.at<float4>(x, y) = { sample.color, 1.0f };
+	});
+	fill(inputs.depth, 0.0f, [&](const uint32_t x, const uint32_t y, const scene_sample& sample) {
+		inputs.depth.at<float>(x, y) = encode_depth(camera_setup, to_linear_depth(sample.depth));
+	});
+	if (mode == VALIDATE_MODE::SCATTER) {
+		fill(inputs.motion, 0.0f, [&](const uint32_t x, const uint32_t y, const scene_sample& sample) {
+			// 3D motion in world units: scaled by the linear depth, so that the screen-space motion has a similar magnitude
+			const auto linear_depth = to_linear_depth(sample.depth);
+			const float3 motion { sample.motion.x * linear_depth, sample.motion.y * linear_depth, rand_snorm() * 0.01f * linear_depth };
+			inputs.motion.at<uint32_t>(x, y) = encode_3d_motion(motion);
+		});
+		return;
+	}
+	fill(inputs.motion, 0.0f, [&inputs](const uint32_t x, const uint32_t y, const scene_sample& sample) {
+		inputs.motion.at<uint32_t>(x, y) = encode_2d_motion(sample.motion);
+	});
+	if (mode == VALIDATE_MODE::GATHER_FORWARD_ONLY) {
+		return;
+	}
+	
+	fill(inputs.color_prev, -1.0f, [&inputs](const uint32_t x, const uint32_t y, const scene_sample& sample) {
+		inputs.color_prev.at<float4>(x, y) = { sample.color, 1.0f };
+	});
+	fill(inputs.depth_prev, -1.0f, [&](const uint32_t x, const uint32_t y, const scene_sample& sample) {
+		inputs.depth_prev.at<float>(x, y) = encode_depth(camera_setup, to_linear_depth(sample.depth));
+	});
+	fill(inputs.motion_backward, -1.0f, [&inputs](const uint32_t x, const uint32_t y, const scene_sample& sample) {
+		inputs.motion_backward.at<uint32_t>(x, y) = encode_2d_motion(-sample.motion);
+	});
+	// motion depth: z/w depth deltas, constant depth per surface in the synthetic scene
+	fill(inputs.motion_depth_forward, 0.0f, [&](const uint32_t x, const uint32_t y, const scene_sample&) {
+		inputs.motion_depth_forward.at<float2>(x, y) = (is_random ? float2 { rand_snorm(), rand_snorm() } * 0.01f : float2 { 0.0f });
+	});
+	fill(inputs.motion_depth_backward, -1.0f, [&](const uint32_t x, const uint32_t y, const scene_sample&) {
+		inputs.motion_depth_backward.at<float2>(x, y) = (is_random ? float2 { rand_snorm(), rand_snorm() } * 0.01f : float2 { 0.0f });
+	});
+}
+
+// creates a backend image of the specified type and uploads the host image
+static shared_ptr<compute_image> upload(const validation_image& img, const COMPUTE_IMAGE_TYPE type) {
+	auto dev_img = ctx->create_image(*dev_queue, uint4 { img.width, img.height, 0u, 0u }, type,
+									 COMPUTE_MEMORY_FLAG::READ_WRITE | COMPUTE_MEMORY_FLAG::HOST_READ_WRITE);
+	if (dev_img == nullptr) {
+		return nullptr;
+	}
+	auto mapped_ptr = dev_img->map(*dev_queue, COMPUTE_MEMORY_MAP_FLAG::WRITE_INVALIDATE | COMPUTE_MEMORY_MAP_FLAG::BLOCK);
+	if (mapped_ptr == nullptr) {
+		return nullptr;
+	}
+	memcpy(mapped_ptr, img.data.data(), img.data.size());
+	if (!dev_img->unmap(*dev_queue, mapped_ptr)) {
+		return nullptr;
+	}
+	return dev_img;
+}
+
+// reads back the backend image into the host image
+static bool read_back(compute_image& dev_img, validation_image& img) {
+	auto mapped_ptr = dev_img.map(*dev_queue, COMPUTE_MEMORY_MAP_FLAG::READ | COMPUTE_MEMORY_MAP_FLAG::BLOCK);
+	if (mapped_ptr == nullptr) {
+		return false;
+	}
+	memcpy(img.data.data(), mapped_ptr, img.data.size());
+	return dev_img.unmap(*dev_queue, mapped_ptr);
+}
+
+struct validation_case {
+	VALIDATE_MODE mode;
+	VALIDATE_INPUT input;
+	VALIDATE_FEATURE feature;
+	libwarp_camera_setup camera_setup;
+	
+	string name() const {
+		static constexpr const char* mode_names[] { "scatter", "gather bidirectional", "gather forward-only" };
+		static constexpr const char* input_names[] { "random", "synthetic", "constant motion" };
+		static constexpr const char* feature_names[] { "", ", confidence output", ", block motion output", ", depth pyramid" };
+		static constexpr const char* projection_names[] { "perspective", "orthographic", "equirectangular", "cubemap face" };
+		static constexpr const char* depth_type_names[] { "normalized", "z/w", "linear" };
+		static constexpr const char* splat_mode_names[] { "none", "2x2", "adaptive" };
+		string ret = string(mode_names[uint32_t(mode)]) + " (" + input_names[uint32_t(input)] + ", " +
+					 projection_names[camera_setup.projection] + ", depth " + depth_type_names[camera_setup.depth_type];
+		if (mode == VALIDATE_MODE::SCATTER) {
+			ret += string(", splat ") + splat_mode_names[camera_setup.splat_mode] +
+				   ", input downscale " + to_string(camera_setup.input_downscale);
+		}
+		return ret + feature_names[uint32_t(feature)] + ")";
+	}
+};
+
+// runs a single test case on a fresh libwarp state, returns true if the backend output matches the reference output
+static bool run_case(const validation_case& test_case, const uint32_t seed, const float delta) {
+	const auto& camera_setup = test_case.camera_setup;
+	const auto mode = test_case.mode;
+	const auto fail = [&test_case](const string& reason) {
+		printf("FAILED: %s: %s\n", test_case.name().c_str(), reason.c_str());
+		libwarp_destroy();
+		return false;
+	};
+	
+	const uint2 dim { camera_setup.screen_width, camera_setup.screen_height };
+	// only scatter supports reduced resolution depth/motion inputs
+	const auto input_dim = (mode == VALIDATE_MODE::SCATTER ? (dim + camera_setup.input_downscale - 1u) / camera_setup.input_downscale : dim);
+	validation_inputs inputs { dim, input_dim };
+	generate_inputs(&camera_setup, mode, test_case.input, seed, inputs);
+	
+	// upload all inputs
+	const auto color_type = COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::RGBA32F | COMPUTE_IMAGE_TYPE::READ;
+	// native depth images for all depth types except z/w (see NATIVE_DEPTH_IMAGE)
+	const auto depth_type = (camera_setup.depth_type == LIBWARP_DEPTH_Z_DIV_W ?
+							 COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::R32F :
+							 COMPUTE_IMAGE_TYPE::IMAGE_DEPTH | COMPUTE_IMAGE_TYPE::D32F) | COMPUTE_IMAGE_TYPE::READ;
+	const auto motion_type = COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::R32UI | COMPUTE_IMAGE_TYPE::READ;
+	const auto motion_depth_type = COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::RG32F | COMPUTE_IMAGE_TYPE::READ;
+	validation_image output { dim, sizeof(float4) };
+	auto color = upload(inputs.color, color_type);
+	auto depth = upload(inputs.depth, depth_type);
+	auto motion = upload(inputs.motion, motion_type);
+	auto dev_output = upload(output, COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::RGBA32F | COMPUTE_IMAGE_TYPE::READ_WRITE);
+	if (color == nullptr || depth == nullptr || motion == nullptr || dev_output == nullptr) {
+		return fail("failed to create the input/output images");
+	}
+	shared_ptr<compute_image> color_prev, depth_prev, motion_backward, motion_depth_forward, motion_depth_backward;
+	if (mode == VALIDATE_MODE::GATHER_BIDIRECTIONAL) {
+		color_prev = upload(inputs.color_prev, color_type);
+		depth_prev = upload(inputs.depth_prev, depth_type);
+		motion_backward = upload(inputs.motion_backward, motion_type);
+		motion_depth_forward = upload(inputs.motion_depth_forward, motion_depth_type);
+		motion_depth_backward = upload(inputs.motion_depth_backward, motion_depth_type);
+		if (color_prev == nullptr || depth_prev == nullptr || motion_backward == nullptr ||
+			motion_depth_forward == nullptr || motion_depth_backward == nullptr) {
+			return fail("failed to create the input images");
+		}
+	}
+	
+	// enable the optional output/feature
+	validation_image confidence { dim, sizeof(float) };
+	shared_ptr<compute_image> dev_confidence;
+	LIBWARP_ERROR_CODE feature_err { LIBWARP_SUCCESS };
+	switch (test_case.feature) {
+		case VALIDATE_FEATURE::NONE:
+			break;
+		case VALIDATE_FEATURE::CONFIDENCE_OUTPUT:
+			dev_confidence = upload(confidence, COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::R32F |
+									COMPUTE_IMAGE_TYPE::READ_WRITE);
+			if (dev_confidence == nullptr) {
+				return fail("failed to create the confidence image");
+			}
+			feature_err = libwarp_set_confidence_output_floor(dev_confidence);
+			break;
+		case VALIDATE_FEATURE::BLOCK_MOTION_OUTPUT:
+			feature_err = libwarp_set_block_motion_output(8u);
+			break;
+		case VALIDATE_FEATURE::DEPTH_PYRAMID:
+			feature_err = libwarp_set_gather_depth_pyramid(true);
+			break;
+	}
+	if (feature_err != LIBWARP_SUCCESS) {
+		return fail("failed to enable the feature: " + to_string(feature_err));
+	}
+	
+	// warp with the backend and the reference implementation
+	auto cpu_color = inputs.color.cpu_image();
+	auto cpu_depth = inputs.depth.cpu_image();
+	auto cpu_motion = inputs.motion.cpu_image();
+	validation_image ref_output { dim, sizeof(float4) };
+	auto cpu_output = ref_output.cpu_image();
+	LIBWARP_ERROR_CODE dev_err { LIBWARP_SUCCESS }, ref_err { LIBWARP_SUCCESS };
+	switch (mode) {
+		case VALIDATE_MODE::SCATTER:
+			dev_err = libwarp::scatter(camera_setup, delta, true, { color, depth, motion, dev_output });
+			ref_err = libwarp_scatter_cpu(&camera_setup, delta, true, &cpu_color, &cpu_depth, &cpu_motion, &cpu_output);
+			break;
+		case VALIDATE_MODE::GATHER_BIDIRECTIONAL: {
+			dev_err = libwarp::gather(camera_setup, delta, {
+				color, depth, color_prev, depth_prev, motion, motion_backward,
+				motion_depth_forward, motion_depth_backward, dev_output
+			});
+			auto cpu_color_prev = inputs.color_prev.cpu_image();
+			auto cpu_depth_prev = inputs.depth_prev.cpu_image();
+			auto cpu_motion_backward = inputs.motion_backward.cpu_image();
+			auto cpu_motion_depth_forward = inputs.motion_depth_forward.cpu_image();
+			auto cpu_motion_depth_backward = inputs.motion_depth_backward.cpu_image();
+			ref_err = libwarp_gather_cpu(&camera_setup, delta, &cpu_color, &cpu_depth, &cpu_color_prev, &cpu_depth_prev,
+										 &cpu_motion, &cpu_motion_backward, &cpu_motion_depth_forward, &cpu_motion_depth_backward,
+										 &cpu_output);
+			break;
+		}
+		case VALIDATE_MODE::GATHER_FORWARD_ONLY:
+			dev_err = libwarp::gather_forward_only(camera_setup, delta, { color, motion, dev_output });
+			ref_err = libwarp_gather_forward_only_cpu(&camera_setup, delta, &cpu_color, &cpu_motion, &cpu_output);
+			break;
+	}
+	if (dev_err != LIBWARP_SUCCESS) {
+		return fail("backend warp failed: " + to_string(dev_err));
+	}
+	if (ref_err != LIBWARP_SUCCESS) {
+		return fail("reference warp failed: " + to_string(ref_err));
+	}
+	if (libwarp_finish() != LIBWARP_SUCCESS || !read_back(*dev_output, output)) {
+		return fail("failed to read back the output");
+	}
+	
+	// check the optional output (its exact values aren't covered by the reference implementation)
+	switch (test_case.feature) {
+		case VALIDATE_FEATURE::NONE:
+			break;
+		case VALIDATE_FEATURE::DEPTH_PYRAMID: {
+			// the pyramid only skips depth reads, so the output must be the same as the backend output without the pyramid
+			validation_image no_pyramid_output { dim, sizeof(float4) };
+			auto dev_no_pyramid_output = upload(no_pyramid_output, COMPUTE_IMAGE_TYPE::IMAGE_2D | COMPUTE_IMAGE_TYPE::RGBA32F |
+												COMPUTE_IMAGE_TYPE::READ_WRITE);
+			if (dev_no_pyramid_output == nullptr) {
+				return fail("failed to create the output image without the depth pyramid");
+			}
+			if (const auto err = libwarp_set_gather_depth_pyramid(false); err != LIBWARP_SUCCESS) {
+				return fail("failed to disable the depth pyramid: " + to_string(err));
+			}
+			if (const auto err = libwarp::gather(camera_setup, delta, {
+					color, depth, color_prev, depth_prev, motion, motion_backward,
+					motion_depth_forward, motion_depth_backward, dev_no_pyramid_output
+				}); err != LIBWARP_SUCCESS) {
+				return fail("backend warp without the depth pyramid failed: " + to_string(err));
+			}
+			if (libwarp_finish() != LIBWARP_SUCCESS || !read_back(*dev_no_pyramid_output, no_pyramid_output)) {
+				return fail("failed to read back the output without the depth pyramid");
+			}
+			// NOTE: only pixels right at the epsilon of the occlusion check may differ due to float rounding
+			uint32_t pyramid_mismatch_count { 0u };
+			for (uint32_t y = 0; y < dim.y; ++y) {
+				for (uint32_t x = 0; x < dim.x; ++x) {
+					const auto error = (output.at<float4>(x, y).xyz - no_pyramid_output.at<float4>(x, y).xyz).abs().max_element();
+					if (!(error == 0.0f)) {
+						++pyramid_mismatch_count;
+					}
+				}
+			}
+			if (float(pyramid_mismatch_count) > max_mismatch_ratio * float(dim.x * dim.y)) {
+				return fail("output differs from the output without the depth pyramid in " + to_string(pyramid_mismatch_count) + " pixels");
+			}
+			break;
+		}
+		case VALIDATE_FEATURE::CONFIDENCE_OUTPUT: {
+			if (!read_back(*dev_confidence, confidence)) {
+				return fail("failed to read back the confidence output");
+			}
+			for (uint32_t y = 0; y < dim.y; ++y) {
+				for (uint32_t x = 0; x < dim.x; ++x) {
+					const auto conf = confidence.at<float>(x, y);
+					if (!(conf >= 0.0f && conf <= 1.0f)) {
+						return fail("confidence out of range: " + to_string(conf));
+					}
+				}
+			}
+			libwarp_tile_info tile_info {};
+			if (const auto err = libwarp_get_low_confidence_tiles(&camera_setup, nullptr, 0u, &tile_info); err != LIBWARP_SUCCESS) {
+				return fail("failed to retrieve the low-confidence tiles: " + to_string(err));
+			}
+			vector<uint32_t> tile_mask(size_t(tile_info.tile_count_x) * size_t(tile_info.tile_count_y));
+			if (const auto err = libwarp_get_low_confidence_tiles(&camera_setup, tile_mask.data(), uint32_t(tile_mask.size()), nullptr);
+				err != LIBWARP_SUCCESS) {
+				return fail("failed to retrieve the low-confidence tiles: " + to_string(err));
+			}
+			break;
+		}
+		case VALIDATE_FEATURE::BLOCK_MOTION_OUTPUT: {
+			libwarp_block_motion_info block_info {};
+			if (const auto err = libwarp_get_block_motion(&camera_setup, nullptr, 0u, &block_info); err != LIBWARP_SUCCESS) {
+				return fail("failed to retrieve the block motion: " + to_string(err));
+			}
+			if (block_info.block_size != 8u ||
+				block_info.block_count_x != (dim.x + 7u) / 8u || block_info.block_count_y != (dim.y + 7u) / 8u) {
+				return fail("invalid block motion layout");
+			}
+			vector<libwarp_block_motion> blocks(size_t(block_info.block_count_x) * size_t(block_info.block_count_y));
+			if (const auto err = libwarp_get_block_motion(&camera_setup, blocks.data(), uint32_t(blocks.size()), nullptr);
+				err != LIBWARP_SUCCESS) {
+				return fail("failed to retrieve the block motion: " + to_string(err));
+			}
+			for (const auto& block : blocks) {
+				if (!(block.confidence >= 0.0f && block.confidence <= 1.0f)) {
+					return fail("block motion confidence out of range: " + to_string(block.confidence));
+				}
+			}
+			if (test_case.input == VALIDATE_INPUT::CONSTANT_MOTION) {
+				// all converged pixels have the same source offset: the forward-only gather samples at p - delta * motion,
+				// the bidirectional gather at p + (1 - delta) * motion (in the current color input)
+				const auto motion_scale = (mode == VALIDATE_MODE::GATHER_FORWARD_ONLY ? -delta : 1.0f - delta);
+				const auto expected = background_motion * motion_scale * float2 { float(dim.x), float(dim.y) } * 4.0f;
+				uint32_t valid_count { 0u };
+				for (const auto& block : blocks) {
+					if (block.confidence <= 0.0f) {
+						continue; // no converged pixels (e.g. source outside of the screen)
+					}
+					++valid_count;
+					if (abs(float(block.mv_x) - expected.x) > 1.0f || abs(float(block.mv_y) - expected.y) > 1.0f) {
+						return fail("block motion (" + to_string(block.mv_x) + ", " + to_string(block.mv_y) + ") != expected (" +
+									to_string(expected.x) + ", " + to_string(expected.y) + ")");
+					}
+				}
+				if (valid_count * 2u < uint32_t(blocks.size())) {
+					return fail("too few blocks with a valid block motion: " + to_string(valid_count));
+				}
+			}
+			break;
+		}
+	}
+	libwarp_destroy();
+	
+	// compare
+	const auto pixel_tolerance = (mode == VALIDATE_MODE::SCATTER ? scatter_tolerance : gather_tolerance);
+	float max_error { 0.0f };
+	double error_sum { 0.0 };
+	uint32_t mismatch_count { 0u };
+	for (uint32_t y = 0; y < dim.y; ++y) {
+		for (uint32_t x = 0; x < dim.x; ++x) {
+			const auto error = (output.at<float4>(x, y).xyz - ref_output.at<float4>(x, y).xyz).abs().max_element();
+			// NOTE: NaN is always a mismatch
+			if (!(error <= pixel_tolerance)) {
+				++mismatch_count;
+			}
+			if (error == error) {
+				max_error = max(max_error, error);
+				error_sum += double(error);
+			}
+		}
+	}
+	const auto pixel_count = dim.x * dim.y;
+	const auto mean_error = float(error_sum / double(pixel_count));
+	const bool is_match = (float(mismatch_count) <= max_mismatch_ratio * float(pixel_count));
+	printf("%s: %s: max error %f, mean error %f, %u/%u mismatching pixels\n", (is_match ? "passed" : "FAILED"),
+		   test_case.name().c_str(), double(max_error), double(mean_error), mismatch_count, pixel_count);
+	return is_match;
+}
+
+int main(int, char**) {
+	if (!floor::init(floor::init_state {
+		.call_path = "",
+		.data_path = "data/",
+		.app_name = "libwarp_validate",
+		.console_only = true,
+		.renderer = floor::RENDERER::NONE,
+	})) {
+		printf("failed to initialize libfloor\n");
+		return 1;
+	}
+	// NOTE: libwarp uses the same compute context and device, but its own queue
+	ctx = floor::get_compute_context();
+	auto dev = (ctx != nullptr ? ctx->get_device(compute_device::TYPE::FASTEST) : nullptr);
+	dev_queue = (dev != nullptr ? ctx->create_queue(*dev) : nullptr);
+	if (dev_queue == nullptr) {
+		printf("failed to create the compute queue\n");
+		return 1;
+	}
+	
+	// screen size isn't a multiple of any tile size
+	libwarp_camera_setup base_setup {
+		.screen_width = 250u,
+		.screen_height = 158u,
+		.field_of_view = 72.0f,
+		.near_plane = 0.5f,
+		.far_plane = 100.0f,
+		.depth_type = LIBWARP_DEPTH_NORMALIZED,
+	};
+	vector<validation_case> cases;
+	
+	// all warp modes, inputs, projections and depth types, scatter also cycles through all splat modes and input downscales
+	static constexpr const VALIDATE_MODE modes[] {
+		VALIDATE_MODE::SCATTER, VALIDATE_MODE::GATHER_BIDIRECTIONAL, VALIDATE_MODE::GATHER_FORWARD_ONLY,
+	};
+	static constexpr const LIBWARP_SPLAT_MODE splat_modes[] { LIBWARP_SPLAT_NONE, LIBWARP_SPLAT_2X2, LIBWARP_SPLAT_ADAPTIVE };
+	static constexpr const uint32_t input_downscales[] { 1u, 2u, 4u };
+	uint32_t scatter_variant { 0u };
+	for (const auto mode : modes) {
+		for (const auto input : { VALIDATE_INPUT::RANDOM, VALIDATE_INPUT::SYNTHETIC }) {
+			for (uint32_t projection = 0; projection <= uint32_t(LIBWARP_PROJECTION_CUBEMAP_FACE); ++projection) {
+				for (uint32_t depth_type = 0; depth_type <= uint32_t(LIBWARP_DEPTH_LINEAR); ++depth_type) {
+					auto camera_setup = base_setup;
+					camera_setup.projection = LIBWARP_PROJECTION(projection);
+					camera_setup.depth_type = LIBWARP_DEPTH_TYPE(depth_type);
+					if (mode == VALIDATE_MODE::SCATTER) {
+						camera_setup.splat_mode = splat_modes[scatter_variant % size(splat_modes)];
+						camera_setup.input_downscale = input_downscales[(scatter_variant / size(splat_modes)) % size(input_downscales)];
+						++scatter_variant;
+					}
+					cases.emplace_back(validation_case { mode, input, VALIDATE_FEATURE::NONE, camera_setup });
+				}
+			}
+		}
+	}
+	
+	// optional outputs/features that must not change the warp output
+	cases.emplace_back(validation_case { VALIDATE_MODE::SCATTER, VALIDATE_INPUT::SYNTHETIC, VALIDATE_FEATURE::CONFIDENCE_OUTPUT, base_setup });
+	cases.emplace_back(validation_case { VALIDATE_MODE::GATHER_BIDIRECTIONAL, VALIDATE_INPUT::SYNTHETIC,
+										 VALIDATE_FEATURE::CONFIDENCE_OUTPUT, base_setup });
+	cases.emplace_back(validation_case { VALIDATE_MODE::GATHER_FORWARD_ONLY, VALIDATE_INPUT::SYNTHETIC,
+										 VALIDATE_FEATURE::CONFIDENCE_OUTPUT, base_setup });
+	cases.emplace_back(validation_case { VALIDATE_MODE::GATHER_BIDIRECTIONAL, VALIDATE_INPUT::SYNTHETIC,
+										 VALIDATE_FEATURE::BLOCK_MOTION_OUTPUT, base_setup });
+	cases.emplace_back(validation_case { VALIDATE_MODE::GATHER_FORWARD_ONLY, VALIDATE_INPUT::SYNTHETIC,
+										 VALIDATE_FEATURE::BLOCK_MOTION_OUTPUT, base_setup });
+	// block motion values are checked against the known motion
+	cases.emplace_back(validation_case { VALIDATE_MODE::GATHER_BIDIRECTIONAL, VALIDATE_INPUT::CONSTANT_MOTION,
+										 VALIDATE_FEATURE::BLOCK_MOTION_OUTPUT, base_setup });
+	cases.emplace_back(validation_case { VALIDATE_MODE::GATHER_FORWARD_ONLY, VALIDATE_INPUT::CONSTANT_MOTION,
+										 VALIDATE_FEATURE::BLOCK_MOTION_OUTPUT, base_setup });
+	cases.emplace_back(validation_case { VALIDATE_MODE::GATHER_BIDIRECTIONAL, VALIDATE_INPUT::SYNTHETIC,
+										 VALIDATE_FEATURE::DEPTH_PYRAMID, base_setup });
+	cases.emplace_back(validation_case { VALIDATE_MODE::GATHER_BIDIRECTIONAL, VALIDATE_INPUT::RANDOM,
+										 VALIDATE_FEATURE::DEPTH_PYRAMID, base_setup });
+	
+	// variants that change the warp output in ways the reference implementation doesn't implement
+	static constexpr const char* excluded_variants[] {
+		"scatter history (temporal hole filling): output depends on the previous frames, no reference implementation",
+		"scatter with a second layer: no reference implementation of the second layer passes",
+		"second-order (accel) scatter/forward-only gather: no reference implementation of the acceleration term",
+		"unified motion scatter/gathers: no reference implementation of the unified motion decoding",
+		"depth-aware forward-only gather: no reference implementation of the depth-based occlusion resolve",
+		"motion blurred gathers: no reference implementation of the sub-frame sample averaging",
+		"composed motion forward-only gather: no reference implementation of the motion field composition",
+		"streaming scatter: no reference implementation of the band-wise input/output callbacks",
+		"block-matching motion estimation: no reference implementation of the luma pyramid search",
+		"auto mode (incl. mixed warping): selected mode depends on measured kernel costs, no reference implementation",
+	};
+	
+	uint32_t failed_count { 0u };
+	for (uint32_t i = 0; i < uint32_t(cases.size()); ++i) {
+		if (!run_case(cases[i], 0x1234u + i, 0.5f)) {
+			++failed_count;
+		}
+	}
+	for (const auto& excluded : excluded_variants) {
+		printf("excluded: %s\n", excluded);
+	}
+	printf("%u/%u test cases passed\n", uint32_t(cases.size()) - failed_count, uint32_t(cases.size()));
+	
+	dev_queue = nullptr;
+	ctx = nullptr;
+	floor::destroy();
+	return (failed_count == 0u ? 0 : 1);
+}